@@ -0,0 +1,74 @@
+// EloCalculator over a batch of independent matches (K-factor what-ifs,
+// leaderboard previews): calculate() per pair vs calculateBatch() over SoA
+// spans. Both produce the same ratings; the second argument switches to the
+// compile-time table (elo.expected_score_table).
+//
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=EloCalculator
+
+#include <benchmark/benchmark.h>
+#include "utils/elo_calculator.h"
+#include "utils/validation.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Matches {
+  std::vector<int> elo1, elo2, score1, score2;
+};
+
+Matches makeMatches(size_t n) {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> elo(1500.0, 300.0);
+  std::uniform_int_distribution<int> score(0, 11);
+  auto rating = [&] {
+    return std::clamp(static_cast<int>(elo(rng)), utils::MIN_ELO, utils::MAX_ELO);
+  };
+  Matches m;
+  for (size_t i = 0; i < n; ++i) {
+    m.elo1.push_back(rating());
+    m.elo2.push_back(rating());
+    m.score1.push_back(score(rng));
+    m.score2.push_back(score(rng));
+  }
+  return m;
+}
+
+// range(1) = 1 selects the compile-time table (ExpectedScoreMode::kTable)
+utils::ExpectedScoreMode modeArg(const benchmark::State& state) {
+  return state.range(1) ? utils::ExpectedScoreMode::kTable : utils::ExpectedScoreMode::kExact;
+}
+
+void BM_EloCalculatorScalar(benchmark::State& state) {
+  auto m = makeMatches(static_cast<size_t>(state.range(0)));
+  utils::EloCalculator calculator(32, modeArg(state));
+  std::vector<int> new1(m.elo1.size()), new2(m.elo1.size());
+  for (auto _ : state) {
+    for (size_t i = 0; i < m.elo1.size(); ++i) {
+      auto [a, b] = calculator.calculate(m.elo1[i], m.elo2[i], m.score1[i], m.score2[i]);
+      new1[i] = a;
+      new2[i] = b;
+    }
+    benchmark::DoNotOptimize(new1.data());
+    benchmark::DoNotOptimize(new2.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_EloCalculatorBatch(benchmark::State& state) {
+  auto m = makeMatches(static_cast<size_t>(state.range(0)));
+  utils::EloCalculator calculator(32, modeArg(state));
+  std::vector<int> new1(m.elo1.size()), new2(m.elo1.size());
+  for (auto _ : state) {
+    calculator.calculateBatch(m.elo1, m.elo2, m.score1, m.score2, new1, new2);
+    benchmark::DoNotOptimize(new1.data());
+    benchmark::DoNotOptimize(new2.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_EloCalculatorScalar)->ArgsProduct({{1024, 65536}, {0, 1}});
+BENCHMARK(BM_EloCalculatorBatch)->ArgsProduct({{1024, 65536}, {0, 1}});
@@ -0,0 +1,49 @@
+// In-memory part of the /undo replay: a group's whole match history through
+// utils::EloReplay. The database side adds one SELECT and three batched
+// UPDATEs on top.
+//
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=EloReplay
+
+#include <benchmark/benchmark.h>
+#include "utils/elo_calculator.h"
+#include "utils/elo_replay.h"
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<utils::ReplayMatch> makeHistory(size_t matches, int players) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> player(1, players);
+  std::uniform_int_distribution<int> score(0, 11);
+  std::vector<utils::ReplayMatch> history;
+  history.reserve(matches);
+  for (size_t i = 0; i < matches; ++i) {
+    int p1 = player(rng);
+    int p2 = player(rng);
+    if (p2 == p1) {
+      p2 = p1 % players + 1;
+    }
+    history.push_back({static_cast<int64_t>(i + 1), p1, p2, score(rng), score(rng)});
+  }
+  return history;
+}
+
+void BM_EloReplay(benchmark::State& state) {
+  auto history = makeHistory(static_cast<size_t>(state.range(0)), static_cast<int>(state.range(1)));
+  utils::EloCalculator calculator(32);
+  for (auto _ : state) {
+    utils::EloReplay replay(calculator);
+    auto replayed = replay.replay(history);
+    benchmark::DoNotOptimize(replayed.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(BM_EloReplay)
+    ->Args({1000, 20})
+    ->Args({100000, 50})
+    ->Args({100000, 1000})
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,159 @@
+// Webhook request parsing: zero-copy HttpRequestParser vs the previous
+// string-building parser, on payloads shaped like real Telegram deliveries.
+//
+//   cmake -DBUILD_BENCHMARKS=ON .. && make school_tg_tt_bot_benchmarks
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=Parse
+
+#include <benchmark/benchmark.h>
+#include "bot/http_request_parser.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+
+// Count heap allocations so the benchmark reports allocations per request
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"  // malloc/free pairing is intentional
+#endif
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(size_t size) {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+// Captured deliveries (ids and names anonymised)
+const char* kCommandUpdate = R"({"update_id":873341207,"message":{"message_id":5121,"message_thread_id":5043,"from":{"id":412345678,"is_bot":false,"first_name":"Alex","last_name":"Petrov","username":"apetrov","language_code":"en"},"chat":{"id":-1002087654321,"title":"School 21 Table Tennis","is_forum":true,"type":"supergroup"},"date":1718032211,"is_topic_message":true,"text":"/match @apetrov @mkuznetsova 11 7","entities":[{"offset":0,"length":6,"type":"bot_command"},{"offset":7,"length":8,"type":"mention"},{"offset":16,"length":12,"type":"mention"}]}})";
+
+const char* kChatMemberUpdate = R"({"update_id":873341208,"chat_member":{"chat":{"id":-1002087654321,"title":"School 21 Table Tennis","is_forum":true,"type":"supergroup"},"from":{"id":512345678,"is_bot":false,"first_name":"Maria","username":"mkuznetsova"},"date":1718032290,"old_chat_member":{"user":{"id":512345678,"is_bot":false,"first_name":"Maria","username":"mkuznetsova"},"status":"left"},"new_chat_member":{"user":{"id":512345678,"is_bot":false,"first_name":"Maria","username":"mkuznetsova"},"status":"member"}}})";
+
+std::string makeDelivery(const std::string& body) {
+  return "POST /webhook HTTP/1.1\r\n"
+         "Host: bot.example.com\r\n"
+         "Content-Type: application/json\r\n"
+         "Content-Length: " + std::to_string(body.size()) + "\r\n"
+         "X-Telegram-Bot-Api-Secret-Token: 3b1f0c9a7e5d4b2a8c6e0f1d3b5a7c9e\r\n"
+         "Accept-Encoding: gzip, deflate\r\n"
+         "Connection: keep-alive\r\n"
+         "\r\n" + body;
+}
+
+// Previous WebhookServer parsing: headers accumulated from 4 KiB recv() chunks,
+// request line and header lines split with istringstream, every name and value
+// copied into its own std::string
+struct LegacyRequest {
+  std::string method;
+  std::string path;
+  std::string content_type;
+  std::string secret_token;
+  std::string body;
+  bool valid = false;
+};
+
+LegacyRequest legacyParse(const std::string& raw) {
+  LegacyRequest request;
+  size_t offset = 0;
+
+  // readHeaders()
+  std::string headers;
+  char buffer[4096];
+  while (offset < raw.size()) {
+    size_t n = std::min(sizeof(buffer) - 1, raw.size() - offset);
+    std::copy_n(raw.data() + offset, n, buffer);
+    offset += n;
+    buffer[n] = '\0';
+    headers += buffer;
+    if (headers.find("\r\n\r\n") != std::string::npos) {
+      size_t end = headers.find("\r\n\r\n");
+      offset -= headers.size() - (end + 4);
+      headers = headers.substr(0, end + 4);
+      break;
+    }
+  }
+
+  size_t first_line_end = headers.find("\r\n");
+  std::string request_line = headers.substr(0, first_line_end);
+  std::istringstream iss(request_line);
+  std::string version;
+  iss >> request.method >> request.path >> version;
+
+  size_t content_length = 0;
+  std::string header_section = headers.substr(first_line_end + 2);
+  std::istringstream header_stream(header_section);
+  std::string line;
+  while (std::getline(header_stream, line)) {
+    if (line.empty() || line == "\r") break;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = line.substr(0, colon);
+    std::string value = line.substr(colon + 1);
+    size_t start = value.find_first_not_of(" \t");
+    if (start != std::string::npos) value = value.substr(start);
+    std::string name_lower = name;
+    std::transform(name_lower.begin(), name_lower.end(), name_lower.begin(), ::tolower);
+    if (name_lower == "content-length") {
+      content_length = std::stoull(value);
+    } else if (name_lower == "content-type") {
+      request.content_type = value;
+    } else if (name_lower == "x-telegram-bot-api-secret-token") {
+      request.secret_token = value;
+    }
+  }
+
+  // readBody()
+  request.body.reserve(content_length);
+  request.body.append(raw, offset, content_length);
+  request.valid = true;
+  return request;
+}
+
+void BM_ParseLegacy(benchmark::State& state, const char* payload) {
+  std::string raw = makeDelivery(payload);
+  size_t allocations = 0;
+  for (auto _ : state) {
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    LegacyRequest request = legacyParse(raw);
+    benchmark::DoNotOptimize(request);
+    allocations += g_allocations.load(std::memory_order_relaxed) - before;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+  state.counters["allocs_per_request"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+void BM_ParseZeroCopy(benchmark::State& state, const char* payload) {
+  std::string raw = makeDelivery(payload);
+  bot::HttpRequestParser parser(8192, 1024 * 1024);
+  size_t allocations = 0;
+  for (auto _ : state) {
+    size_t before = g_allocations.load(std::memory_order_relaxed);
+    bot::HttpRequestView request;
+    parser.reset();
+    parser.parse(raw, request);
+    // The webhook path copies only the body for the update callback
+    std::string body(request.body);
+    benchmark::DoNotOptimize(body);
+    allocations += g_allocations.load(std::memory_order_relaxed) - before;
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * raw.size()));
+  state.counters["allocs_per_request"] =
+      benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_ParseLegacy, command, kCommandUpdate);
+BENCHMARK_CAPTURE(BM_ParseZeroCopy, command, kCommandUpdate);
+BENCHMARK_CAPTURE(BM_ParseLegacy, chat_member, kChatMemberUpdate);
+BENCHMARK_CAPTURE(BM_ParseZeroCopy, chat_member, kChatMemberUpdate);
@@ -0,0 +1,130 @@
+// Cost of a log call on the calling thread:
+//  - the ring-buffer Logger against the previous mutex + format + write path
+//  - the webhook's per-update lines, string concatenation against typed fields
+//  - a disabled DEBUG line, the method call against OBS_DEBUG
+// Output goes to /dev/null so only the logging path is measured.
+//
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=Log
+
+#include <benchmark/benchmark.h>
+#include "observability/logger.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+int devNull() {
+  static int fd = ::open("/dev/null", O_WRONLY);
+  return fd;
+}
+
+// The synchronous logger this replaced
+std::mutex g_legacy_mutex;
+
+void legacyLog(const std::string& message) {
+  std::lock_guard<std::mutex> lock(g_legacy_mutex);
+  nlohmann::json entry;
+  auto now = std::time(nullptr);
+  auto tm = *std::gmtime(&now);
+  std::ostringstream oss;
+  oss << std::put_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
+  entry["timestamp"] = oss.str();
+  entry["level"] = "INFO";
+  entry["message"] = message;
+  std::string line = entry.dump() + "\n";
+  benchmark::DoNotOptimize(::write(devNull(), line.data(), line.size()));
+}
+
+void BM_LogLegacy(benchmark::State& state) {
+  const std::string message = "Processing webhook request";
+  for (auto _ : state) {
+    legacyLog(message);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LogRingBuffer(benchmark::State& state) {
+  auto logger = observability::Logger::getInstance();
+  if (state.thread_index() == 0) {
+    logger->setOutput(devNull());
+    logger->setOverflowPolicy(observability::OverflowPolicy::kBlock);
+  }
+  const std::string message = "Processing webhook request";
+  for (auto _ : state) {
+    logger->info(message);
+  }
+  if (state.thread_index() == 0) {
+    logger->flush();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// The two INFO lines WebhookServer writes for every update
+void BM_LogWebhookConcatenated(benchmark::State& state) {
+  auto logger = observability::Logger::getInstance();
+  logger->setOutput(devNull());
+  logger->setOverflowPolicy(observability::OverflowPolicy::kBlock);
+  const char* client_ip = "149.154.167.220";
+  uint16_t client_port = 43512;
+  size_t body_size = 842;
+  for (auto _ : state) {
+    logger->info("Incoming webhook connection from " + std::string(client_ip) + ":" +
+                 std::to_string(client_port));
+    logger->info("Processing Telegram update, body_size=" + std::to_string(body_size));
+  }
+  logger->flush();
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+void BM_LogWebhookTypedFields(benchmark::State& state) {
+  auto logger = observability::Logger::getInstance();
+  logger->setOutput(devNull());
+  logger->setOverflowPolicy(observability::OverflowPolicy::kBlock);
+  const char* client_ip = "149.154.167.220";
+  uint16_t client_port = 43512;
+  size_t body_size = 842;
+  for (auto _ : state) {
+    logger->info("Incoming webhook connection",
+                 observability::field<"client_ip">(client_ip),
+                 observability::field<"client_port">(client_port));
+    logger->info("Processing Telegram update", observability::field<"body_size">(body_size));
+  }
+  logger->flush();
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+
+// A DEBUG line at the production INFO level: the method call builds its
+// argument before the level check, the macro never does
+void BM_LogDisabledDebugCall(benchmark::State& state) {
+  auto logger = observability::Logger::getInstance();
+  logger->setLevel(observability::LogLevel::INFO);
+  const std::string username = "apetrov";
+  for (auto _ : state) {
+    logger->debug("Username not found in cache: @" + username);
+  }
+}
+
+void BM_LogDisabledDebugMacro(benchmark::State& state) {
+  auto logger = observability::Logger::getInstance();
+  logger->setLevel(observability::LogLevel::INFO);
+  const std::string username = "apetrov";
+  for (auto _ : state) {
+    OBS_DEBUG(logger, "Username not found in cache: @" + username);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_LogLegacy)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_LogRingBuffer)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_LogWebhookConcatenated);
+BENCHMARK(BM_LogWebhookTypedFields);
+BENCHMARK(BM_LogDisabledDebugCall);
+BENCHMARK(BM_LogDisabledDebugMacro);
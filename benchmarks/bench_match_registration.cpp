@@ -0,0 +1,236 @@
+// /match registration throughput, all threads recording matches between the
+// same two players of one group (the contended case):
+//   Inline    - the old Bot::handleMatch transaction, inline SQL (exec_params)
+//   Prepared  - the same seven statements through the prepared catalogue
+//   Function  - unlocked rating read + one register_match() call (V2 migration)
+// Needs a migrated database, like the integration tests (DATABASE_URL or
+// POSTGRES_* variables). Rows use Telegram ids above 3000000 and are removed at
+// the start of the next run.
+//
+//   cmake -DBUILD_BENCHMARKS=ON .. && make school_tg_tt_bot_benchmarks
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=MatchRegistration
+
+#include <benchmark/benchmark.h>
+#include "database/prepared_statements.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <pqxx/pqxx>
+
+namespace {
+
+// Benchmark rows live above this id so they never collide with test data
+constexpr int64_t kTelegramIdBase = 3000000;
+constexpr int64_t kGroupTelegramId = -(kTelegramIdBase + 1);
+constexpr int64_t kUser1TelegramId = kTelegramIdBase + 1;
+constexpr int64_t kUser2TelegramId = kTelegramIdBase + 2;
+
+// Unique idempotency keys across threads and runs
+std::atomic<int64_t> g_sequence{0};
+const std::string kRunPrefix =
+    "bench_" + std::to_string(std::chrono::system_clock::now().time_since_epoch().count()) + "_";
+
+std::string nextKey() {
+  return kRunPrefix + std::to_string(g_sequence.fetch_add(1));
+}
+
+std::string connectionString() {
+  if (const char* db_url = std::getenv("DATABASE_URL")) {
+    return db_url;
+  }
+  auto env = [](const char* name, const char* fallback) {
+    const char* value = std::getenv(name);
+    return std::string(value ? value : fallback);
+  };
+  return "postgresql://" + env("POSTGRES_USER", "postgres") + ":" + env("POSTGRES_PASSWORD", "postgres") +
+         "@" + env("POSTGRES_HOST", "localhost") + ":" + env("POSTGRES_PORT", "5432") + "/" +
+         env("POSTGRES_DB", "school_tg_bot");
+}
+
+void cleanup(pqxx::connection& conn) {
+  pqxx::work txn(conn);
+  std::string base = std::to_string(kTelegramIdBase);
+  std::string groups = "(SELECT id FROM groups WHERE telegram_group_id = " + std::to_string(kGroupTelegramId) + ")";
+  txn.exec("DELETE FROM elo_history WHERE group_id IN " + groups);
+  txn.exec("DELETE FROM matches WHERE group_id IN " + groups);
+  txn.exec("DELETE FROM group_players WHERE group_id IN " + groups);
+  txn.exec("DELETE FROM groups WHERE telegram_group_id = " + std::to_string(kGroupTelegramId));
+  txn.exec("DELETE FROM players WHERE telegram_user_id > " + base);
+  txn.commit();
+}
+
+struct Fixture {
+  int64_t group_id = 0;
+  int64_t player1_id = 0;
+  int64_t player2_id = 0;
+};
+
+// Get-or-create, so every benchmark thread can call it
+Fixture setUp(pqxx::connection& conn) {
+  static std::once_flag cleaned;
+  std::call_once(cleaned, [&conn] { cleanup(conn); });
+
+  pqxx::work txn(conn);
+  txn.exec_params("INSERT INTO groups (telegram_group_id, name) VALUES ($1, 'bench') "
+                  "ON CONFLICT (telegram_group_id) DO NOTHING", kGroupTelegramId);
+  for (int64_t user : {kUser1TelegramId, kUser2TelegramId}) {
+    txn.exec_params("INSERT INTO players (telegram_user_id) VALUES ($1) "
+                    "ON CONFLICT (telegram_user_id) WHERE deleted_at IS NULL DO NOTHING", user);
+  }
+  Fixture fixture;
+  fixture.group_id = txn.exec_params1("SELECT id FROM groups WHERE telegram_group_id = $1",
+                                      kGroupTelegramId)[0].as<int64_t>();
+  fixture.player1_id = txn.exec_params1("SELECT id FROM players WHERE telegram_user_id = $1 AND deleted_at IS NULL",
+                                        kUser1TelegramId)[0].as<int64_t>();
+  fixture.player2_id = txn.exec_params1("SELECT id FROM players WHERE telegram_user_id = $1 AND deleted_at IS NULL",
+                                        kUser2TelegramId)[0].as<int64_t>();
+  for (int64_t player_id : {fixture.player1_id, fixture.player2_id}) {
+    txn.exec_params("INSERT INTO group_players (group_id, player_id) VALUES ($1, $2) "
+                    "ON CONFLICT (group_id, player_id) DO NOTHING",
+                    fixture.group_id, player_id);
+  }
+  txn.commit();
+  return fixture;
+}
+
+// One registration as Bot::handleMatch ran it before the catalogue
+void registerInline(pqxx::connection& conn, const Fixture& f) {
+  std::string key = nextKey();
+  pqxx::work work(conn);
+  work.exec_params("SELECT id FROM matches WHERE idempotency_key = $1", key);
+  int64_t gp_ids[2];
+  int versions[2];
+  int64_t players[2] = {f.player1_id, f.player2_id};
+  for (int i = 0; i < 2; ++i) {
+    auto row = work.exec_params1(
+        "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
+        "FROM group_players "
+        "WHERE group_id = $1 AND player_id = $2 FOR UPDATE",
+        f.group_id, players[i]);
+    gp_ids[i] = row["id"].as<int64_t>();
+    versions[i] = row["version"].as<int>();
+  }
+  for (int i = 0; i < 2; ++i) {
+    work.exec_params(
+        "UPDATE group_players SET "
+        "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
+        "version = version + 1, updated_at = NOW() "
+        "WHERE id = $5 AND version = $6",
+        1500, 1, 0, 0, gp_ids[i], versions[i]);
+  }
+  auto match_id = work.exec_params1(
+      "INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score, "
+      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
+      "idempotency_key, created_by_telegram_user_id, created_at, is_undone) "
+      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), FALSE) "
+      "RETURNING id, created_at",
+      f.group_id, f.player1_id, f.player2_id, 11, 7, 1500, 1500, 1500, 1500, key,
+      kUser1TelegramId)["id"].as<int64_t>();
+  for (int i = 0; i < 2; ++i) {
+    work.exec_params(
+        "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
+        "elo_after, elo_change, created_at, is_undone) "
+        "VALUES ($1, $2, $3, $4, $5, $6, NOW(), FALSE)",
+        match_id, f.group_id, players[i], 1500, 1500, 0);
+  }
+  work.commit();
+}
+
+// The same seven statements through the prepared-statement catalogue
+void registerPrepared(pqxx::connection& conn, const Fixture& f) {
+  using namespace database::statements;
+  std::string key = nextKey();
+  pqxx::work work(conn);
+  work.exec_prepared(kMatchByIdempotencyKey, key);
+  int64_t gp_ids[2];
+  int versions[2];
+  int64_t players[2] = {f.player1_id, f.player2_id};
+  for (int i = 0; i < 2; ++i) {
+    auto row = work.exec_prepared1(kGroupPlayerLock, f.group_id, players[i]);
+    gp_ids[i] = row["id"].as<int64_t>();
+    versions[i] = row["version"].as<int>();
+  }
+  for (int i = 0; i < 2; ++i) {
+    work.exec_prepared(kGroupPlayerUpdateVersioned, 1500, 1, 0, 0, gp_ids[i], versions[i]);
+  }
+  auto match_id = work.exec_prepared1(
+      kMatchInsert, f.group_id, f.player1_id, f.player2_id, 11, 7, 1500, 1500, 1500, 1500, key,
+      kUser1TelegramId)["id"].as<int64_t>();
+  for (int i = 0; i < 2; ++i) {
+    work.exec_prepared(kEloHistoryInsert, match_id, f.group_id, players[i], 1500, 1500, 0, false);
+  }
+  work.commit();
+}
+
+// MatchRepository::getRatings() + registerMatch(), retried on version conflicts
+void registerFunction(pqxx::connection& conn, const Fixture&) {
+  using namespace database::statements;
+  std::string key = nextKey();
+  while (true) {
+    int versions[2];
+    {
+      pqxx::work read(conn);
+      auto ratings = read.exec_prepared(kMatchRatings, kGroupTelegramId, kUser1TelegramId, kUser2TelegramId);
+      versions[0] = ratings[0]["version"].as<int>();
+      versions[1] = ratings[1]["version"].as<int>();
+      read.commit();
+    }
+    try {
+      pqxx::work work(conn);
+      work.exec_prepared(kRegisterMatch, kGroupTelegramId, "bench", kUser1TelegramId, kUser2TelegramId,
+                         11, 7, versions[0], versions[1], 1500, 1500, key, kUser1TelegramId,
+                         350.0, 350.0, 0.06, 0.06);
+      work.commit();
+      return;
+    } catch (const pqxx::sql_error& e) {
+      if (e.sqlstate() != "TT001") {
+        throw;
+      }
+    }
+  }
+}
+
+using RegisterFn = void (*)(pqxx::connection&, const Fixture&);
+
+void runRegistrations(benchmark::State& state, RegisterFn register_match) {
+  std::unique_ptr<pqxx::connection> conn;
+  Fixture fixture;
+  try {
+    conn = std::make_unique<pqxx::connection>(connectionString());
+    if (register_match != registerInline) {
+      database::prepareStatements(*conn);
+    }
+    fixture = setUp(*conn);
+  } catch (const std::exception& e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+
+  for (auto _ : state) {
+    register_match(*conn, fixture);
+  }
+  state.counters["registrations_per_second"] =
+      benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+
+void BM_MatchRegistrationInline(benchmark::State& state) {
+  runRegistrations(state, registerInline);
+}
+
+void BM_MatchRegistrationPrepared(benchmark::State& state) {
+  runRegistrations(state, registerPrepared);
+}
+
+void BM_MatchRegistrationFunction(benchmark::State& state) {
+  runRegistrations(state, registerFunction);
+}
+
+}  // namespace
+
+BENCHMARK(BM_MatchRegistrationInline)->Threads(1)->Threads(8)->UseRealTime();
+BENCHMARK(BM_MatchRegistrationPrepared)->Threads(1)->Threads(8)->UseRealTime();
+BENCHMARK(BM_MatchRegistrationFunction)->Threads(1)->Threads(8)->UseRealTime();
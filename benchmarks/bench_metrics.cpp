@@ -0,0 +1,47 @@
+// Cost of recording a metric from many threads at once:
+//  - the sharded Counter against a single shared atomic
+//  - Histogram::observe() on one shared histogram
+//
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=Metric
+
+#include <benchmark/benchmark.h>
+#include "observability/metrics.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace {
+
+std::atomic<uint64_t> g_shared_counter{0};
+
+void BM_MetricSharedAtomic(benchmark::State& state) {
+  for (auto _ : state) {
+    g_shared_counter.fetch_add(1, std::memory_order_relaxed);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MetricCounter(benchmark::State& state) {
+  static auto& counter = observability::MetricsRegistry::getInstance().counter(
+      "bench_counter_total", "Benchmark counter");
+  for (auto _ : state) {
+    counter.inc();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_MetricHistogram(benchmark::State& state) {
+  static auto& histogram = observability::MetricsRegistry::getInstance().histogram(
+      "bench_latency_seconds", "Benchmark histogram");
+  auto duration = std::chrono::microseconds(250);
+  for (auto _ : state) {
+    histogram.observe(duration);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_MetricSharedAtomic)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_MetricCounter)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_MetricHistogram)->ThreadRange(1, 8)->UseRealTime();
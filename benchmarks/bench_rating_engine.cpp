@@ -0,0 +1,57 @@
+// RatingEngine::rateBatch per rating system over independent matches, i.e.
+// the cost each group pays per /match (and per match of a what-if run)
+//
+//   ./school_tg_tt_bot_benchmarks --benchmark_filter=RatingEngine
+
+#include <benchmark/benchmark.h>
+#include "utils/rating_engine.h"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+void BM_RatingEngineBatch(benchmark::State& state) {
+  auto system = static_cast<utils::RatingSystem>(state.range(0));
+  const size_t n = static_cast<size_t>(state.range(1));
+  utils::RatingEngines engines;
+  const auto& engine = engines.get(system);
+
+  std::mt19937 rng(7);
+  std::normal_distribution<double> rating(1500.0, 300.0);
+  std::uniform_int_distribution<int> score(0, 11);
+  std::vector<int> rating1(n), rating2(n), score1(n), score2(n);
+  for (size_t i = 0; i < n; ++i) {
+    rating1[i] = static_cast<int>(rating(rng));
+    rating2[i] = static_cast<int>(rating(rng));
+    score1[i] = score(rng);
+    score2[i] = score(rng);
+  }
+  std::vector<int> r1(n), r2(n);
+  std::vector<double> deviation1(n), deviation2(n), volatility1(n), volatility2(n);
+
+  for (auto _ : state) {
+    // Every iteration rates the same starting state
+    state.PauseTiming();
+    r1 = rating1;
+    r2 = rating2;
+    std::fill(deviation1.begin(), deviation1.end(), utils::kInitialDeviation);
+    std::fill(deviation2.begin(), deviation2.end(), utils::kInitialDeviation);
+    std::fill(volatility1.begin(), volatility1.end(), utils::kInitialVolatility);
+    std::fill(volatility2.begin(), volatility2.end(), utils::kInitialVolatility);
+    state.ResumeTiming();
+    engine.rateBatch({r1, r2, deviation1, deviation2, volatility1, volatility2, score1, score2});
+    benchmark::DoNotOptimize(r1.data());
+  }
+  state.SetLabel(std::string(utils::toString(system)));
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+}  // namespace
+
+BENCHMARK(BM_RatingEngineBatch)
+    ->ArgsProduct({{static_cast<int>(utils::RatingSystem::kElo),
+                    static_cast<int>(utils::RatingSystem::kGlicko2),
+                    static_cast<int>(utils::RatingSystem::kMarginElo)},
+                   {1, 4096}});
@@ -2,6 +2,7 @@
 #define BOT_BOT_H
 
 #include "bot/bot_base.h"
+#include "bot/outbound_sender.h"
 #include "bot/production_bot_api.h"
 #include <memory>
 #include <string>
@@ -19,10 +20,13 @@ class MatchRepository;
 
 namespace school21 {
 class ApiClient;
+class VerificationCache;
+class VerificationPool;
+struct Lookup;
 }
 
 namespace utils {
-class EloCalculator;
+class RatingEngines;
 }
 
 namespace observability {
@@ -85,6 +89,11 @@ class Bot : public BotBase<Bot>, public ProductionBotApi {
   void onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message) override;
 
  private:
+  // Update routing, run on the chat's dispatcher lane
+  void routeCommand(const tgbotxx::Ptr<tgbotxx::Message>& command);
+  void routeChatMemberUpdate(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& chatMember);
+  void routeAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message);
+
   std::string token_;
   
   // Dependencies
@@ -93,7 +102,7 @@ class Bot : public BotBase<Bot>, public ProductionBotApi {
   std::unique_ptr<repositories::PlayerRepository> player_repo_;
   std::unique_ptr<repositories::MatchRepository> match_repo_;
   std::unique_ptr<school21::ApiClient> school21_client_;
-  std::unique_ptr<utils::EloCalculator> elo_calculator_;
+  std::unique_ptr<utils::RatingEngines> rating_engines_;
   observability::Logger* logger_;
   
   // Username cache (username -> user_id mapping)
@@ -106,8 +115,15 @@ class Bot : public BotBase<Bot>, public ProductionBotApi {
   void handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleId(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleIdGuest(const tgbotxx::Ptr<tgbotxx::Message>& message);
+  // Second half of /id, once the School21 lookup is done
+  // cached: the lookup came from verification_cache_ and is not stored again
+  void completeIdVerification(const tgbotxx::Ptr<tgbotxx::Message>& message,
+                              const std::string& nickname,
+                              const school21::Lookup& lookup, bool cached);
   void handleUndo(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleConfigTopic(const tgbotxx::Ptr<tgbotxx::Message>& message);
+  void handleRatingSystem(const tgbotxx::Ptr<tgbotxx::Message>& message);
+  void handleKPolicy(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleHelp(const tgbotxx::Ptr<tgbotxx::Message>& message);
   
   // Group event handlers
@@ -156,6 +172,13 @@ class Bot : public BotBase<Bot>, public ProductionBotApi {
   void reactToMessage(int64_t chat_id, int message_id, const std::string& emoji);
   void sendToLogsTopic(int64_t chat_id, const std::string& text);
   
+  // Outbound queue: handlers enqueue, sender threads call deliver()
+  // Delivers inline when the sender is off or shut down; drops the message
+  // when the queue is full.
+  void startOutboundSender();
+  void enqueueOrDeliver(OutboundMessage message);
+  void deliver(const OutboundMessage& message);  // Throws on API errors
+  
   // Group and player helpers
   models::Group getOrCreateGroup(int64_t telegram_group_id, const std::string& name = "");
   models::Player getOrCreatePlayer(int64_t telegram_user_id);
@@ -174,6 +197,12 @@ class Bot : public BotBase<Bot>, public ProductionBotApi {
   // Undo helpers
   bool isMatchUndoable(const models::Match& match, int64_t user_id);
   void undoMatchTransaction(int64_t match_id, int64_t undone_by_user_id);
+  
+  // Destroyed first, in reverse order: pending /id lookups still reply
+  // through the sender, and the sender still calls the API
+  std::unique_ptr<OutboundSender> outbound_sender_;
+  std::unique_ptr<school21::VerificationCache> verification_cache_;
+  std::unique_ptr<school21::VerificationPool> verification_pool_;
 };
 
 }  // namespace bot
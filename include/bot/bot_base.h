@@ -3,7 +3,9 @@
 
 #include "bot_api.h"
 #include "bot/webhook_server.h"
+#include "bot/update_dispatcher.h"
 #include <memory>
+#include <functional>
 #include <string>
 #include <atomic>
 #include <vector>
@@ -36,7 +38,8 @@ class ApiClient;
 }
 
 namespace utils {
-class EloCalculator;
+class RatingEngines;
+struct KFactorPolicy;
 }
 
 namespace observability {
@@ -91,6 +94,10 @@ class BotBase {
   // Returns true if update was processed successfully
   bool processUpdate(const std::string& json_body);
   
+  // Same as processUpdate(json_body), but tells the webhook server which status
+  // to answer: kRetryLater when the update's lane is full
+  WebhookServer::UpdateResult receiveUpdate(const std::string& json_body);
+  
   // Process a parsed Update object
   void processUpdate(const tgbotxx::Update& update);
   
@@ -126,6 +133,21 @@ class BotBase {
   const Derived* derived() const {
     return static_cast<const Derived*>(this);
   }
+  
+  // Start per-chat update lanes if telegram.dispatcher.lanes > 0
+  void startDispatcher();
+  
+  // Run fn on the lane owning chat_id (inline when the dispatcher is disabled)
+  void dispatchForChat(int64_t chat_id, std::function<void()> fn);
+  
+  // Like dispatchForChat, but refuses instead of blocking when the lane is full
+  UpdateDispatcher::DispatchResult tryDispatchForChat(int64_t chat_id, std::function<void()> fn);
+  
+  // Wrap fn so a lane thread continues the caller's trace
+  static std::function<void()> withCurrentContext(std::function<void()> fn);
+  
+  // Chat id an update belongs to (0 if it has none)
+  static int64_t extractChatId(const nlohmann::json& json);
 
  protected:
   // Protected so derived classes can initialize
@@ -139,15 +161,25 @@ class BotBase {
   std::unique_ptr<WebhookServer> webhook_server_;
   std::string webhook_url_;
   
+  // Orders updates per chat while running different chats in parallel
+  std::unique_ptr<UpdateDispatcher> update_dispatcher_;
+  
   // Dependencies
   std::shared_ptr<database::ConnectionPool> db_pool_;
   std::unique_ptr<repositories::GroupRepository> group_repo_;
   std::unique_ptr<repositories::PlayerRepository> player_repo_;
   std::unique_ptr<repositories::MatchRepository> match_repo_;
   std::unique_ptr<school21::ApiClient> school21_client_;
-  std::unique_ptr<utils::EloCalculator> elo_calculator_;
+  std::unique_ptr<utils::RatingEngines> rating_engines_;
   observability::Logger* logger_ = nullptr;
 
+  // One engine per rating system, configured from elo.*
+  static std::unique_ptr<utils::RatingEngines> makeRatingEngines();
+
+  // K-factor policy of a group: its groups.k_policy over the elo.k_factor
+  // default; a policy that no longer parses falls back to the default
+  static utils::KFactorPolicy kFactorPolicy(const std::optional<std::string>& k_policy);
+
  private:
   
   // Username cache (username -> user_id mapping)
@@ -162,6 +194,8 @@ class BotBase {
   void handleIdGuest(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleUndo(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleConfigTopic(const tgbotxx::Ptr<tgbotxx::Message>& message);
+  void handleRatingSystem(const tgbotxx::Ptr<tgbotxx::Message>& message);
+  void handleKPolicy(const tgbotxx::Ptr<tgbotxx::Message>& message);
   void handleHelp(const tgbotxx::Ptr<tgbotxx::Message>& message);
   
   // Group event handlers
@@ -7,14 +7,17 @@
 #include "bot/bot_base.h"
 #include "bot/webhook_server.h"
 #include "database/connection_pool.h"
+#include "database/prepared_statements.h"
 #include "database/transaction.h"
 #include "repositories/group_repository.h"
 #include "repositories/player_repository.h"
 #include "repositories/match_repository.h"
 #include "school21/api_client.h"
-#include "utils/elo_calculator.h"
+#include "utils/k_factor_policy.h"
+#include "utils/rating_engine.h"
 #include "utils/retry.h"
 #include "observability/logger.h"
+#include "observability/tracing.h"
 #include "config/config.h"
 #include "models/group.h"
 #include "models/player.h"
@@ -47,15 +50,39 @@ BotBase<Derived>::~BotBase() {
 
 template<typename Derived>
 void BotBase<Derived>::initialize() {
-  // Initialize ELO calculator with K-factor from config
-  auto& config = config::Config::getInstance();
-  int k_factor = config.getInt("elo.k_factor", 32);
-  elo_calculator_ = std::make_unique<utils::EloCalculator>(k_factor);
+  rating_engines_ = makeRatingEngines();
   
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->info("BotBase initialized (dependencies must be set via setDependencies)");
+  OBS_INFO(logger_, "BotBase initialized (dependencies must be set via setDependencies)");
+}
+
+template<typename Derived>
+std::unique_ptr<utils::RatingEngines> BotBase<Derived>::makeRatingEngines() {
+  auto& config = config::Config::getInstance();
+  utils::RatingEngines::Options options;
+  options.k_factor = config.getInt("elo.k_factor", 32);
+  options.mode = config.getBool("elo.expected_score_table", false)
+      ? utils::ExpectedScoreMode::kTable : utils::ExpectedScoreMode::kExact;
+  options.glicko_tau = config.getDouble("elo.glicko2_tau", 0.5);
+  return std::make_unique<utils::RatingEngines>(options);
+}
+
+template<typename Derived>
+utils::KFactorPolicy BotBase<Derived>::kFactorPolicy(const std::optional<std::string>& k_policy) {
+  utils::KFactorPolicy defaults;
+  defaults.k_factor = config::Config::getInstance().getInt("elo.k_factor", 32);
+  if (!k_policy) {
+    return defaults;
+  }
+  try {
+    return utils::KFactorPolicy::fromJson(*k_policy, defaults);
+  } catch (const std::invalid_argument& e) {
+    OBS_WARN(observability::Logger::getInstance(), "Ignoring invalid K-factor policy: " +
+                                                   std::string(e.what()));
+    return defaults;
+  }
 }
 
 template<typename Derived>
@@ -73,7 +100,7 @@ void BotBase<Derived>::setDependencies(
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->info("BotBase dependencies set");
+  OBS_INFO(logger_, "BotBase dependencies set");
 }
 
 template<typename Derived>
@@ -81,15 +108,15 @@ void BotBase<Derived>::onCommand(const tgbotxx::Ptr<tgbotxx::Message>& command)
   try {
     if (!command) {
       if (!logger_) logger_ = observability::Logger::getInstance().get();
-      logger_->warn("onCommand called with null command");
+      OBS_WARN(logger_, "onCommand called with null command");
       return;
     }
     
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->info("Command received: " + (command->text.empty() ? "empty" : command->text));
+    OBS_INFO(logger_, "Command received: " + (command->text.empty() ? "empty" : command->text));
     
     std::string cmd = extractCommandName(command);
-    logger_->info("Extracted command: " + (cmd.empty() ? "empty" : cmd));
+    OBS_INFO(logger_, "Extracted command: " + (cmd.empty() ? "empty" : cmd));
     
     if (cmd == "start") {
       handleStart(command);
@@ -105,14 +132,18 @@ void BotBase<Derived>::onCommand(const tgbotxx::Ptr<tgbotxx::Message>& command)
       handleUndo(command);
     } else if (cmd == "config_topic") {
       handleConfigTopic(command);
+    } else if (cmd == "rating_system") {
+      handleRatingSystem(command);
+    } else if (cmd == "k_policy") {
+      handleKPolicy(command);
     } else if (cmd == "help") {
       handleHelp(command);
     } else {
-      logger_->info("Unknown command: " + cmd);
+      OBS_INFO(logger_, "Unknown command: " + cmd);
     }
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error in onCommand: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in onCommand: " + std::string(e.what()));
   }
 }
 
@@ -128,9 +159,9 @@ void BotBase<Derived>::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMembe
     std::string status = chatMember->newChatMember->status;
     
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->info("Chat member update: chat_id=" + std::to_string(chat_id) + 
-                  ", user_id=" + std::to_string(user_id) + 
-                  ", status=" + status);
+    OBS_INFO(logger_, "Chat member update: chat_id=" + std::to_string(chat_id) + 
+                      ", user_id=" + std::to_string(user_id) + 
+                      ", status=" + status);
     
     // Handle member join
     if (status == "member") {
@@ -142,7 +173,7 @@ void BotBase<Derived>::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMembe
     }
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error handling chat member update: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling chat member update: " + std::string(e.what()));
   }
 }
 
@@ -158,7 +189,7 @@ void BotBase<Derived>::onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& messag
       std::string cmd = extractCommandName(message);
       if (!cmd.empty()) {
         if (!logger_) logger_ = observability::Logger::getInstance().get();
-        logger_->info("Command detected in onAnyMessage: " + cmd);
+        OBS_INFO(logger_, "Command detected in onAnyMessage: " + cmd);
         // Route to command handler
         onCommand(message);
         return;
@@ -167,11 +198,11 @@ void BotBase<Derived>::onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& messag
     
     // Command-only mode: ignore non-command messages
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->debug("Message received (not a command): " + 
-                  (message->text.empty() ? "empty" : message->text.substr(0, 50)));
+    OBS_DEBUG(logger_, "Message received (not a command): " + 
+                      (message->text.empty() ? "empty" : message->text.substr(0, 50)));
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error in onAnyMessage: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in onAnyMessage: " + std::string(e.what()));
   }
 }
 
@@ -187,6 +218,82 @@ void BotBase<Derived>::startPolling() {
   // TestBot will just set running_ = true
 }
 
+template<typename Derived>
+void BotBase<Derived>::startDispatcher() {
+  if (update_dispatcher_) {
+    return;
+  }
+  
+  if (!logger_) logger_ = observability::Logger::getInstance().get();
+  
+  auto& config = config::Config::getInstance();
+  int lanes = config.getInt("telegram.dispatcher.lanes", 0);
+  int max_lane_depth = config.getInt("telegram.dispatcher.max_lane_depth", 256);
+  if (lanes <= 0) {
+    OBS_INFO(logger_, "Update dispatcher disabled, updates are processed inline");
+    return;
+  }
+  
+  update_dispatcher_ = std::make_unique<UpdateDispatcher>(static_cast<size_t>(lanes),
+                                                          static_cast<size_t>(std::max(max_lane_depth, 1)));
+  OBS_INFO(logger_, "Update dispatcher started with " + std::to_string(lanes) + " lanes");
+}
+
+template<typename Derived>
+std::function<void()> BotBase<Derived>::withCurrentContext(std::function<void()> fn) {
+  auto context = observability::currentContext();
+  if (!context.valid()) {
+    return fn;
+  }
+  return [context, fn = std::move(fn)]() {
+    observability::ContextScope scope(context);
+    fn();
+  };
+}
+
+template<typename Derived>
+void BotBase<Derived>::dispatchForChat(int64_t chat_id, std::function<void()> fn) {
+  fn = withCurrentContext(std::move(fn));
+  if (!update_dispatcher_ || !update_dispatcher_->dispatch(chat_id, fn)) {
+    fn();
+  }
+}
+
+template<typename Derived>
+UpdateDispatcher::DispatchResult BotBase<Derived>::tryDispatchForChat(int64_t chat_id, std::function<void()> fn) {
+  fn = withCurrentContext(std::move(fn));
+  if (!update_dispatcher_) {
+    fn();
+    return UpdateDispatcher::DispatchResult::kAccepted;
+  }
+  auto result = update_dispatcher_->tryDispatch(chat_id, fn);
+  if (result == UpdateDispatcher::DispatchResult::kShutDown) {
+    // Stopping: nothing else will run it
+    fn();
+    return UpdateDispatcher::DispatchResult::kAccepted;
+  }
+  return result;
+}
+
+template<typename Derived>
+int64_t BotBase<Derived>::extractChatId(const nlohmann::json& json) {
+  static const char* kChatCarriers[] = {
+      "message", "edited_message", "channel_post", "edited_channel_post", "my_chat_member", "chat_member"};
+  
+  for (const char* key : kChatCarriers) {
+    auto it = json.find(key);
+    if (it != json.end() && it->contains("chat")) {
+      return (*it)["chat"].value("id", int64_t{0});
+    }
+  }
+  
+  auto callback = json.find("callback_query");
+  if (callback != json.end() && callback->contains("message") && (*callback)["message"].contains("chat")) {
+    return (*callback)["message"]["chat"].value("id", int64_t{0});
+  }
+  return 0;
+}
+
 template<typename Derived>
 void BotBase<Derived>::startWebhook(const std::string& webhook_url, int port, const std::string& secret_token) {
   if (running_) {
@@ -195,6 +302,8 @@ void BotBase<Derived>::startWebhook(const std::string& webhook_url, int port, co
   
   if (!logger_) logger_ = observability::Logger::getInstance().get();
   
+  startDispatcher();
+  
   // Store webhook URL for later use
   webhook_url_ = webhook_url;
   
@@ -220,20 +329,28 @@ void BotBase<Derived>::startWebhook(const std::string& webhook_url, int port, co
   server_config.port = port;
   server_config.path = webhook_path;
   server_config.secret_token = secret_token;
+  auto& config = config::Config::getInstance();
+  server_config.metrics_path = config.getString("telegram.webhook.metrics_path", server_config.metrics_path);
+  server_config.metrics_token = config.getString("telegram.webhook.metrics_token", server_config.metrics_token);
+  server_config.worker_threads = config.getInt("telegram.webhook.worker_threads", server_config.worker_threads);
+  server_config.max_queue_depth = config.getInt("telegram.webhook.max_queue_depth", server_config.max_queue_depth);
+  server_config.keep_alive_timeout_seconds =
+      config.getInt("telegram.webhook.keep_alive_timeout_seconds", server_config.keep_alive_timeout_seconds);
+  server_config.max_connections = config.getInt("telegram.webhook.max_connections", server_config.max_connections);
   webhook_server_->configure(server_config);
   
   // Set callback to process incoming updates
   webhook_server_->setUpdateCallback([this](const std::string& json_body) {
-    return processUpdate(json_body);
+    return receiveUpdate(json_body);
   });
   
   // Start the webhook server
   if (!webhook_server_->start()) {
-    logger_->error("Failed to start webhook server on port " + std::to_string(port));
+    OBS_ERROR(logger_, "Failed to start webhook server on port " + std::to_string(port));
     throw std::runtime_error("Failed to start webhook server");
   }
   
-  logger_->info("Webhook server started on port " + std::to_string(port));
+  OBS_INFO(logger_, "Webhook server started on port " + std::to_string(port));
   
   // Register webhook with Telegram
   // Note: The derived class (Bot) should call api()->setWebhook() 
@@ -242,7 +359,7 @@ void BotBase<Derived>::startWebhook(const std::string& webhook_url, int port, co
   mode_ = BotMode::Webhook;
   running_ = true;
   
-  logger_->info("Bot started in webhook mode, URL: " + webhook_url);
+  OBS_INFO(logger_, "Bot started in webhook mode, URL: " + webhook_url);
 }
 
 template<typename Derived>
@@ -259,6 +376,12 @@ void BotBase<Derived>::stop() {
     webhook_server_.reset();
   }
   
+  // No more updates can arrive; finish the queued ones
+  if (update_dispatcher_) {
+    update_dispatcher_->shutdown();
+    update_dispatcher_.reset();
+  }
+  
   mode_ = BotMode::None;
   
   // ProductionBotApi (tgbotxx::Bot) will handle stop() for polling mode
@@ -267,30 +390,64 @@ void BotBase<Derived>::stop() {
 
 template<typename Derived>
 bool BotBase<Derived>::processUpdate(const std::string& json_body) {
+  return receiveUpdate(json_body) == WebhookServer::UpdateResult::kProcessed;
+}
+
+template<typename Derived>
+WebhookServer::UpdateResult BotBase<Derived>::receiveUpdate(const std::string& json_body) {
   if (!logger_) logger_ = observability::Logger::getInstance().get();
   
-  logger_->info("Received webhook update, body_size=" + std::to_string(json_body.size()));
+  OBS_INFO(logger_, "Received webhook update, body_size=" + std::to_string(json_body.size()));
   
   try {
     // Parse JSON string to nlohmann::json
-    nlohmann::json json = nlohmann::json::parse(json_body);
+    nlohmann::json json;
+    {
+      observability::ScopedSpan parse_span("update.parse");
+      json = nlohmann::json::parse(json_body);
+    }
     
     // Extract update_id for logging
     int32_t update_id = json.value("update_id", 0);
-    logger_->info("Parsed Telegram update, update_id=" + std::to_string(update_id));
+    OBS_INFO(logger_, "Parsed Telegram update, update_id=" + std::to_string(update_id));
     
     // Process the update directly from JSON
     // This avoids needing to link against tgbotxx::Update::fromJson
+    if (update_dispatcher_) {
+      // Serialised per chat, parallel across chats.
+      //
+      // Delivery is at-most-once: Telegram gets its 200 as soon as the lane
+      // accepts the update, before any handler has run. Telegram never
+      // redelivers an acknowledged update, so whatever is still queued in a
+      // lane is lost if the process crashes or is killed; a graceful stop()
+      // drains the lanes first. Acking only after processing would instead
+      // hold a webhook worker per in-flight update and let one slow chat
+      // stall every other.
+      //
+      // A full lane refuses the update rather than dropping it or blocking
+      // the webhook worker: we answer 503 and Telegram redelivers it later.
+      int64_t chat_id = extractChatId(json);
+      auto shared_json = std::make_shared<nlohmann::json>(std::move(json));
+      auto result = tryDispatchForChat(chat_id, [this, shared_json]() { processJsonUpdate(*shared_json); });
+      if (result == UpdateDispatcher::DispatchResult::kLaneFull) {
+        OBS_WARN(logger_, "Lane full, asking Telegram to retry update_id=" + std::to_string(update_id) +
+                              " for chat_id=" + std::to_string(chat_id));
+        return WebhookServer::UpdateResult::kRetryLater;
+      }
+      OBS_INFO(logger_, "Queued update_id=" + std::to_string(update_id) + " for chat_id=" + std::to_string(chat_id));
+      return WebhookServer::UpdateResult::kProcessed;
+    }
+    
     processJsonUpdate(json);
     
-    logger_->info("Successfully processed update_id=" + std::to_string(update_id));
-    return true;
+    OBS_INFO(logger_, "Successfully processed update_id=" + std::to_string(update_id));
+    return WebhookServer::UpdateResult::kProcessed;
   } catch (const nlohmann::json::parse_error& e) {
-    logger_->error("Failed to parse webhook JSON: " + std::string(e.what()) + ", body_preview=" + json_body.substr(0, 200));
-    return false;
+    OBS_ERROR(logger_, "Failed to parse webhook JSON: " + std::string(e.what()) + ", body_preview=" + json_body.substr(0, 200));
+    return WebhookServer::UpdateResult::kFailed;
   } catch (const std::exception& e) {
-    logger_->error("Error processing webhook update: " + std::string(e.what()));
-    return false;
+    OBS_ERROR(logger_, "Error processing webhook update: " + std::string(e.what()));
+    return WebhookServer::UpdateResult::kFailed;
   }
 }
 
@@ -477,11 +634,11 @@ void BotBase<Derived>::processJsonUpdate(const nlohmann::json& json) {
   
   try {
     int32_t update_id = json.value("update_id", 0);
-    logger_->info("Processing JSON update, update_id=" + std::to_string(update_id));
+    OBS_INFO(logger_, "Processing JSON update, update_id=" + std::to_string(update_id));
     
     // Route update to appropriate handler based on update type
     if (json.contains("message")) {
-      logger_->info("Update contains message, update_id=" + std::to_string(update_id));
+      OBS_INFO(logger_, "Update contains message, update_id=" + std::to_string(update_id));
       auto message = parseMessageFromJson(json["message"]);
       
       int64_t chat_id = message->chat ? message->chat->id : 0;
@@ -489,30 +646,30 @@ void BotBase<Derived>::processJsonUpdate(const nlohmann::json& json) {
       std::string from_username = message->from ? message->from->username : "";
       int64_t from_id = message->from ? message->from->id : 0;
       
-      logger_->info("Message details: chat_id=" + std::to_string(chat_id) + 
-                    ", chat_title=" + chat_title + 
-                    ", from_id=" + std::to_string(from_id) + 
-                    ", from_username=" + from_username +
-                    ", text_length=" + std::to_string(message->text.size()));
+      OBS_INFO(logger_, "Message details: chat_id=" + std::to_string(chat_id) + 
+                        ", chat_title=" + chat_title + 
+                        ", from_id=" + std::to_string(from_id) + 
+                        ", from_username=" + from_username +
+                        ", text_length=" + std::to_string(message->text.size()));
       
       // Check if it's a command (text starts with /)
       if (!message->text.empty() && message->text.front() == '/') {
         std::string command = extractCommandName(message);
-        logger_->info("Processing command: " + command + ", update_id=" + std::to_string(update_id));
+        OBS_INFO(logger_, "Processing command: " + command + ", update_id=" + std::to_string(update_id));
         onCommand(message);
       }
       // Always call onAnyMessage for all messages
-      logger_->info("Calling onAnyMessage handler, update_id=" + std::to_string(update_id));
+      OBS_INFO(logger_, "Calling onAnyMessage handler, update_id=" + std::to_string(update_id));
       onAnyMessage(message);
     }
     else if (json.contains("edited_message")) {
-      logger_->debug("Received edited message, update_id=" + std::to_string(update_id));
+      OBS_DEBUG(logger_, "Received edited message, update_id=" + std::to_string(update_id));
     }
     else if (json.contains("channel_post")) {
-      logger_->debug("Received channel post, update_id=" + std::to_string(update_id));
+      OBS_DEBUG(logger_, "Received channel post, update_id=" + std::to_string(update_id));
     }
     else if (json.contains("edited_channel_post")) {
-      logger_->debug("Received edited channel post, update_id=" + std::to_string(update_id));
+      OBS_DEBUG(logger_, "Received edited channel post, update_id=" + std::to_string(update_id));
     }
     else if (json.contains("my_chat_member")) {
       auto chat_member_update = parseChatMemberUpdatedFromJson(json["my_chat_member"]);
@@ -523,13 +680,13 @@ void BotBase<Derived>::processJsonUpdate(const nlohmann::json& json) {
       onChatMemberUpdated(chat_member_update);
     }
     else if (json.contains("callback_query")) {
-      logger_->debug("Received callback query, update_id=" + std::to_string(update_id));
+      OBS_DEBUG(logger_, "Received callback query, update_id=" + std::to_string(update_id));
     }
     else {
-      logger_->debug("Received unhandled update type, update_id=" + std::to_string(update_id));
+      OBS_DEBUG(logger_, "Received unhandled update type, update_id=" + std::to_string(update_id));
     }
   } catch (const std::exception& e) {
-    logger_->error("Error in processJsonUpdate: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in processJsonUpdate: " + std::string(e.what()));
   }
 }
 
@@ -551,15 +708,15 @@ void BotBase<Derived>::processUpdate(const tgbotxx::Update& update) {
     }
     else if (update.editedMessage) {
       // Could add onEditedMessage handler if needed
-      logger_->debug("Received edited message, update_id=" + std::to_string(update.updateId));
+      OBS_DEBUG(logger_, "Received edited message, update_id=" + std::to_string(update.updateId));
     }
     else if (update.channelPost) {
       // Could add onChannelPost handler if needed
-      logger_->debug("Received channel post, update_id=" + std::to_string(update.updateId));
+      OBS_DEBUG(logger_, "Received channel post, update_id=" + std::to_string(update.updateId));
     }
     else if (update.editedChannelPost) {
       // Could add onEditedChannelPost handler if needed
-      logger_->debug("Received edited channel post, update_id=" + std::to_string(update.updateId));
+      OBS_DEBUG(logger_, "Received edited channel post, update_id=" + std::to_string(update.updateId));
     }
     else if (update.myChatMember) {
       // Bot's chat member status was updated
@@ -571,13 +728,13 @@ void BotBase<Derived>::processUpdate(const tgbotxx::Update& update) {
     }
     else if (update.callbackQuery) {
       // Could add onCallbackQuery handler if needed
-      logger_->debug("Received callback query, update_id=" + std::to_string(update.updateId));
+      OBS_DEBUG(logger_, "Received callback query, update_id=" + std::to_string(update.updateId));
     }
     else {
-      logger_->debug("Received unhandled update type, update_id=" + std::to_string(update.updateId));
+      OBS_DEBUG(logger_, "Received unhandled update type, update_id=" + std::to_string(update.updateId));
     }
   } catch (const std::exception& e) {
-    logger_->error("Error in processUpdate: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in processUpdate: " + std::string(e.what()));
   }
 }
 
@@ -612,8 +769,8 @@ void BotBase<Derived>::sendMessage(int64_t chat_id, const std::string& text,
                    std::optional<int> message_thread_id) {
   try {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->info("Sending message to chat_id=" + std::to_string(chat_id) + 
-                  ", text length=" + std::to_string(text.length()));
+    OBS_INFO(logger_, "Sending message to chat_id=" + std::to_string(chat_id) + 
+                      ", text length=" + std::to_string(text.length()));
     
     tgbotxx::Ptr<tgbotxx::ReplyParameters> reply_params = nullptr;
     if (reply_to_message_id && reply_to_message_id.value() > 0) {
@@ -627,7 +784,7 @@ void BotBase<Derived>::sendMessage(int64_t chat_id, const std::string& text,
     
     auto* api_impl = getBotApi();
     if (!api_impl) {
-      logger_->error("API not available for sending message");
+      OBS_ERROR(logger_, "API not available for sending message");
       return;
     }
     auto sent_message = api_impl->sendMessage(
@@ -649,14 +806,14 @@ void BotBase<Derived>::sendMessage(int64_t chat_id, const std::string& text,
     );
     
     if (sent_message) {
-      logger_->info("Message sent successfully, message_id=" + 
-                    std::to_string(sent_message->messageId));
+      OBS_INFO(logger_, "Message sent successfully, message_id=" + 
+                        std::to_string(sent_message->messageId));
     } else {
-      logger_->warn("Message sent but returned null");
+      OBS_WARN(logger_, "Message sent but returned null");
     }
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error sending message: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error sending message: " + std::string(e.what()));
   }
 }
 
@@ -664,8 +821,8 @@ template<typename Derived>
 void BotBase<Derived>::reactToMessage(int64_t chat_id, int message_id, const std::string& emoji) {
   try {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->info("Reacting to message_id=" + std::to_string(message_id) + 
-                  " with emoji: " + emoji);
+    OBS_INFO(logger_, "Reacting to message_id=" + std::to_string(message_id) + 
+                      " with emoji: " + emoji);
     
     auto reaction_type = tgbotxx::Ptr<tgbotxx::ReactionTypeEmoji>(
         new tgbotxx::ReactionTypeEmoji());
@@ -676,7 +833,7 @@ void BotBase<Derived>::reactToMessage(int64_t chat_id, int message_id, const std
     
     auto* api_impl = getBotApi();
     if (!api_impl) {
-      logger_->error("API not available for setting reaction");
+      OBS_ERROR(logger_, "API not available for setting reaction");
       return;
     }
     bool success = api_impl->setMessageReaction(
@@ -687,13 +844,13 @@ void BotBase<Derived>::reactToMessage(int64_t chat_id, int message_id, const std
     );
     
     if (success) {
-      logger_->info("Reaction set successfully");
+      OBS_INFO(logger_, "Reaction set successfully");
     } else {
-      logger_->warn("Reaction set returned false");
+      OBS_WARN(logger_, "Reaction set returned false");
     }
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error reacting to message: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error reacting to message: " + std::string(e.what()));
   }
 }
 
@@ -719,6 +876,8 @@ void BotBase<Derived>::handleStart(const tgbotxx::Ptr<tgbotxx::Message>& message
         "/id_guest - Register as guest player\n"
         "/undo - Undo last match (with reply) or last match\n"
         "/config_topic <topic_type> - Configure topic (admin only)\n"
+        "/rating_system [elo|glicko2|margin_elo] - Show or set the rating system (admin only)\n"
+        "/k_policy [json|reset] - Show or set the K-factor policy (admin only)\n"
         "/help - Show this help message\n\n"
         "For command-specific help, use: /<command> help";
 
@@ -728,7 +887,7 @@ void BotBase<Derived>::handleStart(const tgbotxx::Ptr<tgbotxx::Message>& message
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling start command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling start command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to process command");
   }
 }
@@ -764,100 +923,67 @@ void BotBase<Derived>::handleMatch(const tgbotxx::Ptr<tgbotxx::Message>& message
     }
 
     std::string group_name = message->chat->title.empty() ? "" : message->chat->title;
-    auto group = getOrCreateGroup(message->chat->id, group_name);
-
-    auto player1 = getOrCreatePlayer(parsed.player1_user_id);
-    auto player2 = getOrCreatePlayer(parsed.player2_user_id);
-
-    auto gp1 = getOrCreateGroupPlayer(group.id, player1.id);
-    auto gp2 = getOrCreateGroupPlayer(group.id, player2.id);
-
     std::string idempotency_key = generateIdempotencyKey(message);
-    if (isDuplicateMatch(idempotency_key)) {
+
+    if (!rating_engines_) {
+      rating_engines_ = makeRatingEngines();
+    }
+
+    // Groups seen for the first time rate with ELO and the global K
+    auto system = utils::RatingSystem::kElo;
+    std::optional<std::string> k_policy;
+    if (auto group = group_repo_ ? group_repo_->getByTelegramId(message->chat->id) : std::nullopt) {
+      system = utils::parseRatingSystem(group->rating_system).value_or(utils::RatingSystem::kElo);
+      k_policy = group->k_policy;
+    }
+    const auto& engine = rating_engines_->get(system);
+    const auto policy = kFactorPolicy(k_policy);
+
+    // One unlocked read plus one register_match() round trip; retried when a
+    // concurrent match moved either player's version in between
+    models::Match created_match;
+    try {
+      created_match = utils::retryWithBackoff([&]() {
+        auto [rating1, rating2] = match_repo_->getRatings(
+            message->chat->id, parsed.player1_user_id, parsed.player2_user_id);
+        // The policy's inputs come with the ratings, no extra query
+        utils::Rating player1{rating1.current_elo, rating1.rating_deviation, rating1.rating_volatility,
+                              policy.kFor(rating1.current_elo, rating1.matches_played,
+                                          parsed.score1, parsed.score2, system)};
+        utils::Rating player2{rating2.current_elo, rating2.rating_deviation, rating2.rating_volatility,
+                              policy.kFor(rating2.current_elo, rating2.matches_played,
+                                          parsed.score1, parsed.score2, system)};
+        auto [new1, new2] = engine.rate(player1, player2, parsed.score1, parsed.score2);
+
+        models::MatchRegistration registration;
+        registration.telegram_group_id = message->chat->id;
+        registration.group_name = group_name;
+        registration.player1_telegram_user_id = parsed.player1_user_id;
+        registration.player2_telegram_user_id = parsed.player2_user_id;
+        registration.player1_score = parsed.score1;
+        registration.player2_score = parsed.score2;
+        registration.player1_before = rating1;
+        registration.player2_before = rating2;
+        registration.player1_elo_after = new1.rating;
+        registration.player2_elo_after = new2.rating;
+        registration.player1_deviation_after = new1.deviation;
+        registration.player2_deviation_after = new2.deviation;
+        registration.player1_volatility_after = new1.volatility;
+        registration.player2_volatility_after = new2.volatility;
+        registration.rating_system = std::string(utils::toString(system));
+        registration.player1_k_factor = player1.k_factor;
+        registration.player2_k_factor = player2.k_factor;
+        registration.idempotency_key = idempotency_key;
+        registration.created_by_telegram_user_id = message->from ? message->from->id : 0;
+        return match_repo_->registerMatch(registration);
+      });
+    } catch (const repositories::DuplicateMatchException&) {
       sendErrorMessage(message, "This match was already registered");
       return;
     }
 
-    if (!elo_calculator_) {
-      auto& config = config::Config::getInstance();
-      int k_factor = config.getInt("elo.k_factor", 32);
-      elo_calculator_ = std::make_unique<utils::EloCalculator>(k_factor);
-    }
-
-    auto elo_pair = elo_calculator_->calculate(
-        gp1.current_elo, gp2.current_elo, parsed.score1, parsed.score2);
-    int elo1_after = elo_pair.first;
-    int elo2_after = elo_pair.second;
-    int elo1_change = elo1_after - gp1.current_elo;
-    int elo2_change = elo2_after - gp2.current_elo;
-
-    models::GroupPlayer gp1_updated = gp1;
-    models::GroupPlayer gp2_updated = gp2;
-    gp1_updated.current_elo = elo1_after;
-    gp2_updated.current_elo = elo2_after;
-    gp1_updated.matches_played += 1;
-    gp2_updated.matches_played += 1;
-    if (parsed.score1 > parsed.score2) {
-      gp1_updated.matches_won += 1;
-      gp2_updated.matches_lost += 1;
-    } else if (parsed.score1 < parsed.score2) {
-      gp2_updated.matches_won += 1;
-      gp1_updated.matches_lost += 1;
-    }
-
-    // Use a single DB transaction to keep ELO updates and match creation atomic
-    database::Transaction txn(db_pool_);
-    auto& work = txn.get();
-
-    auto update1 = work.exec_params(
-      "UPDATE group_players SET "
-      "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-      "version = version + 1, updated_at = NOW() "
-      "WHERE id = $5",
-      gp1_updated.current_elo, gp1_updated.matches_played, gp1_updated.matches_won,
-      gp1_updated.matches_lost, gp1_updated.id);
-    if (update1.affected_rows() == 0) {
-      throw std::runtime_error("Failed to update player1 stats");
-    }
-
-    auto update2 = work.exec_params(
-      "UPDATE group_players SET "
-      "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-      "version = version + 1, updated_at = NOW() "
-      "WHERE id = $5",
-      gp2_updated.current_elo, gp2_updated.matches_played, gp2_updated.matches_won,
-      gp2_updated.matches_lost, gp2_updated.id);
-    if (update2.affected_rows() == 0) {
-      throw std::runtime_error("Failed to update player2 stats");
-    }
-
-    auto match_result = work.exec_params(
-      "INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score, "
-      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-      "idempotency_key, created_by_telegram_user_id, created_at, is_undone) "
-      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), FALSE) "
-      "RETURNING id, created_at",
-      group.id, player1.id, player2.id, parsed.score1, parsed.score2,
-      gp1.current_elo, gp2.current_elo, elo1_after, elo2_after,
-      idempotency_key, message->from ? message->from->id : 0);
-
-    if (match_result.empty()) {
-      throw std::runtime_error("Failed to create match");
-    }
-
-    int64_t match_id = match_result[0]["id"].template as<int64_t>();
-
-    work.exec_params(
-      "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, elo_after, elo_change, created_at, is_undone) "
-      "VALUES ($1, $2, $3, $4, $5, $6, NOW(), FALSE)",
-      match_id, group.id, player1.id, gp1.current_elo, elo1_after, elo1_change);
-
-    work.exec_params(
-      "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, elo_after, elo_change, created_at, is_undone) "
-      "VALUES ($1, $2, $3, $4, $5, $6, NOW(), FALSE)",
-      match_id, group.id, player2.id, gp2.current_elo, elo2_after, elo2_change);
-
-    txn.commit();
+    int elo1_change = created_match.player1_elo_after - created_match.player1_elo_before;
+    int elo2_change = created_match.player2_elo_after - created_match.player2_elo_before;
 
     std::ostringstream response;
     response << "Match registered: @" << parsed.player1_user_id << " (" << parsed.score1
@@ -874,7 +1000,7 @@ void BotBase<Derived>::handleMatch(const tgbotxx::Ptr<tgbotxx::Message>& message
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling match command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling match command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to register match");
   }
 }
@@ -887,14 +1013,41 @@ void BotBase<Derived>::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& messa
       auto topic_id = getTopicId(message);
       sendMessage(message->chat->id,
                   "Ranking command:\n"
-                  "/ranking or /rank\n\n"
-                  "Shows current ELO rankings for this group.",
+                  "/ranking or /rank\n"
+                  "/ranking me\n\n"
+                  "Shows current ELO rankings for this group, or your position and the players around you.",
                   message->messageId, topic_id);
       return;
     }
 
     auto group = getOrCreateGroup(message->chat->id);
-    auto rankings = group_repo_->getRankings(group.id, 10);
+
+    if (args == "me") {
+      auto player = message->from ? player_repo_->getByTelegramId(message->from->id)
+                                  : std::nullopt;
+      auto around = player ? group_repo_->getPlayersAround(group.id, player->id, 2)
+                           : std::vector<repositories::Leaderboard::Entry>{};
+      auto topic_id = getTopicId(message);
+      if (around.empty()) {
+        sendMessage(message->chat->id, "You have no ranking in this group yet.",
+                    message->messageId, topic_id);
+        return;
+      }
+      std::ostringstream response;
+      for (const auto& entry : around) {
+        if (entry.player_id == player->id) {
+          response << "Your rank: " << entry.rank << " - " << entry.elo << " ELO\n\n";
+        }
+      }
+      for (const auto& entry : around) {
+        response << entry.rank << ". Player " << entry.player_id << " - " << entry.elo
+                 << " ELO" << (entry.player_id == player->id ? " (you)" : "") << "\n";
+      }
+      sendMessage(message->chat->id, response.str(), message->messageId, topic_id);
+      return;
+    }
+
+    auto rankings = group_repo_->getLeaderboard(group.id, 10);
     if (rankings.empty()) {
       auto topic_id = getTopicId(message);
       sendMessage(message->chat->id, "No rankings available yet.", message->messageId,
@@ -904,11 +1057,9 @@ void BotBase<Derived>::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& messa
 
     std::ostringstream response;
     response << "Current Rankings:\n";
-    int rank = 1;
-    for (const auto& gp : rankings) {
-      response << rank << ". Player " << gp.player_id << " - " << gp.current_elo
+    for (const auto& entry : rankings) {
+      response << entry.rank << ". Player " << entry.player_id << " - " << entry.elo
                << " ELO\n";
-      rank++;
     }
     auto topic_id = getTopicId(message);
     sendMessage(message->chat->id, response.str(), message->messageId, topic_id);
@@ -916,7 +1067,7 @@ void BotBase<Derived>::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& messa
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling ranking command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ranking command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to get rankings");
   }
 }
@@ -997,7 +1148,7 @@ void BotBase<Derived>::handleId(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling ID command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ID command: " + std::string(e.what()));
     reactToMessage(message->chat->id, message->messageId, "👎");
     sendErrorMessage(message, "Failed to verify nickname");
   }
@@ -1044,7 +1195,7 @@ void BotBase<Derived>::handleIdGuest(const tgbotxx::Ptr<tgbotxx::Message>& messa
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling ID guest command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ID guest command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to register as guest");
   }
 }
@@ -1054,7 +1205,7 @@ void BotBase<Derived>::handleUndo(const tgbotxx::Ptr<tgbotxx::Message>& message)
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->warn("handleUndo not implemented in BotBase for tests");
+  OBS_WARN(logger_, "handleUndo not implemented in BotBase for tests");
 }
 
 template<typename Derived>
@@ -1062,7 +1213,23 @@ void BotBase<Derived>::handleConfigTopic(const tgbotxx::Ptr<tgbotxx::Message>& m
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->warn("handleConfigTopic not implemented in BotBase for tests");
+  OBS_WARN(logger_, "handleConfigTopic not implemented in BotBase for tests");
+}
+
+template<typename Derived>
+void BotBase<Derived>::handleRatingSystem(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+  if (!logger_) {
+    logger_ = observability::Logger::getInstance().get();
+  }
+  OBS_WARN(logger_, "handleRatingSystem not implemented in BotBase for tests");
+}
+
+template<typename Derived>
+void BotBase<Derived>::handleKPolicy(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+  if (!logger_) {
+    logger_ = observability::Logger::getInstance().get();
+  }
+  OBS_WARN(logger_, "handleKPolicy not implemented in BotBase for tests");
 }
 
 template<typename Derived>
@@ -1088,7 +1255,7 @@ void BotBase<Derived>::handleMemberJoin(const tgbotxx::Ptr<tgbotxx::ChatMemberUp
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling member join: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling member join: " + std::string(e.what()));
   }
 }
 
@@ -1109,7 +1276,7 @@ void BotBase<Derived>::handleMemberLeave(const tgbotxx::Ptr<tgbotxx::ChatMemberU
     if (!logger_) {
       logger_ = observability::Logger::getInstance().get();
     }
-    logger_->error("Error handling member leave: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling member leave: " + std::string(e.what()));
   }
 }
 
@@ -1118,7 +1285,7 @@ void BotBase<Derived>::handleBotRemoval(const tgbotxx::Ptr<tgbotxx::ChatMemberUp
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->warn("handleBotRemoval not implemented in BotBase for tests");
+  OBS_WARN(logger_, "handleBotRemoval not implemented in BotBase for tests");
 }
 
 template<typename Derived>
@@ -1126,7 +1293,7 @@ void BotBase<Derived>::handleGroupMigration(const tgbotxx::Ptr<tgbotxx::Message>
   if (!logger_) {
     logger_ = observability::Logger::getInstance().get();
   }
-  logger_->warn("handleGroupMigration not implemented in BotBase for tests");
+  OBS_WARN(logger_, "handleGroupMigration not implemented in BotBase for tests");
 }
 
 template<typename Derived>
@@ -1197,7 +1364,7 @@ std::vector<int64_t> BotBase<Derived>::extractMentionedUserIds(
             user_ids.push_back(*user_id);
           } else {
             if (!logger_) logger_ = observability::Logger::getInstance().get();
-            logger_->warn("Could not resolve username mention: @" + username);
+            OBS_WARN(logger_, "Could not resolve username mention: @" + username);
           }
         }
       }
@@ -1235,11 +1402,11 @@ std::optional<int64_t> BotBase<Derived>::lookupUserIdByUsername(
     }
 
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->debug("Username not found in cache: @" + username);
+    OBS_DEBUG(logger_, "Username not found in cache: @" + username);
     return std::nullopt;
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error looking up username: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error looking up username: " + std::string(e.what()));
     return std::nullopt;
   }
 }
@@ -1300,21 +1467,21 @@ bool BotBase<Derived>::isGroupAdmin(int64_t chat_id, int64_t user_id) {
   }
 
   if (chat_id == 0 || user_id == 0) {
-    logger_->warn("Admin check skipped: missing chat_id or user_id");
+    OBS_WARN(logger_, "Admin check skipped: missing chat_id or user_id");
     return false;
   }
 
   try {
     auto* api_impl = getBotApi();
     if (!api_impl) {
-      logger_->warn("Admin check failed: Bot API is not available");
+      OBS_WARN(logger_, "Admin check failed: Bot API is not available");
       return false;
     }
 
     auto member = api_impl->getChatMember(chat_id, user_id);
     if (!member) {
-      logger_->warn("Admin check failed: getChatMember returned null (chat_id=" +
-                    std::to_string(chat_id) + ", user_id=" + std::to_string(user_id) + ")");
+      OBS_WARN(logger_, "Admin check failed: getChatMember returned null (chat_id=" +
+                        std::to_string(chat_id) + ", user_id=" + std::to_string(user_id) + ")");
       return false;
     }
 
@@ -1323,11 +1490,11 @@ bool BotBase<Derived>::isGroupAdmin(int64_t chat_id, int64_t user_id) {
       return true;
     }
 
-    logger_->info("User is not admin: status=" + status + ", chat_id=" +
-                  std::to_string(chat_id) + ", user_id=" + std::to_string(user_id));
+    OBS_INFO(logger_, "User is not admin: status=" + status + ", chat_id=" +
+                      std::to_string(chat_id) + ", user_id=" + std::to_string(user_id));
     return false;
   } catch (const std::exception& e) {
-    logger_->error("Error checking admin status: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error checking admin status: " + std::string(e.what()));
     return false;
   }
 }
@@ -1364,7 +1531,7 @@ void BotBase<Derived>::sendToLogsTopic(int64_t chat_id, const std::string& text)
     }
   } catch (const std::exception& e) {
     if (!logger_) logger_ = observability::Logger::getInstance().get();
-    logger_->error("Error sending to logs topic: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error sending to logs topic: " + std::string(e.what()));
     sendMessage(chat_id, text);
   }
 }
@@ -0,0 +1,49 @@
+#ifndef BOT_HTTP_REQUEST_PARSER_H
+#define BOT_HTTP_REQUEST_PARSER_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace bot {
+
+// HTTP/1.x request as views into the connection buffer
+// Views are valid until the buffer is modified.
+struct HttpRequestView {
+  std::string_view method;
+  std::string_view path;
+  std::string_view version;
+  std::string_view content_type;
+  std::string_view secret_token;    // X-Telegram-Bot-Api-Secret-Token
+  std::string_view authorization;
+  std::string_view body;
+  bool keep_alive = true;
+  size_t total_size = 0;            // Bytes of buffer occupied by this request
+};
+
+// Single-pass, allocation-free parser for webhook requests
+// Keeps the header terminator scan position between calls, so feeding a
+// growing buffer costs O(new bytes) rather than rescanning from the start.
+class HttpRequestParser {
+ public:
+  enum class Status { kIncomplete, kComplete, kInvalid, kTooLarge };
+
+  HttpRequestParser(size_t max_header_size, size_t max_body_size)
+      : max_header_size_(max_header_size), max_body_size_(max_body_size) {}
+
+  // Parse one request from the front of buffer
+  // On kComplete, request views point into buffer and request.total_size bytes
+  // can be consumed. Call reset() before parsing the next request.
+  Status parse(std::string_view buffer, HttpRequestView& request);
+
+  // Forget scan state (after consuming a request or switching buffers)
+  void reset() { scan_offset_ = 0; }
+
+ private:
+  size_t max_header_size_;
+  size_t max_body_size_;
+  size_t scan_offset_ = 0;
+};
+
+}  // namespace bot
+
+#endif  // BOT_HTTP_REQUEST_PARSER_H
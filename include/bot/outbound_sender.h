@@ -0,0 +1,128 @@
+#ifndef BOT_OUTBOUND_SENDER_H
+#define BOT_OUTBOUND_SENDER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "observability/tracing.h"
+#include "utils/token_bucket.h"
+
+namespace bot {
+
+// A message or reaction waiting to be sent to Telegram
+struct OutboundMessage {
+  enum class Kind { kText, kReaction };
+
+  Kind kind = Kind::kText;
+  int64_t chat_id = 0;
+  std::string text;                        // Message text, or the reaction emoji
+  std::optional<int> reply_to_message_id;
+  std::optional<int> message_thread_id;
+  int message_id = 0;                      // Message a reaction is set on
+  bool coalesce = false;                   // Log line, may be merged with the next ones
+  observability::SpanContext trace_context;  // Trace of the handler that queued it (set by send())
+};
+
+// Asynchronous outbound queue in front of the Telegram API
+// Handlers enqueue and return; sender threads deliver. Each chat is a FIFO
+// with at most one request in flight, paced by a per-chat token bucket and
+// a global one (Telegram allows about 1 msg/s per chat and 30 msg/s overall).
+// Queued log lines of a chat/thread go out as one message, and a 429 puts
+// the message back at the head of its chat for the retry_after Telegram asks.
+class OutboundSender {
+ public:
+  // Delivers one message; throws on failure (the error text is checked for
+  // "retry after N" to recognize 429s)
+  using Transport = std::function<void(const OutboundMessage&)>;
+
+  struct Options {
+    size_t sender_threads = 2;
+    double per_chat_rate = 1.0;        // Messages per second
+    double per_chat_burst = 3.0;
+    double global_rate = 30.0;
+    double global_burst = 30.0;
+    size_t max_queue = 10000;          // send() refuses messages beyond this
+    int max_retries = 3;               // 429 retries per message
+    size_t max_coalesced_length = 4096;  // Telegram's message length limit
+    std::chrono::milliseconds drain_timeout{5000};
+  };
+
+  struct Stats {
+    size_t queued = 0;       // Waiting right now
+    uint64_t sent = 0;       // Requests that succeeded
+    uint64_t coalesced = 0;  // Log lines merged into another message
+    uint64_t retried = 0;    // 429s retried
+    uint64_t failed = 0;     // Requests that failed for good
+    uint64_t dropped = 0;    // Still queued when the drain timed out
+    uint64_t rejected = 0;   // Refused by send() because the queue was full
+  };
+
+  OutboundSender(Transport transport, Options options);
+  ~OutboundSender();
+
+  OutboundSender(const OutboundSender&) = delete;
+  OutboundSender& operator=(const OutboundSender&) = delete;
+
+  // Queue a message; returns false (message not taken) when the queue is
+  // full or the sender has been shut down
+  bool send(OutboundMessage message);
+
+  // Stop accepting messages, deliver what is queued within drain_timeout
+  // and join the sender threads
+  void shutdown();
+
+  // shutdown() was called; send() refuses every message from now on
+  bool isShutDown() const;
+
+  Stats getStats() const;
+
+  // retry_after of a Telegram 429 error ("Too Many Requests: retry after 5")
+  static std::optional<std::chrono::seconds> retryAfter(const std::string& error);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Pending {
+    OutboundMessage message;
+    int attempts = 0;
+  };
+
+  struct Chat {
+    std::deque<Pending> queue;
+    utils::TokenBucket bucket;
+    Clock::time_point paused_until{};  // Set by a 429
+    bool in_flight = false;
+  };
+
+  void senderLoop();
+  // Next message of the chat, with the log lines behind it merged in
+  Pending takeNext(Chat& chat);
+  void sweepIdleChats(Clock::time_point now);
+
+  Transport transport_;
+  Options options_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::unordered_map<int64_t, Chat> chats_;
+  std::deque<int64_t> ready_;  // Chats with queued messages and nothing in flight
+  utils::TokenBucket global_bucket_;
+  size_t queued_ = 0;
+  bool stopping_ = false;
+  Clock::time_point drain_deadline_{};
+  Stats stats_;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bot
+
+#endif  // BOT_OUTBOUND_SENDER_H
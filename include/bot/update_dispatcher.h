@@ -0,0 +1,97 @@
+#ifndef BOT_UPDATE_DISPATCHER_H
+#define BOT_UPDATE_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bot {
+
+// Sharded update dispatcher
+// Each chat id is hashed to a fixed lane; a lane is a FIFO queue served by a
+// single thread. Updates from different groups run in parallel, updates from
+// the same group run one at a time in the order they were dispatched.
+class UpdateDispatcher {
+ public:
+  using Task = std::function<void()>;
+
+  enum class DispatchResult {
+    kAccepted,  // Queued (or run inline on the lane's own thread)
+    kLaneFull,  // Lane at max_lane_depth; nothing was queued
+    kShutDown,  // Dispatcher shut down; nothing was queued
+  };
+
+  // Snapshot of a lane's counters
+  struct LaneStats {
+    size_t queue_depth = 0;          // Updates waiting in the lane
+    uint64_t processed = 0;          // Updates completed
+    uint64_t total_wait_us = 0;      // Time spent queued, summed over processed updates
+    uint64_t total_run_us = 0;       // Time spent in handlers, summed over processed updates
+    uint64_t max_wait_us = 0;
+    uint64_t max_run_us = 0;
+  };
+
+  UpdateDispatcher(size_t num_lanes, size_t max_lane_depth);
+  ~UpdateDispatcher();
+
+  // Non-copyable, non-movable
+  UpdateDispatcher(const UpdateDispatcher&) = delete;
+  UpdateDispatcher& operator=(const UpdateDispatcher&) = delete;
+  UpdateDispatcher(UpdateDispatcher&&) = delete;
+  UpdateDispatcher& operator=(UpdateDispatcher&&) = delete;
+
+  // Queue a task on the lane owning chat_id
+  // Blocks while the lane is full so back-pressure reaches the caller.
+  // Runs the task inline when called from that lane's own thread (nested dispatch).
+  // Returns false if the dispatcher has been shut down.
+  bool dispatch(int64_t chat_id, Task task);
+
+  // Same as dispatch() but never blocks: a full lane refuses the task
+  DispatchResult tryDispatch(int64_t chat_id, Task task);
+
+  // Stop accepting tasks, run everything already queued and join lane threads
+  void shutdown();
+
+  size_t getLaneCount() const { return lanes_.size(); }
+  size_t laneFor(int64_t chat_id) const;
+
+  LaneStats getLaneStats(size_t lane) const;
+  std::vector<LaneStats> getStats() const;
+
+ private:
+  struct Item {
+    Task task;
+    std::chrono::steady_clock::time_point enqueued_at;
+  };
+
+  struct Lane {
+    mutable std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::deque<Item> queue;
+    std::thread thread;
+    bool stopping = false;
+
+    std::atomic<uint64_t> processed{0};
+    std::atomic<uint64_t> total_wait_us{0};
+    std::atomic<uint64_t> total_run_us{0};
+    std::atomic<uint64_t> max_wait_us{0};
+    std::atomic<uint64_t> max_run_us{0};
+  };
+
+  void laneLoop(Lane& lane);
+
+  size_t max_lane_depth_;
+  std::vector<std::unique_ptr<Lane>> lanes_;
+};
+
+}  // namespace bot
+
+#endif  // BOT_UPDATE_DISPATCHER_H
@@ -13,26 +13,48 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include <vector>
+#include <cstdint>
+#include <chrono>
+#include <unordered_map>
+#include "bot/http_request_parser.h"
+
+namespace utils {
+class ThreadPool;
+}
 
 namespace bot {
 
 // Lightweight HTTP server for receiving Telegram webhook updates
-// Uses POSIX sockets for maximum portability and minimal dependencies
+// Single-threaded edge-triggered epoll reactor over non-blocking POSIX sockets:
+// requests are parsed incrementally, connections are kept alive (HTTP/1.1)
+// and every connection carries a deadline so a slow client cannot stall the loop
 class WebhookServer {
  public:
+  // Outcome of handing an update to the callback
+  enum class UpdateResult {
+    kProcessed,   // Accepted; answered 200
+    kFailed,      // Unusable update; still answered 200 so Telegram does not redeliver it
+    kRetryLater,  // No capacity right now; answered 503 so Telegram redelivers it
+  };
+
   // Callback type for processing incoming webhook requests
-  // Returns true if the update was processed successfully
-  using UpdateCallback = std::function<bool(const std::string& json_body)>;
+  using UpdateCallback = std::function<UpdateResult(const std::string& json_body)>;
   
   // Configuration for the webhook server
   struct Config {
     int port = 8080;                          // Port to listen on
     std::string bind_address = "0.0.0.0";     // Address to bind to
     std::string path = "/webhook";            // Expected webhook path (e.g., "/webhook")
+    std::string metrics_path = "/metrics";    // GET serves the metrics registry (empty disables)
+    std::string metrics_token;                 // Required as "Authorization: Bearer <token>" on metrics_path (empty = open)
     std::string secret_token;                  // Secret token for validation (X-Telegram-Bot-Api-Secret-Token)
     int backlog = 10;                          // Connection queue size
     int max_body_size = 1024 * 1024;           // Maximum request body size (1MB)
-    int socket_timeout_seconds = 30;           // Socket read/write timeout
+    int socket_timeout_seconds = 30;           // Deadline for receiving a full request / flushing a response
+    int keep_alive_timeout_seconds = 60;       // Idle time before a keep-alive connection is closed
+    int max_connections = 1024;                // Open client connections before new ones are refused
+    int worker_threads = 0;                    // Request handler threads (0 = handle on the accept thread)
+    int max_queue_depth = 64;                  // Accepted connections waiting for a worker before 503
   };
   
   WebhookServer();
@@ -63,40 +85,121 @@ class WebhookServer {
   // Get the port the server is listening on
   int getPort() const { return config_.port; }
   
+  // Number of accepted connections waiting for a worker (0 in inline mode)
+  size_t getQueueDepth() const;
+  
+  // Number of requests rejected with 503 because the queue was full
+  uint64_t getRejectedCount() const { return rejected_count_.load(); }
+  
+  // Number of open client connections
+  size_t getConnectionCount() const { return connection_count_.load(); }
+  
  private:
-  // Server loop (runs in separate thread)
-  void serverLoop();
+  using Clock = std::chrono::steady_clock;
+  
+  // Per-connection state, owned by the event loop thread
+  struct Connection {
+    int fd = -1;
+    uint64_t id = 0;                 // Distinguishes reused fd numbers
+    std::string in_buffer;           // Received bytes; reused across requests
+    size_t in_offset = 0;            // Start of unparsed data in in_buffer
+    HttpRequestParser parser;
+    std::string out_buffer;          // Response bytes not yet written
+    size_t out_offset = 0;
+    Clock::time_point deadline;
+    bool in_flight = false;          // A request is being handled; reading is paused
+    bool close_after_write = false;
+    bool peer_closed = false;
+    bool closing = false;            // Marked for close at the end of the loop iteration
+    bool timing = false;             // request_started belongs to the request being served
+    Clock::time_point request_started;  // Accept or first byte, until the response is flushed
+    
+    Connection(size_t max_header_size, size_t max_body_size) : parser(max_header_size, max_body_size) {}
+    
+    std::string_view pendingInput() const {
+      return std::string_view(in_buffer).substr(in_offset);
+    }
+    bool hasPendingInput() const { return in_offset < in_buffer.size(); }
+  };
   
-  // Handle a single client connection
-  void handleClient(int client_socket);
-  
-  // Parse HTTP request and extract body
-  struct HttpRequest {
-    std::string method;
-    std::string path;
-    std::string content_type;
-    std::string secret_token;
-    std::string body;
-    bool valid = false;
+  // Response produced by a worker, handed back to the event loop
+  struct Completion {
+    int fd;
+    uint64_t id;
+    std::string response;
+    bool keep_alive;
   };
-  HttpRequest parseRequest(int client_socket);
   
-  // Send HTTP response
-  void sendResponse(int client_socket, int status_code, const std::string& body = "");
+  // Event loop (runs in separate thread)
+  void serverLoop();
+  
+  void acceptConnections();
+  void onReadable(Connection& conn);
+  void onWritable(Connection& conn);
+  
+  // Connections are closed at the end of a loop iteration so handlers never
+  // see a dangling Connection reference
+  void markForClose(Connection& conn);
+  void reapConnections();
+  void closeAllConnections();
   
-  // Read from socket until \r\n\r\n (end of headers)
-  std::string readHeaders(int client_socket);
+  // Parse and dispatch as many complete requests as are buffered
+  void processBuffer(Connection& conn);
   
-  // Read exact number of bytes from socket
-  std::string readBody(int client_socket, size_t content_length);
+  // Drop a parsed request from the front of the connection buffer
+  static void consumeInput(Connection& conn, size_t bytes);
+  
+  // Hand a validated request body to the worker pool (or handle it inline)
+  void dispatchRequest(Connection& conn, std::string body, bool keep_alive);
+  
+  // Move finished worker responses onto their connections
+  void drainCompletions();
+  
+  // Close connections whose deadline has passed; returns ms until the next deadline
+  int expireConnections();
+  
+  // Check method, path, content type and secret token; returns HTTP status code
+  int validateRequest(const HttpRequestView& request) const;
+  
+  // Invoke the update callback; returns HTTP status code
+  int handleUpdate(const std::string& body);
+  
+  // Build an HTTP response
+  static std::string buildResponse(int status_code, const std::string& body, bool keep_alive);
+  
+  // Queue response bytes on a connection and try to flush them
+  void queueResponse(Connection& conn, std::string response, bool keep_alive);
+  
+  // Wake the event loop (stop request or completion available)
+  void wakeLoop();
   
   Config config_;
   UpdateCallback callback_;
   
   std::atomic<bool> running_{false};
   std::thread server_thread_;
+  std::unique_ptr<utils::ThreadPool> worker_pool_;
+  std::atomic<uint64_t> rejected_count_{0};
+  std::atomic<size_t> connection_count_{0};
   int server_socket_ = -1;
+  int epoll_fd_ = -1;
+  int wake_fd_ = -1;
   mutable std::mutex mutex_;
+  
+  // Snapshot of config_ taken by start() for the request path
+  std::string expected_path_;        // Webhook path without leading/trailing '/'
+  std::string metrics_path_;         // Same form; empty when the endpoint is disabled
+  std::string expected_metrics_authorization_;  // "Bearer <token>"; empty when metrics are open
+  std::string expected_secret_token_;
+  
+  // Event loop state (loop thread only)
+  std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+  uint64_t next_connection_id_ = 1;
+  std::vector<int> pending_close_;
+  
+  // Worker -> loop handoff
+  std::mutex completions_mutex_;
+  std::vector<Completion> completions_;
 };
 
 }  // namespace bot
@@ -1,12 +1,66 @@
 #ifndef DATABASE_CONNECTION_POOL_H
 #define DATABASE_CONNECTION_POOL_H
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <pqxx/pqxx>
+#include "observability/metrics.h"
 
 namespace database {
 
+class ConnectionPool;
+
+// Move-only lease on a pooled connection
+// Returns the connection to its pool when destroyed, so every exit path
+// (including exceptions) releases exactly once. Broken connections are
+// discarded and their slot freed. The pool must outlive its leases.
+class PooledConnection {
+ public:
+  PooledConnection() = default;
+  PooledConnection(ConnectionPool* pool, std::shared_ptr<pqxx::connection> conn)
+      : pool_(pool), conn_(std::move(conn)) {}
+  ~PooledConnection() { release(); }
+  
+  PooledConnection(const PooledConnection&) = delete;
+  PooledConnection& operator=(const PooledConnection&) = delete;
+  
+  PooledConnection(PooledConnection&& other) noexcept
+      : pool_(other.pool_), conn_(std::move(other.conn_)) {
+    other.pool_ = nullptr;
+  }
+  PooledConnection& operator=(PooledConnection&& other) noexcept {
+    if (this != &other) {
+      release();
+      pool_ = other.pool_;
+      conn_ = std::move(other.conn_);
+      other.pool_ = nullptr;
+    }
+    return *this;
+  }
+  
+  pqxx::connection& operator*() const { return *conn_; }
+  pqxx::connection* operator->() const { return conn_.get(); }
+  pqxx::connection* get() const { return conn_.get(); }
+  explicit operator bool() const { return conn_ != nullptr; }
+  
+  // Return the connection to the pool now (no-op if already released)
+  void release();
+  
+  // Close the connection so the pool drops it instead of reusing it
+  void invalidate();
+  
+ private:
+  ConnectionPool* pool_ = nullptr;
+  std::shared_ptr<pqxx::connection> conn_;
+};
+
 class ConnectionPool {
  public:
   struct Config {
@@ -15,6 +69,9 @@ class ConnectionPool {
     int max_size = 10;
     int idle_timeout_seconds = 300;
     int max_lifetime_seconds = 3600;
+    int acquire_timeout_ms = 5000;     // How long acquire() waits for a free connection
+    int maintenance_interval_seconds = 30;  // Reaping / warm-up period (0 disables the thread)
+    int validation_idle_seconds = 60;  // Ping connections idle this long before lending them
   };
   
   static std::unique_ptr<ConnectionPool> create(const Config& config);
@@ -22,28 +79,86 @@ class ConnectionPool {
   ~ConnectionPool();
   
   // Get a connection from the pool
-  std::shared_ptr<pqxx::connection> acquire();
-  
-  // Return a connection to the pool
-  void release(std::shared_ptr<pqxx::connection> conn);
+  // Waits up to acquire_timeout_ms when all max_size connections are in use;
+  // waiters are served in FIFO order. Throws std::runtime_error on timeout.
+  // The connection goes back to the pool when the returned lease is destroyed.
+  PooledConnection acquire();
+  PooledConnection acquire(std::chrono::milliseconds timeout);
   
   // Get pool statistics
   int getActiveConnections() const;
   int getTotalConnections() const;
+  int getWaitingCount() const;
   
   // Health check
   bool healthCheck();
 
  private:
+  friend class PooledConnection;
+  
   ConnectionPool(const Config& config);
   
+  // Return a leased connection; closed connections are dropped and their slot freed
+  void release(std::shared_ptr<pqxx::connection> conn);
+  
+  // A blocked acquire() call, queued in arrival order
+  // release() either hands it a connection directly or grants it a free slot
+  // to open a new connection outside the lock.
+  struct Waiter {
+    std::condition_variable cv;
+    std::shared_ptr<pqxx::connection> conn;
+    bool done = false;
+  };
+  
+  using Clock = std::chrono::steady_clock;
+  
+  struct IdleConnection {
+    std::shared_ptr<pqxx::connection> conn;
+    Clock::time_point idle_since;
+  };
+  
   Config config_;
-  std::vector<std::shared_ptr<pqxx::connection>> pool_;
+  std::deque<IdleConnection> pool_;  // Idle connections, most recently used at the back
+  std::unordered_map<const pqxx::connection*, Clock::time_point> opened_at_;  // For max lifetime
+  std::deque<Waiter*> waiters_;
   mutable std::mutex mutex_;  // Mutable to allow locking in const methods
-  int active_connections_ = 0;
+  int active_connections_ = 0;  // Lent out or being opened (reserved slots)
+  
+  std::thread maintenance_thread_;
+  std::condition_variable maintenance_cv_;
+  bool stopping_ = false;
+  
+  // Series are shared by every pool in the process; the gauges read the state
+  // above, so they are declared last and unregistered first
+  observability::Histogram& acquire_latency_;
+  observability::Counter& acquire_timeouts_;
+  std::vector<observability::MetricsRegistry::CallbackHandle> gauges_;
   
   std::shared_ptr<pqxx::connection> createConnection();
+  
+  // Hand out an idle connection taken from pool_ (its slot is already counted
+  // as active); replaces it if it is broken, expired or fails validation
+  std::shared_ptr<pqxx::connection> checkOut(IdleConnection idle);
+  
+  // Cheap round trip on a connection that has been idle for a while
+  bool validate(pqxx::connection& conn);
+  
+  // Past max_lifetime_seconds (caller holds mutex_)
+  bool isExpiredLocked(const pqxx::connection* conn, Clock::time_point now) const;
+  
+  // Wait for a connection or a free slot (see acquire)
+  std::shared_ptr<pqxx::connection> acquireRaw(std::chrono::milliseconds timeout);
+  
+  // Open a connection for an already reserved slot; frees the slot on failure
+  std::shared_ptr<pqxx::connection> createReserved();
+  
+  // Give a freed slot to the oldest waiter (caller holds mutex_)
+  void grantSlotLocked();
+  
+  // Close idle connections past their idle or lifetime limit, then top the
+  // pool back up to min_size. Runs on the maintenance thread.
   void cleanupIdleConnections();
+  void maintenanceLoop();
 };
 
 }  // namespace database
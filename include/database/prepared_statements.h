@@ -0,0 +1,128 @@
+#ifndef DATABASE_PREPARED_STATEMENTS_H
+#define DATABASE_PREPARED_STATEMENTS_H
+
+#include <pqxx/pqxx>
+#include <utility>
+#include <vector>
+#include "observability/metrics.h"
+#include "observability/tracing.h"
+
+namespace database {
+
+// Catalogue of named statements run by the repositories and bot transactions
+// Every pooled connection prepares the whole catalogue once when it is opened,
+// so call sites use execPrepared() and Postgres parses each query only once
+// per connection instead of on every call.
+namespace statements {
+
+// groups
+inline constexpr const char* kGroupUpsert = "group_upsert";
+inline constexpr const char* kGroupUpsertNamed = "group_upsert_named";
+inline constexpr const char* kGroupByTelegramId = "group_by_telegram_id";
+inline constexpr const char* kGroupById = "group_by_id";
+inline constexpr const char* kGroupMigrate = "group_migrate";
+inline constexpr const char* kGroupSetActive = "group_set_active";
+inline constexpr const char* kGroupSetRatingSystem = "group_set_rating_system";
+inline constexpr const char* kGroupSetKPolicy = "group_set_k_policy";
+inline constexpr const char* kGroupClearKPolicy = "group_clear_k_policy";
+
+// group_players
+inline constexpr const char* kGroupPlayerInsert = "group_player_insert";
+inline constexpr const char* kGroupPlayerGet = "group_player_get";
+inline constexpr const char* kGroupPlayerLock = "group_player_lock";
+inline constexpr const char* kGroupPlayerUpdateVersioned = "group_player_update_versioned";
+inline constexpr const char* kGroupPlayerRankings = "group_player_rankings";
+inline constexpr const char* kGroupPlayerElos = "group_player_elos";
+inline constexpr const char* kGroupPlayerElosByGroup = "group_player_elos_by_group";
+inline constexpr const char* kGroupPlayersLockGroup = "group_players_lock_group";
+inline constexpr const char* kGroupPlayersUpdateRatings = "group_players_update_ratings";
+
+// group_topics
+inline constexpr const char* kGroupTopicUpsert = "group_topic_upsert";
+inline constexpr const char* kGroupTopicUpsertNoThread = "group_topic_upsert_no_thread";
+inline constexpr const char* kGroupTopicGet = "group_topic_get";
+inline constexpr const char* kGroupTopicGetByType = "group_topic_get_by_type";
+inline constexpr const char* kGroupTopicsByGroup = "group_topics_by_group";
+
+// players
+inline constexpr const char* kPlayerInsert = "player_insert";
+inline constexpr const char* kPlayerByTelegramId = "player_by_telegram_id";
+inline constexpr const char* kPlayerById = "player_by_id";
+inline constexpr const char* kPlayerUpdate = "player_update";
+inline constexpr const char* kPlayerUpdateNoNickname = "player_update_no_nickname";
+inline constexpr const char* kPlayerCount = "player_count";
+inline constexpr const char* kPlayerSoftDelete = "player_soft_delete";
+
+// matches
+inline constexpr const char* kMatchInsert = "match_insert";
+inline constexpr const char* kMatchById = "match_by_id";
+inline constexpr const char* kMatchByIdempotencyKey = "match_by_idempotency_key";
+inline constexpr const char* kMatchesByGroup = "matches_by_group";
+inline constexpr const char* kMatchLock = "match_lock";
+inline constexpr const char* kMatchMarkUndone = "match_mark_undone";
+inline constexpr const char* kMatchRatings = "match_ratings";
+inline constexpr const char* kRegisterMatch = "register_match";
+inline constexpr const char* kMatchHistory = "match_history";
+inline constexpr const char* kMatchesUpdateRatings = "matches_update_ratings";
+
+// elo_history
+inline constexpr const char* kEloHistoryInsert = "elo_history_insert";
+inline constexpr const char* kEloHistoryInsertNoMatch = "elo_history_insert_no_match";
+inline constexpr const char* kEloHistoryUpdateRatings = "elo_history_update_ratings";
+
+// player_verifications
+inline constexpr const char* kVerificationFresh = "verification_fresh";
+inline constexpr const char* kVerificationInsert = "verification_insert";
+
+}  // namespace statements
+
+struct PreparedStatement {
+  const char* name;
+  const char* sql;
+};
+
+// All statements in the catalogue
+const std::vector<PreparedStatement>& preparedStatements();
+
+// Prepare the catalogue on a freshly opened connection
+// A statement that fails to prepare (e.g. schema not migrated yet) is logged
+// and skipped; running it later fails with "prepared statement does not exist".
+// Returns the number of statements prepared.
+int prepareStatements(pqxx::connection& conn);
+
+// db_statement_duration_seconds for a statement name; catalogue statements
+// are looked up without locking or allocating
+observability::Histogram& statementLatency(const char* name);
+
+// Client span for one statement in the current trace
+observability::Span statementSpan(const char* name);
+
+// exec_prepared() that records the statement's latency and span
+template<typename... Args>
+pqxx::result execPrepared(pqxx::transaction_base& txn, const char* name, Args&&... args) {
+  observability::ScopedTimer timer(statementLatency(name));
+  auto span = statementSpan(name);
+  try {
+    return txn.exec_prepared(name, std::forward<Args>(args)...);
+  } catch (const std::exception& e) {
+    span.setError(e.what());
+    throw;
+  }
+}
+
+// exec_prepared1() that records the statement's latency and span
+template<typename... Args>
+pqxx::row execPrepared1(pqxx::transaction_base& txn, const char* name, Args&&... args) {
+  observability::ScopedTimer timer(statementLatency(name));
+  auto span = statementSpan(name);
+  try {
+    return txn.exec_prepared1(name, std::forward<Args>(args)...);
+  } catch (const std::exception& e) {
+    span.setError(e.what());
+    throw;
+  }
+}
+
+}  // namespace database
+
+#endif  // DATABASE_PREPARED_STATEMENTS_H
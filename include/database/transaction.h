@@ -3,10 +3,7 @@
 
 #include <memory>
 #include <pqxx/pqxx>
-
-namespace database {
-class ConnectionPool;
-}
+#include "database/connection_pool.h"
 
 namespace database {
 
@@ -43,7 +40,7 @@ class Transaction {
 
  private:
   std::shared_ptr<ConnectionPool> pool_;
-  std::shared_ptr<pqxx::connection> conn_;
+  PooledConnection conn_;             // Declared before txn_ so it is released after txn_ is destroyed
   std::unique_ptr<pqxx::work> txn_;
   bool active_;
   bool committed_;
@@ -15,6 +15,8 @@ struct Group {
   std::chrono::system_clock::time_point created_at;
   std::chrono::system_clock::time_point updated_at;
   bool is_active = true;
+  std::string rating_system = "elo";  // 'elo', 'glicko2', 'margin_elo'
+  std::optional<std::string> k_policy;  // utils::KFactorPolicy JSON; none = global K
 };
 
 struct GroupTopic {
@@ -39,6 +39,39 @@ struct EloHistory {
   bool is_undone = false;
 };
 
+// Rating state of a player in a group, as read before registering a match
+// Players not in the group yet report the column defaults.
+struct PlayerRating {
+  int current_elo = 1500;
+  int version = 0;
+  int matches_played = 0;           // Input of the group's K-factor policy
+  double rating_deviation = 350.0;  // Glicko-2 state, unused by ELO groups
+  double rating_volatility = 0.06;
+};
+
+// Input of MatchRepository::registerMatch()
+struct MatchRegistration {
+  int64_t telegram_group_id = 0;
+  std::string group_name;
+  int64_t player1_telegram_user_id = 0;
+  int64_t player2_telegram_user_id = 0;
+  int player1_score = 0;
+  int player2_score = 0;
+  PlayerRating player1_before;  // From getRatings(); version must still match
+  PlayerRating player2_before;
+  int player1_elo_after = 0;
+  int player2_elo_after = 0;
+  double player1_deviation_after = 350.0;
+  double player2_deviation_after = 350.0;
+  double player1_volatility_after = 0.06;
+  double player2_volatility_after = 0.06;
+  std::string rating_system = "elo";  // utils::toString() of the engine used, replayed by /undo
+  int player1_k_factor = 0;           // K from the group's policy; 0 = the engine's K
+  int player2_k_factor = 0;
+  std::string idempotency_key;
+  int64_t created_by_telegram_user_id = 0;
+};
+
 }  // namespace models
 
 #endif  // MODELS_MATCH_H
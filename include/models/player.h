@@ -28,10 +28,19 @@ struct GroupPlayer {
   int matches_won = 0;
   int matches_lost = 0;
   int version = 0;
+  double rating_deviation = 350.0;  // Glicko-2 state, unused by ELO groups
+  double rating_volatility = 0.06;
   std::chrono::system_clock::time_point created_at;
   std::chrono::system_clock::time_point updated_at;
 };
 
+// A School21 lookup kept in player_verifications until expires_at
+struct PlayerVerification {
+  std::string school_nickname;
+  std::string verification_status;  // Participant status, or NOT_FOUND
+  std::chrono::system_clock::time_point expires_at;
+};
+
 }  // namespace models
 
 #endif  // MODELS_PLAYER_H
@@ -1,10 +1,21 @@
 #ifndef OBSERVABILITY_LOGGER_H
 #define OBSERVABILITY_LOGGER_H
 
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include "utils/mpsc_ring_buffer.h"
 
 namespace observability {
 
@@ -17,36 +28,231 @@ enum class LogLevel {
   FATAL
 };
 
+// What log() does when the ring buffer is full
+enum class OverflowPolicy {
+  kDrop,    // Drop the record (counted in Stats::dropped)
+  kBlock,   // Wait for the writer to make room
+  kSample   // Wait for one record in every sample_every, drop the rest
+};
+
+// Level by name ("DEBUG", "info", ...); fallback for unknown names
+LogLevel logLevelFromString(std::string_view name, LogLevel fallback = LogLevel::INFO);
+
+// Key of a structured field, encoded as `"key":` at compile time
+// Keys are plain identifiers; anything JSON would need escaped is rejected.
+template<size_t N>
+struct FieldKey {
+  char text[N + 2]{};
+
+  consteval FieldKey(const char (&key)[N]) {
+    static_assert(N > 1, "field keys must not be empty");
+    text[0] = '"';
+    for (size_t i = 0; i + 1 < N; ++i) {
+      char c = key[i];
+      if (c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+        throw "field keys must not need JSON escaping";
+      }
+      text[i + 1] = c;
+    }
+    text[N] = '"';
+    text[N + 1] = ':';
+  }
+
+  constexpr std::string_view encoded() const { return std::string_view(text, N + 2); }
+};
+
+// A typed key/value pair for Logger::log(); holds a reference, so build it
+// in the logging call: OBS_INFO(logger, "Update", field<"chat_id">(chat_id))
+template<FieldKey Key, typename T>
+struct Field {
+  const T& value;
+};
+
+template<FieldKey Key, typename T>
+Field<Key, T> field(const T& value) {
+  return Field<Key, T>{value};
+}
+
+namespace detail {
+
+void appendJsonString(std::string& out, std::string_view value);
+
+template<typename T>
+struct IsOptional : std::false_type {};
+template<typename T>
+struct IsOptional<std::optional<T>> : std::true_type {};
+
+template<typename T>
+void appendJsonValue(std::string& out, const T& value) {
+  if constexpr (std::is_same_v<T, bool>) {
+    out += value ? "true" : "false";
+  } else if constexpr (std::is_integral_v<T>) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+  } else if constexpr (std::is_floating_point_v<T>) {
+    if (!std::isfinite(value)) {
+      out += "null";  // NaN and infinities have no JSON form
+      return;
+    }
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+  } else if constexpr (std::is_enum_v<T>) {
+    appendJsonValue(out, static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+    appendJsonString(out, std::string_view(value));
+  } else if constexpr (IsOptional<T>::value) {
+    if (value) {
+      appendJsonValue(out, *value);
+    } else {
+      out += "null";
+    }
+  } else {
+    static_assert(!sizeof(T*), "unsupported log field type");
+  }
+}
+
+}  // namespace detail
+
+// JSON-lines logger with an asynchronous backend
+// log() encodes the line into a thread-local buffer and copies it into a slot
+// of a lock-free ring buffer; a writer thread writes the slots out in batches
+// with write(2). Buffers and slots keep their capacity, so a steady stream of
+// lines allocates nothing. Lines are
+//   {"timestamp":"...","level":"INFO","message":"...",<fields>}
+// FATAL records are flushed before log() returns. Once the writer has been
+// stopped (process exit) records are written synchronously.
 class Logger {
  public:
+  struct Stats {
+    uint64_t written = 0;  // Records written out
+    uint64_t dropped = 0;  // Records lost to a full buffer
+  };
+
+  static constexpr size_t kQueueCapacity = 8192;
+  static constexpr size_t kMaxBatch = 256;
+  // Slots that held a longer line give the memory back
+  static constexpr size_t kMaxRetainedLine = 16 * 1024;
+
   static std::shared_ptr<Logger> getInstance();
-  
-  void log(LogLevel level, const std::string& message);
-  void log(LogLevel level, const std::string& message, 
-          const std::map<std::string, std::string>& context);
-  
+
+  ~Logger();
+
+  Logger(const Logger&) = delete;
+  Logger& operator=(const Logger&) = delete;
+
+  template<typename... Fields>
+  void log(LogLevel level, std::string_view message, const Fields&... fields) {
+    if (level < getLevel()) {
+      return;
+    }
+    std::string& line = beginLine(level, message);
+    (appendField(line, fields), ...);
+    commitLine(level, line);
+  }
+
+  // String context, e.g. from request headers; prefer typed fields
+  void log(LogLevel level, std::string_view message,
+           const std::map<std::string, std::string>& context);
+
   // Convenience methods
-  void trace(const std::string& message);
-  void debug(const std::string& message);
-  void info(const std::string& message);
-  void warn(const std::string& message);
-  void error(const std::string& message);
-  void fatal(const std::string& message);
-  
+  template<typename... Fields>
+  void trace(std::string_view message, const Fields&... fields) {
+    log(LogLevel::TRACE, message, fields...);
+  }
+  template<typename... Fields>
+  void debug(std::string_view message, const Fields&... fields) {
+    log(LogLevel::DEBUG, message, fields...);
+  }
+  template<typename... Fields>
+  void info(std::string_view message, const Fields&... fields) {
+    log(LogLevel::INFO, message, fields...);
+  }
+  template<typename... Fields>
+  void warn(std::string_view message, const Fields&... fields) {
+    log(LogLevel::WARN, message, fields...);
+  }
+  template<typename... Fields>
+  void error(std::string_view message, const Fields&... fields) {
+    log(LogLevel::ERROR, message, fields...);
+  }
+  template<typename... Fields>
+  void fatal(std::string_view message, const Fields&... fields) {
+    log(LogLevel::FATAL, message, fields...);
+  }
+
   void setLevel(LogLevel level);
-  LogLevel getLevel() const { return level_; }
+  LogLevel getLevel() const { return level_.load(std::memory_order_relaxed); }
+  bool isEnabled(LogLevel level) const { return level >= getLevel(); }
+
+  void setOverflowPolicy(OverflowPolicy policy, size_t sample_every = 100);
+
+  // Descriptor the writer writes to (stdout by default)
+  void setOutput(int fd);
+
+  // Wait until every record logged before the call has been written
+  void flush();
+
+  Stats getStats() const;
 
  private:
-  Logger() = default;
-  LogLevel level_ = LogLevel::INFO;
-  mutable std::mutex mutex_;  // Mutable to allow locking in const methods
-  
-  std::string levelToString(LogLevel level) const;
-  std::string formatMessage(LogLevel level, const std::string& message,
-                            const std::map<std::string, std::string>& context) const;
+  Logger();
+
+  template<FieldKey Key, typename T>
+  static void appendField(std::string& line, const Field<Key, T>& field) {
+    line += ',';
+    line += Key.encoded();
+    detail::appendJsonValue(line, field.value);
+  }
+
+  // Start a line in this thread's buffer: timestamp, level and message
+  std::string& beginLine(LogLevel level, std::string_view message);
+  // Close the line and hand it to the writer
+  void commitLine(LogLevel level, std::string& line);
+
+  void writerLoop();
+  void stopWriter();
+  void writeOut(std::string_view data);
+
+  std::atomic<LogLevel> level_{LogLevel::INFO};
+  std::atomic<OverflowPolicy> overflow_{OverflowPolicy::kDrop};
+  std::atomic<size_t> sample_every_{100};
+  std::atomic<int> fd_;
+
+  utils::MpscRingBuffer<std::string> queue_{kQueueCapacity};
+  std::atomic<bool> writer_sleeping_{false};
+  std::atomic<bool> stopping_{false};
+  std::atomic<uint64_t> overflowed_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> written_{0};
+  std::mutex write_mutex_;  // Serializes write(2) once records are written inline
+  std::thread writer_;
 };
 
 }  // namespace observability
 
-#endif  // OBSERVABILITY_LOGGER_H
+// Logging front end used by every module
+// The level is checked first (one relaxed atomic load, no lock) and the
+// arguments are only evaluated when it passes, so a disabled level costs
+// nothing at the call site:
+//   OBS_DEBUG(logger_, "Username not found in cache: @" + username);
+//   OBS_INFO(logger, "Processing Telegram update",
+//            observability::field<"body_size">(body.size()));
+// `logger` is anything with -> to a Logger and is evaluated once.
+#define OBS_LOG(logger, level, ...)                        \
+  do {                                                     \
+    auto&& obs_log_logger_ = (logger);                     \
+    if (obs_log_logger_->isEnabled(level)) {               \
+      obs_log_logger_->log(level, __VA_ARGS__);            \
+    }                                                      \
+  } while (0)
 
+#define OBS_TRACE(logger, ...) OBS_LOG(logger, ::observability::LogLevel::TRACE, __VA_ARGS__)
+#define OBS_DEBUG(logger, ...) OBS_LOG(logger, ::observability::LogLevel::DEBUG, __VA_ARGS__)
+#define OBS_INFO(logger, ...) OBS_LOG(logger, ::observability::LogLevel::INFO, __VA_ARGS__)
+#define OBS_WARN(logger, ...) OBS_LOG(logger, ::observability::LogLevel::WARN, __VA_ARGS__)
+#define OBS_ERROR(logger, ...) OBS_LOG(logger, ::observability::LogLevel::ERROR, __VA_ARGS__)
+#define OBS_FATAL(logger, ...) OBS_LOG(logger, ::observability::LogLevel::FATAL, __VA_ARGS__)
+
+#endif  // OBSERVABILITY_LOGGER_H
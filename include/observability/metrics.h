@@ -0,0 +1,212 @@
+#ifndef OBSERVABILITY_METRICS_H
+#define OBSERVABILITY_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace observability {
+
+// Label name/value pairs of one series, e.g. {{"statement", "player_by_id"}}
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+namespace detail {
+
+// Shard picked once per thread, so threads that record at the same time
+// mostly touch different cache lines
+inline size_t threadShard() {
+  static std::atomic<size_t> next{0};
+  thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed);
+  return shard;
+}
+
+}  // namespace detail
+
+// Monotonic counter; inc() is one relaxed add on this thread's shard
+class Counter {
+ public:
+  static constexpr size_t kShards = 16;
+
+  void inc(uint64_t n = 1) {
+    shards_[detail::threadShard() % kShards].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  uint64_t value() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+  std::array<Shard, kShards> shards_;
+};
+
+// Value that goes up and down
+class Gauge {
+ public:
+  void set(double value) { value_.store(value, std::memory_order_relaxed); }
+  void add(double delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  double value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<double> value_{0.0};
+};
+
+// Latency histogram with HDR-style log-linear buckets over microseconds
+// Below 8us every microsecond has its own bucket; above that each power of
+// two is split into 8 sub-buckets, so any recorded value is known to within
+// 12.5% from 1us up to ~19 hours (longer values land in the last bucket).
+// observe() is two relaxed adds on this thread's shard.
+class Histogram {
+ public:
+  static constexpr size_t kShards = 4;
+  static constexpr int kSubBucketBits = 3;
+  static constexpr size_t kSubBuckets = size_t{1} << kSubBucketBits;
+  static constexpr int kMaxExponent = 35;
+  static constexpr size_t kBuckets = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+  struct Snapshot {
+    std::vector<uint64_t> buckets;  // Per-bucket counts, kBuckets entries
+    uint64_t count = 0;
+    double sum_seconds = 0.0;
+
+    // Upper bound (in seconds) of the bucket holding quantile q in [0, 1];
+    // 0 when nothing was recorded
+    double quantile(double q) const;
+    // Observations below bound_micros, which should be a bucket bound
+    uint64_t countBelow(uint64_t bound_micros) const;
+  };
+
+  void observe(std::chrono::nanoseconds duration) {
+    auto nanos = duration.count() < 0 ? 0 : static_cast<uint64_t>(duration.count());
+    auto& shard = shards_[detail::threadShard() % kShards];
+    shard.buckets[bucketIndex(nanos / 1000)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum_nanos.fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  Snapshot snapshot() const;
+
+  static size_t bucketIndex(uint64_t micros) {
+    if (micros < kSubBuckets) {
+      return static_cast<size_t>(micros);
+    }
+    int exponent = 63 - __builtin_clzll(micros);
+    if (exponent > kMaxExponent) {
+      return kBuckets - 1;
+    }
+    auto sub = static_cast<size_t>(micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+  }
+
+  // Smallest value (in microseconds) that is not in bucket index
+  static uint64_t bucketUpperBound(size_t index);
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+    std::atomic<uint64_t> sum_nanos{0};
+  };
+  std::array<Shard, kShards> shards_;
+};
+
+// Records the time from construction to destruction into a histogram
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Histogram& histogram)
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  Histogram& histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Process-wide set of named metrics, rendered in the Prometheus text format
+// Series are created on first use and live until exit, so callers may keep
+// the returned references (typically in a function-local static). Asking for
+// an existing name with a different type throws std::invalid_argument.
+class MetricsRegistry {
+ public:
+  // Unregisters a callback gauge when destroyed
+  class CallbackHandle {
+   public:
+    CallbackHandle() = default;
+    ~CallbackHandle() { reset(); }
+
+    CallbackHandle(CallbackHandle&& other) noexcept { *this = std::move(other); }
+    CallbackHandle& operator=(CallbackHandle&& other) noexcept;
+    CallbackHandle(const CallbackHandle&) = delete;
+    CallbackHandle& operator=(const CallbackHandle&) = delete;
+
+    void reset();
+
+   private:
+    friend class MetricsRegistry;
+    MetricsRegistry* registry_ = nullptr;
+    std::string name_;
+    MetricLabels labels_;
+    uint64_t id_ = 0;
+  };
+
+  // Exported histogram bounds: powers of two from 128us to ~33.5s
+  static constexpr int kFirstExportedExponent = 7;
+  static constexpr int kLastExportedExponent = 25;
+
+  static MetricsRegistry& getInstance();
+
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  Counter& counter(std::string_view name, std::string_view help, const MetricLabels& labels = {});
+  Gauge& gauge(std::string_view name, std::string_view help, const MetricLabels& labels = {});
+  Histogram& histogram(std::string_view name, std::string_view help, const MetricLabels& labels = {});
+
+  // Gauge read from `read` at scrape time; `read` must not touch the registry.
+  // Registering the same name and labels again replaces the older callback.
+  [[nodiscard]] CallbackHandle gaugeCallback(std::string_view name, std::string_view help,
+                                             const MetricLabels& labels, std::function<double()> read);
+
+  // Every series in the Prometheus text exposition format (version 0.0.4)
+  std::string render() const;
+
+ private:
+  enum class Type { kCounter, kGauge, kHistogram };
+
+  struct Series {
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+    std::function<double()> callback;
+    uint64_t callback_id = 0;
+  };
+
+  struct Family {
+    Type type;
+    std::string help;
+    std::map<MetricLabels, Series> series;
+  };
+
+  Series& seriesFor(std::string_view name, std::string_view help, const MetricLabels& labels, Type type);
+  void removeCallback(const std::string& name, const MetricLabels& labels, uint64_t id);
+
+  mutable std::shared_mutex mutex_;
+  std::map<std::string, Family, std::less<>> families_;
+  uint64_t next_callback_id_ = 1;
+};
+
+}  // namespace observability
+
+#endif  // OBSERVABILITY_METRICS_H
@@ -0,0 +1,219 @@
+#ifndef OBSERVABILITY_TRACING_H
+#define OBSERVABILITY_TRACING_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "utils/mpsc_ring_buffer.h"
+
+namespace observability {
+
+class Tracer;
+
+// Identifies a span within its trace (W3C Trace Context ids)
+// An invalid context (all-zero trace id) means "not in a trace".
+struct SpanContext {
+  std::array<uint8_t, 16> trace_id{};
+  std::array<uint8_t, 8> span_id{};
+  bool sampled = false;
+
+  bool valid() const;
+  // "00-<trace_id>-<span_id>-<flags>", as in the traceparent header
+  std::string traceparent() const;
+};
+
+// OTLP span kinds
+enum class SpanKind { kInternal = 1, kServer = 2, kClient = 3, kProducer = 4, kConsumer = 5 };
+
+enum class SpanStatus { kUnset = 0, kOk = 1, kError = 2 };
+
+using AttributeValue = std::variant<std::string, int64_t, double, bool>;
+
+// A finished (or finishing) sampled span
+struct SpanData {
+  SpanContext context;
+  std::array<uint8_t, 8> parent_span_id{};  // All zero for a root span
+  std::string name;
+  SpanKind kind = SpanKind::kInternal;
+  uint64_t start_unix_nanos = 0;
+  uint64_t end_unix_nanos = 0;
+  std::vector<std::pair<std::string, AttributeValue>> attributes;
+  SpanStatus status = SpanStatus::kUnset;
+  std::string status_message;
+};
+
+// Context of the span running on this thread; spans started without an
+// explicit parent become its children
+SpanContext currentContext();
+
+// Makes a context current for a scope and restores the previous one, e.g. to
+// carry a trace into a task that runs on another thread
+class ContextScope {
+ public:
+  explicit ContextScope(const SpanContext& context);
+  ~ContextScope();
+
+  ContextScope(const ContextScope&) = delete;
+  ContextScope& operator=(const ContextScope&) = delete;
+
+ private:
+  SpanContext previous_;
+};
+
+// Move-only handle to a span; ends it when destroyed
+// Spans of unsampled traces record nothing and only carry the context, so
+// instrumented code costs a thread-local read when tracing is off.
+class Span {
+ public:
+  Span() = default;
+  ~Span() { end(); }
+
+  Span(Span&& other) noexcept;
+  Span& operator=(Span&& other) noexcept;
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+
+  bool isRecording() const { return data_.has_value(); }
+  const SpanContext& context() const { return context_; }
+
+  template<typename T>
+  void setAttribute(std::string_view key, const T& value) {
+    if (!data_) {
+      return;
+    }
+    if constexpr (std::is_same_v<T, bool>) {
+      data_->attributes.emplace_back(std::string(key), value);
+    } else if constexpr (std::is_integral_v<T>) {
+      data_->attributes.emplace_back(std::string(key), static_cast<int64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      data_->attributes.emplace_back(std::string(key), static_cast<double>(value));
+    } else {
+      data_->attributes.emplace_back(std::string(key), std::string(std::string_view(value)));
+    }
+  }
+
+  void setError(std::string_view message);
+
+  // Hand the span to its tracer's exporter (no-op if already ended)
+  void end();
+
+ private:
+  friend class Tracer;
+
+  Tracer* tracer_ = nullptr;
+  SpanContext context_;
+  std::optional<SpanData> data_;
+  std::chrono::steady_clock::time_point started_;
+};
+
+// A span that is also the current context until it ends
+class ScopedSpan {
+ public:
+  ScopedSpan(std::string_view name, SpanKind kind = SpanKind::kInternal);
+  ScopedSpan(std::string_view name, SpanKind kind, const SpanContext& parent);
+
+  Span& span() { return span_; }
+  Span* operator->() { return &span_; }
+
+ private:
+  Span span_;
+  ContextScope scope_;
+};
+
+// Head-sampled tracer exporting spans over OTLP/HTTP (JSON encoding)
+// The sampling decision is made once per trace, when its root span starts,
+// from the trace id; children follow their parent. Ended spans go through a
+// lock-free ring buffer to an exporter thread that posts them in batches of
+// up to max_batch, at least every export_interval. Spans that do not fit the
+// buffer, or whose export fails, are dropped and counted.
+class Tracer {
+ public:
+  // Delivers one OTLP JSON request body; returns false on failure
+  using Exporter = std::function<bool(const std::string& body)>;
+
+  struct Options {
+    bool enabled = false;
+    double sampling_rate = 1.0;    // Share of traces recorded, 0..1
+    std::string endpoint = "http://localhost:4318/v1/traces";
+    std::string service_name = "school-tg-tt-bot";
+    size_t max_batch = 512;        // Spans per export request
+    std::chrono::milliseconds export_interval{5000};
+    int export_timeout_seconds = 30;
+  };
+
+  struct Stats {
+    uint64_t exported = 0;
+    uint64_t dropped = 0;  // Buffer full or export failed
+  };
+
+  static constexpr size_t kQueueCapacity = 2048;  // Ended spans waiting for export
+
+  static Tracer& getInstance();
+
+  Tracer() = default;
+  ~Tracer();
+
+  Tracer(const Tracer&) = delete;
+  Tracer& operator=(const Tracer&) = delete;
+
+  // (Re)start with new options; exporter replaces the OTLP/HTTP client
+  void configure(Options options, Exporter exporter = {});
+
+  // Export everything ended so far and stop the exporter thread
+  void shutdown();
+
+  bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Child of parent (the current context by default), or the root of a new
+  // trace when parent is invalid
+  Span startSpan(std::string_view name, SpanKind kind = SpanKind::kInternal);
+  Span startSpan(std::string_view name, SpanKind kind, const SpanContext& parent);
+
+  Stats getStats() const;
+
+  // OTLP/JSON ExportTraceServiceRequest for a batch of spans
+  static std::string encode(const std::vector<SpanData>& spans, std::string_view service_name);
+
+ private:
+  friend class Span;
+
+  void submit(SpanData&& data);
+  void exportLoop();
+  void exportBatch(std::vector<SpanData>& batch);
+  bool postOtlp(const std::string& body);
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> sample_threshold_{0};  // Root spans whose random id is below this are sampled
+  std::atomic<size_t> max_batch_{512};         // Backlog that wakes the exporter early
+  Options options_;
+  Exporter exporter_;
+  utils::MpscRingBuffer<SpanData> queue_{kQueueCapacity};
+
+  std::mutex mutex_;  // Guards stopping_ and the exporter wakeup
+  std::condition_variable wake_;
+  bool stopping_ = false;
+  std::thread exporter_thread_;
+  void* curl_ = nullptr;  // CURL*, kept out of the header; exporter thread only
+  bool curl_global_ = false;  // curl_global_init() done by configure(), undone by shutdown()
+
+  std::atomic<uint64_t> exported_{0};
+  std::atomic<uint64_t> dropped_{0};
+};
+
+}  // namespace observability
+
+#endif  // OBSERVABILITY_TRACING_H
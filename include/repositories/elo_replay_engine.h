@@ -0,0 +1,61 @@
+#ifndef REPOSITORIES_ELO_REPLAY_ENGINE_H
+#define REPOSITORIES_ELO_REPLAY_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <pqxx/pqxx>
+#include "utils/elo_calculator.h"
+#include "utils/elo_replay.h"
+#include "utils/k_factor_policy.h"
+#include "utils/rating_engine.h"
+
+namespace repositories {
+
+// Recomputes every rating of a group from its match history
+// Streams the group's non-undone matches in created_at order through
+// utils::EloReplay with the group's rating engine (or, with setEngines(),
+// the engine each match was rated with) and writes back, with one batched UPDATE per table, the
+// match rows, elo_history rows and group_players rows whose values changed.
+// Used by /undo so that matches played after the undone one are rated
+// against the corrected ratings.
+class EloReplayEngine {
+ public:
+  struct Result {
+    size_t matches = 0;
+    size_t matches_changed = 0;
+    // group_players rows whose rating or stats changed
+    std::vector<utils::ReplayedPlayer> changed_players;
+  };
+
+  explicit EloReplayEngine(const utils::RatingEngine& engine,
+                           int initial_elo = utils::kInitialRating);
+  // Plain ELO with the calculator's K
+  explicit EloReplayEngine(const utils::EloCalculator& calculator,
+                           int initial_elo = utils::kInitialRating);
+
+  // The group's K-factor policy, see utils::EloReplay::setKFactorPolicy()
+  void setKFactorPolicy(std::optional<utils::KFactorPolicy> policy) { k_policy_ = std::move(policy); }
+
+  // Rate each match with the system stored on it (matches.rating_system),
+  // see utils::EloReplay::setEngines()
+  void setEngines(const utils::RatingEngines* engines) { engines_ = engines; }
+
+  // Runs inside the caller's transaction; locks all of the group's
+  // group_players rows first (id order, like register_match()), so match
+  // registration in the group waits until the caller commits
+  Result recompute(pqxx::work& work, int64_t group_id);
+
+ private:
+  std::unique_ptr<utils::RatingEngine> owned_engine_;
+  const utils::RatingEngine* engine_;
+  const utils::RatingEngines* engines_ = nullptr;
+  int initial_elo_;
+  std::optional<utils::KFactorPolicy> k_policy_;
+};
+
+}  // namespace repositories
+
+#endif  // REPOSITORIES_ELO_REPLAY_ENGINE_H
@@ -0,0 +1,65 @@
+#ifndef REPOSITORIES_ENTITY_CACHE_H
+#define REPOSITORIES_ENTITY_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "models/group.h"
+#include "models/player.h"
+#include "repositories/leaderboard.h"
+#include "utils/lru_cache.h"
+
+namespace repositories {
+
+struct GroupPlayerKey {
+  int64_t group_id = 0;
+  int64_t player_id = 0;
+
+  bool operator==(const GroupPlayerKey& other) const {
+    return group_id == other.group_id && player_id == other.player_id;
+  }
+};
+
+struct GroupPlayerKeyHash {
+  size_t operator()(const GroupPlayerKey& key) const {
+    return std::hash<int64_t>{}(key.group_id) * 31 + std::hash<int64_t>{}(key.player_id);
+  }
+};
+
+// Write-through cache of rows the command handlers look up on every message
+// Shared by the repositories so a write through one of them (e.g. a match
+// registered by MatchRepository) invalidates what another one cached.
+// Every write path either refreshes or erases the affected entries; rows
+// changed outside the repositories are not seen until evicted.
+struct EntityCache {
+  struct Config {
+    size_t capacity = 4096;  // entries per table
+    size_t shards = 16;
+  };
+
+  explicit EntityCache(const Config& config)
+      : groups(config.capacity, config.shards),
+        players(config.capacity, config.shards),
+        group_players(config.capacity, config.shards),
+        topics(config.capacity, config.shards) {}
+
+  EntityCache() : EntityCache(Config{}) {}
+
+  // groups by telegram_group_id
+  utils::ShardedLruCache<int64_t, models::Group> groups;
+  // active players by telegram_user_id
+  utils::ShardedLruCache<int64_t, models::Player> players;
+  // group_players by (group_id, player_id)
+  utils::ShardedLruCache<GroupPlayerKey, models::GroupPlayer, GroupPlayerKeyHash> group_players;
+  // every group_topics row of a group by group_id, loaded on the first topic
+  // check and dropped only by configureTopic; stats() gives the hit/miss
+  // counters for the topic checks
+  utils::ShardedLruCache<int64_t, std::vector<models::GroupTopic>> topics;
+  // per-group rankings, rebuilt at startup and updated by every rating write
+  Leaderboard leaderboard;
+};
+
+}  // namespace repositories
+
+#endif  // REPOSITORIES_ENTITY_CACHE_H
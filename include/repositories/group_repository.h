@@ -6,6 +6,8 @@
 #include <vector>
 #include "models/group.h"
 #include "models/player.h"
+#include "repositories/leaderboard.h"
+#include "utils/lru_cache.h"
 
 namespace database {
 class ConnectionPool;
@@ -17,9 +19,13 @@ class row;
 
 namespace repositories {
 
+struct EntityCache;
+
 class GroupRepository {
  public:
-  explicit GroupRepository(std::shared_ptr<database::ConnectionPool> pool);
+  // cache is optional; repositories sharing one keep each other's entries fresh
+  explicit GroupRepository(std::shared_ptr<database::ConnectionPool> pool,
+                           std::shared_ptr<EntityCache> cache = nullptr);
   
   // Create or get group by Telegram group ID
   models::Group createOrGet(int64_t telegram_group_id, 
@@ -54,8 +60,54 @@ class GroupRepository {
   std::optional<models::GroupTopic> getTopicByType(int64_t group_id,
                                                    const std::string& topic_type);
 
+  // Move a group to its new chat id after a supergroup migration
+  // Returns false if no group has old_telegram_group_id or a group with
+  // new_telegram_group_id already exists
+  bool migrateTelegramId(int64_t old_telegram_group_id, int64_t new_telegram_group_id);
+
+  // Mark group active/inactive (bot added/removed)
+  bool setActive(int64_t telegram_group_id, bool is_active);
+
+  // Switch the group's rating system ('elo', 'glicko2', 'margin_elo')
+  // Existing ratings are kept and rated by the new system from the next match.
+  // Returns false if the group does not exist.
+  bool setRatingSystem(int64_t telegram_group_id, const std::string& rating_system);
+
+  // Set the group's K-factor policy (utils::KFactorPolicy JSON); fields left
+  // out take the defaults. Throws std::invalid_argument on an invalid policy.
+  // Returns false if the group does not exist.
+  bool setKFactorPolicy(int64_t telegram_group_id, const std::string& policy_json);
+
+  // Back to the global elo.k_factor; returns false if the group does not exist
+  bool clearKFactorPolicy(int64_t telegram_group_id);
+
+  // Record a group player rating written outside this repository
+  void groupPlayerChanged(int64_t group_id, int64_t player_id, int current_elo);
+  
+  // Load every group's leaderboard from group_players (startup)
+  // Returns the number of groups loaded; no-op without a cache
+  size_t rebuildLeaderboard();
+  
+  // Leaderboard queries, from memory when cached; without a cache (or while
+  // a group is still loading) the group is read from group_players
+  std::vector<Leaderboard::Entry> getLeaderboard(int64_t group_id, int limit = 10);
+  std::optional<Leaderboard::Entry> getPlayerRank(int64_t group_id, int64_t player_id);
+  std::vector<Leaderboard::Entry> getPlayersAround(int64_t group_id, int64_t player_id,
+                                                   int radius = 2);
+  
+  // Hit/miss counters of the topic cache (all zero without a cache)
+  utils::ShardedLruCache<int64_t, std::vector<models::GroupTopic>>::Stats topicCacheStats() const;
+
  private:
   std::shared_ptr<database::ConnectionPool> pool_;
+  std::shared_ptr<EntityCache> cache_;
+  
+  // All topics of a group, from the cache or loaded into it
+  std::vector<models::GroupTopic> cachedTopics(int64_t group_id);
+  
+  // Run a query against the group's leaderboard, loading it first if needed
+  template<typename Query>
+  auto withLeaderboard(int64_t group_id, Query query);
   
   // Helper methods to convert database rows to models
   models::Group rowToGroup(const pqxx::row& row);
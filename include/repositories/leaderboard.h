@@ -0,0 +1,120 @@
+#ifndef REPOSITORIES_LEADERBOARD_H
+#define REPOSITORIES_LEADERBOARD_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "utils/fenwick_tree.h"
+
+namespace repositories {
+
+// In-memory per-group ranking materialized from group_players
+// Each group keeps a Fenwick tree of player counts per ELO value (rank of a
+// player = 1 + players with a strictly higher ELO, in O(log MAX_ELO)) and
+// an ELO-ordered index for top-N and "players around me" listings. Ties
+// share a rank and are listed by player_id.
+//
+// Groups are loaded whole from the database (loadGroup) and then kept in
+// step by the match/undo write paths (update). Updates for a group that is
+// not loaded are dropped; the next load reads them from the database.
+class Leaderboard {
+  struct Board;
+
+ public:
+  struct Entry {
+    int64_t player_id = 0;
+    int elo = 0;
+    int rank = 0;
+  };
+
+  // Read-only view of one loaded group, valid only inside tryQuery()
+  class GroupView {
+   public:
+    std::vector<Entry> top(int limit) const;
+    std::optional<Entry> rankOf(int64_t player_id) const;
+    std::vector<Entry> around(int64_t player_id, int radius) const;
+
+   private:
+    friend class Leaderboard;
+    explicit GroupView(const Board& board) : board_(board) {}
+    const Board& board_;
+  };
+
+  // Rating writes seen for one group when its database read started
+  struct LoadToken {
+    uint64_t generation = 0;  // clear() calls
+    uint64_t version = 0;     // Writes to the group since the last clear()
+  };
+
+  Leaderboard() = default;
+  Leaderboard(const Leaderboard&) = delete;
+  Leaderboard& operator=(const Leaderboard&) = delete;
+
+  // Token to take before reading a group from the database
+  LoadToken loadToken(int64_t group_id) const;
+
+  // Install a group read from the database after its loadToken(); returns
+  // false (and installs nothing) if a write to that group arrived meanwhile
+  bool loadGroup(int64_t group_id, const std::vector<std::pair<int64_t, int>>& players,
+                 LoadToken token);
+
+  bool hasGroup(int64_t group_id) const;
+  // Drop every group; the returned token loads any group not written since
+  LoadToken clear();
+
+  // A player's rating changed (or the player joined the group)
+  void update(int64_t group_id, int64_t player_id, int elo);
+  // A player row was read; adds it only if the group is loaded and does not
+  // know the player yet
+  void addIfAbsent(int64_t group_id, int64_t player_id, int elo);
+
+  // Run query(GroupView) under one read lock if the group is loaded;
+  // nullopt if it is not, so callers can tell "not cached" from "empty"
+  template<typename Query>
+  auto tryQuery(int64_t group_id, Query query) const
+      -> std::optional<std::invoke_result_t<Query, const GroupView&>> {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Board* board = find(group_id);
+    if (!board) {
+      return std::nullopt;
+    }
+    return query(GroupView(*board));
+  }
+
+  std::vector<Entry> top(int64_t group_id, int limit) const;
+  std::optional<Entry> rankOf(int64_t group_id, int64_t player_id) const;
+  // Up to `radius` players on each side of player_id, including the player
+  std::vector<Entry> around(int64_t group_id, int64_t player_id, int radius) const;
+
+ private:
+  struct Board {
+    Board();
+    utils::FenwickTree counts;
+    std::unordered_map<int64_t, int> elo_by_player;
+    std::map<int, std::set<int64_t>, std::greater<int>> players_by_elo;
+
+    void set(int64_t player_id, int elo);
+    int rankOf(int elo) const;
+  };
+
+  static int clampElo(int elo);
+  const Board* find(int64_t group_id) const;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<int64_t, std::unique_ptr<Board>> boards_;
+  // Per group, so writes to one group do not fail loads of the others
+  std::unordered_map<int64_t, uint64_t> versions_;
+  uint64_t generation_ = 0;
+};
+
+}  // namespace repositories
+
+#endif  // REPOSITORIES_LEADERBOARD_H
@@ -3,6 +3,8 @@
 
 #include <memory>
 #include <optional>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 #include "models/match.h"
 
@@ -16,9 +18,20 @@ class row;
 
 namespace repositories {
 
+struct EntityCache;
+
+// Thrown when a match with the same idempotency key was already registered
+class DuplicateMatchException : public std::runtime_error {
+ public:
+  explicit DuplicateMatchException(const std::string& message = "Match with this idempotency key already exists")
+      : std::runtime_error(message) {}
+};
+
 class MatchRepository {
  public:
-  explicit MatchRepository(std::shared_ptr<database::ConnectionPool> pool);
+  // cache is optional; see GroupRepository
+  explicit MatchRepository(std::shared_ptr<database::ConnectionPool> pool,
+                           std::shared_ptr<EntityCache> cache = nullptr);
   
   // Create match
   models::Match create(const models::Match& match);
@@ -40,9 +53,21 @@ class MatchRepository {
   
   // Create ELO history entry
   void createEloHistory(const models::EloHistory& history);
+  
+  // Current ratings of two players in a group (no locks taken)
+  std::pair<models::PlayerRating, models::PlayerRating> getRatings(
+      int64_t telegram_group_id, int64_t player1_telegram_user_id,
+      int64_t player2_telegram_user_id);
+  
+  // Register a match in one round trip (register_match() in V2 migration)
+  // Creates the group, players and group players as needed. Throws
+  // utils::OptimisticLockException if either rating changed since getRatings()
+  // and DuplicateMatchException if the idempotency key was already used.
+  models::Match registerMatch(const models::MatchRegistration& registration);
 
  private:
   std::shared_ptr<database::ConnectionPool> pool_;
+  std::shared_ptr<EntityCache> cache_;
   
   // Helper method to convert database row to Match model
   models::Match rowToMatch(const pqxx::row& row);
@@ -16,9 +16,13 @@ class row;
 
 namespace repositories {
 
+struct EntityCache;
+
 class PlayerRepository {
  public:
-  explicit PlayerRepository(std::shared_ptr<database::ConnectionPool> pool);
+  // cache is optional; see GroupRepository
+  explicit PlayerRepository(std::shared_ptr<database::ConnectionPool> pool,
+                            std::shared_ptr<EntityCache> cache = nullptr);
   
   // Create or get player by Telegram user ID
   models::Player createOrGet(int64_t telegram_user_id);
@@ -37,6 +41,10 @@ class PlayerRepository {
 
  private:
   std::shared_ptr<database::ConnectionPool> pool_;
+  std::shared_ptr<EntityCache> cache_;
+  
+  // Drop the cached entry for a player row after a write
+  void invalidatePlayer(int64_t player_id);
   
   // Helper to convert database row to Player model
   models::Player rowToPlayer(const pqxx::row& row);
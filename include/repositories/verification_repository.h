@@ -0,0 +1,37 @@
+#ifndef REPOSITORIES_VERIFICATION_REPOSITORY_H
+#define REPOSITORIES_VERIFICATION_REPOSITORY_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "models/player.h"
+
+namespace database {
+class ConnectionPool;
+}
+
+namespace repositories {
+
+// School21 lookup results in player_verifications, the persistent tier of
+// school21::VerificationCache
+class VerificationRepository {
+ public:
+  explicit VerificationRepository(std::shared_ptr<database::ConnectionPool> pool);
+
+  // Latest unexpired result for a nickname (case-insensitive)
+  std::optional<models::PlayerVerification> findFresh(const std::string& school_nickname);
+
+  // Record a lookup made for player_id in group_id, valid for ttl
+  void record(int64_t player_id, int64_t group_id, const std::string& school_nickname,
+              const std::string& verification_status, int64_t telegram_message_id,
+              std::chrono::seconds ttl);
+
+ private:
+  std::shared_ptr<database::ConnectionPool> pool_;
+};
+
+}  // namespace repositories
+
+#endif  // REPOSITORIES_VERIFICATION_REPOSITORY_H
@@ -7,6 +7,10 @@
 #include <chrono>
 #include <mutex>
 
+namespace observability {
+class Histogram;
+}
+
 namespace school21 {
 
 struct Participant {
@@ -16,6 +20,18 @@ struct Participant {
   std::optional<std::string> parallel_name;
 };
 
+// Outcome of a participant lookup; only kFound and kNotFound are worth caching
+enum class LookupStatus { kFound, kNotFound, kError };
+
+struct Lookup {
+  LookupStatus status = LookupStatus::kError;
+  std::optional<Participant> participant;  // Set when kFound
+};
+
+// school21_request_duration_seconds for one HTTP method; shared by the
+// blocking client and the VerificationPool
+observability::Histogram& requestLatency(const char* method);
+
 class ApiClient {
  public:
   struct Config {
@@ -36,6 +52,15 @@ class ApiClient {
   // Check if participant exists and is active
   virtual bool verifyParticipant(const std::string& login);
 
+  // Valid access token, authenticating first when needed (blocking)
+  std::string getAccessToken();
+
+  const Config& getConfig() const { return config_; }
+
+  // Participant from a /participants/{login} response body
+  // Throws on malformed JSON.
+  static Participant parseParticipant(const std::string& body, const std::string& login);
+
  private:
   Config config_;
   
@@ -52,7 +77,6 @@ class ApiClient {
   Token authenticate();
   Token refreshToken(const std::string& refresh_token);
   bool isTokenValid() const;
-  std::string getAccessToken();
   
   // HTTP client methods
   std::string httpGet(const std::string& url, const std::string& token);
@@ -0,0 +1,77 @@
+#ifndef SCHOOL21_VERIFICATION_CACHE_H
+#define SCHOOL21_VERIFICATION_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include "school21/api_client.h"
+#include "utils/lru_cache.h"
+
+namespace repositories {
+class VerificationRepository;
+}
+
+namespace school21 {
+
+// Two-tier cache of participant lookups in front of the School21 API
+// Memory (sharded LRU) first, then the unexpired player_verifications rows;
+// a database hit is copied into memory. Found participants are kept for
+// success_ttl, unknown logins for the shorter failure_ttl so a mistyped
+// nickname doesn't reach the API on every retry. Errors are never cached.
+// Logins are compared case-insensitively.
+class VerificationCache {
+ public:
+  struct Options {
+    size_t capacity = 4096;
+    size_t shards = 16;
+    std::chrono::seconds success_ttl = std::chrono::hours(24);
+    std::chrono::seconds failure_ttl = std::chrono::hours(1);
+  };
+
+  struct Stats {
+    uint64_t memory_hits = 0;
+    uint64_t database_hits = 0;
+    uint64_t misses = 0;
+  };
+
+  // repository is optional; without it only the memory tier is used
+  explicit VerificationCache(Options options,
+                             std::shared_ptr<repositories::VerificationRepository> repository = nullptr);
+
+  // Cached kFound/kNotFound lookup, if still fresh
+  std::optional<Lookup> get(const std::string& login);
+
+  // Remember a lookup made by player_id in group_id (the player_verifications
+  // row); kError lookups are ignored. Database failures are logged, not thrown.
+  void put(const std::string& login, const Lookup& lookup,
+           int64_t player_id, int64_t group_id, int64_t telegram_message_id);
+
+  Stats getStats() const;
+
+  // verification_status stored for a login the API doesn't know
+  static constexpr const char* kNotFoundStatus = "NOT_FOUND";
+
+ private:
+  struct Entry {
+    Lookup lookup;
+    std::chrono::system_clock::time_point expires_at;
+  };
+
+  static std::string key(const std::string& login);
+
+  Options options_;
+  std::shared_ptr<repositories::VerificationRepository> repository_;
+  utils::ShardedLruCache<std::string, Entry> memory_;
+
+  std::atomic<uint64_t> memory_hits_{0};
+  std::atomic<uint64_t> database_hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace school21
+
+#endif  // SCHOOL21_VERIFICATION_CACHE_H
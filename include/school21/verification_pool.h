@@ -0,0 +1,75 @@
+#ifndef SCHOOL21_VERIFICATION_POOL_H
+#define SCHOOL21_VERIFICATION_POOL_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include "observability/tracing.h"
+#include "school21/api_client.h"
+#include "utils/thread_pool.h"
+
+namespace school21 {
+
+// Asynchronous participant lookups for /id
+// One event-loop thread drives every request through a curl multi handle,
+// so concurrent lookups share the loop and its connection cache instead of
+// a blocking request (and TLS handshake) each. Results are handed to
+// callback threads; callbacks never run on the event loop.
+class VerificationPool {
+ public:
+  using Callback = std::function<void(Lookup)>;
+  // Bearer token for the next requests; may block (called on the loop thread)
+  using TokenProvider = std::function<std::string()>;
+
+  struct Options {
+    std::string base_url;
+    int timeout_seconds = 10;
+    size_t max_concurrent = 16;   // Requests in flight at once
+    size_t max_queue = 1000;      // Lookups waiting for a slot
+    size_t callback_threads = 2;
+  };
+
+  VerificationPool(Options options, TokenProvider token_provider);
+  ~VerificationPool();
+
+  VerificationPool(const VerificationPool&) = delete;
+  VerificationPool& operator=(const VerificationPool&) = delete;
+
+  // Queue a lookup; returns false when the queue is full or the pool has
+  // been shut down (the callback is not called)
+  bool submit(const std::string& login, Callback callback);
+
+  // Finish queued and in-flight lookups, run their callbacks and join threads
+  void shutdown();
+
+ private:
+  struct Job {
+    std::string login;
+    Callback callback;
+    observability::SpanContext trace_context;  // Submitter's trace; the callback continues it
+  };
+  struct Transfer;
+
+  void eventLoop();
+  void complete(Job& job, Lookup lookup);
+
+  Options options_;
+  TokenProvider token_provider_;
+  void* multi_ = nullptr;  // CURLM*, kept out of the header
+
+  std::mutex mutex_;
+  std::deque<Job> pending_;
+  bool stopping_ = false;
+
+  std::unique_ptr<utils::ThreadPool> callbacks_;
+  std::thread loop_;
+};
+
+}  // namespace school21
+
+#endif  // SCHOOL21_VERIFICATION_POOL_H
@@ -1,30 +1,60 @@
 #ifndef UTILS_ELO_CALCULATOR_H
 #define UTILS_ELO_CALCULATOR_H
 
+#include <span>
 #include <utility>
 
 namespace utils {
 
+// Where the logistic expected score comes from
+enum class ExpectedScoreMode {
+  kExact,  // std::pow per match
+  kTable,  // compile-time table over the rating difference, no libm call
+};
+
 class EloCalculator {
  public:
-  EloCalculator(int k_factor = 32);
-  
+  EloCalculator(int k_factor = 32, ExpectedScoreMode mode = ExpectedScoreMode::kExact);
+
   // Calculate new ELO ratings after a match
   // Returns: (new_elo1, new_elo2)
-  std::pair<int, int> calculate(int elo1, int elo2, 
-                                int score1, int score2);
-  
+  std::pair<int, int> calculate(int elo1, int elo2,
+                                int score1, int score2) const;
+
+  // Same with a K-factor per player (utils::KFactorPolicy)
+  std::pair<int, int> calculate(int elo1, int elo2, int score1, int score2,
+                                int k_factor1, int k_factor2) const;
+
   // Calculate expected score for player1
-  double expectedScore(int elo1, int elo2);
-  
+  double expectedScore(int elo1, int elo2) const;
+
   // Calculate ELO change for a player
-  int calculateChange(int elo, double expected_score, double actual_score);
+  int calculateChange(int elo, double expected_score, double actual_score) const;
+
+  // Batch versions over structure-of-arrays inputs, element i is one match
+  // Expected scores come from a table over the rating difference that is
+  // filled with the scalar formula (or the compile-time one in kTable mode),
+  // so results are bit-identical to expectedScore() / calculate(). Throws
+  // std::invalid_argument if the spans differ in length.
+  void expectedScores(std::span<const int> elo1, std::span<const int> elo2,
+                      std::span<double> expected1) const;
+
+  void calculateBatch(std::span<const int> elo1, std::span<const int> elo2,
+                      std::span<const int> score1, std::span<const int> score2,
+                      std::span<int> new_elo1, std::span<int> new_elo2) const;
+
+  void calculateBatch(std::span<const int> elo1, std::span<const int> elo2,
+                      std::span<const int> score1, std::span<const int> score2,
+                      std::span<const int> k_factor1, std::span<const int> k_factor2,
+                      std::span<int> new_elo1, std::span<int> new_elo2) const;
+
+  int kFactor() const { return k_factor_; }
 
  private:
   int k_factor_;
+  ExpectedScoreMode mode_;
 };
 
 }  // namespace utils
 
 #endif  // UTILS_ELO_CALCULATOR_H
-
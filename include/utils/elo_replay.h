@@ -0,0 +1,99 @@
+#ifndef UTILS_ELO_REPLAY_H
+#define UTILS_ELO_REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "utils/elo_calculator.h"
+#include "utils/k_factor_policy.h"
+#include "utils/rating_engine.h"
+
+namespace utils {
+
+// One match of a group's history, in the order it was played
+struct ReplayMatch {
+  int64_t match_id = 0;
+  int64_t player1_id = 0;
+  int64_t player2_id = 0;
+  int player1_score = 0;
+  int player2_score = 0;
+  // System the match was rated with; rated by it when the replay has
+  // setEngines(), otherwise (or if unset) by the replay's engine
+  std::optional<RatingSystem> system = std::nullopt;
+  // K each player was rated with; 0 = from the K-factor policy, if any, or
+  // the engine's K
+  int player1_k_factor = 0;
+  int player2_k_factor = 0;
+};
+
+// Ratings of a match as recomputed by the replay
+struct ReplayedMatch {
+  int player1_elo_before = 0;
+  int player2_elo_before = 0;
+  int player1_elo_after = 0;
+  int player2_elo_after = 0;
+};
+
+// Final state of a player after the replay
+struct ReplayedPlayer {
+  int64_t player_id = 0;
+  int current_elo = 0;
+  int matches_played = 0;
+  int matches_won = 0;
+  int matches_lost = 0;
+  double rating_deviation = kInitialDeviation;
+  double rating_volatility = kInitialVolatility;
+};
+
+// Recomputes a group's ratings from scratch by running its matches through
+// the group's RatingEngine in order
+// Players are mapped to dense indices on first sight, so the rating table
+// is a few flat vectors and each match costs two hash lookups.
+class EloReplay {
+ public:
+  explicit EloReplay(const RatingEngine& engine, int initial_elo = kInitialRating);
+  // Plain ELO with the calculator's K
+  explicit EloReplay(const EloCalculator& calculator, int initial_elo = kInitialRating);
+
+  // Pick each player's K with the group's policy, from the replayed rating
+  // and matches played so far, for matches without a stored K; none = the
+  // engine's K
+  void setKFactorPolicy(std::optional<KFactorPolicy> policy) { k_policy_ = std::move(policy); }
+
+  // Rate each match with the engine of its own ReplayMatch::system, so a
+  // group that switched systems keeps the history each system produced
+  void setEngines(const RatingEngines* engines) { engines_ = engines; }
+
+  // Seed a player with no matches (keeps them in players() at initial_elo)
+  void addPlayer(int64_t player_id);
+
+  // Replay matches in order; the result is aligned with the input
+  std::vector<ReplayedMatch> replay(const std::vector<ReplayMatch>& matches);
+
+  // Every player seen so far, in first-seen order
+  std::vector<ReplayedPlayer> players() const;
+
+ private:
+  size_t indexOf(int64_t player_id);
+
+  std::unique_ptr<RatingEngine> owned_engine_;
+  const RatingEngine* engine_;
+  const RatingEngines* engines_ = nullptr;
+  int initial_elo_;
+  std::optional<KFactorPolicy> k_policy_;
+  std::unordered_map<int64_t, size_t> index_;
+  std::vector<int64_t> player_ids_;
+  std::vector<int> elo_;
+  std::vector<double> deviation_;
+  std::vector<double> volatility_;
+  std::vector<int> played_;
+  std::vector<int> won_;
+  std::vector<int> lost_;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_ELO_REPLAY_H
@@ -0,0 +1,49 @@
+#ifndef UTILS_FENWICK_TREE_H
+#define UTILS_FENWICK_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace utils {
+
+// Binary indexed tree of counts over positions [0, size)
+// 4 bytes per position, so a tree over the full ELO range is ~40 KB.
+// Point updates and prefix sums in O(log size).
+class FenwickTree {
+ public:
+  explicit FenwickTree(size_t size = 0) : tree_(size + 1, 0) {}
+
+  size_t size() const { return tree_.size() - 1; }
+
+  void add(size_t position, int32_t delta) {
+    for (size_t i = position + 1; i < tree_.size(); i += i & (~i + 1)) {
+      tree_[i] += delta;
+    }
+    total_ += delta;
+  }
+
+  // Sum of positions [0, position]
+  int32_t prefixSum(size_t position) const {
+    int32_t sum = 0;
+    for (size_t i = position + 1; i > 0; i -= i & (~i + 1)) {
+      sum += tree_[i];
+    }
+    return sum;
+  }
+
+  // Sum of positions (position, size)
+  int32_t suffixSumAfter(size_t position) const {
+    return total_ - prefixSum(position);
+  }
+
+  int32_t total() const { return total_; }
+
+ private:
+  std::vector<int32_t> tree_;
+  int32_t total_ = 0;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_FENWICK_TREE_H
@@ -0,0 +1,41 @@
+#ifndef UTILS_K_FACTOR_POLICY_H
+#define UTILS_K_FACTOR_POLICY_H
+
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "utils/rating_engine.h"
+
+namespace utils {
+
+// How a group picks each player's ELO K-factor for a match (groups.k_policy)
+// Inputs are the rating and matches_played already read with the ratings, so
+// the policy costs no extra query. Stored as JSON, e.g.
+//   {"k_factor": 24, "provisional_matches": 10, "provisional_k_factor": 40,
+//    "bands": [{"min_rating": 2000, "k_factor": 16}], "margin_weight": 0.5}
+struct KFactorPolicy {
+  struct Band {
+    int min_rating = 0;
+    int k_factor = 0;
+  };
+
+  int k_factor = 32;               // everyone not covered below
+  int provisional_matches = 0;     // fewer matches played => provisional; 0 disables
+  int provisional_k_factor = 40;
+  std::vector<Band> bands;         // rating >= min_rating, the highest band wins
+  double margin_weight = 0.0;      // K *= 1 + margin_weight * ln(score margin)
+
+  // K-factor of a player with this rating and history in a match that ended
+  // score1 : score2, always within [1, 200]. margin_weight is ignored under
+  // kMarginElo, whose engine already scales K by the margin.
+  int kFor(int rating, int matches_played, int score1, int score2, RatingSystem system) const;
+
+  // Fields missing from the JSON keep the values of `defaults`
+  // Throws std::invalid_argument on malformed JSON or out-of-range values.
+  static KFactorPolicy fromJson(const std::string& json, const KFactorPolicy& defaults);
+  nlohmann::json toJson() const;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_K_FACTOR_POLICY_H
@@ -0,0 +1,181 @@
+#ifndef UTILS_LRU_CACHE_H
+#define UTILS_LRU_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+
+// Bounded, thread-safe LRU cache
+// Keys are spread over independently locked shards so lookups from different
+// handler threads rarely contend; each shard evicts its own least recently
+// used entry once it holds capacity / shards entries.
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLruCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+  };
+
+  explicit ShardedLruCache(size_t capacity = 4096, size_t shards = 16)
+      : shards_(std::max<size_t>(shards, 1)) {
+    shard_capacity_ = std::max<size_t>(capacity / shards_.size(), 1);
+  }
+
+  ShardedLruCache(const ShardedLruCache&) = delete;
+  ShardedLruCache& operator=(const ShardedLruCache&) = delete;
+
+  std::optional<Value> get(const Key& key) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return std::nullopt;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->second;
+  }
+
+  // Insert or replace (write-through); also cancels fills still in flight
+  void put(const Key& key, Value value) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.invalidations++;
+    putLocked(shard, key, std::move(value));
+  }
+
+  // Invalidation counter of the key's shard, taken before reading the source
+  uint64_t snapshot(const Key& key) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.invalidations;
+  }
+
+  // Fill after a read of the source that started at snapshot(key)
+  // Skipped if an erase hit the shard meanwhile, so a read that raced with a
+  // write cannot put the old row back after the writer invalidated it.
+  bool putIfUnchanged(const Key& key, Value value, uint64_t snapshot) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.invalidations != snapshot) {
+      return false;
+    }
+    putLocked(shard, key, std::move(value));
+    return true;
+  }
+
+  bool erase(const Key& key) {
+    auto& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.invalidations++;
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      return false;
+    }
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+    return true;
+  }
+
+  // Remove every entry whose value matches; scans all shards, so keep it for
+  // rare invalidations that only know a secondary key
+  template<typename Predicate>
+  size_t eraseIf(Predicate pred) {
+    size_t erased = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.invalidations++;
+      for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+        if (pred(it->first, it->second)) {
+          shard.index.erase(it->first);
+          it = shard.entries.erase(it);
+          erased++;
+        } else {
+          ++it;
+        }
+      }
+    }
+    return erased;
+  }
+
+  void clear() {
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      shard.invalidations++;
+      shard.index.clear();
+      shard.entries.clear();
+    }
+  }
+
+  size_t size() const {
+    size_t total = 0;
+    for (auto& shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      total += shard.entries.size();
+    }
+    return total;
+  }
+
+  Stats stats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.size = size();
+    return stats;
+  }
+
+ private:
+  struct Shard {
+    mutable std::mutex mutex;
+    // Most recently used at the front
+    std::list<std::pair<Key, Value>> entries;
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index;
+    uint64_t invalidations = 0;
+  };
+
+  void putLocked(Shard& shard, const Key& key, Value value) {
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      it->second->second = std::move(value);
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      return;
+    }
+    shard.entries.emplace_front(key, std::move(value));
+    shard.index.emplace(key, shard.entries.begin());
+    if (shard.entries.size() > shard_capacity_) {
+      shard.index.erase(shard.entries.back().first);
+      shard.entries.pop_back();
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  Shard& shardFor(const Key& key) {
+    return shards_[Hash{}(key) % shards_.size()];
+  }
+
+  std::vector<Shard> shards_;
+  size_t shard_capacity_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+};
+
+}  // namespace utils
+
+#endif  // UTILS_LRU_CACHE_H
@@ -0,0 +1,108 @@
+#ifndef UTILS_MPSC_RING_BUFFER_H
+#define UTILS_MPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace utils {
+
+// Bounded multi-producer / single-consumer queue without locks
+// Each slot carries a sequence number (Vyukov's bounded queue): producers
+// claim a position with one CAS on head_ and publish the slot by bumping its
+// sequence, the consumer reads slots in order without touching head_.
+// Capacity is rounded up to a power of two.
+template<typename T>
+class MpscRingBuffer {
+ public:
+  explicit MpscRingBuffer(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_ = std::make_unique<Slot[]>(size);
+    for (size_t i = 0; i < size; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRingBuffer(const MpscRingBuffer&) = delete;
+  MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+  // Any thread; returns false (value left untouched) when the buffer is full
+  bool tryPush(T&& value) {
+    return tryPushWith([&value](T& slot) { slot = std::move(value); });
+  }
+
+  // Like tryPush(), but fill(T&) writes into the slot in place, e.g. to
+  // reuse the capacity a slot's string already has
+  template<typename Fill>
+  bool tryPushWith(Fill&& fill) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[pos & mask_];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          fill(slot.value);
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer thread only
+  bool tryPop(T& out) {
+    return tryPopWith([&out](T& slot) { out = std::move(slot); });
+  }
+
+  // Consumer thread only; consume(T&) reads the slot in place
+  template<typename Consume>
+  bool tryPopWith(Consume&& consume) {
+    Slot& slot = slots_[tail_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != tail_ + 1) {
+      return false;
+    }
+    consume(slot.value);
+    slot.sequence.store(tail_ + mask_ + 1, std::memory_order_release);
+    ++tail_;
+    popped_.store(tail_, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only: nothing is ready to pop
+  bool empty() const {
+    return slots_[tail_ & mask_].sequence.load(std::memory_order_acquire) != tail_ + 1;
+  }
+
+  // Positions claimed by producers so far; pushed() - popped() is the backlog
+  uint64_t pushed() const { return head_.load(std::memory_order_acquire); }
+  uint64_t popped() const { return popped_.load(std::memory_order_acquire); }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct alignas(64) Slot {
+    std::atomic<size_t> sequence{0};
+    T value{};
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_ = 0;
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) size_t tail_ = 0;
+  std::atomic<uint64_t> popped_{0};
+};
+
+}  // namespace utils
+
+#endif  // UTILS_MPSC_RING_BUFFER_H
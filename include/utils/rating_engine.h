@@ -0,0 +1,143 @@
+#ifndef UTILS_RATING_ENGINE_H
+#define UTILS_RATING_ENGINE_H
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include "utils/elo_calculator.h"
+
+namespace utils {
+
+// Starting state of a group_players row
+inline constexpr int kInitialRating = 1500;
+inline constexpr double kInitialDeviation = 350.0;
+inline constexpr double kInitialVolatility = 0.06;
+
+// Rating system of a group (groups.rating_system)
+enum class RatingSystem {
+  kElo,        // "elo": classic ELO with a fixed K
+  kGlicko2,    // "glicko2": Glicko-2, one rating period per match
+  kMarginElo,  // "margin_elo": ELO with K scaled by the score margin
+};
+
+std::string_view toString(RatingSystem system);
+std::optional<RatingSystem> parseRatingSystem(std::string_view name);
+
+// A player's rating state; ELO engines leave deviation and volatility alone
+struct Rating {
+  int rating = kInitialRating;
+  double deviation = kInitialDeviation;
+  double volatility = kInitialVolatility;
+  int k_factor = 0;  // ELO K for this match (KFactorPolicy); 0 = the engine's
+};
+
+// Independent matches as structure-of-arrays, element i is one match
+// Ratings, deviations and volatilities are updated in place; every span must
+// have the same length. k_factor1/2 may be left empty for the engine's K.
+struct RatingBatch {
+  std::span<int> rating1;
+  std::span<int> rating2;
+  std::span<double> deviation1;
+  std::span<double> deviation2;
+  std::span<double> volatility1;
+  std::span<double> volatility2;
+  std::span<const int> score1;
+  std::span<const int> score2;
+  std::span<const int> k_factor1 = {};
+  std::span<const int> k_factor2 = {};
+
+  size_t size() const { return rating1.size(); }
+  // Throws std::invalid_argument if the spans differ in length
+  void validate() const;
+};
+
+class RatingEngine {
+ public:
+  virtual ~RatingEngine() = default;
+
+  virtual RatingSystem system() const = 0;
+
+  // New state of both players after one match
+  virtual std::pair<Rating, Rating> rate(const Rating& player1, const Rating& player2,
+                                         int score1, int score2) const = 0;
+
+  // rate() over every match of the batch; same results as calling it per match
+  virtual void rateBatch(const RatingBatch& batch) const = 0;
+};
+
+class EloEngine : public RatingEngine {
+ public:
+  explicit EloEngine(EloCalculator calculator) : calculator_(calculator) {}
+
+  RatingSystem system() const override { return RatingSystem::kElo; }
+  std::pair<Rating, Rating> rate(const Rating& player1, const Rating& player2,
+                                 int score1, int score2) const override;
+  void rateBatch(const RatingBatch& batch) const override;
+
+ private:
+  EloCalculator calculator_;
+};
+
+// ELO where the winner's K is multiplied by ln(margin + 1), damped when the
+// favourite wins (the margin-of-victory multiplier used by FiveThirtyEight)
+// Draws use the plain K.
+class MarginEloEngine : public RatingEngine {
+ public:
+  MarginEloEngine(int k_factor, ExpectedScoreMode mode)
+      : k_factor_(k_factor), calculator_(k_factor, mode) {}
+
+  RatingSystem system() const override { return RatingSystem::kMarginElo; }
+  std::pair<Rating, Rating> rate(const Rating& player1, const Rating& player2,
+                                 int score1, int score2) const override;
+  void rateBatch(const RatingBatch& batch) const override;
+
+  // K multiplier for a match with the given ratings and scores
+  static double marginMultiplier(int rating1, int rating2, int score1, int score2);
+
+ private:
+  int k_factor_;
+  EloCalculator calculator_;
+};
+
+// Glicko-2 (Glickman, 2012) with every match treated as its own rating
+// period; tau constrains how fast volatility changes (0.3 - 1.2)
+class Glicko2Engine : public RatingEngine {
+ public:
+  explicit Glicko2Engine(double tau = 0.5) : tau_(tau) {}
+
+  RatingSystem system() const override { return RatingSystem::kGlicko2; }
+  std::pair<Rating, Rating> rate(const Rating& player1, const Rating& player2,
+                                 int score1, int score2) const override;
+  void rateBatch(const RatingBatch& batch) const override;
+
+ private:
+  // New state of `player` after scoring `score` (1, 0.5, 0) against `opponent`
+  Rating update(const Rating& player, const Rating& opponent, double score) const;
+
+  double tau_;
+};
+
+// One engine per rating system, shared by every group that uses it
+class RatingEngines {
+ public:
+  struct Options {
+    int k_factor = 32;
+    ExpectedScoreMode mode = ExpectedScoreMode::kExact;
+    double glicko_tau = 0.5;
+  };
+
+  explicit RatingEngines(const Options& options);
+  RatingEngines() : RatingEngines(Options{}) {}
+
+  const RatingEngine& get(RatingSystem system) const;
+
+ private:
+  std::array<std::unique_ptr<RatingEngine>, 3> engines_;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_RATING_ENGINE_H
@@ -5,6 +5,7 @@
 #include <chrono>
 #include <thread>
 #include <stdexcept>
+#include "observability/metrics.h"
 
 namespace utils {
 
@@ -23,6 +24,24 @@ struct RetryConfig {
   std::chrono::milliseconds max_delay{1000};
 };
 
+namespace detail {
+
+// Optimistic lock conflicts that were retried
+inline observability::Counter& optimisticLockRetries() {
+  static auto& counter = observability::MetricsRegistry::getInstance().counter(
+      "optimistic_lock_retries_total", "Optimistic lock conflicts retried by retryWithBackoff");
+  return counter;
+}
+
+// Calls that still conflicted after max_retries
+inline observability::Counter& optimisticLockFailures() {
+  static auto& counter = observability::MetricsRegistry::getInstance().counter(
+      "optimistic_lock_failures_total", "Optimistic lock conflicts that exhausted their retries");
+  return counter;
+}
+
+}  // namespace detail
+
 // Retry a callable with exponential backoff
 // The callable should throw OptimisticLockException on conflicts
 // Returns the result of the callable if successful
@@ -38,8 +57,10 @@ auto retryWithBackoff(Callable&& func, const RetryConfig& config = RetryConfig{}
     } catch (const OptimisticLockException& e) {
       if (attempt >= config.max_retries) {
         // Max retries exceeded, rethrow
+        detail::optimisticLockFailures().inc();
         throw;
       }
+      detail::optimisticLockRetries().inc();
       
       // Wait before retrying
       std::this_thread::sleep_for(delay);
@@ -0,0 +1,60 @@
+#ifndef UTILS_THREAD_POOL_H
+#define UTILS_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+// Fixed-size worker pool with a bounded task queue.
+// trySubmit() never blocks: when the queue is full it returns false so the
+// caller can shed load (e.g. answer 503) instead of stalling its own thread.
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+
+  ThreadPool(size_t num_threads, size_t max_queue_depth);
+  ~ThreadPool();
+
+  // Non-copyable, non-movable
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  // Queue a task for execution
+  // Returns false if the queue is full or the pool is shutting down
+  bool trySubmit(Task task);
+
+  // Stop accepting tasks, run everything already queued and join workers
+  void shutdown();
+
+  // Number of tasks waiting for a worker (excludes tasks being executed)
+  size_t getQueueDepth() const;
+
+  // Number of tasks currently being executed
+  size_t getBusyWorkers() const;
+
+  size_t getThreadCount() const;
+  size_t getMaxQueueDepth() const { return max_queue_depth_; }
+
+ private:
+  void workerLoop();
+
+  size_t max_queue_depth_;
+  std::vector<std::thread> workers_;
+  std::deque<Task> tasks_;
+  size_t busy_workers_ = 0;
+  bool stopping_ = false;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_THREAD_POOL_H
@@ -0,0 +1,60 @@
+#ifndef UTILS_TOKEN_BUCKET_H
+#define UTILS_TOKEN_BUCKET_H
+
+#include <algorithm>
+#include <chrono>
+
+namespace utils {
+
+// Classic token bucket: `rate` tokens per second, holding at most `burst`
+// Not thread-safe; callers hold their own lock.
+class TokenBucket {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  TokenBucket(double rate, double burst, Clock::time_point now = Clock::now())
+      : rate_(rate), burst_(std::max(burst, 1.0)), tokens_(burst_), updated_at_(now) {}
+
+  // When a token will be available (now if one already is)
+  Clock::time_point readyAt(Clock::time_point now) {
+    refill(now);
+    if (tokens_ >= 1.0) {
+      return now;
+    }
+    auto wait = std::chrono::duration<double>((1.0 - tokens_) / rate_);
+    return now + std::chrono::duration_cast<Clock::duration>(wait) + Clock::duration(1);
+  }
+
+  bool tryTake(Clock::time_point now) {
+    refill(now);
+    if (tokens_ < 1.0) {
+      return false;
+    }
+    tokens_ -= 1.0;
+    return true;
+  }
+
+  // True once the bucket has refilled completely (an idle bucket can be dropped)
+  bool full(Clock::time_point now) {
+    refill(now);
+    return tokens_ >= burst_;
+  }
+
+ private:
+  void refill(Clock::time_point now) {
+    if (now > updated_at_) {
+      double elapsed = std::chrono::duration<double>(now - updated_at_).count();
+      tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+      updated_at_ = now;
+    }
+  }
+
+  double rate_;
+  double burst_;
+  double tokens_;
+  Clock::time_point updated_at_;
+};
+
+}  // namespace utils
+
+#endif  // UTILS_TOKEN_BUCKET_H
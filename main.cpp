@@ -11,6 +11,7 @@
 #include "database/connection_pool.h"
 #include "bot/bot.h"
 #include "observability/logger.h"
+#include "repositories/entity_cache.h"
 #include "repositories/group_repository.h"
 #include "repositories/player_repository.h"
 #include "repositories/match_repository.h"
@@ -73,13 +74,13 @@ int main(int argc, char* argv[]) {
   try {
     // Initialize logger
     auto logger = observability::Logger::getInstance();
-    logger->info("Starting School Telegram Table Tennis Bot");
+    OBS_INFO(logger, "Starting School Telegram Table Tennis Bot");
     
     // Load configuration
     std::string config_path = findConfigFile();
     auto& config = config::Config::getInstance();
     config.load(config_path);
-    logger->info("Configuration loaded from: " + config_path);
+    OBS_INFO(logger, "Configuration loaded from: " + config_path);
     
     // Set log level from config
     std::string log_level_str = config.getString("observability.log_level", "INFO");
@@ -98,13 +99,16 @@ int main(int argc, char* argv[]) {
     db_config.max_size = config.getInt("database.connection_pool.max_size", 10);
     db_config.idle_timeout_seconds = config.getInt("database.connection_pool.idle_timeout_seconds", 300);
     db_config.max_lifetime_seconds = config.getInt("database.connection_pool.max_lifetime_seconds", 3600);
+    db_config.acquire_timeout_ms = config.getInt("database.connection_pool.acquire_timeout_ms", 5000);
+    db_config.maintenance_interval_seconds = config.getInt("database.connection_pool.maintenance_interval_seconds", 30);
+    db_config.validation_idle_seconds = config.getInt("database.connection_pool.validation_idle_seconds", 60);
     
     auto db_pool_unique = database::ConnectionPool::create(db_config);
-    logger->info("Database connection pool initialized");
+    OBS_INFO(logger, "Database connection pool initialized");
     
     // Health check
     if (!db_pool_unique->healthCheck()) {
-      logger->error("Database health check failed");
+      OBS_ERROR(logger, "Database health check failed");
       return 1;
     }
     
@@ -117,10 +121,18 @@ int main(int argc, char* argv[]) {
       throw std::runtime_error("TELEGRAM_BOT_TOKEN not set");
     }
     
-    // Create repositories
-    auto group_repo = std::make_unique<repositories::GroupRepository>(db_pool_shared);
-    auto player_repo = std::make_unique<repositories::PlayerRepository>(db_pool_shared);
-    auto match_repo = std::make_unique<repositories::MatchRepository>(db_pool_shared);
+    // Create repositories, sharing one entity cache
+    repositories::EntityCache::Config cache_config;
+    cache_config.capacity = config.getInt("database.cache.capacity", 4096);
+    cache_config.shards = config.getInt("database.cache.shards", 16);
+    auto entity_cache = std::make_shared<repositories::EntityCache>(cache_config);
+    
+    auto group_repo = std::make_unique<repositories::GroupRepository>(db_pool_shared, entity_cache);
+    auto player_repo = std::make_unique<repositories::PlayerRepository>(db_pool_shared, entity_cache);
+    auto match_repo = std::make_unique<repositories::MatchRepository>(db_pool_shared, entity_cache);
+    
+    size_t leaderboard_groups = group_repo->rebuildLeaderboard();
+    OBS_INFO(logger, "Leaderboard loaded for " + std::to_string(leaderboard_groups) + " groups");
     
     // Create School21 API client if configured
     std::unique_ptr<school21::ApiClient> school21_client = nullptr;
@@ -136,9 +148,9 @@ int main(int argc, char* argv[]) {
       school21_config.timeout_seconds = config.getInt("school21.timeout_seconds", 10);
       school21_config.max_retries = config.getInt("school21.max_retries", 3);
       school21_client = std::make_unique<school21::ApiClient>(school21_config);
-      logger->info("School21 API client initialized");
+      OBS_INFO(logger, "School21 API client initialized");
     } else {
-      logger->warn("School21 API credentials not provided, ID verification will be disabled");
+      OBS_WARN(logger, "School21 API credentials not provided, ID verification will be disabled");
     }
     
     // Initialize bot
@@ -147,7 +159,7 @@ int main(int argc, char* argv[]) {
     telegram_bot.setDependencies(db_pool_shared, std::move(group_repo), 
                                   std::move(player_repo), std::move(match_repo),
                                   std::move(school21_client));
-    logger->info("Telegram bot initialized");
+    OBS_INFO(logger, "Telegram bot initialized");
     
     // Start bot
     bool webhook_enabled = config.getBool("telegram.webhook.enabled", false);
@@ -187,17 +199,17 @@ int main(int argc, char* argv[]) {
       bool register_with_telegram = (registrar_str == "true" || registrar_str == "1");
       
       telegram_bot.startWebhook(webhook_url, port, secret_token, register_with_telegram);
-      logger->info("Bot started in webhook mode on port " + std::to_string(port) + 
-                   (register_with_telegram ? " (webhook registrar)" : " (webhook worker)"));
+      OBS_INFO(logger, "Bot started in webhook mode on port " + std::to_string(port) + 
+                      (register_with_telegram ? " (webhook registrar)" : " (webhook worker)"));
     } else if (polling_enabled) {
       telegram_bot.startPolling();
-      logger->info("Bot started in polling mode");
+      OBS_INFO(logger, "Bot started in polling mode");
     } else {
       throw std::runtime_error("Neither webhook nor polling enabled");
     }
     
     // Keep running
-    logger->info("Bot is running. Press Ctrl+C to stop.");
+    OBS_INFO(logger, "Bot is running. Press Ctrl+C to stop.");
     while (true) {
       std::this_thread::sleep_for(std::chrono::seconds(1));
     }
@@ -0,0 +1,6 @@
+-- Per-group K-factor policies (utils::KFactorPolicy)
+-- NULL keeps the global elo.k_factor. The policy is applied by the bot from
+-- the ratings it already reads, so it needs no column on group_players.
+
+ALTER TABLE groups
+    ADD COLUMN IF NOT EXISTS k_policy JSONB;
@@ -0,0 +1,6 @@
+-- player_verifications as the persistent tier of the /id lookup cache
+-- (school21::VerificationCache). Lookups go by nickname, case-insensitively,
+-- for rows that have not expired yet.
+
+CREATE INDEX IF NOT EXISTS idx_player_verifications_nickname_expires
+    ON player_verifications (lower(school_nickname), expires_at);
@@ -0,0 +1,138 @@
+-- Each match records the rating system it was rated with, so /undo replays
+-- every match with its own system after a group switches systems.
+-- Matches from before this migration get their group's current system, the
+-- best guess available.
+
+ALTER TABLE matches
+    ADD COLUMN IF NOT EXISTS rating_system VARCHAR(20);
+
+UPDATE matches m SET rating_system = g.rating_system
+FROM groups g
+WHERE m.group_id = g.id AND m.rating_system IS NULL;
+
+ALTER TABLE matches
+    ALTER COLUMN rating_system SET DEFAULT 'elo',
+    ALTER COLUMN rating_system SET NOT NULL;
+
+ALTER TABLE matches DROP CONSTRAINT IF EXISTS check_match_rating_system;
+ALTER TABLE matches
+    ADD CONSTRAINT check_match_rating_system CHECK (rating_system IN ('elo', 'glicko2', 'margin_elo'));
+
+-- register_match() gains the rating system of the match
+DROP FUNCTION IF EXISTS register_match(BIGINT, VARCHAR, BIGINT, BIGINT, INTEGER, INTEGER,
+                                       INTEGER, INTEGER, INTEGER, INTEGER, VARCHAR, BIGINT,
+                                       DOUBLE PRECISION, DOUBLE PRECISION,
+                                       DOUBLE PRECISION, DOUBLE PRECISION);
+
+CREATE OR REPLACE FUNCTION register_match(
+    p_telegram_group_id BIGINT,
+    p_group_name VARCHAR,
+    p_telegram_user1 BIGINT,
+    p_telegram_user2 BIGINT,
+    p_score1 INTEGER,
+    p_score2 INTEGER,
+    p_expected_version1 INTEGER,
+    p_expected_version2 INTEGER,
+    p_elo1_after INTEGER,
+    p_elo2_after INTEGER,
+    p_idempotency_key VARCHAR,
+    p_created_by BIGINT,
+    p_deviation1_after DOUBLE PRECISION,
+    p_deviation2_after DOUBLE PRECISION,
+    p_volatility1_after DOUBLE PRECISION,
+    p_volatility2_after DOUBLE PRECISION,
+    p_rating_system VARCHAR
+)
+RETURNS TABLE (
+    match_id BIGINT,
+    group_id BIGINT,
+    player1_id BIGINT,
+    player2_id BIGINT,
+    player1_elo_before INTEGER,
+    player2_elo_before INTEGER,
+    created_at TIMESTAMP WITH TIME ZONE
+)
+LANGUAGE plpgsql AS $$
+#variable_conflict use_column
+DECLARE
+    v_group_id BIGINT;
+    v_player1_id BIGINT;
+    v_player2_id BIGINT;
+    v_gp1 group_players%ROWTYPE;
+    v_gp2 group_players%ROWTYPE;
+    v_match_id BIGINT;
+    v_created_at TIMESTAMP WITH TIME ZONE;
+BEGIN
+    IF EXISTS (SELECT 1 FROM matches m WHERE m.idempotency_key = p_idempotency_key) THEN
+        RAISE EXCEPTION 'Match with this idempotency key already exists'
+            USING ERRCODE = 'unique_violation';
+    END IF;
+
+    v_group_id := ensure_group(p_telegram_group_id, p_group_name);
+    v_player1_id := ensure_player(p_telegram_user1);
+    v_player2_id := ensure_player(p_telegram_user2);
+
+    INSERT INTO group_players (group_id, player_id, current_elo, created_at, updated_at)
+    VALUES (v_group_id, v_player1_id, 1500, NOW(), NOW()),
+           (v_group_id, v_player2_id, 1500, NOW(), NOW())
+    ON CONFLICT (group_id, player_id) DO NOTHING;
+
+    -- Lock both rows in id order so concurrent registrations cannot deadlock
+    PERFORM 1
+    FROM group_players gp
+    WHERE gp.group_id = v_group_id AND gp.player_id IN (v_player1_id, v_player2_id)
+    ORDER BY gp.id
+    FOR UPDATE;
+
+    SELECT * INTO v_gp1 FROM group_players gp WHERE gp.group_id = v_group_id AND gp.player_id = v_player1_id;
+    SELECT * INTO v_gp2 FROM group_players gp WHERE gp.group_id = v_group_id AND gp.player_id = v_player2_id;
+
+    IF v_gp1.version IS DISTINCT FROM p_expected_version1
+       OR v_gp2.version IS DISTINCT FROM p_expected_version2 THEN
+        RAISE EXCEPTION 'Optimistic lock conflict for group % players % and %',
+            v_group_id, v_player1_id, v_player2_id
+            USING ERRCODE = 'TT001';
+    END IF;
+
+    UPDATE group_players SET
+        current_elo = p_elo1_after,
+        rating_deviation = p_deviation1_after,
+        rating_volatility = p_volatility1_after,
+        matches_played = matches_played + 1,
+        matches_won = matches_won + (p_score1 > p_score2)::INTEGER,
+        matches_lost = matches_lost + (p_score1 < p_score2)::INTEGER,
+        version = version + 1,
+        updated_at = NOW()
+    WHERE id = v_gp1.id;
+
+    UPDATE group_players SET
+        current_elo = p_elo2_after,
+        rating_deviation = p_deviation2_after,
+        rating_volatility = p_volatility2_after,
+        matches_played = matches_played + 1,
+        matches_won = matches_won + (p_score2 > p_score1)::INTEGER,
+        matches_lost = matches_lost + (p_score2 < p_score1)::INTEGER,
+        version = version + 1,
+        updated_at = NOW()
+    WHERE id = v_gp2.id;
+
+    INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score,
+                         player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after,
+                         idempotency_key, created_by_telegram_user_id, created_at, is_undone,
+                         rating_system)
+    VALUES (v_group_id, v_player1_id, v_player2_id, p_score1, p_score2,
+            v_gp1.current_elo, v_gp2.current_elo, p_elo1_after, p_elo2_after,
+            p_idempotency_key, p_created_by, NOW(), FALSE,
+            p_rating_system)
+    RETURNING id, created_at INTO v_match_id, v_created_at;
+
+    INSERT INTO elo_history (match_id, group_id, player_id, elo_before, elo_after, elo_change, created_at, is_undone)
+    VALUES (v_match_id, v_group_id, v_player1_id, v_gp1.current_elo, p_elo1_after,
+            p_elo1_after - v_gp1.current_elo, NOW(), FALSE),
+           (v_match_id, v_group_id, v_player2_id, v_gp2.current_elo, p_elo2_after,
+            p_elo2_after - v_gp2.current_elo, NOW(), FALSE);
+
+    RETURN QUERY SELECT v_match_id, v_group_id, v_player1_id, v_player2_id,
+                        v_gp1.current_elo, v_gp2.current_elo, v_created_at;
+END;
+$$;
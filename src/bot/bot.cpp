@@ -10,14 +10,22 @@
 #include <iomanip>
 
 #include "database/connection_pool.h"
+#include "database/prepared_statements.h"
 #include "database/transaction.h"
 #include "repositories/group_repository.h"
 #include "repositories/player_repository.h"
 #include "repositories/match_repository.h"
+#include "repositories/elo_replay_engine.h"
+#include "repositories/verification_repository.h"
 #include "school21/api_client.h"
-#include "utils/elo_calculator.h"
+#include "school21/verification_cache.h"
+#include "school21/verification_pool.h"
+#include "utils/k_factor_policy.h"
+#include "utils/rating_engine.h"
 #include "utils/retry.h"
 #include "observability/logger.h"
+#include "observability/metrics.h"
+#include "observability/tracing.h"
 #include "config/config.h"
 #include "models/group.h"
 #include "models/player.h"
@@ -30,6 +38,20 @@
 
 namespace bot {
 
+namespace {
+
+observability::Histogram& commandLatency(const std::string& command) {
+  return observability::MetricsRegistry::getInstance().histogram(
+      "bot_command_duration_seconds", "Command handler latency", {{"command", command}});
+}
+
+observability::Histogram& telegramLatency(const char* method) {
+  return observability::MetricsRegistry::getInstance().histogram(
+      "telegram_request_duration_seconds", "Telegram Bot API call latency", {{"method", method}});
+}
+
+}  // namespace
+
 Bot::Bot(const std::string& token) 
     : BotBase<Bot>(),
       ProductionBotApi(token),
@@ -39,15 +61,40 @@ Bot::Bot(const std::string& token)
 
 Bot::~Bot() {
   stop();
+  observability::Tracer::getInstance().shutdown();
 }
 
 void Bot::initialize() {
-  // Initialize ELO calculator with K-factor from config
   auto& config = config::Config::getInstance();
-  int k_factor = config.getInt("elo.k_factor", 32);
-  elo_calculator_ = std::make_unique<utils::EloCalculator>(k_factor);
-  
-  logger_->info("Bot initialized (dependencies must be set via setDependencies)");
+  logger_->setLevel(observability::logLevelFromString(
+      config.getString("observability.log_level", "INFO")));
+  
+  // What handlers do when the log writer falls behind
+  auto overflow = config.getString("observability.log_overflow", "drop");
+  auto policy = observability::OverflowPolicy::kDrop;
+  if (overflow == "block") {
+    policy = observability::OverflowPolicy::kBlock;
+  } else if (overflow == "sample") {
+    policy = observability::OverflowPolicy::kSample;
+  }
+  logger_->setOverflowPolicy(
+      policy, static_cast<size_t>(std::max(config.getInt("observability.log_sample_every", 100), 1)));
+  
+  // Spans go to the OTLP/HTTP receiver of the collector
+  observability::Tracer::Options trace_options;
+  trace_options.enabled = config.getBool("observability.trace_enabled", false);
+  trace_options.sampling_rate = config.getDouble("observability.trace_sampling_rate", trace_options.sampling_rate);
+  trace_options.endpoint = config.getString("observability.trace_endpoint", trace_options.endpoint);
+  trace_options.max_batch = static_cast<size_t>(
+      std::max(config.getInt("observability.trace_max_batch", static_cast<int>(trace_options.max_batch)), 1));
+  trace_options.export_interval = std::chrono::milliseconds(
+      config.getInt("observability.trace_export_interval_ms", static_cast<int>(trace_options.export_interval.count())));
+  observability::Tracer::getInstance().configure(std::move(trace_options));
+  
+  rating_engines_ = makeRatingEngines();
+  startOutboundSender();
+  
+  OBS_INFO(logger_, "Bot initialized (dependencies must be set via setDependencies)");
 }
 
 void Bot::setDependencies(
@@ -61,21 +108,78 @@ void Bot::setDependencies(
   player_repo_ = std::move(player_repo);
   match_repo_ = std::move(match_repo);
   school21_client_ = std::move(school21_client);
-  logger_->info("Bot dependencies set");
+  
+  // Known nicknames are answered from memory or player_verifications
+  auto& config = config::Config::getInstance();
+  if (school21_client_) {
+    school21::VerificationCache::Options cache_options;
+    cache_options.success_ttl = std::chrono::hours(
+        std::max(config.getInt("school21.verification.cache_ttl_success_hours", 24), 0));
+    cache_options.failure_ttl = std::chrono::hours(
+        std::max(config.getInt("school21.verification.cache_ttl_failure_hours", 1), 0));
+    std::shared_ptr<repositories::VerificationRepository> verification_repo;
+    if (db_pool_) {
+      verification_repo = std::make_shared<repositories::VerificationRepository>(db_pool_);
+    }
+    verification_cache_ = std::make_unique<school21::VerificationCache>(
+        cache_options, std::move(verification_repo));
+  }
+
+  // /id lookups run on their own event loop instead of the handler thread
+  if (school21_client_ && config.getBool("school21.verification.async", true)) {
+    school21::VerificationPool::Options options;
+    options.base_url = school21_client_->getConfig().base_url;
+    options.timeout_seconds = school21_client_->getConfig().timeout_seconds;
+    options.max_concurrent = static_cast<size_t>(
+        std::max(config.getInt("school21.verification.max_concurrent", 16), 1));
+    options.max_queue = static_cast<size_t>(
+        std::max(config.getInt("school21.verification.max_queue", 1000), 1));
+    auto* client = school21_client_.get();
+    verification_pool_ = std::make_unique<school21::VerificationPool>(
+        options, [client]() { return client->getAccessToken(); });
+  }
+  OBS_INFO(logger_, "Bot dependencies set");
 }
 
 void Bot::onCommand(const tgbotxx::Ptr<tgbotxx::Message>& command) {
+  int64_t chat_id = command && command->chat ? command->chat->id : 0;
+  dispatchForChat(chat_id, [this, command]() { routeCommand(command); });
+}
+
+void Bot::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& chatMember) {
+  int64_t chat_id = chatMember && chatMember->chat ? chatMember->chat->id : 0;
+  dispatchForChat(chat_id, [this, chatMember]() { routeChatMemberUpdate(chatMember); });
+}
+
+void Bot::onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+  int64_t chat_id = message && message->chat ? message->chat->id : 0;
+  dispatchForChat(chat_id, [this, message]() { routeAnyMessage(message); });
+}
+
+void Bot::routeCommand(const tgbotxx::Ptr<tgbotxx::Message>& command) {
+  auto started = std::chrono::steady_clock::now();
+  std::string handled;  // Labels the latency metric; stays empty for unknown commands
+  observability::ScopedSpan span("bot.command");
   try {
     if (!command) {
-      logger_->warn("onCommand called with null command");
+      OBS_WARN(logger_, "onCommand called with null command");
       return;
     }
+    span->setAttribute("telegram.message_id", command->messageId);
+    if (command->chat) {
+      span->setAttribute("telegram.group_id", command->chat->id);
+    }
+    if (command->from) {
+      span->setAttribute("telegram.user_id", command->from->id);
+    }
     
-    logger_->info("Command received: " + (command->text.empty() ? "empty" : command->text));
+    OBS_INFO(logger_, "Command received: " + (command->text.empty() ? "empty" : command->text));
     
     std::string cmd = extractCommandName(command);
-    logger_->info("Extracted command: " + (cmd.empty() ? "empty" : cmd));
+    OBS_INFO(logger_, "Extracted command: " + (cmd.empty() ? "empty" : cmd));
     
+    handled = cmd;
+    span->setAttribute("command.type", cmd);
     if (cmd == "start") {
       handleStart(command);
     } else if (cmd == "match") {
@@ -90,17 +194,26 @@ void Bot::onCommand(const tgbotxx::Ptr<tgbotxx::Message>& command) {
       handleUndo(command);
     } else if (cmd == "config_topic") {
       handleConfigTopic(command);
+    } else if (cmd == "rating_system") {
+      handleRatingSystem(command);
+    } else if (cmd == "k_policy") {
+      handleKPolicy(command);
     } else if (cmd == "help") {
       handleHelp(command);
     } else {
-      logger_->info("Unknown command: " + cmd);
+      OBS_INFO(logger_, "Unknown command: " + cmd);
+      handled.clear();
     }
   } catch (const std::exception& e) {
-    logger_->error("Error in onCommand: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in onCommand: " + std::string(e.what()));
+    span->setError(e.what());
+  }
+  if (!handled.empty()) {
+    commandLatency(handled).observe(std::chrono::steady_clock::now() - started);
   }
 }
 
-void Bot::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& chatMember) {
+void Bot::routeChatMemberUpdate(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& chatMember) {
   try {
     if (!chatMember || !chatMember->chat || !chatMember->newChatMember) {
       return;
@@ -110,9 +223,9 @@ void Bot::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& ch
     int64_t user_id = chatMember->from ? chatMember->from->id : 0;
     std::string status = chatMember->newChatMember->status;
     
-    logger_->info("Chat member update: chat_id=" + std::to_string(chat_id) + 
-                  ", user_id=" + std::to_string(user_id) + 
-                  ", status=" + status);
+    OBS_INFO(logger_, "Chat member update: chat_id=" + std::to_string(chat_id) + 
+                      ", user_id=" + std::to_string(user_id) + 
+                      ", status=" + status);
     
     // Check if bot was removed
     // TODO: Get bot's own user ID from tgbotxx API
@@ -132,11 +245,11 @@ void Bot::onChatMemberUpdated(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& ch
       handleMemberLeave(chatMember);
     }
   } catch (const std::exception& e) {
-    logger_->error("Error handling chat member update: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling chat member update: " + std::string(e.what()));
   }
 }
 
-void Bot::onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+void Bot::routeAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message) {
   try {
     if (!message) return;
     
@@ -146,18 +259,18 @@ void Bot::onAnyMessage(const tgbotxx::Ptr<tgbotxx::Message>& message) {
       // This is a command - extract and handle it
       std::string cmd = extractCommandName(message);
       if (!cmd.empty()) {
-        logger_->info("Command detected in onAnyMessage: " + cmd);
-        // Route to command handler
-        onCommand(message);
+        OBS_INFO(logger_, "Command detected in onAnyMessage: " + cmd);
+        // Route to command handler (already on this chat's lane)
+        routeCommand(message);
         return;
       }
     }
     
     // Command-only mode: ignore non-command messages
-    logger_->debug("Message received (not a command): " + 
-                  (message->text.empty() ? "empty" : message->text.substr(0, 50)));
+    OBS_DEBUG(logger_, "Message received (not a command): " + 
+                      (message->text.empty() ? "empty" : message->text.substr(0, 50)));
   } catch (const std::exception& e) {
-    logger_->error("Error in onAnyMessage: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error in onAnyMessage: " + std::string(e.what()));
   }
 }
 
@@ -189,22 +302,23 @@ void Bot::startPolling() {
   if (!logger_) logger_ = observability::Logger::getInstance().get();
   
   if (running_) {
-    logger_->warn("Bot is already running, skipping startPolling");
+    OBS_WARN(logger_, "Bot is already running, skipping startPolling");
     return;
   }
   
-  logger_->info("Starting polling mode...");
+  OBS_INFO(logger_, "Starting polling mode...");
+  startDispatcher();
   running_ = true;
   mode_ = BotMode::Polling;
   
   try {
-    logger_->info("Calling tgbotxx::Bot::start() to begin polling");
+    OBS_INFO(logger_, "Calling tgbotxx::Bot::start() to begin polling");
     start();  // tgbotxx::Bot::start() starts polling (this blocks)
-    logger_->info("tgbotxx::Bot::start() returned (polling started)");
+    OBS_INFO(logger_, "tgbotxx::Bot::start() returned (polling started)");
   } catch (const std::exception& e) {
     running_ = false;
     mode_ = BotMode::None;
-    logger_->error("Failed to start polling: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Failed to start polling: " + std::string(e.what()));
     throw std::runtime_error("Failed to start polling: " + 
                              std::string(e.what()));
   }
@@ -249,9 +363,9 @@ void Bot::startWebhook(const std::string& webhook_url, int port, const std::stri
         throw std::runtime_error("Failed to register webhook with Telegram");
       }
       
-      logger_->info("Webhook registered with Telegram: " + webhook_url);
+      OBS_INFO(logger_, "Webhook registered with Telegram: " + webhook_url);
     } else {
-      logger_->info("Webhook server started (not registering with Telegram - worker instance)");
+      OBS_INFO(logger_, "Webhook server started (not registering with Telegram - worker instance)");
     }
     
   } catch (const std::exception& e) {
@@ -270,15 +384,23 @@ void Bot::stop() {
   if (mode_ == BotMode::Webhook) {
     try {
       deleteWebhook(false);
-      logger_->info("Webhook deleted from Telegram");
+      OBS_INFO(logger_, "Webhook deleted from Telegram");
     } catch (const std::exception& e) {
-      logger_->warn("Failed to delete webhook: " + std::string(e.what()));
+      OBS_WARN(logger_, "Failed to delete webhook: " + std::string(e.what()));
     }
   }
   
   // Call BotBase::stop() which handles webhook server cleanup
   BotBase<Bot>::stop();
   
+  // Handlers are done; finish their lookups, then flush their replies
+  if (verification_pool_) {
+    verification_pool_->shutdown();
+  }
+  if (outbound_sender_) {
+    outbound_sender_->shutdown();
+  }
+  
   // For polling mode, also stop tgbotxx::Bot
   if (mode_ == BotMode::Polling) {
     tgbotxx::Bot::stop();
@@ -296,8 +418,8 @@ void Bot::handleMemberJoin(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& updat
     int64_t user_id = update->from->id;
     int64_t chat_id = update->chat->id;
     
-    logger_->info("Member joined: user_id=" + std::to_string(user_id) + 
-                  ", chat_id=" + std::to_string(chat_id));
+    OBS_INFO(logger_, "Member joined: user_id=" + std::to_string(user_id) + 
+                      ", chat_id=" + std::to_string(chat_id));
     
     // Log member join - no automatic action per ADR-011
     // Users register themselves via /id or /id_guest commands
@@ -307,7 +429,7 @@ void Bot::handleMemberJoin(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& updat
         ("User " + std::to_string(update->from->id)) : update->from->username;
     sendToLogsTopic(chat_id, "👋 " + username + " joined the group. Welcome!");
   } catch (const std::exception& e) {
-    logger_->error("Error handling member join: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling member join: " + std::string(e.what()));
   }
 }
 
@@ -317,16 +439,16 @@ void Bot::handleMemberLeave(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& upda
     
     int64_t user_id = update->from->id;
     
-    logger_->info("Member left: user_id=" + std::to_string(user_id));
+    OBS_INFO(logger_, "Member left: user_id=" + std::to_string(user_id));
     
     // Get player and soft delete
     auto player = player_repo_->getByTelegramId(user_id);
     if (player) {
       player_repo_->softDelete(player->id);
-      logger_->info("Player soft deleted: player_id=" + std::to_string(player->id));
+      OBS_INFO(logger_, "Player soft deleted: player_id=" + std::to_string(player->id));
     }
   } catch (const std::exception& e) {
-    logger_->error("Error handling member leave: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling member leave: " + std::string(e.what()));
   }
 }
 
@@ -336,16 +458,14 @@ void Bot::handleBotRemoval(const tgbotxx::Ptr<tgbotxx::ChatMemberUpdated>& updat
     
     int64_t chat_id = update->chat->id;
     
-    logger_->warn("Bot removed from group: chat_id=" + std::to_string(chat_id));
+    OBS_WARN(logger_, "Bot removed from group: chat_id=" + std::to_string(chat_id));
     
     // Mark group as inactive
-    auto group = group_repo_->getByTelegramId(chat_id);
-    if (group) {
-      // TODO: Update group.is_active = false when repository supports it
-      logger_->info("Group marked as inactive: group_id=" + std::to_string(group->id));
+    if (group_repo_->setActive(chat_id, false)) {
+      OBS_INFO(logger_, "Group marked as inactive: chat_id=" + std::to_string(chat_id));
     }
   } catch (const std::exception& e) {
-    logger_->error("Error handling bot removal: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling bot removal: " + std::string(e.what()));
   }
 }
 
@@ -356,17 +476,18 @@ void Bot::handleGroupMigration(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     int64_t old_chat_id = message->migrateFromChatId;
     int64_t new_chat_id = message->chat->id;
     
-    logger_->info("Group migration: old_chat_id=" + std::to_string(old_chat_id) + 
-                  ", new_chat_id=" + std::to_string(new_chat_id));
+    OBS_INFO(logger_, "Group migration: old_chat_id=" + std::to_string(old_chat_id) + 
+                      ", new_chat_id=" + std::to_string(new_chat_id));
     
     // Update group telegram_group_id
-    auto group = group_repo_->getByTelegramId(old_chat_id);
-    if (group) {
-      // TODO: Update group.telegram_group_id when repository supports it
-      logger_->info("Group migrated: group_id=" + std::to_string(group->id));
+    if (group_repo_->migrateTelegramId(old_chat_id, new_chat_id)) {
+      OBS_INFO(logger_, "Group migrated: new_chat_id=" + std::to_string(new_chat_id));
+    } else {
+      OBS_WARN(logger_, "Group not migrated (no group for old chat or new chat already registered): old_chat_id=" +
+                        std::to_string(old_chat_id));
     }
   } catch (const std::exception& e) {
-    logger_->error("Error handling group migration: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling group migration: " + std::string(e.what()));
   }
 }
 
@@ -385,13 +506,15 @@ void Bot::handleStart(const tgbotxx::Ptr<tgbotxx::Message>& message) {
         "/id_guest - Register as guest player\n"
         "/undo - Undo last match (with reply) or last match\n"
         "/config_topic <topic_type> - Configure topic (admin only)\n"
+        "/rating_system [elo|glicko2|margin_elo] - Show or set the rating system (admin only)\n"
+        "/k_policy [json|reset] - Show or set the K-factor policy (admin only)\n"
         "/help - Show this help message\n\n"
         "For command-specific help, use: /<command> help";
     
     auto topic_id = getTopicId(message);
     sendMessage(message->chat->id, help_text, std::nullopt, topic_id);
   } catch (const std::exception& e) {
-    logger_->error("Error handling start command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling start command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to process command");
   }
 }
@@ -426,24 +549,8 @@ void Bot::handleMatch(const tgbotxx::Ptr<tgbotxx::Message>& message) {
       return;
     }
     
-    // Get or create group
     std::string group_name = message->chat->title.empty() ? "" : message->chat->title;
-    auto group = getOrCreateGroup(message->chat->id, group_name);
-    
-    // Get or create players
-    auto player1 = getOrCreatePlayer(parsed.player1_user_id);
-    auto player2 = getOrCreatePlayer(parsed.player2_user_id);
-    
-    // Get or create group players (ensure they exist in the group)
-    getOrCreateGroupPlayer(group.id, player1.id);
-    getOrCreateGroupPlayer(group.id, player2.id);
-    
-    // Check for duplicate
     std::string idempotency_key = generateIdempotencyKey(message);
-    if (isDuplicateMatch(idempotency_key)) {
-      sendErrorMessage(message, "This match was already registered");
-      return;
-    }
     
     // Use retry logic with exponential backoff for optimistic locking
     utils::RetryConfig retry_config;
@@ -451,202 +558,75 @@ void Bot::handleMatch(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     retry_config.initial_delay = std::chrono::milliseconds(100);
     retry_config.backoff_multiplier = 2.0;
     
-    int elo1_before = 0;
-    int elo2_before = 0;
-    int elo1_after = 0;
-    int elo2_after = 0;
-    int elo1_change = 0;
-    int elo2_change = 0;
+    // Groups seen for the first time rate with ELO and the global K
+    auto system = utils::RatingSystem::kElo;
+    std::optional<std::string> k_policy;
+    if (auto group = group_repo_->getByTelegramId(message->chat->id)) {
+      system = utils::parseRatingSystem(group->rating_system).value_or(utils::RatingSystem::kElo);
+      k_policy = group->k_policy;
+    }
+    const auto& engine = rating_engines_->get(system);
+    const auto policy = kFactorPolicy(k_policy);
+    
+    // Read both ratings without locking, compute the new ratings, then let
+    // register_match() create any missing group/player rows and write the
+    // match in one round trip. A concurrent update of either player is
+    // reported as an optimistic lock conflict and retried.
     models::Match created_match;
+    try {
+      created_match = utils::retryWithBackoff([&]() {
+        auto [rating1, rating2] = match_repo_->getRatings(
+            message->chat->id, parsed.player1_user_id, parsed.player2_user_id);
+        // matches_played comes with the ratings, so the policy needs no extra query
+        utils::Rating player1{rating1.current_elo, rating1.rating_deviation, rating1.rating_volatility,
+                              policy.kFor(rating1.current_elo, rating1.matches_played,
+                                          parsed.score1, parsed.score2, system)};
+        utils::Rating player2{rating2.current_elo, rating2.rating_deviation, rating2.rating_volatility,
+                              policy.kFor(rating2.current_elo, rating2.matches_played,
+                                          parsed.score1, parsed.score2, system)};
+        auto [new1, new2] = engine.rate(player1, player2, parsed.score1, parsed.score2);
+        
+        models::MatchRegistration registration;
+        registration.telegram_group_id = message->chat->id;
+        registration.group_name = group_name;
+        registration.player1_telegram_user_id = parsed.player1_user_id;
+        registration.player2_telegram_user_id = parsed.player2_user_id;
+        registration.player1_score = parsed.score1;
+        registration.player2_score = parsed.score2;
+        registration.player1_before = rating1;
+        registration.player2_before = rating2;
+        registration.player1_elo_after = new1.rating;
+        registration.player2_elo_after = new2.rating;
+        registration.player1_deviation_after = new1.deviation;
+        registration.player2_deviation_after = new2.deviation;
+        registration.player1_volatility_after = new1.volatility;
+        registration.player2_volatility_after = new2.volatility;
+        registration.rating_system = std::string(utils::toString(system));
+        registration.player1_k_factor = player1.k_factor;
+        registration.player2_k_factor = player2.k_factor;
+        registration.idempotency_key = idempotency_key;
+        registration.created_by_telegram_user_id = message->from ? message->from->id : 0;
+        return match_repo_->registerMatch(registration);
+      }, retry_config);
+    } catch (const repositories::DuplicateMatchException&) {
+      sendErrorMessage(message, "This match was already registered");
+      return;
+    }
     
-    utils::retryWithBackoff([&]() {
-      // Start transaction
-      database::Transaction txn(db_pool_);
-      auto& work = txn.get();
-      
-      // 1. Check idempotency key (SELECT in transaction)
-      auto idempotency_result = work.exec_params(
-        "SELECT id FROM matches WHERE idempotency_key = $1",
-        idempotency_key
-      );
-      if (!idempotency_result.empty()) {
-        throw std::runtime_error("Match with this idempotency key already exists");
-      }
-      
-      // 2. Read current ELO and version for both players (SELECT ... FOR UPDATE)
-      auto gp1_result = work.exec_params(
-        "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
-        "FROM group_players "
-        "WHERE group_id = $1 AND player_id = $2 FOR UPDATE",
-        group.id, player1.id
-      );
-      if (gp1_result.empty()) {
-        throw std::runtime_error("Group player 1 not found");
-      }
-      
-      auto gp2_result = work.exec_params(
-        "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
-        "FROM group_players "
-        "WHERE group_id = $1 AND player_id = $2 FOR UPDATE",
-        group.id, player2.id
-      );
-      if (gp2_result.empty()) {
-        throw std::runtime_error("Group player 2 not found");
-      }
-      
-      // Extract current state
-      int64_t gp1_id = gp1_result[0]["id"].as<int64_t>();
-      int gp1_current_elo = gp1_result[0]["current_elo"].as<int>();
-      int gp1_matches_played = gp1_result[0]["matches_played"].as<int>();
-      int gp1_matches_won = gp1_result[0]["matches_won"].as<int>();
-      int gp1_matches_lost = gp1_result[0]["matches_lost"].as<int>();
-      int gp1_version = gp1_result[0]["version"].as<int>();
-      
-      int64_t gp2_id = gp2_result[0]["id"].as<int64_t>();
-      int gp2_current_elo = gp2_result[0]["current_elo"].as<int>();
-      int gp2_matches_played = gp2_result[0]["matches_played"].as<int>();
-      int gp2_matches_won = gp2_result[0]["matches_won"].as<int>();
-      int gp2_matches_lost = gp2_result[0]["matches_lost"].as<int>();
-      int gp2_version = gp2_result[0]["version"].as<int>();
-      
-      // 3. Calculate new ELO values
-      auto [new_elo1, new_elo2] = elo_calculator_->calculate(
-          gp1_current_elo, gp2_current_elo, parsed.score1, parsed.score2);
-      
-      elo1_before = gp1_current_elo;
-      elo2_before = gp2_current_elo;
-      elo1_after = new_elo1;
-      elo2_after = new_elo2;
-      elo1_change = elo1_after - elo1_before;
-      elo2_change = elo2_after - elo2_before;
-      
-      // 4. Update player1 ELO with optimistic locking
-      int gp1_new_matches_played = gp1_matches_played + 1;
-      int gp1_new_matches_won = gp1_matches_won;
-      int gp1_new_matches_lost = gp1_matches_lost;
-      if (parsed.score1 > parsed.score2) {
-        gp1_new_matches_won++;
-      } else if (parsed.score1 < parsed.score2) {
-        gp1_new_matches_lost++;
-      }
-      
-      auto update1_result = work.exec_params(
-        "UPDATE group_players SET "
-        "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-        "version = version + 1, updated_at = NOW() "
-        "WHERE id = $5 AND version = $6",
-        elo1_after, gp1_new_matches_played, gp1_new_matches_won, gp1_new_matches_lost,
-        gp1_id, gp1_version
-      );
-      
-      if (update1_result.affected_rows() == 0) {
-        throw utils::OptimisticLockException("Optimistic lock conflict for player 1");
-      }
-      
-      // 5. Update player2 ELO with optimistic locking
-      int gp2_new_matches_played = gp2_matches_played + 1;
-      int gp2_new_matches_won = gp2_matches_won;
-      int gp2_new_matches_lost = gp2_matches_lost;
-      if (parsed.score2 > parsed.score1) {
-        gp2_new_matches_won++;
-      } else if (parsed.score2 < parsed.score1) {
-        gp2_new_matches_lost++;
-      }
-      
-      auto update2_result = work.exec_params(
-        "UPDATE group_players SET "
-        "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-        "version = version + 1, updated_at = NOW() "
-        "WHERE id = $5 AND version = $6",
-        elo2_after, gp2_new_matches_played, gp2_new_matches_won, gp2_new_matches_lost,
-        gp2_id, gp2_version
-      );
-      
-      if (update2_result.affected_rows() == 0) {
-        throw utils::OptimisticLockException("Optimistic lock conflict for player 2");
-      }
-      
-      // 6. Insert match record
-      auto match_result = work.exec_params(
-        "INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score, "
-        "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-        "idempotency_key, created_by_telegram_user_id, created_at, is_undone) "
-        "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), FALSE) "
-        "RETURNING id, created_at",
-        group.id, player1.id, player2.id, parsed.score1, parsed.score2,
-        elo1_before, elo2_before, elo1_after, elo2_after,
-        idempotency_key, message->from ? message->from->id : 0
-      );
-      
-      if (match_result.empty()) {
-        throw std::runtime_error("Failed to create match");
-      }
-      
-      created_match.id = match_result[0]["id"].as<int64_t>();
-      created_match.group_id = group.id;
-      created_match.player1_id = player1.id;
-      created_match.player2_id = player2.id;
-      created_match.player1_score = parsed.score1;
-      created_match.player2_score = parsed.score2;
-      created_match.player1_elo_before = elo1_before;
-      created_match.player2_elo_before = elo2_before;
-      created_match.player1_elo_after = elo1_after;
-      created_match.player2_elo_after = elo2_after;
-      created_match.idempotency_key = idempotency_key;
-      created_match.created_by_telegram_user_id = message->from ? message->from->id : 0;
-      created_match.is_undone = false;
-      
-      // Parse created_at timestamp
-      auto created_at_str = match_result[0]["created_at"].as<std::string>();
-      std::tm tm = {};
-      std::istringstream ss(created_at_str);
-      ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-      if (ss.fail()) {
-        ss.clear();
-        ss.str(created_at_str);
-        ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
-      }
-      if (!ss.fail()) {
-        created_match.created_at = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-      } else {
-        created_match.created_at = std::chrono::system_clock::now();
-      }
-      
-      // 7. Insert elo_history records (2 rows)
-      work.exec_params(
-        "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-        "elo_after, elo_change, created_at, is_undone) "
-        "VALUES ($1, $2, $3, $4, $5, $6, NOW(), FALSE)",
-        created_match.id, group.id, player1.id, elo1_before, elo1_after, elo1_change
-      );
-      
-      work.exec_params(
-        "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-        "elo_after, elo_change, created_at, is_undone) "
-        "VALUES ($1, $2, $3, $4, $5, $6, NOW(), FALSE)",
-        created_match.id, group.id, player2.id, elo2_before, elo2_after, elo2_change
-      );
-      
-      // Commit transaction
-      txn.commit();
-    }, retry_config);
+    int elo1_change = created_match.player1_elo_after - created_match.player1_elo_before;
+    int elo2_change = created_match.player2_elo_after - created_match.player2_elo_before;
     
     // Send success message
     std::string player1_username = "player1";
-    std::string player2_username = "player2";
     
-    // Try to get usernames from message entities or database
+    // Try to get usernames from message entities
     if (message->from) {
       player1_username = message->from->username.empty() ? 
           ("player" + std::to_string(parsed.player1_user_id)) : message->from->username;
     }
     
-    // Get player2 username from database if available
-    auto p2 = player_repo_->getByTelegramId(parsed.player2_user_id);
-    if (p2) {
-      // We don't store username in database, so use user ID
-      player2_username = "player" + std::to_string(parsed.player2_user_id);
-    }
+    // We don't store usernames in the database, so use the user ID
+    std::string player2_username = "player" + std::to_string(parsed.player2_user_id);
     
     std::ostringstream response;
     response << "Match registered: @" << player1_username << " (" << parsed.score1 
@@ -661,7 +641,7 @@ void Bot::handleMatch(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     sendMessage(message->chat->id, response.str(), message->messageId, topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling match command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling match command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to register match");
   }
 }
@@ -674,8 +654,9 @@ void Bot::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& message) {
       auto topic_id = getTopicId(message);
       sendMessage(message->chat->id,
                   "Ranking command:\n"
-                  "/ranking or /rank\n\n"
-                  "Shows current ELO rankings for this group.",
+                  "/ranking or /rank\n"
+                  "/ranking me\n\n"
+                  "Shows current ELO rankings for this group, or your position and the players around you.",
                   message->messageId, topic_id);
       return;
     }
@@ -689,8 +670,32 @@ void Bot::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     // Get group
     auto group = getOrCreateGroup(message->chat->id);
     
+    // Own position: "/ranking me"
+    if (args == "me") {
+      auto player = message->from ? player_repo_->getByTelegramId(message->from->id) : std::nullopt;
+      auto around = player ? group_repo_->getPlayersAround(group.id, player->id, 2)
+                           : std::vector<repositories::Leaderboard::Entry>{};
+      auto topic_id = getTopicId(message);
+      if (around.empty()) {
+        sendMessage(message->chat->id, "You have no ranking in this group yet.", message->messageId, topic_id);
+        return;
+      }
+      std::ostringstream response;
+      for (const auto& entry : around) {
+        if (entry.player_id == player->id) {
+          response << "Your rank: " << entry.rank << " - " << entry.elo << " ELO\n\n";
+        }
+      }
+      for (const auto& entry : around) {
+        response << entry.rank << ". Player " << entry.player_id << " - " << entry.elo << " ELO"
+                 << (entry.player_id == player->id ? " (you)" : "") << "\n";
+      }
+      sendMessage(message->chat->id, response.str(), message->messageId, topic_id);
+      return;
+    }
+    
     // Get rankings
-    auto rankings = group_repo_->getRankings(group.id, 10);
+    auto rankings = group_repo_->getLeaderboard(group.id, 10);
     
     if (rankings.empty()) {
       auto topic_id = getTopicId(message);
@@ -701,19 +706,17 @@ void Bot::handleRanking(const tgbotxx::Ptr<tgbotxx::Message>& message) {
     // Format rankings
     std::ostringstream response;
     response << "Current Rankings:\n";
-    int rank = 1;
-    for (const auto& gp : rankings) {
+    for (const auto& entry : rankings) {
       // TODO: Get player username from database
-      response << rank << ". Player " << gp.player_id 
-               << " - " << gp.current_elo << " ELO\n";
-      rank++;
+      response << entry.rank << ". Player " << entry.player_id 
+               << " - " << entry.elo << " ELO\n";
     }
     
     auto topic_id = getTopicId(message);
     sendMessage(message->chat->id, response.str(), message->messageId, topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling ranking command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ranking command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to get rankings");
   }
 }
@@ -770,18 +773,55 @@ void Bot::handleId(const tgbotxx::Ptr<tgbotxx::Message>& message) {
       return;
     }
     
-    auto participant = school21_client_->getParticipant(nickname);
+    if (verification_cache_) {
+      if (auto cached = verification_cache_->get(nickname)) {
+        completeIdVerification(message, nickname, *cached, true);
+        return;
+      }
+    }
+    
+    // The 🤔 reaction is the immediate reply; the pool finishes the command
+    if (verification_pool_ &&
+        verification_pool_->submit(nickname, [this, message, nickname](school21::Lookup lookup) {
+          completeIdVerification(message, nickname, lookup, false);
+        })) {
+      return;
+    }
+    
+    // getParticipant() doesn't tell a 404 from a failure, so a miss isn't cached
+    school21::Lookup lookup;
+    lookup.participant = school21_client_->getParticipant(nickname);
+    if (lookup.participant) {
+      lookup.status = school21::LookupStatus::kFound;
+    }
+    completeIdVerification(message, nickname, lookup, false);
     
-    if (!participant) {
+  } catch (const std::exception& e) {
+    OBS_ERROR(logger_, "Error handling ID command: " + std::string(e.what()));
+    reactToMessage(message->chat->id, message->messageId, "👎");
+    sendErrorMessage(message, "Failed to verify nickname");
+  }
+}
+
+void Bot::completeIdVerification(const tgbotxx::Ptr<tgbotxx::Message>& message,
+                                 const std::string& nickname,
+                                 const school21::Lookup& lookup, bool cached) {
+  try {
+    auto player = getOrCreatePlayer(message->from->id);
+    if (!cached && verification_cache_ && lookup.status != school21::LookupStatus::kError) {
+      auto group = getOrCreateGroup(message->chat->id);
+      verification_cache_->put(nickname, lookup, player.id, group.id, message->messageId);
+    }
+    
+    if (lookup.status != school21::LookupStatus::kFound || !lookup.participant) {
       reactToMessage(message->chat->id, message->messageId, "👎");
       sendErrorMessage(message, "Nickname not found in School21 system");
       return;
     }
     
     // Update player
-    auto player = getOrCreatePlayer(message->from->id);
     player.school_nickname = nickname;
-    player.is_verified_student = (participant->status == "ACTIVE");
+    player.is_verified_student = (lookup.participant->status == "ACTIVE");
     player_repo_->update(player);
     
     // Add success emoji and remove loading
@@ -794,7 +834,7 @@ void Bot::handleId(const tgbotxx::Ptr<tgbotxx::Message>& message) {
                 message->messageId, topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling ID command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ID command: " + std::string(e.what()));
     reactToMessage(message->chat->id, message->messageId, "👎");
     sendErrorMessage(message, "Failed to verify nickname");
   }
@@ -842,7 +882,7 @@ void Bot::handleIdGuest(const tgbotxx::Ptr<tgbotxx::Message>& message) {
                 message->messageId, topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling ID guest command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling ID guest command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to register as guest");
   }
 }
@@ -903,7 +943,7 @@ void Bot::handleUndo(const tgbotxx::Ptr<tgbotxx::Message>& message) {
                 message->messageId, topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling undo command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling undo command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to undo match");
   }
 }
@@ -970,11 +1010,126 @@ void Bot::handleConfigTopic(const tgbotxx::Ptr<tgbotxx::Message>& message) {
                 message->messageId, reply_topic_id);
     
   } catch (const std::exception& e) {
-    logger_->error("Error handling config topic command: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error handling config topic command: " + std::string(e.what()));
     sendErrorMessage(message, "Failed to configure topic");
   }
 }
 
+void Bot::handleRatingSystem(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+  try {
+    std::string args = extractCommandArgs(message);
+    args.erase(0, args.find_first_not_of(" \t"));
+    args.erase(args.find_last_not_of(" \t") + 1);
+    
+    auto topic_id = getTopicId(message);
+    if (args == "help" || args.find("help") == 0) {
+      sendMessage(message->chat->id,
+                  "Rating system command:\n"
+                  "/rating_system [system]\n\n"
+                  "Without an argument, shows how this group's ratings are computed.\n"
+                  "Only group admins can change it.\n\n"
+                  "Systems:\n"
+                  "- elo: classic ELO with a fixed K-factor\n"
+                  "- glicko2: Glicko-2, also tracks rating deviation and volatility\n"
+                  "- margin_elo: ELO where the score margin scales the rating change\n\n"
+                  "Existing ratings are kept; the new system applies from the next match.",
+                  message->messageId, topic_id);
+      return;
+    }
+    
+    if (args.empty()) {
+      auto group = getOrCreateGroup(message->chat->id);
+      sendMessage(message->chat->id, "Rating system: " + group.rating_system,
+                  message->messageId, topic_id);
+      return;
+    }
+    
+    if (!isAdmin(message)) {
+      sendErrorMessage(message, "Only group admins can change the rating system");
+      return;
+    }
+    
+    if (!utils::parseRatingSystem(args)) {
+      sendErrorMessage(message, "Invalid rating system. Use: elo, glicko2, or margin_elo");
+      return;
+    }
+    
+    getOrCreateGroup(message->chat->id);
+    group_repo_->setRatingSystem(message->chat->id, args);
+    
+    sendMessage(message->chat->id,
+                "Rating system set to " + args + ". Existing ratings are kept.",
+                message->messageId, topic_id);
+    
+  } catch (const std::exception& e) {
+    OBS_ERROR(logger_, "Error handling rating system command: " + std::string(e.what()));
+    sendErrorMessage(message, "Failed to change the rating system");
+  }
+}
+
+void Bot::handleKPolicy(const tgbotxx::Ptr<tgbotxx::Message>& message) {
+  try {
+    std::string args = extractCommandArgs(message);
+    args.erase(0, args.find_first_not_of(" \t"));
+    args.erase(args.find_last_not_of(" \t") + 1);
+    
+    auto topic_id = getTopicId(message);
+    if (args == "help") {
+      sendMessage(message->chat->id,
+                  "K-factor policy command:\n"
+                  "/k_policy [json|reset]\n\n"
+                  "Without an argument, shows how this group picks each player's K-factor.\n"
+                  "Only group admins can change it. Fields left out keep their defaults:\n"
+                  "- k_factor: K for everyone else\n"
+                  "- provisional_matches, provisional_k_factor: K for players with fewer matches\n"
+                  "- bands: [{\"min_rating\": 2000, \"k_factor\": 16}], the highest matching band wins\n"
+                  "- margin_weight: K grows by 1 + weight * ln(score margin); ignored under margin_elo\n\n"
+                  "Example: /k_policy {\"provisional_matches\": 10, \"provisional_k_factor\": 40}\n"
+                  "/k_policy reset goes back to the default K-factor.",
+                  message->messageId, topic_id);
+      return;
+    }
+    
+    if (args.empty()) {
+      auto group = getOrCreateGroup(message->chat->id);
+      sendMessage(message->chat->id,
+                  std::string(group.k_policy ? "K-factor policy: " : "K-factor policy (default): ") +
+                      kFactorPolicy(group.k_policy).toJson().dump(),
+                  message->messageId, topic_id);
+      return;
+    }
+    
+    if (!isAdmin(message)) {
+      sendErrorMessage(message, "Only group admins can change the K-factor policy");
+      return;
+    }
+    
+    getOrCreateGroup(message->chat->id);
+    if (args == "reset") {
+      group_repo_->clearKFactorPolicy(message->chat->id);
+      sendMessage(message->chat->id, "K-factor policy reset to the default.",
+                  message->messageId, topic_id);
+      return;
+    }
+    
+    try {
+      group_repo_->setKFactorPolicy(message->chat->id, args);
+    } catch (const std::invalid_argument& e) {
+      sendErrorMessage(message, std::string(e.what()) + "\nSee /k_policy help");
+      return;
+    }
+    
+    sendMessage(message->chat->id,
+                "K-factor policy updated. It applies from the next match; "
+                "earlier matches keep the K they were rated with.",
+                message->messageId, topic_id);
+    
+  } catch (const std::exception& e) {
+    OBS_ERROR(logger_, "Error handling K-factor policy command: " + std::string(e.what()));
+    sendErrorMessage(message, "Failed to change the K-factor policy");
+  }
+}
+
 void Bot::handleHelp(const tgbotxx::Ptr<tgbotxx::Message>& message) {
   handleStart(message);  // Reuse start command for help
 }
@@ -1054,8 +1209,8 @@ std::vector<int64_t> Bot::extractMentionedUserIds(const tgbotxx::Ptr<tgbotxx::Me
           if (user_id) {
             user_ids.push_back(*user_id);
           } else {
-            logger_->warn("Could not resolve username mention: @" + username + 
-                         " (user should use text mention or be in chat)");
+            OBS_WARN(logger_, "Could not resolve username mention: @" + username + 
+                             " (user should use text mention or be in chat)");
           }
         }
       }
@@ -1098,10 +1253,10 @@ std::optional<int64_t> Bot::lookupUserIdByUsername(const std::string& username,
     // We would need searchChatMembers which might not be available in tgbotxx
     
     // For now, return nullopt - username will be cached when we see it in message entities
-    logger_->debug("Username not found in cache: @" + username);
+    OBS_DEBUG(logger_, "Username not found in cache: @" + username);
     return std::nullopt;
   } catch (const std::exception& e) {
-    logger_->error("Error looking up username: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error looking up username: " + std::string(e.what()));
     return std::nullopt;
   }
 }
@@ -1168,126 +1323,183 @@ bool Bot::canUndoMatch(int64_t /* match_id */, int64_t user_id, const models::Ma
 void Bot::sendMessage(int64_t chat_id, const std::string& text, 
                      std::optional<int> reply_to_message_id,
                      std::optional<int> message_thread_id) {
-  try {
-    // Use tgbotxx API to send message
-    // Bot inherits from tgbotxx::Bot, so we can call parent's sendMessage
-    logger_->info("Sending message to chat_id=" + std::to_string(chat_id) + 
-                  ", text length=" + std::to_string(text.length()));
-    
-    tgbotxx::Ptr<tgbotxx::ReplyParameters> reply_params = nullptr;
-    if (reply_to_message_id && reply_to_message_id.value() > 0) {
-      reply_params = tgbotxx::Ptr<tgbotxx::ReplyParameters>(new tgbotxx::ReplyParameters());
-      reply_params->messageId = reply_to_message_id.value();
-      // Set chat explicitly; default-initialized ReplyParameters uses chat_id=0.
-      reply_params->chatId = chat_id;
-      // Note: messageThreadId is set via the sendMessage parameter, not in ReplyParameters
-    }
-    
-    // Use message_thread_id if provided, otherwise 0 (main chat)
-    int thread_id = message_thread_id.value_or(0);
-    
-    auto* api_impl = getBotApi();
-    if (!api_impl) {
-      logger_->error("API not available for sending message");
+  OutboundMessage message;
+  message.chat_id = chat_id;
+  message.text = text;
+  message.reply_to_message_id = reply_to_message_id;
+  message.message_thread_id = message_thread_id;
+  enqueueOrDeliver(std::move(message));
+}
+
+void Bot::startOutboundSender() {
+  if (outbound_sender_) {
+    return;
+  }
+  
+  auto& config = config::Config::getInstance();
+  int threads = config.getInt("telegram.outbound.sender_threads", 2);
+  if (threads <= 0) {
+    OBS_INFO(logger_, "Outbound sender disabled, messages are sent inline");
+    return;
+  }
+  
+  OutboundSender::Options options;
+  options.sender_threads = static_cast<size_t>(threads);
+  options.per_chat_rate = config.getDouble("telegram.outbound.per_chat_per_second", 1.0);
+  options.per_chat_burst = config.getDouble("telegram.outbound.per_chat_burst", 3.0);
+  options.global_rate = config.getDouble("telegram.outbound.global_per_second", 30.0);
+  options.global_burst = config.getDouble("telegram.outbound.global_burst", 30.0);
+  options.max_queue = static_cast<size_t>(std::max(config.getInt("telegram.outbound.max_queue", 10000), 1));
+  options.max_retries = config.getInt("telegram.outbound.max_retries", 3);
+  options.drain_timeout = std::chrono::milliseconds(config.getInt("telegram.outbound.drain_timeout_ms", 5000));
+  
+  outbound_sender_ = std::make_unique<OutboundSender>(
+      [this](const OutboundMessage& message) { deliver(message); }, options);
+  OBS_INFO(logger_, "Outbound sender started with " + std::to_string(threads) + " threads");
+}
+
+void Bot::enqueueOrDeliver(OutboundMessage message) {
+  if (outbound_sender_) {
+    if (outbound_sender_->send(message)) {
       return;
     }
-    auto sent_message = api_impl->sendMessage(
-        chat_id,
-        text,
-        thread_id,  // messageThreadId
-        "",  // parseMode
-        std::vector<tgbotxx::Ptr<tgbotxx::MessageEntity>>(),  // entities
-        false,  // disableNotification
-        false,  // protectContent
-        nullptr,  // replyMarkup
-        "",  // businessConnectionId
-        0,  // directMessagesTopicId
-        nullptr,  // linkPreviewOptions
-        false,  // allowPaidBroadcast
-        "",  // messageEffectId
-        nullptr,  // suggestedPostParameters
-        reply_params  // replyParameters
-    );
-    
-    if (sent_message) {
-      logger_->info("Message sent successfully, message_id=" + 
-                    std::to_string(sent_message->messageId));
-    } else {
-      logger_->warn("Message sent but returned null");
+    // Sending inline would skip the rate limits and the chat's ordering
+    // exactly when the queue is overloaded, so drop instead
+    if (!outbound_sender_->isShutDown()) {
+      OBS_WARN(logger_, "Outbound queue full, dropping message to chat_id=" +
+                        std::to_string(message.chat_id));
+      return;
     }
+  }
+  // No sender, or it has shut down: deliver on this thread
+  try {
+    deliver(message);
   } catch (const std::exception& e) {
-    logger_->error("Error sending message: " + std::string(e.what()));
+    OBS_ERROR(logger_, "Error sending message: " + std::string(e.what()));
     // Don't throw - log and continue
   }
 }
 
-void Bot::sendErrorMessage(const tgbotxx::Ptr<tgbotxx::Message>& message, 
-                           const std::string& error) {
-  if (!message) return;
-  auto topic_id = getTopicId(message);
-  sendMessage(message->chat->id, "❌ " + error, message->messageId, topic_id);
-}
-
-void Bot::sendToLogsTopic(int64_t chat_id, const std::string& text) {
-  if (!areTopicsEnabled() || !group_repo_) {
-    // If topics disabled or no repo, send to main chat
-    sendMessage(chat_id, text);
+void Bot::deliver(const OutboundMessage& message) {
+  auto* api_impl = getBotApi();
+  if (!api_impl) {
+    OBS_ERROR(logger_, "API not available for sending message");
     return;
   }
   
-  try {
-    auto group = getOrCreateGroup(chat_id);
-    auto logs_topic = group_repo_->getTopic(group.id, 0, "logs");
-    
-    if (logs_topic && logs_topic->is_active) {
-      // Send to logs topic
-      sendMessage(chat_id, text, std::nullopt, logs_topic->telegram_topic_id);
-    } else {
-      // No logs topic configured, send to main chat
-      sendMessage(chat_id, text);
-    }
-  } catch (const std::exception& e) {
-    logger_->error("Error sending to logs topic: " + std::string(e.what()));
-    // Fallback to main chat
-    sendMessage(chat_id, text);
-  }
-}
-
-void Bot::reactToMessage(int64_t chat_id, int message_id, const std::string& emoji) {
-  try {
-    // Use tgbotxx API to react to message
-    logger_->info("Reacting to message_id=" + std::to_string(message_id) + 
-                  " with emoji: " + emoji);
+  if (message.kind == OutboundMessage::Kind::kReaction) {
+    OBS_INFO(logger_, "Reacting to message_id=" + std::to_string(message.message_id) + 
+                      " with emoji: " + message.text);
     
     // Create ReactionTypeEmoji - it's defined in ReactionType.hpp
     auto reaction_type = tgbotxx::Ptr<tgbotxx::ReactionTypeEmoji>(
         new tgbotxx::ReactionTypeEmoji());
-    reaction_type->emoji = emoji;
+    reaction_type->emoji = message.text;
     
     std::vector<tgbotxx::Ptr<tgbotxx::ReactionType>> reactions;
     reactions.push_back(tgbotxx::Ptr<tgbotxx::ReactionType>(reaction_type));
     
-    // Call setMessageReaction through the API
-    auto* api_impl = getBotApi();
-    if (!api_impl) {
-      logger_->error("API not available for setting reaction");
-      return;
-    }
+    static auto& reaction_latency = telegramLatency("setMessageReaction");
+    observability::ScopedTimer timer(reaction_latency);
+    observability::ScopedSpan span("telegram.setMessageReaction", observability::SpanKind::kClient,
+                                   message.trace_context);
     bool success = api_impl->setMessageReaction(
-        chat_id,
-        message_id,
+        message.chat_id,
+        message.message_id,
         reactions,
         false  // isBig
     );
     
     if (success) {
-      logger_->info("Reaction set successfully");
+      OBS_INFO(logger_, "Reaction set successfully");
     } else {
-      logger_->warn("Reaction set returned false");
+      OBS_WARN(logger_, "Reaction set returned false");
+    }
+    return;
+  }
+  
+  OBS_INFO(logger_, "Sending message to chat_id=" + std::to_string(message.chat_id) + 
+                    ", text length=" + std::to_string(message.text.length()));
+  
+  tgbotxx::Ptr<tgbotxx::ReplyParameters> reply_params = nullptr;
+  if (message.reply_to_message_id && message.reply_to_message_id.value() > 0) {
+    reply_params = tgbotxx::Ptr<tgbotxx::ReplyParameters>(new tgbotxx::ReplyParameters());
+    reply_params->messageId = message.reply_to_message_id.value();
+    // Set chat explicitly; default-initialized ReplyParameters uses chat_id=0.
+    reply_params->chatId = message.chat_id;
+    // Note: messageThreadId is set via the sendMessage parameter, not in ReplyParameters
+  }
+  
+  // Use message_thread_id if provided, otherwise 0 (main chat)
+  int thread_id = message.message_thread_id.value_or(0);
+  
+  static auto& send_latency = telegramLatency("sendMessage");
+  observability::ScopedTimer timer(send_latency);
+  observability::ScopedSpan span("telegram.sendMessage", observability::SpanKind::kClient, message.trace_context);
+  span->setAttribute("telegram.group_id", message.chat_id);
+  auto sent_message = api_impl->sendMessage(
+      message.chat_id,
+      message.text,
+      thread_id,  // messageThreadId
+      "",  // parseMode
+      std::vector<tgbotxx::Ptr<tgbotxx::MessageEntity>>(),  // entities
+      false,  // disableNotification
+      false,  // protectContent
+      nullptr,  // replyMarkup
+      "",  // businessConnectionId
+      0,  // directMessagesTopicId
+      nullptr,  // linkPreviewOptions
+      false,  // allowPaidBroadcast
+      "",  // messageEffectId
+      nullptr,  // suggestedPostParameters
+      reply_params  // replyParameters
+  );
+  
+  if (sent_message) {
+    OBS_INFO(logger_, "Message sent successfully, message_id=" + 
+                      std::to_string(sent_message->messageId));
+  } else {
+    OBS_WARN(logger_, "Message sent but returned null");
+  }
+}
+
+void Bot::sendErrorMessage(const tgbotxx::Ptr<tgbotxx::Message>& message, 
+                           const std::string& error) {
+  if (!message) return;
+  auto topic_id = getTopicId(message);
+  sendMessage(message->chat->id, "❌ " + error, message->messageId, topic_id);
+}
+
+void Bot::sendToLogsTopic(int64_t chat_id, const std::string& text) {
+  // Log lines may be merged with the ones queued behind them
+  OutboundMessage message;
+  message.chat_id = chat_id;
+  message.text = text;
+  message.coalesce = true;
+  
+  if (areTopicsEnabled() && group_repo_) {
+    try {
+      auto group = getOrCreateGroup(chat_id);
+      auto logs_topic = group_repo_->getTopic(group.id, 0, "logs");
+      if (logs_topic && logs_topic->is_active) {
+        message.message_thread_id = logs_topic->telegram_topic_id;
+      }
+    } catch (const std::exception& e) {
+      // Fall back to the main chat
+      OBS_ERROR(logger_, "Error sending to logs topic: " + std::string(e.what()));
     }
-  } catch (const std::exception& e) {
-    logger_->error("Error reacting to message: " + std::string(e.what()));
   }
+  
+  enqueueOrDeliver(std::move(message));
+}
+
+void Bot::reactToMessage(int64_t chat_id, int message_id, const std::string& emoji) {
+  OutboundMessage message;
+  message.kind = OutboundMessage::Kind::kReaction;
+  message.chat_id = chat_id;
+  message.message_id = message_id;
+  message.text = emoji;
+  enqueueOrDeliver(std::move(message));
 }
 
 models::Group Bot::getOrCreateGroup(int64_t telegram_group_id, const std::string& name) {
@@ -1381,11 +1593,11 @@ bool Bot::isMatchUndoable(const models::Match& match, int64_t user_id) {
       telegram_group_id = group->telegram_group_id;
       is_admin = isGroupAdmin(group->telegram_group_id, user_id);
     } else {
-      logger_->warn("Group not found for undo permission check: group_id=" +
-                    std::to_string(match.group_id));
+      OBS_WARN(logger_, "Group not found for undo permission check: group_id=" +
+                        std::to_string(match.group_id));
     }
   } else {
-    logger_->warn("Group repository not initialized for undo permission check");
+    OBS_WARN(logger_, "Group repository not initialized for undo permission check");
   }
   
   // Check permission
@@ -1420,10 +1632,7 @@ void Bot::undoMatchTransaction(int64_t match_id, int64_t undone_by_user_id) {
   auto& work = txn.get();
   
   // 1. Get match
-  auto match_result = work.exec_params(
-    "SELECT id, group_id, player1_id, player2_id, player1_elo_before, player2_elo_before, "
-    "player1_elo_after, player2_elo_after, is_undone "
-    "FROM matches WHERE id = $1 FOR UPDATE",
+  auto match_result = database::execPrepared(work, database::statements::kMatchLock,
     match_id
   );
   
@@ -1443,131 +1652,40 @@ void Bot::undoMatchTransaction(int64_t match_id, int64_t undone_by_user_id) {
   int elo1_after = match_result[0]["player1_elo_after"].as<int>();
   int elo2_after = match_result[0]["player2_elo_after"].as<int>();
   
-  // 2. Get current group player states (with FOR UPDATE for consistency)
-  auto gp1_result = work.exec_params(
-    "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
-    "FROM group_players "
-    "WHERE group_id = $1 AND player_id = $2 FOR UPDATE",
-    group_id, player1_id
-  );
-  
-  if (gp1_result.empty()) {
-    throw std::runtime_error("Group player 1 not found");
-  }
-  
-  auto gp2_result = work.exec_params(
-    "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
-    "FROM group_players "
-    "WHERE group_id = $1 AND player_id = $2 FOR UPDATE",
-    group_id, player2_id
-  );
-  
-  if (gp2_result.empty()) {
-    throw std::runtime_error("Group player 2 not found");
-  }
-  
-  int64_t gp1_id = gp1_result[0]["id"].as<int64_t>();
-  int gp1_current_elo = gp1_result[0]["current_elo"].as<int>();
-  int gp1_matches_played = gp1_result[0]["matches_played"].as<int>();
-  int gp1_matches_won = gp1_result[0]["matches_won"].as<int>();
-  int gp1_matches_lost = gp1_result[0]["matches_lost"].as<int>();
-  int gp1_version = gp1_result[0]["version"].as<int>();
-  
-  int64_t gp2_id = gp2_result[0]["id"].as<int64_t>();
-  int gp2_current_elo = gp2_result[0]["current_elo"].as<int>();
-  int gp2_matches_played = gp2_result[0]["matches_played"].as<int>();
-  int gp2_matches_won = gp2_result[0]["matches_won"].as<int>();
-  int gp2_matches_lost = gp2_result[0]["matches_lost"].as<int>();
-  int gp2_version = gp2_result[0]["version"].as<int>();
-  
-  // Calculate reversed ELO (subtract the change)
-  int elo1_reversed = gp1_current_elo - (elo1_after - elo1_before);
-  int elo2_reversed = gp2_current_elo - (elo2_after - elo2_before);
-  
-  // Determine match result to reverse statistics
-  int score1 = 0, score2 = 0;
-  auto score_result = work.exec_params(
-    "SELECT player1_score, player2_score FROM matches WHERE id = $1",
-    match_id
-  );
-  if (!score_result.empty()) {
-    score1 = score_result[0]["player1_score"].as<int>();
-    score2 = score_result[0]["player2_score"].as<int>();
-  }
-  
-  // 3. Reverse ELO changes and update statistics with optimistic locking
-  int gp1_new_matches_played = std::max(0, gp1_matches_played - 1);
-  int gp1_new_matches_won = gp1_matches_won;
-  int gp1_new_matches_lost = gp1_matches_lost;
-  if (score1 > score2) {
-    gp1_new_matches_won = std::max(0, gp1_matches_won - 1);
-  } else if (score1 < score2) {
-    gp1_new_matches_lost = std::max(0, gp1_matches_lost - 1);
-  }
-  
-  auto update1_result = work.exec_params(
-    "UPDATE group_players SET "
-    "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-    "version = version + 1, updated_at = NOW() "
-    "WHERE id = $5 AND version = $6",
-    elo1_reversed, gp1_new_matches_played, gp1_new_matches_won, gp1_new_matches_lost,
-    gp1_id, gp1_version
-  );
-  
-  if (update1_result.affected_rows() == 0) {
-    throw utils::OptimisticLockException("Optimistic lock conflict for player 1 during undo");
-  }
-  
-  int gp2_new_matches_played = std::max(0, gp2_matches_played - 1);
-  int gp2_new_matches_won = gp2_matches_won;
-  int gp2_new_matches_lost = gp2_matches_lost;
-  if (score2 > score1) {
-    gp2_new_matches_won = std::max(0, gp2_matches_won - 1);
-  } else if (score2 < score1) {
-    gp2_new_matches_lost = std::max(0, gp2_matches_lost - 1);
-  }
-  
-  auto update2_result = work.exec_params(
-    "UPDATE group_players SET "
-    "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
-    "version = version + 1, updated_at = NOW() "
-    "WHERE id = $5 AND version = $6",
-    elo2_reversed, gp2_new_matches_played, gp2_new_matches_won, gp2_new_matches_lost,
-    gp2_id, gp2_version
-  );
-  
-  if (update2_result.affected_rows() == 0) {
-    throw utils::OptimisticLockException("Optimistic lock conflict for player 2 during undo");
-  }
-  
-  // 4. Mark match as undone
-  work.exec_params(
-    "UPDATE matches SET "
-    "is_undone = TRUE, undone_at = NOW(), undone_by_telegram_user_id = $1 "
-    "WHERE id = $2",
+  // 2. Mark match as undone
+  database::execPrepared(work, database::statements::kMatchMarkUndone,
     undone_by_user_id, match_id
   );
   
-  // 5. Create reverse ELO history entries (mark as undone)
+  // 3. Create reverse ELO history entries (mark as undone)
   int elo1_change = elo1_before - elo1_after;  // Reverse change
   int elo2_change = elo2_before - elo2_after;  // Reverse change
   
-  work.exec_params(
-    "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-    "elo_after, elo_change, created_at, is_undone) "
-    "VALUES ($1, $2, $3, $4, $5, $6, NOW(), TRUE)",
-    match_id, group_id, player1_id, elo1_after, elo1_before, elo1_change
+  database::execPrepared(work, database::statements::kEloHistoryInsert,
+    match_id, group_id, player1_id, elo1_after, elo1_before, elo1_change, true
   );
   
-  work.exec_params(
-    "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-    "elo_after, elo_change, created_at, is_undone) "
-    "VALUES ($1, $2, $3, $4, $5, $6, NOW(), TRUE)",
-    match_id, group_id, player2_id, elo2_after, elo2_before, elo2_change
+  database::execPrepared(work, database::statements::kEloHistoryInsert,
+    match_id, group_id, player2_id, elo2_after, elo2_before, elo2_change, true
   );
   
+  // 4. Replay the rest of the group's history, so matches played after the
+  // undone one are re-rated too. Each match is rated with the system and K it
+  // was registered with, so changing either does not rewrite older matches.
+  auto group_row = database::execPrepared1(work, database::statements::kGroupById, group_id);
+  auto system = utils::parseRatingSystem(group_row["rating_system"].as<std::string>())
+      .value_or(utils::RatingSystem::kElo);
+  repositories::EloReplayEngine replay(rating_engines_->get(system));
+  replay.setEngines(rating_engines_.get());
+  auto replayed = replay.recompute(work, group_id);
+  
   // Commit transaction
   txn.commit();
+  
+  // group_players were written directly, refresh the cached rows
+  for (const auto& player : replayed.changed_players) {
+    group_repo_->groupPlayerChanged(group_id, player.player_id, player.current_elo);
+  }
 }
 
 }  // namespace bot
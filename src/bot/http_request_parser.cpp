@@ -0,0 +1,143 @@
+#include "bot/http_request_parser.h"
+
+#include <charconv>
+
+namespace bot {
+
+namespace {
+
+constexpr std::string_view kHeaderTerminator = "\r\n\r\n";
+
+char asciiLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Case-insensitive comparison; `lower` must already be lowercase
+bool equalsLower(std::string_view value, std::string_view lower) {
+  if (value.size() != lower.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < value.size(); ++i) {
+    if (asciiLower(value[i]) != lower[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Case-insensitive substring search; `lower` must already be lowercase
+bool containsLower(std::string_view value, std::string_view lower) {
+  if (lower.size() > value.size()) {
+    return false;
+  }
+  for (size_t i = 0; i + lower.size() <= value.size(); ++i) {
+    if (equalsLower(value.substr(i, lower.size()), lower)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string_view trim(std::string_view value) {
+  while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+}  // namespace
+
+HttpRequestParser::Status HttpRequestParser::parse(std::string_view buffer, HttpRequestView& request) {
+  // Resume the terminator search where the previous call stopped; back up so a
+  // terminator split across reads is still found
+  size_t from = scan_offset_ >= kHeaderTerminator.size() - 1 ? scan_offset_ - (kHeaderTerminator.size() - 1) : 0;
+  size_t header_end = buffer.find(kHeaderTerminator, from);
+  if (header_end == std::string_view::npos) {
+    scan_offset_ = buffer.size();
+    return buffer.size() > max_header_size_ ? Status::kTooLarge : Status::kIncomplete;
+  }
+  scan_offset_ = header_end;
+
+  size_t header_size = header_end + kHeaderTerminator.size();
+  if (header_size > max_header_size_) {
+    return Status::kTooLarge;
+  }
+
+  std::string_view head = buffer.substr(0, header_end);
+
+  // Request line: METHOD SP PATH SP VERSION
+  size_t line_end = head.find("\r\n");
+  std::string_view request_line = head.substr(0, line_end);
+  size_t sp1 = request_line.find(' ');
+  size_t sp2 = sp1 == std::string_view::npos ? sp1 : request_line.find(' ', sp1 + 1);
+  if (sp2 == std::string_view::npos) {
+    return Status::kInvalid;
+  }
+
+  request = HttpRequestView{};
+  request.method = request_line.substr(0, sp1);
+  request.path = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+  request.version = trim(request_line.substr(sp2 + 1));
+  if (request.method.empty() || request.path.empty()) {
+    return Status::kInvalid;
+  }
+
+  // HTTP/1.1 connections are persistent unless the client says otherwise
+  request.keep_alive = request.version == "HTTP/1.1";
+
+  // Header fields
+  size_t content_length = 0;
+  size_t pos = line_end == std::string_view::npos ? head.size() : line_end + 2;
+  while (pos < head.size()) {
+    size_t eol = head.find("\r\n", pos);
+    if (eol == std::string_view::npos) {
+      eol = head.size();
+    }
+    std::string_view line = head.substr(pos, eol - pos);
+    pos = eol + 2;
+
+    size_t colon = line.find(':');
+    if (colon == std::string_view::npos) {
+      continue;
+    }
+    std::string_view name = line.substr(0, colon);
+    std::string_view value = trim(line.substr(colon + 1));
+
+    if (equalsLower(name, "content-length")) {
+      auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), content_length);
+      if (ec != std::errc() || end != value.data() + value.size()) {
+        return Status::kInvalid;
+      }
+    } else if (equalsLower(name, "content-type")) {
+      request.content_type = value;
+    } else if (equalsLower(name, "x-telegram-bot-api-secret-token")) {
+      request.secret_token = value;
+    } else if (equalsLower(name, "authorization")) {
+      request.authorization = value;
+    } else if (equalsLower(name, "connection")) {
+      if (containsLower(value, "close")) {
+        request.keep_alive = false;
+      } else if (containsLower(value, "keep-alive")) {
+        request.keep_alive = true;
+      }
+    } else if (equalsLower(name, "transfer-encoding")) {
+      return Status::kInvalid;  // Telegram always sends Content-Length
+    }
+  }
+
+  if (content_length > max_body_size_) {
+    return Status::kTooLarge;
+  }
+  if (buffer.size() - header_size < content_length) {
+    return Status::kIncomplete;  // Body still arriving
+  }
+
+  request.body = buffer.substr(header_size, content_length);
+  request.total_size = header_size + content_length;
+  return Status::kComplete;
+}
+
+}  // namespace bot
@@ -0,0 +1,259 @@
+#include "bot/outbound_sender.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include "observability/logger.h"
+
+namespace bot {
+
+namespace {
+
+// Idle chats are forgotten once there are this many (their buckets are full)
+constexpr size_t kSweepThreshold = 4096;
+
+}  // namespace
+
+OutboundSender::OutboundSender(Transport transport, Options options)
+    : transport_(std::move(transport)),
+      options_(options),
+      global_bucket_(options.global_rate, options.global_burst) {
+  if (!transport_) {
+    throw std::invalid_argument("OutboundSender requires a transport");
+  }
+  if (options_.sender_threads == 0 || options_.per_chat_rate <= 0.0 || options_.global_rate <= 0.0) {
+    throw std::invalid_argument("OutboundSender requires sender threads and positive rates");
+  }
+
+  threads_.reserve(options_.sender_threads);
+  for (size_t i = 0; i < options_.sender_threads; ++i) {
+    threads_.emplace_back([this]() { senderLoop(); });
+  }
+}
+
+OutboundSender::~OutboundSender() {
+  shutdown();
+}
+
+bool OutboundSender::send(OutboundMessage message) {
+  if (!message.trace_context.valid()) {
+    message.trace_context = observability::currentContext();
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (stopping_) {
+    return false;
+  }
+  if (queued_ >= options_.max_queue) {
+    stats_.rejected++;
+    return false;
+  }
+
+  auto now = Clock::now();
+  if (chats_.size() >= kSweepThreshold) {
+    sweepIdleChats(now);
+  }
+
+  int64_t chat_id = message.chat_id;
+  auto it = chats_.try_emplace(
+      chat_id, Chat{{}, utils::TokenBucket(options_.per_chat_rate, options_.per_chat_burst, now)}).first;
+  Chat& chat = it->second;
+  bool was_idle = chat.queue.empty() && !chat.in_flight;
+  chat.queue.push_back(Pending{std::move(message), 0});
+  ++queued_;
+  if (was_idle) {
+    ready_.push_back(chat_id);
+  }
+  wake_.notify_one();
+  return true;
+}
+
+void OutboundSender::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!stopping_) {
+      stopping_ = true;
+      drain_deadline_ = Clock::now() + options_.drain_timeout;
+    }
+  }
+  wake_.notify_all();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (queued_ > 0) {
+    OBS_WARN(observability::Logger::getInstance(), 
+        "OutboundSender: dropping " + std::to_string(queued_) + " messages left at shutdown");
+    stats_.dropped += queued_;
+    queued_ = 0;
+  }
+  chats_.clear();
+  ready_.clear();
+}
+
+bool OutboundSender::isShutDown() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stopping_;
+}
+
+OutboundSender::Stats OutboundSender::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.queued = queued_;
+  return stats;
+}
+
+std::optional<std::chrono::seconds> OutboundSender::retryAfter(const std::string& error) {
+  // tgbotxx reports the description ("retry after N"); the raw response has "retry_after": N
+  for (const char* marker : {"retry after", "retry_after"}) {
+    size_t pos = error.find(marker);
+    if (pos == std::string::npos) {
+      continue;
+    }
+    pos += std::strlen(marker);
+    while (pos < error.size() && (error[pos] == ' ' || error[pos] == ':' || error[pos] == '"')) {
+      ++pos;
+    }
+    long long seconds = 0;
+    size_t digits = 0;
+    while (pos < error.size() && std::isdigit(static_cast<unsigned char>(error[pos])) && digits < 9) {
+      seconds = seconds * 10 + (error[pos] - '0');
+      ++pos;
+      ++digits;
+    }
+    if (digits > 0) {
+      return std::chrono::seconds(seconds);
+    }
+  }
+  return std::nullopt;
+}
+
+OutboundSender::Pending OutboundSender::takeNext(Chat& chat) {
+  Pending next = std::move(chat.queue.front());
+  chat.queue.pop_front();
+  --queued_;
+
+  auto& message = next.message;
+  if (!message.coalesce || message.kind != OutboundMessage::Kind::kText || message.reply_to_message_id) {
+    return next;
+  }
+  while (!chat.queue.empty()) {
+    const auto& line = chat.queue.front().message;
+    if (!line.coalesce || line.kind != OutboundMessage::Kind::kText || line.reply_to_message_id ||
+        line.message_thread_id != message.message_thread_id ||
+        message.text.size() + 1 + line.text.size() > options_.max_coalesced_length) {
+      break;
+    }
+    message.text += '\n';
+    message.text += line.text;
+    chat.queue.pop_front();
+    --queued_;
+    ++stats_.coalesced;
+  }
+  return next;
+}
+
+void OutboundSender::sweepIdleChats(Clock::time_point now) {
+  for (auto it = chats_.begin(); it != chats_.end();) {
+    Chat& chat = it->second;
+    if (chat.queue.empty() && !chat.in_flight && chat.paused_until <= now && chat.bucket.full(now)) {
+      it = chats_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void OutboundSender::senderLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    auto now = Clock::now();
+    if (stopping_ && (queued_ == 0 || now >= drain_deadline_)) {
+      break;
+    }
+
+    // Round-robin over chats with work, taking the first one allowed to send
+    auto wake_at = Clock::time_point::max();
+    std::optional<int64_t> chat_id;
+    for (size_t n = ready_.size(); n > 0; --n) {
+      int64_t candidate = ready_.front();
+      ready_.pop_front();
+      Chat& chat = chats_.at(candidate);
+      auto ready_at = std::max(chat.paused_until, chat.bucket.readyAt(now));
+      if (ready_at <= now) {
+        chat_id = candidate;
+        break;
+      }
+      wake_at = std::min(wake_at, ready_at);
+      ready_.push_back(candidate);
+    }
+    if (chat_id) {
+      auto global_ready_at = global_bucket_.readyAt(now);
+      if (global_ready_at > now) {
+        ready_.push_front(*chat_id);
+        chat_id.reset();
+        wake_at = global_ready_at;
+      }
+    }
+
+    if (!chat_id) {
+      if (stopping_) {
+        wake_at = std::min(wake_at, drain_deadline_);
+      }
+      if (wake_at == Clock::time_point::max()) {
+        wake_.wait(lock);
+      } else {
+        wake_.wait_until(lock, wake_at);
+      }
+      continue;
+    }
+
+    // References into chats_ survive rehashing, and a chat with a request in
+    // flight is never swept
+    Chat& chat = chats_.at(*chat_id);
+    chat.bucket.tryTake(now);
+    global_bucket_.tryTake(now);
+    Pending pending = takeNext(chat);
+    chat.in_flight = true;
+    lock.unlock();
+
+    std::string error;
+    bool delivered = false;
+    try {
+      transport_(pending.message);
+      delivered = true;
+    } catch (const std::exception& e) {
+      error = e.what();
+    } catch (...) {
+      error = "unknown error";
+    }
+
+    lock.lock();
+    chat.in_flight = false;
+    if (delivered) {
+      ++stats_.sent;
+    } else if (auto retry_after = retryAfter(error); retry_after && pending.attempts < options_.max_retries) {
+      // Back at the head so the chat keeps its order
+      ++pending.attempts;
+      chat.paused_until = Clock::now() + *retry_after;
+      chat.queue.push_front(std::move(pending));
+      ++queued_;
+      ++stats_.retried;
+    } else {
+      ++stats_.failed;
+      OBS_ERROR(observability::Logger::getInstance(), 
+          "OutboundSender: delivery to chat " + std::to_string(*chat_id) + " failed: " + error);
+    }
+    if (!chat.queue.empty()) {
+      ready_.push_back(*chat_id);
+    }
+    wake_.notify_all();
+  }
+}
+
+}  // namespace bot
@@ -0,0 +1,179 @@
+#include "bot/update_dispatcher.h"
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include "observability/logger.h"
+
+namespace bot {
+
+namespace {
+
+// Lane served by the current thread (nullptr outside lane threads)
+thread_local const void* current_lane = nullptr;
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+  uint64_t current = target.load(std::memory_order_relaxed);
+  while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+UpdateDispatcher::UpdateDispatcher(size_t num_lanes, size_t max_lane_depth)
+    : max_lane_depth_(max_lane_depth) {
+  if (num_lanes == 0) {
+    throw std::invalid_argument("UpdateDispatcher requires at least one lane");
+  }
+  if (max_lane_depth_ == 0) {
+    max_lane_depth_ = 1;
+  }
+
+  lanes_.reserve(num_lanes);
+  for (size_t i = 0; i < num_lanes; ++i) {
+    lanes_.push_back(std::make_unique<Lane>());
+  }
+  for (auto& lane : lanes_) {
+    Lane* raw = lane.get();
+    lane->thread = std::thread([this, raw]() { laneLoop(*raw); });
+  }
+}
+
+UpdateDispatcher::~UpdateDispatcher() {
+  shutdown();
+}
+
+size_t UpdateDispatcher::laneFor(int64_t chat_id) const {
+  // Fibonacci hashing spreads sequential ids (and the -100... supergroup prefix) evenly
+  uint64_t hash = static_cast<uint64_t>(chat_id) * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>((hash >> 32) % lanes_.size());
+}
+
+bool UpdateDispatcher::dispatch(int64_t chat_id, Task task) {
+  Lane& lane = *lanes_[laneFor(chat_id)];
+
+  // Already running on this lane: keep ordering by running inline instead of
+  // queueing behind ourselves (and deadlocking when the lane is full)
+  if (current_lane == &lane) {
+    task();
+    return true;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(lane.mutex);
+    lane.not_full.wait(lock, [&] { return lane.stopping || lane.queue.size() < max_lane_depth_; });
+    if (lane.stopping) {
+      return false;
+    }
+    lane.queue.push_back(Item{std::move(task), std::chrono::steady_clock::now()});
+  }
+  lane.not_empty.notify_one();
+  return true;
+}
+
+UpdateDispatcher::DispatchResult UpdateDispatcher::tryDispatch(int64_t chat_id, Task task) {
+  Lane& lane = *lanes_[laneFor(chat_id)];
+
+  if (current_lane == &lane) {
+    task();
+    return DispatchResult::kAccepted;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(lane.mutex);
+    if (lane.stopping) {
+      return DispatchResult::kShutDown;
+    }
+    if (lane.queue.size() >= max_lane_depth_) {
+      return DispatchResult::kLaneFull;
+    }
+    lane.queue.push_back(Item{std::move(task), std::chrono::steady_clock::now()});
+  }
+  lane.not_empty.notify_one();
+  return DispatchResult::kAccepted;
+}
+
+void UpdateDispatcher::shutdown() {
+  for (auto& lane : lanes_) {
+    {
+      std::lock_guard<std::mutex> lock(lane->mutex);
+      lane->stopping = true;
+    }
+    lane->not_empty.notify_all();
+    lane->not_full.notify_all();
+  }
+  for (auto& lane : lanes_) {
+    if (lane->thread.joinable()) {
+      lane->thread.join();
+    }
+  }
+}
+
+UpdateDispatcher::LaneStats UpdateDispatcher::getLaneStats(size_t index) const {
+  const Lane& lane = *lanes_.at(index);
+  LaneStats stats;
+  {
+    std::lock_guard<std::mutex> lock(lane.mutex);
+    stats.queue_depth = lane.queue.size();
+  }
+  stats.processed = lane.processed.load(std::memory_order_relaxed);
+  stats.total_wait_us = lane.total_wait_us.load(std::memory_order_relaxed);
+  stats.total_run_us = lane.total_run_us.load(std::memory_order_relaxed);
+  stats.max_wait_us = lane.max_wait_us.load(std::memory_order_relaxed);
+  stats.max_run_us = lane.max_run_us.load(std::memory_order_relaxed);
+  return stats;
+}
+
+std::vector<UpdateDispatcher::LaneStats> UpdateDispatcher::getStats() const {
+  std::vector<LaneStats> stats;
+  stats.reserve(lanes_.size());
+  for (size_t i = 0; i < lanes_.size(); ++i) {
+    stats.push_back(getLaneStats(i));
+  }
+  return stats;
+}
+
+void UpdateDispatcher::laneLoop(Lane& lane) {
+  current_lane = &lane;
+
+  while (true) {
+    Item item;
+    {
+      std::unique_lock<std::mutex> lock(lane.mutex);
+      lane.not_empty.wait(lock, [&] { return lane.stopping || !lane.queue.empty(); });
+
+      // Drain remaining updates before exiting so nothing accepted is lost
+      if (lane.queue.empty()) {
+        break;
+      }
+
+      item = std::move(lane.queue.front());
+      lane.queue.pop_front();
+    }
+    lane.not_full.notify_one();
+
+    auto started_at = std::chrono::steady_clock::now();
+    try {
+      item.task();
+    } catch (const std::exception& e) {
+      OBS_ERROR(observability::Logger::getInstance(), "UpdateDispatcher: handler threw: " + std::string(e.what()));
+    } catch (...) {
+      OBS_ERROR(observability::Logger::getInstance(), "UpdateDispatcher: handler threw unknown exception");
+    }
+    auto finished_at = std::chrono::steady_clock::now();
+
+    auto wait_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(started_at - item.enqueued_at).count());
+    auto run_us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(finished_at - started_at).count());
+    lane.total_wait_us.fetch_add(wait_us, std::memory_order_relaxed);
+    lane.total_run_us.fetch_add(run_us, std::memory_order_relaxed);
+    updateMax(lane.max_wait_us, wait_us);
+    updateMax(lane.max_run_us, run_us);
+    lane.processed.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  current_lane = nullptr;
+}
+
+}  // namespace bot
@@ -1,8 +1,12 @@
 #include "bot/webhook_server.h"
 #include "observability/logger.h"
-#include <sstream>
+#include "observability/metrics.h"
+#include "observability/tracing.h"
+#include "utils/thread_pool.h"
 #include <algorithm>
-#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/tcp.h>
 #include <fcntl.h>
 #include <arpa/inet.h>
 #include <cstring>
@@ -10,6 +14,40 @@
 
 namespace bot {
 
+namespace {
+
+constexpr size_t kMaxHeaderSize = 8192;
+constexpr int kMaxEvents = 64;
+constexpr int kMaxLoopWaitMs = 1000;
+
+// Strip one leading and trailing '/' so "/webhook/" and "webhook" compare equal
+std::string_view normalizePath(std::string_view path) {
+  if (!path.empty() && path.back() == '/') {
+    path.remove_suffix(1);
+  }
+  if (!path.empty() && path.front() == '/') {
+    path.remove_prefix(1);
+  }
+  return path;
+}
+
+const char* statusText(int status_code) {
+  switch (status_code) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 415: return "Unsupported Media Type";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "Unknown";
+  }
+}
+
+}  // namespace
+
 WebhookServer::WebhookServer() = default;
 
 WebhookServer::~WebhookServer() {
@@ -30,53 +68,90 @@ bool WebhookServer::start() {
   if (running_.load()) {
     return true;  // Already running
   }
-  
-  // Create socket
-  server_socket_ = socket(AF_INET, SOCK_STREAM, 0);
+
+  auto fail = [this]() {
+    if (server_socket_ >= 0) close(server_socket_);
+    if (epoll_fd_ >= 0) close(epoll_fd_);
+    if (wake_fd_ >= 0) close(wake_fd_);
+    server_socket_ = epoll_fd_ = wake_fd_ = -1;
+    return false;
+  };
+
+  // Create non-blocking listening socket
+  server_socket_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
   if (server_socket_ < 0) {
     return false;
   }
-  
+
   // Allow socket reuse
   int opt = 1;
   if (setsockopt(server_socket_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-    close(server_socket_);
-    server_socket_ = -1;
-    return false;
+    return fail();
   }
-  
+
   // Bind to address
   struct sockaddr_in server_addr{};
   server_addr.sin_family = AF_INET;
   server_addr.sin_port = htons(config_.port);
-  
+
   if (config_.bind_address == "0.0.0.0") {
     server_addr.sin_addr.s_addr = INADDR_ANY;
   } else {
     if (inet_pton(AF_INET, config_.bind_address.c_str(), &server_addr.sin_addr) <= 0) {
-      close(server_socket_);
-      server_socket_ = -1;
-      return false;
+      return fail();
     }
   }
-  
+
   if (bind(server_socket_, reinterpret_cast<struct sockaddr*>(&server_addr), sizeof(server_addr)) < 0) {
-    close(server_socket_);
-    server_socket_ = -1;
-    return false;
+    return fail();
   }
-  
+
   // Start listening
   if (listen(server_socket_, config_.backlog) < 0) {
-    close(server_socket_);
-    server_socket_ = -1;
-    return false;
+    return fail();
+  }
+
+  // Event loop: listening socket plus an eventfd used for stop/completion wakeups
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || wake_fd_ < 0) {
+    return fail();
+  }
+
+  struct epoll_event ev{};
+  ev.events = EPOLLIN | EPOLLET;
+  ev.data.fd = server_socket_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, server_socket_, &ev) < 0) {
+    return fail();
+  }
+  ev.data.fd = wake_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) < 0) {
+    return fail();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expected_path_ = std::string(normalizePath(config_.path));
+    metrics_path_ = config_.metrics_path.empty() ? std::string() : std::string(normalizePath(config_.metrics_path));
+    expected_secret_token_ = config_.secret_token;
+    expected_metrics_authorization_ = config_.metrics_token.empty() ? std::string() : "Bearer " + config_.metrics_token;
+  }
+  if (!metrics_path_.empty() && config_.metrics_token.empty()) {
+    OBS_WARN(observability::Logger::getInstance(),
+             "Metrics are served on " + metrics_path_ + " without a token; set metrics_token or keep the port private");
   }
   
+  // Start request workers (inline mode when worker_threads == 0)
+  if (config_.worker_threads > 0) {
+    worker_pool_ = std::make_unique<utils::ThreadPool>(
+        static_cast<size_t>(config_.worker_threads),
+        static_cast<size_t>(std::max(config_.max_queue_depth, 1)));
+  }
+
   // Start server thread
   running_.store(true);
   server_thread_ = std::thread(&WebhookServer::serverLoop, this);
-  
+
   return true;
 }
 
@@ -84,343 +159,524 @@ void WebhookServer::stop() {
   if (!running_.load()) {
     return;
   }
-  
+
   running_.store(false);
-  
-  // Close server socket to unblock accept()
+  wakeLoop();
+
+  // Wait for server thread to finish
+  if (server_thread_.joinable()) {
+    server_thread_.join();
+  }
+
+  if (worker_pool_) {
+    worker_pool_->shutdown();
+    worker_pool_.reset();
+  }
+
   if (server_socket_ >= 0) {
-    shutdown(server_socket_, SHUT_RDWR);
     close(server_socket_);
     server_socket_ = -1;
   }
-  
-  // Wait for server thread to finish
-  if (server_thread_.joinable()) {
-    server_thread_.join();
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (wake_fd_ >= 0) {
+    close(wake_fd_);
+    wake_fd_ = -1;
+  }
+}
+
+size_t WebhookServer::getQueueDepth() const {
+  return worker_pool_ ? worker_pool_->getQueueDepth() : 0;
+}
+
+void WebhookServer::wakeLoop() {
+  uint64_t one = 1;
+  if (write(wake_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+    OBS_WARN(observability::Logger::getInstance(), "Failed to wake webhook event loop: " + std::string(strerror(errno)));
   }
 }
 
 void WebhookServer::serverLoop() {
-  // Set server socket to non-blocking for poll
-  int flags = fcntl(server_socket_, F_GETFL, 0);
-  fcntl(server_socket_, F_SETFL, flags | O_NONBLOCK);
-  
+  struct epoll_event events[kMaxEvents];
+
   while (running_.load()) {
-    struct pollfd pfd;
-    pfd.fd = server_socket_;
-    pfd.events = POLLIN;
-    
-    // Poll with timeout to allow checking running_ flag
-    int poll_result = poll(&pfd, 1, 1000);  // 1 second timeout
-    
-    if (poll_result < 0) {
+    int timeout_ms = expireConnections();
+    reapConnections();
+
+    int ready = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    if (ready < 0) {
       if (errno == EINTR) continue;  // Interrupted, retry
-      break;  // Error
+      OBS_ERROR(observability::Logger::getInstance(), "epoll_wait failed: " + std::string(strerror(errno)));
+      break;
     }
-    
-    if (poll_result == 0) {
-      continue;  // Timeout, check running_ and retry
-    }
-    
-    if (!(pfd.revents & POLLIN)) {
-      continue;
+
+    for (int i = 0; i < ready; ++i) {
+      int fd = events[i].data.fd;
+      uint32_t mask = events[i].events;
+
+      if (fd == server_socket_) {
+        acceptConnections();
+        continue;
+      }
+
+      if (fd == wake_fd_) {
+        uint64_t value;
+        while (read(wake_fd_, &value, sizeof(value)) > 0) {}
+        drainCompletions();
+        continue;
+      }
+
+      auto it = connections_.find(fd);
+      if (it == connections_.end()) {
+        continue;
+      }
+      Connection& conn = *it->second;
+
+      if (mask & EPOLLERR) {
+        markForClose(conn);
+        continue;
+      }
+      if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        onReadable(conn);
+      }
+      if (mask & EPOLLOUT) {
+        onWritable(conn);
+      }
     }
-    
+
+    reapConnections();
+  }
+
+  // Let accepted requests finish and flush their responses before closing
+  if (worker_pool_) {
+    worker_pool_->shutdown();
+  }
+  drainCompletions();
+  closeAllConnections();
+}
+
+void WebhookServer::acceptConnections() {
+  auto logger = observability::Logger::getInstance();
+
+  // Edge-triggered: accept until the backlog is empty
+  while (true) {
     struct sockaddr_in client_addr{};
     socklen_t client_len = sizeof(client_addr);
-    int client_socket = accept(server_socket_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len);
-    
+    int client_socket = accept4(server_socket_, reinterpret_cast<struct sockaddr*>(&client_addr), &client_len,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
+
     if (client_socket < 0) {
+      if (errno == EINTR) continue;
       if (errno == EAGAIN || errno == EWOULDBLOCK) {
-        continue;  // No connection available
+        break;  // No more pending connections
       }
-      auto logger = observability::Logger::getInstance();
-      logger->warn("Failed to accept connection: " + std::string(strerror(errno)));
-      continue;  // Other error, continue serving
+      OBS_WARN(logger, "Failed to accept connection: " + std::string(strerror(errno)));
+      break;  // Other error, continue serving
+    }
+
+    if (connections_.size() >= static_cast<size_t>(config_.max_connections)) {
+      OBS_WARN(logger, "Webhook connection limit reached (" + std::to_string(config_.max_connections) +
+                       "), refusing connection");
+      close(client_socket);
+      continue;
     }
-    
+
     // Log incoming connection
     char client_ip[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &(client_addr.sin_addr), client_ip, INET_ADDRSTRLEN);
-    {
-      auto logger = observability::Logger::getInstance();
-      logger->info("Incoming webhook connection from " + std::string(client_ip) + ":" + std::to_string(ntohs(client_addr.sin_port)));
+    OBS_INFO(logger, "Incoming webhook connection",
+                     observability::field<"client_ip">(client_ip),
+                     observability::field<"client_port">(ntohs(client_addr.sin_port)));
+
+    // Responses are small; don't let Nagle delay them on keep-alive connections
+    int nodelay = 1;
+    setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+    auto conn = std::make_unique<Connection>(kMaxHeaderSize, static_cast<size_t>(config_.max_body_size));
+    conn->fd = client_socket;
+    conn->id = next_connection_id_++;
+    conn->deadline = Clock::now() + std::chrono::seconds(config_.socket_timeout_seconds);
+    conn->request_started = Clock::now();
+    conn->timing = true;
+
+    struct epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.fd = client_socket;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, client_socket, &ev) < 0) {
+      OBS_WARN(logger, "Failed to register webhook connection: " + std::string(strerror(errno)));
+      close(client_socket);
+      continue;
     }
-    
-    // Set socket timeout for reads/writes
-    struct timeval timeout;
-    timeout.tv_sec = config_.socket_timeout_seconds;
-    timeout.tv_usec = 0;
-    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
-    setsockopt(client_socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
-    
-    // Handle the client (synchronously for simplicity)
-    handleClient(client_socket);
-    
-    close(client_socket);
+
+    connections_.emplace(client_socket, std::move(conn));
+    connection_count_.store(connections_.size());
   }
 }
 
-void WebhookServer::handleClient(int client_socket) {
-  auto logger = observability::Logger::getInstance();
-  logger->info("Processing webhook request");
-  
-  HttpRequest request = parseRequest(client_socket);
-  
-  if (!request.valid) {
-    logger->warn("Invalid webhook request received");
-    sendResponse(client_socket, 400, "Bad Request");
+void WebhookServer::onReadable(Connection& conn) {
+  // While a request is in flight the socket is left unread; the kernel buffer
+  // provides back-pressure and drainCompletions() resumes reading
+  if (conn.closing || conn.in_flight) {
     return;
   }
-  
-  logger->info("Webhook request parsed: method=" + request.method + ", path=" + request.path + 
-               ", content_type=" + request.content_type + ", body_size=" + std::to_string(request.body.size()));
-  
-  // Verify method is POST
-  if (request.method != "POST") {
-    logger->warn("Webhook request with invalid method: " + request.method);
-    sendResponse(client_socket, 405, "Method Not Allowed");
-    return;
-  }
-  
-  // Validate path matches configured webhook path
-  std::string expected_path;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    expected_path = config_.path;
-  }
-  
-  // Normalize paths: remove trailing slashes and ensure leading slash
-  std::string request_path = request.path;
-  if (!request_path.empty() && request_path.back() == '/') {
-    request_path.pop_back();
-  }
-  if (!request_path.empty() && request_path.front() != '/') {
-    request_path = "/" + request_path;
+
+  const size_t max_buffered = kMaxHeaderSize + static_cast<size_t>(config_.max_body_size);
+  char buffer[16384];
+
+  while (true) {
+    bool drained = false;
+
+    // Edge-triggered: read until EAGAIN, EOF or the buffer limit
+    while (conn.in_buffer.size() - conn.in_offset <= max_buffered) {
+      ssize_t bytes_read = recv(conn.fd, buffer, sizeof(buffer), 0);
+      if (bytes_read > 0) {
+        if (!conn.hasPendingInput()) {
+          // First bytes of a new request: it must arrive in full before the deadline
+          conn.deadline = Clock::now() + std::chrono::seconds(config_.socket_timeout_seconds);
+          if (!conn.timing) {
+            conn.request_started = Clock::now();
+            conn.timing = true;
+          }
+        }
+        conn.in_buffer.append(buffer, static_cast<size_t>(bytes_read));
+        continue;
+      }
+      if (bytes_read == 0) {
+        conn.peer_closed = true;
+        drained = true;
+        break;
+      }
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        drained = true;
+        break;
+      }
+      markForClose(conn);
+      return;
+    }
+
+    processBuffer(conn);
+    if (conn.closing || conn.in_flight || drained) {
+      break;
+    }
   }
-  
-  std::string normalized_expected = expected_path;
-  if (!normalized_expected.empty() && normalized_expected.back() == '/') {
-    normalized_expected.pop_back();
+
+  if (!conn.closing && conn.peer_closed && !conn.in_flight && conn.out_buffer.empty()) {
+    markForClose(conn);
   }
-  if (!normalized_expected.empty() && normalized_expected.front() != '/') {
-    normalized_expected = "/" + normalized_expected;
+}
+
+void WebhookServer::onWritable(Connection& conn) {
+  if (conn.closing || conn.out_buffer.empty()) {
+    return;
   }
-  
-  if (request_path != normalized_expected) {
-    logger->warn("Webhook request path mismatch: expected=" + normalized_expected + ", got=" + request_path);
-    sendResponse(client_socket, 404, "Not Found");
+
+  while (conn.out_offset < conn.out_buffer.size()) {
+    ssize_t sent = send(conn.fd, conn.out_buffer.data() + conn.out_offset,
+                        conn.out_buffer.size() - conn.out_offset, MSG_NOSIGNAL);
+    if (sent > 0) {
+      conn.out_offset += static_cast<size_t>(sent);
+      continue;
+    }
+    if (sent < 0 && errno == EINTR) continue;
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      // EPOLLOUT resumes the write; the client must keep reading
+      conn.deadline = Clock::now() + std::chrono::seconds(config_.socket_timeout_seconds);
+      return;
+    }
+    markForClose(conn);
     return;
   }
-  
-  // Verify content type is JSON
-  if (request.content_type.find("application/json") == std::string::npos) {
-    logger->warn("Webhook request with invalid content type: " + request.content_type);
-    sendResponse(client_socket, 415, "Unsupported Media Type");
+
+  conn.out_buffer.clear();
+  conn.out_offset = 0;
+
+  if (conn.timing) {
+    static auto& latency = observability::MetricsRegistry::getInstance().histogram(
+        "webhook_request_duration_seconds", "Time from accept (or first request byte) to the flushed response");
+    auto now = Clock::now();
+    latency.observe(now - conn.request_started);
+    // A pipelined request is already waiting in the buffer
+    conn.timing = conn.hasPendingInput();
+    conn.request_started = now;
+  }
+
+  if (conn.close_after_write || (conn.peer_closed && !conn.in_flight)) {
+    markForClose(conn);
     return;
   }
-  
-  // Verify secret token if configured
-  if (!config_.secret_token.empty()) {
-    if (request.secret_token != config_.secret_token) {
-      logger->warn("Webhook request with invalid secret token");
-      sendResponse(client_socket, 403, "Forbidden");
-      return;
-    }
-    logger->debug("Webhook secret token validated");
+
+  if (!conn.in_flight) {
+    auto timeout = conn.hasPendingInput() ? config_.socket_timeout_seconds : config_.keep_alive_timeout_seconds;
+    conn.deadline = Clock::now() + std::chrono::seconds(timeout);
   }
-  
-  logger->info("Processing Telegram update, body_size=" + std::to_string(request.body.size()));
-  
-  // Process the update
-  UpdateCallback callback;
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    callback = callback_;
+}
+
+void WebhookServer::markForClose(Connection& conn) {
+  if (!conn.closing) {
+    conn.closing = true;
+    pending_close_.push_back(conn.fd);
   }
-  
-  if (callback) {
-    logger->info("Calling update callback");
-    bool success = callback(request.body);
-    if (success) {
-      logger->info("Update processed successfully");
-      sendResponse(client_socket, 200, "OK");
-    } else {
-      logger->warn("Update processing returned false");
-      // Still return 200 to Telegram, but log failure internally
-      sendResponse(client_socket, 200, "OK");
+}
+
+void WebhookServer::reapConnections() {
+  for (int fd : pending_close_) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end() || !it->second->closing) {
+      continue;
     }
-  } else {
-    logger->error("No update callback registered!");
-    sendResponse(client_socket, 200, "OK");
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections_.erase(it);
   }
+  pending_close_.clear();
+  connection_count_.store(connections_.size());
 }
 
-WebhookServer::HttpRequest WebhookServer::parseRequest(int client_socket) {
-  HttpRequest request;
-  auto logger = observability::Logger::getInstance();
-  
-  // Read headers
-  std::string headers = readHeaders(client_socket);
-  if (headers.empty()) {
-    logger->warn("Failed to read headers from webhook request");
-    return request;
-  }
-  
-  logger->debug("Headers received, size=" + std::to_string(headers.size()) + ", preview=" + headers.substr(0, 200));
-  
-  // Parse request line
-  size_t first_line_end = headers.find("\r\n");
-  if (first_line_end == std::string::npos) {
-    logger->warn("Request line separator not found in headers");
-    return request;
+void WebhookServer::closeAllConnections() {
+  for (auto& [fd, conn] : connections_) {
+    close(fd);
   }
-  
-  std::string request_line = headers.substr(0, first_line_end);
-  logger->debug("Request line: " + request_line);
-  
-  std::istringstream iss(request_line);
-  std::string version;
-  iss >> request.method >> request.path >> version;
-  
-  if (request.method.empty() || request.path.empty()) {
-    logger->warn("Failed to parse request line: method=" + request.method + ", path=" + request.path);
-    return request;
+  connections_.clear();
+  pending_close_.clear();
+  connection_count_.store(0);
+
+  std::lock_guard<std::mutex> lock(completions_mutex_);
+  completions_.clear();
+}
+
+int WebhookServer::expireConnections() {
+  auto now = Clock::now();
+  auto next = now + std::chrono::milliseconds(kMaxLoopWaitMs);
+
+  for (auto& [fd, conn] : connections_) {
+    if (conn->closing || conn->in_flight) {
+      continue;
+    }
+    if (conn->deadline <= now) {
+      OBS_DEBUG(observability::Logger::getInstance(), "Closing webhook connection fd=" + std::to_string(fd) +
+                                                      " after deadline");
+      markForClose(*conn);
+      continue;
+    }
+    next = std::min(next, conn->deadline);
   }
-  
-  logger->debug("Parsed request: method=" + request.method + ", path=" + request.path + ", version=" + version);
-  
-  // Parse headers
-  size_t content_length = 0;
-  std::string header_section = headers.substr(first_line_end + 2);
-  std::istringstream header_stream(header_section);
-  std::string line;
-  
-  while (std::getline(header_stream, line)) {
-    if (line.empty() || line == "\r") break;
-    
-    // Remove trailing \r if present
-    if (!line.empty() && line.back() == '\r') {
-      line.pop_back();
+
+  auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count();
+  return static_cast<int>(std::clamp<long long>(wait, 0, kMaxLoopWaitMs));
+}
+
+void WebhookServer::processBuffer(Connection& conn) {
+  // Requests on one connection are answered in order, so only one is in flight
+  while (!conn.closing && !conn.in_flight && !conn.close_after_write && conn.hasPendingInput()) {
+    HttpRequestView request;
+    HttpRequestParser::Status status = conn.parser.parse(conn.pendingInput(), request);
+
+    if (status == HttpRequestParser::Status::kIncomplete) {
+      return;
+    }
+
+    if (status != HttpRequestParser::Status::kComplete) {
+      OBS_WARN(observability::Logger::getInstance(), status == HttpRequestParser::Status::kTooLarge
+                                                         ? "Webhook request exceeds size limits"
+                                                         : "Invalid webhook request received");
+      consumeInput(conn, conn.in_buffer.size() - conn.in_offset);
+      queueResponse(conn, buildResponse(400, statusText(400), false), false);
+      return;
     }
-    
-    size_t colon = line.find(':');
-    if (colon == std::string::npos) continue;
-    
-    std::string name = line.substr(0, colon);
-    std::string value = line.substr(colon + 1);
-    
-    // Trim whitespace from value
-    size_t start = value.find_first_not_of(" \t");
-    if (start != std::string::npos) {
-      value = value.substr(start);
+
+    if (!metrics_path_.empty() && request.method == "GET" && normalizePath(request.path) == metrics_path_) {
+      bool keep_alive = request.keep_alive;
+      bool authorized = expected_metrics_authorization_.empty() ||
+                        request.authorization == expected_metrics_authorization_;
+      consumeInput(conn, request.total_size);
+      if (!authorized) {
+        OBS_WARN(observability::Logger::getInstance(), "Metrics request without a valid bearer token");
+        queueResponse(conn, buildResponse(401, statusText(401), keep_alive), keep_alive);
+        continue;
+      }
+      queueResponse(conn, buildResponse(200, observability::MetricsRegistry::getInstance().render(), keep_alive),
+                    keep_alive);
+      continue;
     }
-    
-    // Convert header name to lowercase for comparison
-    std::string name_lower = name;
-    std::transform(name_lower.begin(), name_lower.end(), name_lower.begin(), ::tolower);
-    
-    if (name_lower == "content-length") {
-      content_length = std::stoull(value);
-    } else if (name_lower == "content-type") {
-      request.content_type = value;
-    } else if (name_lower == "x-telegram-bot-api-secret-token") {
-      request.secret_token = value;
+
+    // Views die with the buffer: copy the body (the only per-request allocation)
+    // before the request bytes are consumed
+    int code = validateRequest(request);
+    bool keep_alive = request.keep_alive;
+    std::string body = code == 200 ? std::string(request.body) : std::string();
+    consumeInput(conn, request.total_size);
+
+    if (code != 200) {
+      queueResponse(conn, buildResponse(code, statusText(code), keep_alive), keep_alive);
+      continue;
     }
+
+    dispatchRequest(conn, std::move(body), keep_alive);
   }
-  
-  // Validate content length
-  if (content_length > static_cast<size_t>(config_.max_body_size)) {
-    return request;  // Body too large
+}
+
+void WebhookServer::consumeInput(Connection& conn, size_t bytes) {
+  conn.in_offset += bytes;
+  conn.parser.reset();
+
+  if (conn.in_offset >= conn.in_buffer.size()) {
+    // Keep the capacity for the next request on this connection
+    conn.in_buffer.clear();
+    conn.in_offset = 0;
+  } else if (conn.in_offset > conn.in_buffer.size() / 2) {
+    // Pipelined data left over: compact so the buffer does not grow unbounded
+    conn.in_buffer.erase(0, conn.in_offset);
+    conn.in_offset = 0;
   }
-  
-  // Read body if present
-  if (content_length > 0) {
-    request.body = readBody(client_socket, content_length);
-    if (request.body.size() != content_length) {
-      return request;  // Failed to read complete body
+}
+
+void WebhookServer::dispatchRequest(Connection& conn, std::string body, bool keep_alive) {
+  conn.in_flight = true;
+
+  if (!worker_pool_) {
+    // Inline mode: handle the request on the event loop thread
+    int status = handleUpdate(body);
+    conn.in_flight = false;
+    queueResponse(conn, buildResponse(status, statusText(status), keep_alive), keep_alive);
+    return;
+  }
+
+  int fd = conn.fd;
+  uint64_t id = conn.id;
+  auto shared_body = std::make_shared<std::string>(std::move(body));
+  bool queued = worker_pool_->trySubmit([this, fd, id, keep_alive, shared_body]() {
+    int status = handleUpdate(*shared_body);
+    {
+      std::lock_guard<std::mutex> lock(completions_mutex_);
+      completions_.push_back({fd, id, buildResponse(status, statusText(status), keep_alive), keep_alive});
     }
+    wakeLoop();
+  });
+
+  if (!queued) {
+    // Back-pressure: Telegram retries non-2xx deliveries, so shedding is safe
+    rejected_count_.fetch_add(1);
+    auto logger = observability::Logger::getInstance();
+    OBS_WARN(logger, "Webhook worker queue full (depth=" + std::to_string(worker_pool_->getQueueDepth()) +
+                     "), rejecting request with 503");
+    conn.in_flight = false;
+    queueResponse(conn, buildResponse(503, statusText(503), false), false);
   }
-  
-  request.valid = true;
-  return request;
 }
 
-std::string WebhookServer::readHeaders(int client_socket) {
-  std::string headers;
-  char buffer[4096];
-  
-  while (true) {
-    ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-    if (bytes_read <= 0) {
-      break;  // Error or connection closed
-    }
-    
-    buffer[bytes_read] = '\0';
-    headers += buffer;
-    
-    // Check if we've received all headers (\r\n\r\n marks end of headers)
-    if (headers.find("\r\n\r\n") != std::string::npos) {
-      // Return only the headers part
-      size_t end = headers.find("\r\n\r\n");
-      return headers.substr(0, end + 4);
-    }
-    
-    // Safety limit
-    if (headers.size() > 8192) {
-      break;  // Headers too large
+void WebhookServer::drainCompletions() {
+  std::vector<Completion> done;
+  {
+    std::lock_guard<std::mutex> lock(completions_mutex_);
+    done.swap(completions_);
+  }
+
+  for (auto& completion : done) {
+    auto it = connections_.find(completion.fd);
+    if (it == connections_.end() || it->second->id != completion.id || it->second->closing) {
+      continue;  // Connection went away while the request was being handled
     }
+    Connection& conn = *it->second;
+    conn.in_flight = false;
+    queueResponse(conn, std::move(completion.response), completion.keep_alive);
+
+    // Resume reading: data that arrived while paused produced no new edge
+    onReadable(conn);
   }
-  
-  return "";
 }
 
-std::string WebhookServer::readBody(int client_socket, size_t content_length) {
-  std::string body;
-  body.reserve(content_length);
-  
-  char buffer[4096];
-  size_t remaining = content_length;
-  
-  while (remaining > 0) {
-    size_t to_read = std::min(remaining, sizeof(buffer));
-    ssize_t bytes_read = recv(client_socket, buffer, to_read, 0);
-    
-    if (bytes_read <= 0) {
-      break;  // Error or connection closed
+void WebhookServer::queueResponse(Connection& conn, std::string response, bool keep_alive) {
+  if (!keep_alive) {
+    conn.close_after_write = true;
+  }
+  conn.out_buffer.append(response);
+  onWritable(conn);
+}
+
+int WebhookServer::validateRequest(const HttpRequestView& request) const {
+  auto logger = observability::Logger::getInstance();
+
+  // Verify method is POST
+  if (request.method != "POST") {
+    OBS_WARN(logger, "Webhook request with invalid method: " + std::string(request.method));
+    return 405;
+  }
+
+  // Validate path matches configured webhook path
+  if (normalizePath(request.path) != expected_path_) {
+    OBS_WARN(logger, "Webhook request path mismatch: expected=/" + expected_path_ + ", got=" + std::string(request.path));
+    return 404;
+  }
+
+  // Verify content type is JSON
+  if (request.content_type.find("application/json") == std::string_view::npos) {
+    OBS_WARN(logger, "Webhook request with invalid content type: " + std::string(request.content_type));
+    return 415;
+  }
+
+  // Verify secret token if configured
+  if (!expected_secret_token_.empty() && request.secret_token != expected_secret_token_) {
+    OBS_WARN(logger, "Webhook request with invalid secret token");
+    return 403;
+  }
+
+  return 200;
+}
+
+int WebhookServer::handleUpdate(const std::string& body) {
+  auto logger = observability::Logger::getInstance();
+  // Root of the update's trace; handlers dispatched from the callback inherit it
+  observability::ScopedSpan span("webhook.receive", observability::SpanKind::kServer);
+  span->setAttribute("http.request.body.size", body.size());
+  OBS_INFO(logger, "Processing Telegram update", observability::field<"body_size">(body.size()));
+
+  // Process the update
+  UpdateCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback = callback_;
+  }
+
+  if (callback) {
+    switch (callback(body)) {
+      case UpdateResult::kProcessed:
+        OBS_DEBUG(logger, "Update processed successfully");
+        break;
+      case UpdateResult::kFailed:
+        // Still return 200 to Telegram, but log failure internally
+        OBS_WARN(logger, "Update processing failed");
+        span->setError("update processing failed");
+        break;
+      case UpdateResult::kRetryLater:
+        OBS_WARN(logger, "Update refused for lack of capacity, asking Telegram to retry");
+        span->setError("update refused, retry later");
+        return 503;
     }
-    
-    body.append(buffer, bytes_read);
-    remaining -= bytes_read;
+  } else {
+    OBS_ERROR(logger, "No update callback registered!");
   }
-  
-  return body;
+  return 200;
 }
 
-void WebhookServer::sendResponse(int client_socket, int status_code, const std::string& body) {
-  std::string status_text;
-  switch (status_code) {
-    case 200: status_text = "OK"; break;
-    case 400: status_text = "Bad Request"; break;
-    case 403: status_text = "Forbidden"; break;
-    case 404: status_text = "Not Found"; break;
-    case 405: status_text = "Method Not Allowed"; break;
-    case 415: status_text = "Unsupported Media Type"; break;
-    case 500: status_text = "Internal Server Error"; break;
-    default: status_text = "Unknown"; break;
+std::string WebhookServer::buildResponse(int status_code, const std::string& body, bool keep_alive) {
+  std::string response;
+  response.reserve(128 + body.size());
+  response += "HTTP/1.1 ";
+  response += std::to_string(status_code);
+  response += ' ';
+  response += statusText(status_code);
+  response += "\r\nContent-Type: text/plain\r\nContent-Length: ";
+  response += std::to_string(body.size());
+  response += "\r\n";
+  if (status_code == 503) {
+    response += "Retry-After: 1\r\n";
   }
-  
-  std::ostringstream response;
-  response << "HTTP/1.1 " << status_code << " " << status_text << "\r\n";
-  response << "Content-Type: text/plain\r\n";
-  response << "Content-Length: " << body.size() << "\r\n";
-  response << "Connection: close\r\n";
-  response << "\r\n";
-  response << body;
-  
-  std::string response_str = response.str();
-  send(client_socket, response_str.c_str(), response_str.size(), 0);
+  response += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+  response += body;
+  return response;
 }
 
 }  // namespace bot
-
@@ -5,29 +5,70 @@
 #include <chrono>
 #include <mutex>
 #include <algorithm>
+#include <vector>
+#include "database/prepared_statements.h"
 #include "observability/logger.h"
 
 namespace database {
 
-ConnectionPool::ConnectionPool(const Config& config) : config_(config) {
+ConnectionPool::ConnectionPool(const Config& config)
+    : config_(config),
+      acquire_latency_(observability::MetricsRegistry::getInstance().histogram(
+          "db_pool_acquire_seconds", "Time acquire() waited for a connection")),
+      acquire_timeouts_(observability::MetricsRegistry::getInstance().counter(
+          "db_pool_acquire_timeouts_total", "acquire() calls that timed out on an exhausted pool")) {
   // Initialize minimum connections
   for (int i = 0; i < config_.min_size; ++i) {
     try {
       auto conn = createConnection();
-      pool_.push_back(conn);
+      pool_.push_back({conn, Clock::now()});
     } catch (const std::exception& e) {
       if (auto logger = observability::Logger::getInstance()) {
-        logger->error("ConnectionPool: failed to pre-create connection " +
-                      std::to_string(i + 1) + "/" +
-                      std::to_string(config_.min_size) + " - " + e.what());
+        OBS_ERROR(logger, "ConnectionPool: failed to pre-create connection " +
+                          std::to_string(i + 1) + "/" +
+                          std::to_string(config_.min_size) + " - " + e.what());
       }
     }
   }
+  
+  if (config_.maintenance_interval_seconds > 0) {
+    maintenance_thread_ = std::thread(&ConnectionPool::maintenanceLoop, this);
+  }
+  
+  // Read under mutex_ at scrape time; the registry is never locked while mutex_ is held
+  auto& registry = observability::MetricsRegistry::getInstance();
+  auto locked = [this](auto read) {
+    return [this, read]() {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return static_cast<double>(read());
+    };
+  };
+  gauges_.push_back(registry.gaugeCallback("db_pool_connections_in_use", "Connections lent out or being opened", {},
+                                           locked([this] { return active_connections_; })));
+  gauges_.push_back(registry.gaugeCallback("db_pool_connections_idle", "Idle pooled connections", {},
+                                           locked([this] { return pool_.size(); })));
+  gauges_.push_back(registry.gaugeCallback("db_pool_waiters", "acquire() calls waiting for a connection", {},
+                                           locked([this] { return waiters_.size(); })));
+  gauges_.push_back(registry.gaugeCallback("db_pool_max_connections", "Configured pool size limit", {},
+                                           [this] { return static_cast<double>(config_.max_size); }));
+  gauges_.push_back(registry.gaugeCallback(
+      "db_pool_utilization", "Share of max_size connections in use", {},
+      locked([this] { return config_.max_size > 0 ? static_cast<double>(active_connections_) / config_.max_size : 0.0; })));
 }
 
 ConnectionPool::~ConnectionPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  maintenance_cv_.notify_all();
+  if (maintenance_thread_.joinable()) {
+    maintenance_thread_.join();
+  }
+  
   std::lock_guard<std::mutex> lock(mutex_);
   pool_.clear();
+  opened_at_.clear();
 }
 
 std::unique_ptr<ConnectionPool> ConnectionPool::create(
@@ -39,53 +80,204 @@ std::unique_ptr<ConnectionPool> ConnectionPool::create(
 std::shared_ptr<pqxx::connection> ConnectionPool::createConnection() {
   try {
     auto conn = std::make_shared<pqxx::connection>(config_.connection_string);
+    prepareStatements(*conn);
+    std::lock_guard<std::mutex> lock(mutex_);
+    opened_at_[conn.get()] = Clock::now();
     return conn;
   } catch (const std::exception& e) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error("ConnectionPool: createConnection failed - " + std::string(e.what()));
+      OBS_ERROR(logger, "ConnectionPool: createConnection failed - " + std::string(e.what()));
     }
     throw std::runtime_error("Failed to create database connection: " + 
                              std::string(e.what()));
   }
 }
 
-std::shared_ptr<pqxx::connection> ConnectionPool::acquire() {
-  std::lock_guard<std::mutex> lock(mutex_);
+void PooledConnection::release() {
+  if (conn_ && pool_) {
+    pool_->release(std::move(conn_));
+  }
+  conn_.reset();
+  pool_ = nullptr;
+}
+
+void PooledConnection::invalidate() {
+  if (conn_) {
+    try {
+      conn_->close();
+    } catch (const std::exception&) {
+      // Already unusable; release() drops it either way
+    }
+  }
+  release();
+}
+
+PooledConnection ConnectionPool::acquire() {
+  return acquire(std::chrono::milliseconds(config_.acquire_timeout_ms));
+}
+
+PooledConnection ConnectionPool::acquire(std::chrono::milliseconds timeout) {
+  auto started = Clock::now();
+  auto conn = acquireRaw(timeout);
+  acquire_latency_.observe(Clock::now() - started);
+  return PooledConnection(this, std::move(conn));
+}
+
+std::shared_ptr<pqxx::connection> ConnectionPool::acquireRaw(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
   
-  // Try to find an available connection
-  for (auto it = pool_.begin(); it != pool_.end(); ++it) {
-    if ((*it)->is_open()) {
-      auto conn = *it;
-      pool_.erase(it);
+  // Fast path, only when nobody is queued so waiters are not overtaken
+  if (waiters_.empty()) {
+    if (!pool_.empty()) {
+      IdleConnection idle = std::move(pool_.back());
+      pool_.pop_back();
       active_connections_++;
-      return conn;
+      lock.unlock();
+      return checkOut(std::move(idle));
+    }
+    
+    if (static_cast<int>(pool_.size()) + active_connections_ < config_.max_size) {
+      // Reserve the slot, then open the connection without holding the lock
+      active_connections_++;
+      lock.unlock();
+      return createReserved();
     }
   }
   
-  // Create new connection if pool not at max
-  if (pool_.size() + active_connections_ < config_.max_size) {
-    active_connections_++;
-    return createConnection();
+  // Pool at capacity: queue up and wait for a hand-off or a free slot
+  Waiter waiter;
+  waiters_.push_back(&waiter);
+  bool served = waiter.cv.wait_for(lock, timeout, [&waiter] { return waiter.done; });
+  
+  if (!served) {
+    waiters_.erase(std::find(waiters_.begin(), waiters_.end(), &waiter));
+    acquire_timeouts_.inc();
+    if (auto logger = observability::Logger::getInstance()) {
+      OBS_ERROR(logger, "ConnectionPool: pool exhausted, acquire timed out after " +
+                        std::to_string(timeout.count()) + "ms (active=" +
+                        std::to_string(active_connections_) +
+                        ", idle=" + std::to_string(pool_.size()) +
+                        ", waiting=" + std::to_string(waiters_.size()) +
+                        ", max=" + std::to_string(config_.max_size) + ")");
+    }
+    throw std::runtime_error("Connection pool exhausted");
+  }
+  
+  // The slot was reserved for us by whoever woke us up
+  auto conn = std::move(waiter.conn);
+  lock.unlock();
+  
+  if (conn && conn->is_open()) {
+    return conn;
+  }
+  return createReserved();
+}
+
+std::shared_ptr<pqxx::connection> ConnectionPool::checkOut(IdleConnection idle) {
+  auto now = Clock::now();
+  bool usable = idle.conn->is_open();
+  if (usable) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    usable = !isExpiredLocked(idle.conn.get(), now);
+  }
+  // Servers and NATs drop quiet connections without libpq noticing, so check
+  // before the caller's first query does
+  if (usable && now - idle.idle_since >= std::chrono::seconds(config_.validation_idle_seconds)) {
+    usable = validate(*idle.conn);
+  }
+  if (usable) {
+    return idle.conn;
   }
   
-  // Pool exhausted
-  if (auto logger = observability::Logger::getInstance()) {
-    logger->error("ConnectionPool: pool exhausted (active=" +
-                  std::to_string(active_connections_) +
-                  ", idle=" + std::to_string(pool_.size()) +
-                  ", max=" + std::to_string(config_.max_size) + ")");
+  // Reuse the slot for a fresh connection
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    opened_at_.erase(idle.conn.get());
+  }
+  idle.conn.reset();
+  return createReserved();
+}
+
+bool ConnectionPool::validate(pqxx::connection& conn) {
+  try {
+    pqxx::nontransaction txn(conn);
+    txn.exec("SELECT 1");
+    return true;
+  } catch (const std::exception& e) {
+    if (auto logger = observability::Logger::getInstance()) {
+      OBS_WARN(logger, "ConnectionPool: idle connection failed validation, reconnecting - " +
+                       std::string(e.what()));
+    }
+    return false;
   }
-  throw std::runtime_error("Connection pool exhausted");
+}
+
+bool ConnectionPool::isExpiredLocked(const pqxx::connection* conn, Clock::time_point now) const {
+  if (config_.max_lifetime_seconds <= 0) {
+    return false;
+  }
+  auto it = opened_at_.find(conn);
+  return it != opened_at_.end() &&
+         now - it->second >= std::chrono::seconds(config_.max_lifetime_seconds);
+}
+
+std::shared_ptr<pqxx::connection> ConnectionPool::createReserved() {
+  try {
+    return createConnection();
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_connections_--;
+    grantSlotLocked();
+    throw;
+  }
+}
+
+void ConnectionPool::grantSlotLocked() {
+  if (waiters_.empty() || static_cast<int>(pool_.size()) + active_connections_ >= config_.max_size) {
+    return;
+  }
+  Waiter* waiter = waiters_.front();
+  waiters_.pop_front();
+  active_connections_++;
+  waiter->done = true;
+  waiter->cv.notify_one();
 }
 
 void ConnectionPool::release(std::shared_ptr<pqxx::connection> conn) {
-  if (!conn || !conn->is_open()) {
+  if (!conn) {
     return;
   }
+  bool healthy = conn->is_open();
   
   std::lock_guard<std::mutex> lock(mutex_);
+  
+  if (!healthy || isExpiredLocked(conn.get(), Clock::now())) {
+    // Drop the connection but give its slot back, so capacity stays max_size;
+    // the maintenance thread restores min_size if needed
+    active_connections_--;
+    opened_at_.erase(conn.get());
+    if (!healthy) {
+      if (auto logger = observability::Logger::getInstance()) {
+        OBS_WARN(logger, "ConnectionPool: discarding broken connection (active=" +
+                         std::to_string(active_connections_) + ", idle=" + std::to_string(pool_.size()) + ")");
+      }
+    }
+    grantSlotLocked();
+    return;
+  }
+  
+  // Hand the connection straight to the oldest waiter; it stays active
+  if (!waiters_.empty()) {
+    Waiter* waiter = waiters_.front();
+    waiters_.pop_front();
+    waiter->conn = std::move(conn);
+    waiter->done = true;
+    waiter->cv.notify_one();
+    return;
+  }
+  
   active_connections_--;
-  pool_.push_back(conn);
+  pool_.push_back({std::move(conn), Clock::now()});
 }
 
 int ConnectionPool::getActiveConnections() const {
@@ -98,23 +290,87 @@ int ConnectionPool::getTotalConnections() const {
   return pool_.size() + active_connections_;
 }
 
+int ConnectionPool::getWaitingCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<int>(waiters_.size());
+}
+
 bool ConnectionPool::healthCheck() {
   try {
     auto conn = acquire();
     pqxx::work txn(*conn);
     txn.exec("SELECT 1");
-    release(conn);
     return true;
   } catch (const std::exception&) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->warn("ConnectionPool: health check failed");
+      OBS_WARN(logger, "ConnectionPool: health check failed");
     }
     return false;
   }
 }
 
 void ConnectionPool::cleanupIdleConnections() {
-  // TODO: Implement cleanup logic
+  std::vector<std::shared_ptr<pqxx::connection>> retired;
+  int to_open = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto now = Clock::now();
+    auto idle_timeout = std::chrono::seconds(config_.idle_timeout_seconds);
+    
+    // Least recently used connections are at the front
+    for (auto it = pool_.begin(); it != pool_.end();) {
+      int total = static_cast<int>(pool_.size()) + active_connections_;
+      bool idle_too_long = config_.idle_timeout_seconds > 0 &&
+                           now - it->idle_since >= idle_timeout &&
+                           total > config_.min_size;
+      if (idle_too_long || isExpiredLocked(it->conn.get(), now)) {
+        opened_at_.erase(it->conn.get());
+        retired.push_back(std::move(it->conn));
+        it = pool_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    
+    // Reserve the slots needed to get back to min_size
+    int total = static_cast<int>(pool_.size()) + active_connections_;
+    to_open = std::min(config_.min_size, config_.max_size) - total;
+    if (to_open > 0) {
+      active_connections_ += to_open;
+    }
+  }
+  
+  // Close and open outside the lock; both are network round trips
+  if (!retired.empty()) {
+    if (auto logger = observability::Logger::getInstance()) {
+      OBS_INFO(logger, "ConnectionPool: closing " + std::to_string(retired.size()) +
+                       " idle or expired connection(s)");
+    }
+    retired.clear();
+  }
+  for (int i = 0; i < to_open; ++i) {
+    try {
+      release(createReserved());
+    } catch (const std::exception& e) {
+      // createReserved() already freed the slot; retry on the next pass
+      if (auto logger = observability::Logger::getInstance()) {
+        OBS_WARN(logger, "ConnectionPool: warm-up failed - " + std::string(e.what()));
+      }
+    }
+  }
+}
+
+void ConnectionPool::maintenanceLoop() {
+  auto interval = std::chrono::seconds(config_.maintenance_interval_seconds);
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    if (maintenance_cv_.wait_for(lock, interval, [this] { return stopping_; })) {
+      break;
+    }
+    lock.unlock();
+    cleanupIdleConnections();
+    lock.lock();
+  }
 }
 
 }  // namespace database
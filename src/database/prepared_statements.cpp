@@ -0,0 +1,263 @@
+#include "database/prepared_statements.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "observability/logger.h"
+
+namespace database {
+
+// Column lists shared by several SELECTs
+#define GROUP_COLUMNS "id, telegram_group_id, name, created_at, updated_at, is_active, rating_system, k_policy "
+#define GROUP_PLAYER_COLUMNS \
+  "id, group_id, player_id, current_elo, matches_played, " \
+  "matches_won, matches_lost, version, rating_deviation, rating_volatility, " \
+  "created_at, updated_at "
+#define GROUP_TOPIC_COLUMNS "id, group_id, telegram_topic_id, topic_type, is_active, created_at "
+#define PLAYER_COLUMNS \
+  "id, telegram_user_id, school_nickname, is_verified_student, " \
+  "is_allowed_non_student, created_at, updated_at, deleted_at "
+#define MATCH_COLUMNS \
+  "id, group_id, player1_id, player2_id, player1_score, player2_score, " \
+  "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, " \
+  "idempotency_key, created_by_telegram_user_id, created_at, is_undone, " \
+  "undone_at, undone_by_telegram_user_id "
+
+const std::vector<PreparedStatement>& preparedStatements() {
+  using namespace statements;
+  static const std::vector<PreparedStatement> catalogue = {
+    // groups
+    {kGroupUpsert,
+     "INSERT INTO groups (telegram_group_id, created_at, updated_at) "
+     "VALUES ($1, NOW(), NOW()) "
+     "ON CONFLICT (telegram_group_id) DO UPDATE SET updated_at = NOW()"},
+    {kGroupUpsertNamed,
+     "INSERT INTO groups (telegram_group_id, name, created_at, updated_at) "
+     "VALUES ($1, $2, NOW(), NOW()) "
+     "ON CONFLICT (telegram_group_id) DO UPDATE SET name = $2, updated_at = NOW()"},
+    {kGroupByTelegramId,
+     "SELECT " GROUP_COLUMNS "FROM groups WHERE telegram_group_id = $1"},
+    {kGroupById,
+     "SELECT " GROUP_COLUMNS "FROM groups WHERE id = $1"},
+    {kGroupMigrate,
+     "UPDATE groups SET telegram_group_id = $2, updated_at = NOW() "
+     "WHERE telegram_group_id = $1 "
+     "AND NOT EXISTS (SELECT 1 FROM groups WHERE telegram_group_id = $2)"},
+    {kGroupSetActive,
+     "UPDATE groups SET is_active = $2, updated_at = NOW() WHERE telegram_group_id = $1"},
+    {kGroupSetRatingSystem,
+     "UPDATE groups SET rating_system = $2, updated_at = NOW() WHERE telegram_group_id = $1"},
+    {kGroupSetKPolicy,
+     "UPDATE groups SET k_policy = $2::jsonb, updated_at = NOW() WHERE telegram_group_id = $1"},
+    {kGroupClearKPolicy,
+     "UPDATE groups SET k_policy = NULL, updated_at = NOW() WHERE telegram_group_id = $1"},
+
+    // group_players
+    {kGroupPlayerInsert,
+     "INSERT INTO group_players (group_id, player_id, current_elo, created_at, updated_at) "
+     "VALUES ($1, $2, 1500, NOW(), NOW()) "
+     "ON CONFLICT (group_id, player_id) DO NOTHING"},
+    {kGroupPlayerGet,
+     "SELECT " GROUP_PLAYER_COLUMNS "FROM group_players WHERE group_id = $1 AND player_id = $2"},
+    {kGroupPlayerLock,
+     "SELECT id, current_elo, matches_played, matches_won, matches_lost, version "
+     "FROM group_players "
+     "WHERE group_id = $1 AND player_id = $2 FOR UPDATE"},
+    {kGroupPlayerUpdateVersioned,
+     "UPDATE group_players SET "
+     "current_elo = $1, matches_played = $2, matches_won = $3, matches_lost = $4, "
+     "version = version + 1, updated_at = NOW() "
+     "WHERE id = $5 AND version = $6"},
+    {kGroupPlayerRankings,
+     "SELECT " GROUP_PLAYER_COLUMNS "FROM group_players "
+     "WHERE group_id = $1 ORDER BY current_elo DESC LIMIT $2"},
+    {kGroupPlayerElos,
+     "SELECT group_id, player_id, current_elo FROM group_players"},
+    {kGroupPlayerElosByGroup,
+     "SELECT group_id, player_id, current_elo FROM group_players WHERE group_id = $1"},
+    {kGroupPlayersLockGroup,
+     "SELECT player_id, current_elo, matches_played, matches_won, matches_lost, "
+     "rating_deviation, rating_volatility "
+     "FROM group_players WHERE group_id = $1 ORDER BY id FOR UPDATE"},
+    {kGroupPlayersUpdateRatings,
+     "UPDATE group_players gp SET "
+     "current_elo = u.elo, matches_played = u.played, matches_won = u.won, matches_lost = u.lost, "
+     "rating_deviation = u.deviation, rating_volatility = u.volatility, "
+     "version = gp.version + 1, updated_at = NOW() "
+     "FROM unnest($2::BIGINT[], $3::INTEGER[], $4::INTEGER[], $5::INTEGER[], $6::INTEGER[], "
+     "$7::DOUBLE PRECISION[], $8::DOUBLE PRECISION[]) "
+     "AS u(player_id, elo, played, won, lost, deviation, volatility) "
+     "WHERE gp.group_id = $1 AND gp.player_id = u.player_id"},
+
+    // group_topics
+    {kGroupTopicUpsert,
+     "INSERT INTO group_topics (group_id, telegram_topic_id, topic_type, is_active, created_at) "
+     "VALUES ($1, $2, $3, $4, NOW()) "
+     "ON CONFLICT (group_id, telegram_topic_id, topic_type) "
+     "DO UPDATE SET is_active = $4"},
+    {kGroupTopicUpsertNoThread,
+     "INSERT INTO group_topics (group_id, telegram_topic_id, topic_type, is_active, created_at) "
+     "VALUES ($1, NULL, $2, $3, NOW()) "
+     "ON CONFLICT (group_id, telegram_topic_id, topic_type) "
+     "DO UPDATE SET is_active = $3"},
+    {kGroupTopicGet,
+     "SELECT " GROUP_TOPIC_COLUMNS "FROM group_topics "
+     "WHERE group_id = $1 AND telegram_topic_id = $2 AND topic_type = $3"},
+    {kGroupTopicGetByType,
+     "SELECT " GROUP_TOPIC_COLUMNS "FROM group_topics WHERE group_id = $1 AND topic_type = $2"},
+    {kGroupTopicsByGroup,
+     "SELECT " GROUP_TOPIC_COLUMNS "FROM group_topics WHERE group_id = $1 ORDER BY id"},
+
+    // players
+    {kPlayerInsert,
+     "INSERT INTO players (telegram_user_id, created_at, updated_at) "
+     "VALUES ($1, NOW(), NOW()) "
+     "ON CONFLICT (telegram_user_id) WHERE deleted_at IS NULL DO NOTHING"},
+    {kPlayerByTelegramId,
+     "SELECT " PLAYER_COLUMNS "FROM players WHERE telegram_user_id = $1 AND deleted_at IS NULL"},
+    {kPlayerById,
+     "SELECT " PLAYER_COLUMNS "FROM players WHERE id = $1"},
+    {kPlayerUpdate,
+     "UPDATE players SET "
+     "school_nickname = $1, is_verified_student = $2, is_allowed_non_student = $3, "
+     "updated_at = NOW() "
+     "WHERE id = $4"},
+    {kPlayerUpdateNoNickname,
+     "UPDATE players SET "
+     "school_nickname = NULL, is_verified_student = $1, is_allowed_non_student = $2, "
+     "updated_at = NOW() "
+     "WHERE id = $3"},
+    {kPlayerCount,
+     "SELECT COUNT(*) as cnt FROM players WHERE id = $1"},
+    {kPlayerSoftDelete,
+     "UPDATE players SET deleted_at = NOW(), updated_at = NOW() "
+     "WHERE id = $1 AND deleted_at IS NULL"},
+
+    // matches
+    {kMatchInsert,
+     "INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score, "
+     "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
+     "idempotency_key, created_by_telegram_user_id, created_at, is_undone) "
+     "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), FALSE) "
+     "RETURNING id, created_at"},
+    {kMatchById,
+     "SELECT " MATCH_COLUMNS "FROM matches WHERE id = $1"},
+    {kMatchByIdempotencyKey,
+     "SELECT " MATCH_COLUMNS "FROM matches WHERE idempotency_key = $1"},
+    {kMatchesByGroup,
+     "SELECT " MATCH_COLUMNS "FROM matches "
+     "WHERE group_id = $1 ORDER BY created_at DESC LIMIT $2 OFFSET $3"},
+    {kMatchLock,
+     "SELECT id, group_id, player1_id, player2_id, player1_score, player2_score, "
+     "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, is_undone "
+     "FROM matches WHERE id = $1 FOR UPDATE"},
+    {kMatchMarkUndone,
+     "UPDATE matches SET "
+     "is_undone = TRUE, undone_at = NOW(), undone_by_telegram_user_id = $1 "
+     "WHERE id = $2 AND is_undone = FALSE"},
+    {kMatchRatings,
+     "SELECT COALESCE(gp.current_elo, 1500) AS current_elo, COALESCE(gp.version, 0) AS version, "
+     "COALESCE(gp.matches_played, 0) AS matches_played, "
+     "COALESCE(gp.rating_deviation, 350) AS rating_deviation, "
+     "COALESCE(gp.rating_volatility, 0.06) AS rating_volatility "
+     "FROM unnest(ARRAY[$2::BIGINT, $3::BIGINT]) WITH ORDINALITY AS u(telegram_user_id, ord) "
+     "LEFT JOIN groups g ON g.telegram_group_id = $1 "
+     "LEFT JOIN players p ON p.telegram_user_id = u.telegram_user_id AND p.deleted_at IS NULL "
+     "LEFT JOIN group_players gp ON gp.group_id = g.id AND gp.player_id = p.id "
+     "ORDER BY u.ord"},
+    {kRegisterMatch,
+     "SELECT match_id, group_id, player1_id, player2_id, player1_elo_before, "
+     "player2_elo_before, created_at "
+     "FROM register_match($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15, $16, $17, "
+     "NULLIF($18::INTEGER, 0), NULLIF($19::INTEGER, 0))"},
+    {kMatchHistory,
+     "SELECT id, player1_id, player2_id, player1_score, player2_score, "
+     "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, rating_system, "
+     "COALESCE(player1_k_factor, 0) AS player1_k_factor, COALESCE(player2_k_factor, 0) AS player2_k_factor "
+     "FROM matches WHERE group_id = $1 AND is_undone = FALSE ORDER BY created_at, id"},
+    {kMatchesUpdateRatings,
+     "UPDATE matches m SET "
+     "player1_elo_before = u.elo1_before, player2_elo_before = u.elo2_before, "
+     "player1_elo_after = u.elo1_after, player2_elo_after = u.elo2_after "
+     "FROM unnest($1::BIGINT[], $2::INTEGER[], $3::INTEGER[], $4::INTEGER[], $5::INTEGER[]) "
+     "AS u(id, elo1_before, elo2_before, elo1_after, elo2_after) "
+     "WHERE m.id = u.id"},
+
+    // elo_history
+    {kEloHistoryInsert,
+     "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
+     "elo_after, elo_change, created_at, is_undone) "
+     "VALUES ($1, $2, $3, $4, $5, $6, NOW(), $7)"},
+    {kEloHistoryInsertNoMatch,
+     "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
+     "elo_after, elo_change, created_at, is_undone) "
+     "VALUES (NULL, $1, $2, $3, $4, $5, NOW(), $6)"},
+    {kEloHistoryUpdateRatings,
+     "UPDATE elo_history h SET "
+     "elo_before = u.elo_before, elo_after = u.elo_after, elo_change = u.elo_after - u.elo_before "
+     "FROM unnest($1::BIGINT[], $2::BIGINT[], $3::INTEGER[], $4::INTEGER[]) "
+     "AS u(match_id, player_id, elo_before, elo_after) "
+     "WHERE h.match_id = u.match_id AND h.player_id = u.player_id AND h.is_undone = FALSE"},
+
+    // player_verifications
+    {kVerificationFresh,
+     "SELECT school_nickname, verification_status, "
+     "EXTRACT(EPOCH FROM expires_at)::BIGINT AS expires_at_epoch "
+     "FROM player_verifications "
+     "WHERE lower(school_nickname) = lower($1) AND expires_at > NOW() "
+     "ORDER BY expires_at DESC LIMIT 1"},
+    {kVerificationInsert,
+     "INSERT INTO player_verifications (player_id, group_id, school_nickname, "
+     "verification_status, telegram_message_id, verified_at, expires_at, created_at) "
+     "VALUES ($1, $2, $3, $4, $5, NOW(), NOW() + $6::BIGINT * INTERVAL '1 second', NOW())"},
+  };
+  return catalogue;
+}
+
+#undef GROUP_COLUMNS
+#undef GROUP_PLAYER_COLUMNS
+#undef GROUP_TOPIC_COLUMNS
+#undef PLAYER_COLUMNS
+#undef MATCH_COLUMNS
+
+int prepareStatements(pqxx::connection& conn) {
+  int prepared = 0;
+  for (const auto& statement : preparedStatements()) {
+    try {
+      conn.prepare(statement.name, statement.sql);
+      prepared++;
+    } catch (const std::exception& e) {
+      if (auto logger = observability::Logger::getInstance()) {
+        OBS_ERROR(logger, "Failed to prepare statement " + std::string(statement.name) +
+                          " - " + e.what());
+      }
+    }
+  }
+  return prepared;
+}
+
+observability::Histogram& statementLatency(const char* name) {
+  auto series = [](const char* statement) -> observability::Histogram& {
+    return observability::MetricsRegistry::getInstance().histogram(
+        "db_statement_duration_seconds", "Prepared statement latency", {{"statement", statement}});
+  };
+  // Built once and only read afterwards
+  static const auto catalogue = [&series]() {
+    std::unordered_map<std::string_view, observability::Histogram*> histograms;
+    for (const auto& statement : preparedStatements()) {
+      histograms.emplace(statement.name, &series(statement.name));
+    }
+    return histograms;
+  }();
+
+  auto it = catalogue.find(name);
+  return it != catalogue.end() ? *it->second : series(name);
+}
+
+observability::Span statementSpan(const char* name) {
+  auto span = observability::Tracer::getInstance().startSpan(name, observability::SpanKind::kClient);
+  span.setAttribute("db.system", "postgresql");
+  return span;
+}
+
+}  // namespace database
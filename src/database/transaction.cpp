@@ -31,10 +31,7 @@ Transaction::~Transaction() {
     }
   }
   
-  // Release connection back to pool
-  if (conn_ && pool_) {
-    pool_->release(conn_);
-  }
+  // conn_ returns to the pool after txn_ is destroyed (member order)
 }
 
 void Transaction::commit() {
@@ -1,27 +1,47 @@
 #include "observability/logger.h"
 
-#include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <cctype>
+#include <cerrno>
 #include <ctime>
 #include <mutex>
 #include <map>
-#include <nlohmann/json.hpp>
+#include <string_view>
+#include <unistd.h>
 
 namespace observability {
 
-std::shared_ptr<Logger> Logger::getInstance() {
-  // Use new directly since we're in a member function and have access to private constructor
-  static std::shared_ptr<Logger> instance(new Logger());
-  return instance;
-}
+namespace detail {
 
-void Logger::setLevel(LogLevel level) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  level_ = level;
+void appendJsonString(std::string& out, std::string_view value) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  out += '"';
+  for (char c : value) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\b': out += "\\b"; break;
+      case '\f': out += "\\f"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += kHex[(c >> 4) & 0xF];
+          out += kHex[c & 0xF];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
 }
 
-std::string Logger::levelToString(LogLevel level) const {
+}  // namespace detail
+
+namespace {
+
+const char* levelToString(LogLevel level) {
   switch (level) {
     case LogLevel::TRACE: return "TRACE";
     case LogLevel::DEBUG: return "DEBUG";
@@ -33,69 +53,224 @@ std::string Logger::levelToString(LogLevel level) const {
   }
 }
 
-std::string Logger::formatMessage(LogLevel level, const std::string& message,
-                                  const std::map<std::string, std::string>& context) const {
-  nlohmann::json log_entry;
-  
-  // Timestamp
-  auto now = std::time(nullptr);
-  auto tm = *std::gmtime(&now);
-  std::ostringstream oss;
-  oss << std::put_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
-  log_entry["timestamp"] = oss.str();
-  
-  log_entry["level"] = levelToString(level);
-  log_entry["message"] = message;
-  
-  // Add context
-  if (!context.empty()) {
-    for (const auto& [key, value] : context) {
-      log_entry[key] = value;
+// "YYYY-MM-DDTHH:MM:SSZ" of the current second, formatted once per second
+// per thread
+std::string_view currentTimestamp() {
+  thread_local std::time_t cached_second = -1;
+  thread_local char cached[32];
+  thread_local size_t cached_length = 0;
+
+  std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+  if (now != cached_second) {
+    std::tm tm{};
+    gmtime_r(&now, &tm);
+    cached_length = std::strftime(cached, sizeof(cached), "%Y-%m-%dT%H:%M:%SZ", &tm);
+    cached_second = now;
+  }
+  return std::string_view(cached, cached_length);
+}
+
+}  // namespace
+
+LogLevel logLevelFromString(std::string_view name, LogLevel fallback) {
+  std::string upper(name);
+  for (auto& c : upper) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+  for (auto level : {LogLevel::TRACE, LogLevel::DEBUG, LogLevel::INFO,
+                     LogLevel::WARN, LogLevel::ERROR, LogLevel::FATAL}) {
+    if (upper == levelToString(level)) {
+      return level;
     }
   }
-  
-  return log_entry.dump();
+  if (upper == "WARNING") {
+    return LogLevel::WARN;
+  }
+  return fallback;
 }
 
-void Logger::log(LogLevel level, const std::string& message) {
-  log(level, message, {});
+std::shared_ptr<Logger> Logger::getInstance() {
+  // Use new directly since we're in a member function and have access to private constructor
+  static std::shared_ptr<Logger> instance(new Logger());
+  return instance;
 }
 
-void Logger::log(LogLevel level, const std::string& message,
-                const std::map<std::string, std::string>& context) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  
-  if (level < level_) {
-    return;
+Logger::Logger() : fd_(STDOUT_FILENO) {
+  writer_ = std::thread([this]() { writerLoop(); });
+}
+
+Logger::~Logger() {
+  stopWriter();
+}
+
+void Logger::setLevel(LogLevel level) {
+  level_.store(level, std::memory_order_relaxed);
+}
+
+void Logger::setOverflowPolicy(OverflowPolicy policy, size_t sample_every) {
+  sample_every_.store(sample_every == 0 ? 1 : sample_every, std::memory_order_relaxed);
+  overflow_.store(policy, std::memory_order_relaxed);
+}
+
+void Logger::setOutput(int fd) {
+  flush();
+  fd_.store(fd, std::memory_order_relaxed);
+}
+
+Logger::Stats Logger::getStats() const {
+  Stats stats;
+  stats.written = written_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+std::string& Logger::beginLine(LogLevel level, std::string_view message) {
+  thread_local std::string line;
+  if (line.capacity() > kMaxRetainedLine) {
+    std::string().swap(line);
   }
-  
-  std::string formatted = formatMessage(level, message, context);
-  std::cout << formatted << std::endl;
+  line.clear();
+  line += "{\"timestamp\":\"";
+  line += currentTimestamp();
+  line += "\",\"level\":\"";
+  line += levelToString(level);
+  line += "\",\"message\":";
+  detail::appendJsonString(line, message);
+  return line;
 }
 
-void Logger::trace(const std::string& message) {
-  log(LogLevel::TRACE, message);
+void Logger::log(LogLevel level, std::string_view message,
+                 const std::map<std::string, std::string>& context) {
+  if (level < getLevel()) {
+    return;
+  }
+  std::string& line = beginLine(level, message);
+  for (const auto& [key, value] : context) {
+    line += ',';
+    detail::appendJsonString(line, key);
+    line += ':';
+    detail::appendJsonString(line, value);
+  }
+  commitLine(level, line);
 }
 
-void Logger::debug(const std::string& message) {
-  log(LogLevel::DEBUG, message);
+void Logger::commitLine(LogLevel level, std::string& line) {
+  line += "}\n";
+
+  bool wait = false;
+  while (!stopping_.load(std::memory_order_acquire)) {
+    if (queue_.tryPushWith([&line](std::string& slot) { slot.assign(line); })) {
+      // Pairs with the fence in writerLoop(): either the writer sees the
+      // record or we see it asleep
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (writer_sleeping_.load(std::memory_order_relaxed) &&
+          writer_sleeping_.exchange(false, std::memory_order_relaxed)) {
+        writer_sleeping_.notify_one();
+      }
+      if (level == LogLevel::FATAL) {
+        flush();
+      }
+      return;
+    }
+
+    if (!wait) {
+      auto policy = overflow_.load(std::memory_order_relaxed);
+      if (policy == OverflowPolicy::kSample) {
+        auto n = overflowed_.fetch_add(1, std::memory_order_relaxed);
+        wait = n % sample_every_.load(std::memory_order_relaxed) == 0;
+      } else {
+        wait = policy == OverflowPolicy::kBlock;
+      }
+      if (!wait) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+    std::this_thread::yield();
+  }
+
+  // Writer stopped: write inline
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  writeOut(line);
+  written_.fetch_add(1, std::memory_order_relaxed);
 }
 
-void Logger::info(const std::string& message) {
-  log(LogLevel::INFO, message);
+void Logger::flush() {
+  if (stopping_.load(std::memory_order_acquire) || std::this_thread::get_id() == writer_.get_id()) {
+    return;
+  }
+  auto target = queue_.pushed();
+  while (queue_.popped() < target) {
+    std::this_thread::yield();
+  }
+  // The writer pops and writes a batch under write_mutex_
+  std::lock_guard<std::mutex> lock(write_mutex_);
 }
 
-void Logger::warn(const std::string& message) {
-  log(LogLevel::WARN, message);
+void Logger::writerLoop() {
+  std::string batch;
+  auto append = [&batch](std::string& line) {
+    batch += line;
+    if (line.capacity() > kMaxRetainedLine) {
+      std::string().swap(line);
+    }
+  };
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      size_t count = 0;
+      while (count < kMaxBatch && queue_.tryPopWith(append)) {
+        ++count;
+      }
+      if (count > 0) {
+        writeOut(batch);
+        batch.clear();
+        written_.fetch_add(count, std::memory_order_release);
+        continue;
+      }
+    }
+
+    if (stopping_.load(std::memory_order_acquire)) {
+      // Producers that saw stopping_ late may still be publishing
+      if (queue_.pushed() == queue_.popped()) {
+        break;
+      }
+      std::this_thread::yield();
+      continue;
+    }
+
+    writer_sleeping_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!queue_.empty() || stopping_.load(std::memory_order_acquire)) {
+      writer_sleeping_.store(false, std::memory_order_relaxed);
+      continue;
+    }
+    writer_sleeping_.wait(true, std::memory_order_relaxed);
+  }
 }
 
-void Logger::error(const std::string& message) {
-  log(LogLevel::ERROR, message);
+void Logger::stopWriter() {
+  stopping_.store(true, std::memory_order_release);
+  writer_sleeping_.store(false, std::memory_order_relaxed);
+  writer_sleeping_.notify_one();
+  if (writer_.joinable()) {
+    writer_.join();
+  }
 }
 
-void Logger::fatal(const std::string& message) {
-  log(LogLevel::FATAL, message);
+void Logger::writeOut(std::string_view data) {
+  int fd = fd_.load(std::memory_order_relaxed);
+  size_t offset = 0;
+  while (offset < data.size()) {
+    ssize_t n = ::write(fd, data.data() + offset, data.size() - offset);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;  // Nowhere left to report it
+    }
+    offset += static_cast<size_t>(n);
+  }
 }
 
 }  // namespace observability
-
@@ -0,0 +1,318 @@
+#include "observability/metrics.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+namespace observability {
+
+namespace {
+
+void appendNumber(std::string& out, uint64_t value) {
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void appendNumber(std::string& out, double value) {
+  if (std::isnan(value)) {
+    out += "NaN";
+    return;
+  }
+  if (std::isinf(value)) {
+    out += value > 0 ? "+Inf" : "-Inf";
+    return;
+  }
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+// HELP text escapes '\' and newlines; label values also escape '"'
+void appendEscaped(std::string& out, std::string_view text, bool quote) {
+  for (char c : text) {
+    if (c == '\\') {
+      out += "\\\\";
+    } else if (c == '\n') {
+      out += "\\n";
+    } else if (c == '"' && quote) {
+      out += "\\\"";
+    } else {
+      out += c;
+    }
+  }
+}
+
+// `{a="x",b="y"}`, with an optional extra `le` label for histogram buckets
+void appendLabels(std::string& out, const MetricLabels& labels, std::string_view le = {}) {
+  if (labels.empty() && le.empty()) {
+    return;
+  }
+  out += '{';
+  bool first = true;
+  for (const auto& [name, value] : labels) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += name;
+    out += "=\"";
+    appendEscaped(out, value, true);
+    out += '"';
+  }
+  if (!le.empty()) {
+    if (!first) {
+      out += ',';
+    }
+    out += "le=\"";
+    out += le;
+    out += '"';
+  }
+  out += '}';
+}
+
+}  // namespace
+
+uint64_t Counter::value() const {
+  uint64_t total = 0;
+  for (const auto& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t Histogram::bucketUpperBound(size_t index) {
+  if (index < kSubBuckets) {
+    return index + 1;
+  }
+  int exponent = static_cast<int>(index / kSubBuckets) + kSubBucketBits - 1;
+  uint64_t sub = index % kSubBuckets;
+  return (kSubBuckets + sub + 1) << (exponent - kSubBucketBits);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+  Snapshot snapshot;
+  snapshot.buckets.assign(kBuckets, 0);
+  uint64_t sum_nanos = 0;
+  for (const auto& shard : shards_) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+      snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+    sum_nanos += shard.sum_nanos.load(std::memory_order_relaxed);
+  }
+  for (auto count : snapshot.buckets) {
+    snapshot.count += count;
+  }
+  snapshot.sum_seconds = static_cast<double>(sum_nanos) / 1e9;
+  return snapshot;
+}
+
+double Histogram::Snapshot::quantile(double q) const {
+  if (count == 0) {
+    return 0.0;
+  }
+  q = std::clamp(q, 0.0, 1.0);
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return static_cast<double>(bucketUpperBound(i)) / 1e6;
+    }
+  }
+  return static_cast<double>(bucketUpperBound(buckets.size() - 1)) / 1e6;
+}
+
+uint64_t Histogram::Snapshot::countBelow(uint64_t bound_micros) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < buckets.size() && bucketUpperBound(i) <= bound_micros; ++i) {
+    total += buckets[i];
+  }
+  return total;
+}
+
+MetricsRegistry::CallbackHandle& MetricsRegistry::CallbackHandle::operator=(CallbackHandle&& other) noexcept {
+  if (this != &other) {
+    reset();
+    registry_ = other.registry_;
+    name_ = std::move(other.name_);
+    labels_ = std::move(other.labels_);
+    id_ = other.id_;
+    other.registry_ = nullptr;
+  }
+  return *this;
+}
+
+void MetricsRegistry::CallbackHandle::reset() {
+  if (registry_) {
+    registry_->removeCallback(name_, labels_, id_);
+    registry_ = nullptr;
+  }
+}
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+  // Never destroyed: statics in other translation units record until exit
+  static auto* instance = new MetricsRegistry();
+  return *instance;
+}
+
+Counter& MetricsRegistry::counter(std::string_view name, std::string_view help, const MetricLabels& labels) {
+  return *seriesFor(name, help, labels, Type::kCounter).counter;
+}
+
+Gauge& MetricsRegistry::gauge(std::string_view name, std::string_view help, const MetricLabels& labels) {
+  auto& series = seriesFor(name, help, labels, Type::kGauge);
+  if (!series.gauge) {
+    throw std::invalid_argument("Metric " + std::string(name) + " is a callback gauge");
+  }
+  return *series.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(std::string_view name, std::string_view help, const MetricLabels& labels) {
+  return *seriesFor(name, help, labels, Type::kHistogram).histogram;
+}
+
+MetricsRegistry::CallbackHandle MetricsRegistry::gaugeCallback(std::string_view name, std::string_view help,
+                                                               const MetricLabels& labels,
+                                                               std::function<double()> read) {
+  if (!read) {
+    throw std::invalid_argument("Metric " + std::string(name) + " needs a callback");
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    it = families_.emplace(std::string(name), Family{Type::kGauge, std::string(help), {}}).first;
+  } else if (it->second.type != Type::kGauge) {
+    throw std::invalid_argument("Metric " + std::string(name) + " is registered with another type");
+  }
+
+  Series& series = it->second.series[labels];
+  if (series.gauge) {
+    throw std::invalid_argument("Metric " + std::string(name) + " is already a plain gauge");
+  }
+  series.callback = std::move(read);
+  series.callback_id = next_callback_id_++;
+
+  CallbackHandle handle;
+  handle.registry_ = this;
+  handle.name_ = std::string(name);
+  handle.labels_ = labels;
+  handle.id_ = series.callback_id;
+  return handle;
+}
+
+MetricsRegistry::Series& MetricsRegistry::seriesFor(std::string_view name, std::string_view help,
+                                                    const MetricLabels& labels, Type type) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto family = families_.find(name);
+    if (family != families_.end() && family->second.type == type) {
+      auto series = family->second.series.find(labels);
+      if (series != family->second.series.end()) {
+        return series->second;
+      }
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto family = families_.find(name);
+  if (family == families_.end()) {
+    family = families_.emplace(std::string(name), Family{type, std::string(help), {}}).first;
+  } else if (family->second.type != type) {
+    throw std::invalid_argument("Metric " + std::string(name) + " is registered with another type");
+  }
+
+  Series& series = family->second.series[labels];
+  if (!series.counter && !series.gauge && !series.histogram && !series.callback) {
+    switch (type) {
+      case Type::kCounter: series.counter = std::make_unique<Counter>(); break;
+      case Type::kGauge: series.gauge = std::make_unique<Gauge>(); break;
+      case Type::kHistogram: series.histogram = std::make_unique<Histogram>(); break;
+    }
+  }
+  return series;
+}
+
+void MetricsRegistry::removeCallback(const std::string& name, const MetricLabels& labels, uint64_t id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto family = families_.find(name);
+  if (family == families_.end()) {
+    return;
+  }
+  auto series = family->second.series.find(labels);
+  // A newer registration for the same series keeps it
+  if (series != family->second.series.end() && series->second.callback_id == id) {
+    family->second.series.erase(series);
+  }
+}
+
+std::string MetricsRegistry::render() const {
+  std::string out;
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  for (const auto& [name, family] : families_) {
+    if (family.series.empty()) {
+      continue;
+    }
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    appendEscaped(out, family.help, false);
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += family.type == Type::kCounter ? "counter" : family.type == Type::kGauge ? "gauge" : "histogram";
+    out += '\n';
+
+    for (const auto& [labels, series] : family.series) {
+      if (series.histogram) {
+        auto snapshot = series.histogram->snapshot();
+        for (int exponent = kFirstExportedExponent; exponent <= kLastExportedExponent; ++exponent) {
+          std::string le;
+          appendNumber(le, static_cast<double>(uint64_t{1} << exponent) / 1e6);
+          out += name;
+          out += "_bucket";
+          appendLabels(out, labels, le);
+          out += ' ';
+          appendNumber(out, snapshot.countBelow(uint64_t{1} << exponent));
+          out += '\n';
+        }
+        out += name;
+        out += "_bucket";
+        appendLabels(out, labels, "+Inf");
+        out += ' ';
+        appendNumber(out, snapshot.count);
+        out += '\n';
+        out += name;
+        out += "_sum";
+        appendLabels(out, labels);
+        out += ' ';
+        appendNumber(out, snapshot.sum_seconds);
+        out += '\n';
+        out += name;
+        out += "_count";
+        appendLabels(out, labels);
+        out += ' ';
+        appendNumber(out, snapshot.count);
+        out += '\n';
+        continue;
+      }
+
+      out += name;
+      appendLabels(out, labels);
+      out += ' ';
+      if (series.counter) {
+        appendNumber(out, series.counter->value());
+      } else if (series.gauge) {
+        appendNumber(out, series.gauge->value());
+      } else {
+        appendNumber(out, series.callback());
+      }
+      out += '\n';
+    }
+  }
+  return out;
+}
+
+}  // namespace observability
@@ -0,0 +1,408 @@
+#include "observability/tracing.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <curl/curl.h>
+#include "observability/logger.h"
+
+namespace observability {
+
+namespace {
+
+thread_local SpanContext t_current;
+
+uint64_t randomId() {
+  thread_local std::mt19937_64 engine([] {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device() ^
+           std::hash<std::thread::id>()(std::this_thread::get_id());
+  }());
+  uint64_t id;
+  do {
+    id = engine();
+  } while (id == 0);
+  return id;
+}
+
+template<size_t N>
+void fillRandom(std::array<uint8_t, N>& bytes) {
+  for (size_t i = 0; i < N; i += 8) {
+    uint64_t value = randomId();
+    std::memcpy(bytes.data() + i, &value, std::min<size_t>(8, N - i));
+  }
+}
+
+template<size_t N>
+void appendHex(std::string& out, const std::array<uint8_t, N>& bytes) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  for (uint8_t byte : bytes) {
+    out += kHex[byte >> 4];
+    out += kHex[byte & 0xF];
+  }
+}
+
+template<size_t N>
+bool isZero(const std::array<uint8_t, N>& bytes) {
+  for (uint8_t byte : bytes) {
+    if (byte != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t unixNanos(std::chrono::system_clock::time_point time) {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+// OTLP/JSON carries 64-bit integers as strings
+void appendQuotedNumber(std::string& out, uint64_t value) {
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out += '"';
+  out.append(buffer, result.ptr);
+  out += '"';
+}
+
+void appendAttributeValue(std::string& out, const AttributeValue& value) {
+  if (auto text = std::get_if<std::string>(&value)) {
+    out += "{\"stringValue\":";
+    detail::appendJsonString(out, *text);
+  } else if (auto number = std::get_if<int64_t>(&value)) {
+    out += "{\"intValue\":\"";
+    out += std::to_string(*number);
+    out += '"';
+  } else if (auto real = std::get_if<double>(&value)) {
+    out += "{\"doubleValue\":";
+    detail::appendJsonValue(out, *real);
+  } else {
+    out += "{\"boolValue\":";
+    out += std::get<bool>(value) ? "true" : "false";
+  }
+  out += '}';
+}
+
+size_t discardBody(void*, size_t size, size_t nmemb, void*) {
+  return size * nmemb;
+}
+
+}  // namespace
+
+bool SpanContext::valid() const {
+  return !isZero(trace_id);
+}
+
+std::string SpanContext::traceparent() const {
+  std::string header = "00-";
+  appendHex(header, trace_id);
+  header += '-';
+  appendHex(header, span_id);
+  header += sampled ? "-01" : "-00";
+  return header;
+}
+
+SpanContext currentContext() {
+  return t_current;
+}
+
+ContextScope::ContextScope(const SpanContext& context) : previous_(t_current) {
+  t_current = context;
+}
+
+ContextScope::~ContextScope() {
+  t_current = previous_;
+}
+
+Span::Span(Span&& other) noexcept
+    : tracer_(other.tracer_), context_(other.context_), data_(std::move(other.data_)), started_(other.started_) {
+  other.data_.reset();
+  other.tracer_ = nullptr;
+}
+
+Span& Span::operator=(Span&& other) noexcept {
+  if (this != &other) {
+    end();
+    tracer_ = other.tracer_;
+    context_ = other.context_;
+    data_ = std::move(other.data_);
+    started_ = other.started_;
+    other.data_.reset();
+    other.tracer_ = nullptr;
+  }
+  return *this;
+}
+
+void Span::setError(std::string_view message) {
+  if (data_) {
+    data_->status = SpanStatus::kError;
+    data_->status_message = std::string(message);
+  }
+}
+
+void Span::end() {
+  if (data_ && tracer_) {
+    // Duration from the monotonic clock, so wall-clock steps don't skew it
+    auto elapsed = std::chrono::steady_clock::now() - started_;
+    data_->end_unix_nanos = data_->start_unix_nanos +
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    tracer_->submit(std::move(*data_));
+  }
+  data_.reset();
+  tracer_ = nullptr;
+}
+
+ScopedSpan::ScopedSpan(std::string_view name, SpanKind kind)
+    : span_(Tracer::getInstance().startSpan(name, kind)), scope_(span_.context()) {}
+
+ScopedSpan::ScopedSpan(std::string_view name, SpanKind kind, const SpanContext& parent)
+    : span_(Tracer::getInstance().startSpan(name, kind, parent)), scope_(span_.context()) {}
+
+Tracer& Tracer::getInstance() {
+  // Never destroyed: spans may end during static destruction
+  static auto* instance = new Tracer();
+  return *instance;
+}
+
+Tracer::~Tracer() {
+  shutdown();
+}
+
+void Tracer::configure(Options options, Exporter exporter) {
+  shutdown();
+
+  double rate = std::clamp(options.sampling_rate, 0.0, 1.0);
+  sample_threshold_.store(rate >= 1.0 ? std::numeric_limits<uint64_t>::max()
+                                      : static_cast<uint64_t>(rate * 18446744073709551616.0),
+                          std::memory_order_relaxed);
+  max_batch_.store(std::max<size_t>(options.max_batch, 1), std::memory_order_relaxed);
+  options_ = std::move(options);
+  options_.max_batch = max_batch_.load(std::memory_order_relaxed);
+  if (options_.export_interval.count() <= 0) {
+    options_.export_interval = Options().export_interval;
+  }
+  exporter_ = std::move(exporter);
+
+  if (!options_.enabled || (!exporter_ && options_.endpoint.empty())) {
+    return;
+  }
+  if (!exporter_) {
+    // Not thread-safe before libcurl 7.84, so it runs on the configuring
+    // thread (like ApiClient and VerificationPool), never on the exporter
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    curl_global_ = true;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = false;
+  }
+  exporter_thread_ = std::thread([this]() { exportLoop(); });
+  enabled_.store(true, std::memory_order_release);
+}
+
+void Tracer::shutdown() {
+  enabled_.store(false, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_one();
+  if (exporter_thread_.joinable()) {
+    exporter_thread_.join();
+  }
+  if (curl_global_) {
+    curl_global_cleanup();
+    curl_global_ = false;
+  }
+}
+
+Span Tracer::startSpan(std::string_view name, SpanKind kind) {
+  return startSpan(name, kind, t_current);
+}
+
+Span Tracer::startSpan(std::string_view name, SpanKind kind, const SpanContext& parent) {
+  Span span;
+  if (parent.valid()) {
+    if (!parent.sampled || !isEnabled()) {
+      span.context_ = parent;  // Nothing to record; children stay in the trace
+      return span;
+    }
+    span.context_.trace_id = parent.trace_id;
+    span.context_.sampled = true;
+  } else {
+    if (!isEnabled()) {
+      return span;
+    }
+    // Head sampling: decided here for the whole trace
+    fillRandom(span.context_.trace_id);
+    uint64_t draw;
+    std::memcpy(&draw, span.context_.trace_id.data(), sizeof(draw));
+    uint64_t threshold = sample_threshold_.load(std::memory_order_relaxed);
+    span.context_.sampled = threshold == std::numeric_limits<uint64_t>::max() || draw < threshold;
+  }
+  fillRandom(span.context_.span_id);
+
+  if (span.context_.sampled) {
+    span.tracer_ = this;
+    span.started_ = std::chrono::steady_clock::now();
+    auto& data = span.data_.emplace();
+    data.context = span.context_;
+    if (parent.valid()) {
+      data.parent_span_id = parent.span_id;
+    }
+    data.name = std::string(name);
+    data.kind = kind;
+    data.start_unix_nanos = unixNanos(std::chrono::system_clock::now());
+  }
+  return span;
+}
+
+Tracer::Stats Tracer::getStats() const {
+  Stats stats;
+  stats.exported = exported_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void Tracer::submit(SpanData&& data) {
+  if (!queue_.tryPush(std::move(data))) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (queue_.pushed() - queue_.popped() >= max_batch_.load(std::memory_order_relaxed)) {
+    wake_.notify_one();
+  }
+}
+
+void Tracer::exportLoop() {
+  std::vector<SpanData> batch;
+  batch.reserve(options_.max_batch);
+
+  while (true) {
+    bool stop;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait_for(lock, options_.export_interval, [this] {
+        return stopping_ || queue_.pushed() - queue_.popped() >= options_.max_batch;
+      });
+      stop = stopping_;
+    }
+
+    SpanData data;
+    while (queue_.tryPop(data)) {
+      batch.push_back(std::move(data));
+      if (batch.size() >= options_.max_batch) {
+        exportBatch(batch);
+      }
+    }
+    if (!batch.empty()) {
+      exportBatch(batch);
+    }
+    if (stop) {
+      break;
+    }
+  }
+
+  if (curl_) {
+    curl_easy_cleanup(static_cast<CURL*>(curl_));
+    curl_ = nullptr;
+  }
+}
+
+void Tracer::exportBatch(std::vector<SpanData>& batch) {
+  std::string body = encode(batch, options_.service_name);
+  bool ok = exporter_ ? exporter_(body) : postOtlp(body);
+  if (ok) {
+    exported_.fetch_add(batch.size(), std::memory_order_relaxed);
+  } else {
+    dropped_.fetch_add(batch.size(), std::memory_order_relaxed);
+    OBS_WARN(Logger::getInstance(), "Trace export failed, dropping spans",
+             field<"spans">(batch.size()));
+  }
+  batch.clear();
+}
+
+bool Tracer::postOtlp(const std::string& body) {
+  if (!curl_) {
+    curl_ = curl_easy_init();
+    if (!curl_) {
+      return false;
+    }
+  }
+  // The handle is reused so the collector connection stays open between batches
+  CURL* curl = static_cast<CURL*>(curl_);
+  static curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+  curl_easy_setopt(curl, CURLOPT_URL, options_.endpoint.c_str());
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.data());
+  curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(body.size()));
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+  curl_easy_setopt(curl, CURLOPT_TIMEOUT, static_cast<long>(options_.export_timeout_seconds));
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+
+  CURLcode res = curl_easy_perform(curl);
+  long status = 0;
+  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+  return res == CURLE_OK && status >= 200 && status < 300;
+}
+
+std::string Tracer::encode(const std::vector<SpanData>& spans, std::string_view service_name) {
+  std::string out;
+  out.reserve(256 + spans.size() * 320);
+  out += "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\",\"value\":{\"stringValue\":";
+  detail::appendJsonString(out, service_name);
+  out += "}}]},\"scopeSpans\":[{\"scope\":{\"name\":";
+  detail::appendJsonString(out, service_name);
+  out += "},\"spans\":[";
+
+  bool first = true;
+  for (const auto& span : spans) {
+    if (!first) {
+      out += ',';
+    }
+    first = false;
+    out += "{\"traceId\":\"";
+    appendHex(out, span.context.trace_id);
+    out += "\",\"spanId\":\"";
+    appendHex(out, span.context.span_id);
+    out += '"';
+    if (!isZero(span.parent_span_id)) {
+      out += ",\"parentSpanId\":\"";
+      appendHex(out, span.parent_span_id);
+      out += '"';
+    }
+    out += ",\"name\":";
+    detail::appendJsonString(out, span.name);
+    out += ",\"kind\":";
+    out += std::to_string(static_cast<int>(span.kind));
+    out += ",\"startTimeUnixNano\":";
+    appendQuotedNumber(out, span.start_unix_nanos);
+    out += ",\"endTimeUnixNano\":";
+    appendQuotedNumber(out, span.end_unix_nanos);
+    out += ",\"attributes\":[";
+    for (size_t i = 0; i < span.attributes.size(); ++i) {
+      if (i > 0) {
+        out += ',';
+      }
+      out += "{\"key\":";
+      detail::appendJsonString(out, span.attributes[i].first);
+      out += ",\"value\":";
+      appendAttributeValue(out, span.attributes[i].second);
+      out += '}';
+    }
+    out += "],\"status\":{\"code\":";
+    out += std::to_string(static_cast<int>(span.status));
+    if (!span.status_message.empty()) {
+      out += ",\"message\":";
+      detail::appendJsonString(out, span.status_message);
+    }
+    out += "}}";
+  }
+  out += "]}]}]}";
+  return out;
+}
+
+}  // namespace observability
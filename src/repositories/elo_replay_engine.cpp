@@ -0,0 +1,182 @@
+#include "repositories/elo_replay_engine.h"
+#include "database/prepared_statements.h"
+#include "observability/logger.h"
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+namespace repositories {
+
+namespace {
+
+// Shortest text that reads back as the same double (std::to_string rounds
+// to six decimals)
+std::string toText(double value) {
+  char buffer[32];
+  auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  return std::string(buffer, end);
+}
+
+template<typename T>
+std::string toText(T value) {
+  return std::to_string(value);
+}
+
+// Postgres array literal ("{1,2,3}") for the unnest() batch updates
+template<typename T>
+std::string arrayLiteral(const std::vector<T>& values) {
+  std::string literal = "{";
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) {
+      literal += ',';
+    }
+    literal += toText(values[i]);
+  }
+  literal += '}';
+  return literal;
+}
+
+struct StoredPlayer {
+  int current_elo = 0;
+  int matches_played = 0;
+  int matches_won = 0;
+  int matches_lost = 0;
+  double rating_deviation = 0.0;
+  double rating_volatility = 0.0;
+};
+
+}  // namespace
+
+EloReplayEngine::EloReplayEngine(const utils::RatingEngine& engine, int initial_elo)
+    : engine_(&engine), initial_elo_(initial_elo) {}
+
+EloReplayEngine::EloReplayEngine(const utils::EloCalculator& calculator, int initial_elo)
+    : owned_engine_(std::make_unique<utils::EloEngine>(calculator)),
+      engine_(owned_engine_.get()),
+      initial_elo_(initial_elo) {}
+
+EloReplayEngine::Result EloReplayEngine::recompute(pqxx::work& work, int64_t group_id) {
+  auto started = std::chrono::steady_clock::now();
+  utils::EloReplay replay(*engine_, initial_elo_);
+  replay.setKFactorPolicy(k_policy_);
+  replay.setEngines(engines_);
+  Result outcome;
+
+  // 1. Lock the group's ratings; players without matches go back to initial
+  std::unordered_map<int64_t, StoredPlayer> stored;
+  auto locked = database::execPrepared(work, database::statements::kGroupPlayersLockGroup, group_id);
+  stored.reserve(locked.size());
+  for (const auto& row : locked) {
+    int64_t player_id = row["player_id"].as<int64_t>();
+    stored[player_id] = {row["current_elo"].as<int>(), row["matches_played"].as<int>(),
+                         row["matches_won"].as<int>(), row["matches_lost"].as<int>(),
+                         row["rating_deviation"].as<double>(), row["rating_volatility"].as<double>()};
+    replay.addPlayer(player_id);
+  }
+
+  // 2. Replay the history
+  auto history = database::execPrepared(work, database::statements::kMatchHistory, group_id);
+  std::vector<utils::ReplayMatch> matches;
+  std::vector<utils::ReplayedMatch> stored_ratings;
+  matches.reserve(history.size());
+  stored_ratings.reserve(history.size());
+  for (const auto& row : history) {
+    matches.push_back({row["id"].as<int64_t>(), row["player1_id"].as<int64_t>(),
+                       row["player2_id"].as<int64_t>(), row["player1_score"].as<int>(),
+                       row["player2_score"].as<int>(),
+                       utils::parseRatingSystem(row["rating_system"].as<std::string>()),
+                       row["player1_k_factor"].as<int>(), row["player2_k_factor"].as<int>()});
+    stored_ratings.push_back({row["player1_elo_before"].as<int>(), row["player2_elo_before"].as<int>(),
+                              row["player1_elo_after"].as<int>(), row["player2_elo_after"].as<int>()});
+  }
+  auto replayed = replay.replay(matches);
+  outcome.matches = matches.size();
+
+  // 3. Batch the matches (and their elo_history rows) whose ratings moved
+  std::vector<int64_t> match_ids;
+  std::vector<int> elo1_before, elo2_before, elo1_after, elo2_after;
+  std::vector<int64_t> history_match_ids, history_player_ids;
+  std::vector<int> history_before, history_after;
+  for (size_t i = 0; i < matches.size(); ++i) {
+    const auto& now = replayed[i];
+    const auto& was = stored_ratings[i];
+    if (now.player1_elo_before == was.player1_elo_before &&
+        now.player2_elo_before == was.player2_elo_before &&
+        now.player1_elo_after == was.player1_elo_after &&
+        now.player2_elo_after == was.player2_elo_after) {
+      continue;
+    }
+    match_ids.push_back(matches[i].match_id);
+    elo1_before.push_back(now.player1_elo_before);
+    elo2_before.push_back(now.player2_elo_before);
+    elo1_after.push_back(now.player1_elo_after);
+    elo2_after.push_back(now.player2_elo_after);
+
+    history_match_ids.push_back(matches[i].match_id);
+    history_player_ids.push_back(matches[i].player1_id);
+    history_before.push_back(now.player1_elo_before);
+    history_after.push_back(now.player1_elo_after);
+    history_match_ids.push_back(matches[i].match_id);
+    history_player_ids.push_back(matches[i].player2_id);
+    history_before.push_back(now.player2_elo_before);
+    history_after.push_back(now.player2_elo_after);
+  }
+  outcome.matches_changed = match_ids.size();
+
+  if (!match_ids.empty()) {
+    database::execPrepared(work, database::statements::kMatchesUpdateRatings,
+                       arrayLiteral(match_ids), arrayLiteral(elo1_before), arrayLiteral(elo2_before),
+                       arrayLiteral(elo1_after), arrayLiteral(elo2_after));
+    database::execPrepared(work, database::statements::kEloHistoryUpdateRatings,
+                       arrayLiteral(history_match_ids), arrayLiteral(history_player_ids),
+                       arrayLiteral(history_before), arrayLiteral(history_after));
+  }
+
+  // 4. Batch the group_players rows that changed
+  std::vector<int64_t> player_ids;
+  std::vector<int> elos, played, won, lost;
+  std::vector<double> deviations, volatilities;
+  for (const auto& player : replay.players()) {
+    auto it = stored.find(player.player_id);
+    if (it == stored.end()) {
+      // Match of a player without a group_players row; nothing to update
+      continue;
+    }
+    const auto& was = it->second;
+    if (was.current_elo == player.current_elo && was.matches_played == player.matches_played &&
+        was.matches_won == player.matches_won && was.matches_lost == player.matches_lost &&
+        was.rating_deviation == player.rating_deviation &&
+        was.rating_volatility == player.rating_volatility) {
+      continue;
+    }
+    player_ids.push_back(player.player_id);
+    elos.push_back(player.current_elo);
+    played.push_back(player.matches_played);
+    won.push_back(player.matches_won);
+    lost.push_back(player.matches_lost);
+    deviations.push_back(player.rating_deviation);
+    volatilities.push_back(player.rating_volatility);
+    outcome.changed_players.push_back(player);
+  }
+
+  if (!player_ids.empty()) {
+    database::execPrepared(work, database::statements::kGroupPlayersUpdateRatings, group_id,
+                       arrayLiteral(player_ids), arrayLiteral(elos), arrayLiteral(played),
+                       arrayLiteral(won), arrayLiteral(lost),
+                       arrayLiteral(deviations), arrayLiteral(volatilities));
+  }
+
+  auto elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - started).count();
+  if (auto logger = observability::Logger::getInstance()) {
+    OBS_INFO(logger, "EloReplayEngine::recompute - group_id=" + std::to_string(group_id) +
+                     " matches=" + std::to_string(outcome.matches) +
+                     " matches_changed=" + std::to_string(outcome.matches_changed) +
+                     " players_changed=" + std::to_string(outcome.changed_players.size()) +
+                     " elapsed_ms=" + std::to_string(elapsed_ms));
+  }
+  return outcome;
+}
+
+}  // namespace repositories
@@ -1,17 +1,23 @@
 #include "repositories/group_repository.h"
 #include "database/connection_pool.h"
+#include "database/prepared_statements.h"
 #include "database/transaction.h"
 #include "observability/logger.h"
+#include "repositories/entity_cache.h"
+#include "utils/k_factor_policy.h"
+#include "utils/rating_engine.h"
 #include "utils/validation.h"
 #include <stdexcept>
 #include <sstream>
 #include <iomanip>
+#include <unordered_map>
 #include <pqxx/pqxx>
 
 namespace repositories {
 
-GroupRepository::GroupRepository(std::shared_ptr<database::ConnectionPool> pool)
-    : pool_(pool) {
+GroupRepository::GroupRepository(std::shared_ptr<database::ConnectionPool> pool,
+                                 std::shared_ptr<EntityCache> cache)
+    : pool_(pool), cache_(std::move(cache)) {
   if (!pool_) {
     throw std::runtime_error("ConnectionPool is null");
   }
@@ -23,6 +29,14 @@ models::Group GroupRepository::createOrGet(int64_t telegram_group_id,
     throw std::invalid_argument("telegram_group_id cannot be zero");
   }
   
+  // A new name still has to be written
+  if (cache_) {
+    auto cached = cache_->groups.get(telegram_group_id);
+    if (cached && (name.empty() || cached->name == name)) {
+      return *cached;
+    }
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -33,41 +47,34 @@ models::Group GroupRepository::createOrGet(int64_t telegram_group_id,
     
     // Try to insert, update name if exists
     if (name.empty()) {
-      txn.exec_params(
-        "INSERT INTO groups (telegram_group_id, created_at, updated_at) "
-        "VALUES ($1, NOW(), NOW()) "
-        "ON CONFLICT (telegram_group_id) DO UPDATE SET updated_at = NOW()",
+      database::execPrepared(txn, database::statements::kGroupUpsert,
         telegram_group_id
       );
     } else {
-      txn.exec_params(
-        "INSERT INTO groups (telegram_group_id, name, created_at, updated_at) "
-        "VALUES ($1, $2, NOW(), NOW()) "
-        "ON CONFLICT (telegram_group_id) DO UPDATE SET name = $2, updated_at = NOW()",
+      database::execPrepared(txn, database::statements::kGroupUpsertNamed,
         telegram_group_id, name
       );
     }
     
     // Get the group (either newly created or existing)
-    auto result = txn.exec_params(
-      "SELECT id, telegram_group_id, name, created_at, updated_at, is_active "
-      "FROM groups "
-      "WHERE telegram_group_id = $1",
+    auto result = database::execPrepared(txn, database::statements::kGroupByTelegramId,
       telegram_group_id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       throw std::runtime_error("Failed to create or retrieve group");
     }
     
-    return rowToGroup(result[0]);
+    auto group = rowToGroup(result[0]);
+    if (cache_) {
+      cache_->groups.put(telegram_group_id, group);
+    }
+    return group;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in createOrGet: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in createOrGet: " + std::string(e.what()));
     throw;
   }
 }
@@ -78,6 +85,14 @@ std::optional<models::Group> GroupRepository::getByTelegramId(
     return std::nullopt;
   }
   
+  uint64_t snapshot = 0;
+  if (cache_) {
+    if (auto cached = cache_->groups.get(telegram_group_id)) {
+      return cached;
+    }
+    snapshot = cache_->groups.snapshot(telegram_group_id);
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -86,25 +101,24 @@ std::optional<models::Group> GroupRepository::getByTelegramId(
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, telegram_group_id, name, created_at, updated_at, is_active "
-      "FROM groups "
-      "WHERE telegram_group_id = $1",
+    auto result = database::execPrepared(txn, database::statements::kGroupByTelegramId,
       telegram_group_id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
     }
     
-    return rowToGroup(result[0]);
+    auto group = rowToGroup(result[0]);
+    if (cache_) {
+      cache_->groups.putIfUnchanged(telegram_group_id, group, snapshot);
+    }
+    return group;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getByTelegramId: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getByTelegramId: " + std::string(e.what()));
     throw;
   }
 }
@@ -122,15 +136,11 @@ std::optional<models::Group> GroupRepository::getById(int64_t id) {
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, telegram_group_id, name, created_at, updated_at, is_active "
-      "FROM groups "
-      "WHERE id = $1",
+    auto result = database::execPrepared(txn, database::statements::kGroupById,
       id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
@@ -138,9 +148,8 @@ std::optional<models::Group> GroupRepository::getById(int64_t id) {
     
     return rowToGroup(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getById: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getById: " + std::string(e.what()));
     throw;
   }
 }
@@ -151,6 +160,15 @@ models::GroupPlayer GroupRepository::getOrCreateGroupPlayer(
     throw std::invalid_argument("group_id and player_id must be positive");
   }
   
+  GroupPlayerKey key{group_id, player_id};
+  uint64_t snapshot = 0;
+  if (cache_) {
+    if (auto cached = cache_->group_players.get(key)) {
+      return *cached;
+    }
+    snapshot = cache_->group_players.snapshot(key);
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -160,34 +178,30 @@ models::GroupPlayer GroupRepository::getOrCreateGroupPlayer(
     pqxx::work txn(*conn);
     
     // Try to insert, ignore if already exists
-    txn.exec_params(
-      "INSERT INTO group_players (group_id, player_id, current_elo, created_at, updated_at) "
-      "VALUES ($1, $2, 1500, NOW(), NOW()) "
-      "ON CONFLICT (group_id, player_id) DO NOTHING",
+    database::execPrepared(txn, database::statements::kGroupPlayerInsert,
       group_id, player_id
     );
     
     // Get the group player (either newly created or existing)
-    auto result = txn.exec_params(
-      "SELECT id, group_id, player_id, current_elo, matches_played, "
-      "matches_won, matches_lost, version, created_at, updated_at "
-      "FROM group_players "
-      "WHERE group_id = $1 AND player_id = $2",
+    auto result = database::execPrepared(txn, database::statements::kGroupPlayerGet,
       group_id, player_id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       throw std::runtime_error("Failed to create or retrieve group player");
     }
     
-    return rowToGroupPlayer(result[0]);
+    auto group_player = rowToGroupPlayer(result[0]);
+    if (cache_) {
+      cache_->group_players.putIfUnchanged(key, group_player, snapshot);
+      cache_->leaderboard.addIfAbsent(group_id, player_id, group_player.current_elo);
+    }
+    return group_player;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getOrCreateGroupPlayer: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getOrCreateGroupPlayer: " + std::string(e.what()));
     throw;
   }
 }
@@ -195,8 +209,8 @@ models::GroupPlayer GroupRepository::getOrCreateGroupPlayer(
 bool GroupRepository::updateGroupPlayer(
     const models::GroupPlayer& group_player) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("GroupRepository::updateGroupPlayer called with group_player_id=" + std::to_string(group_player.id) + 
-                " elo=" + std::to_string(group_player.current_elo) + " version=" + std::to_string(group_player.version));
+  OBS_DEBUG(logger, "GroupRepository::updateGroupPlayer called with group_player_id=" + std::to_string(group_player.id) + 
+                    " elo=" + std::to_string(group_player.current_elo) + " version=" + std::to_string(group_player.version));
   
   // Input validation
   try {
@@ -220,14 +234,14 @@ bool GroupRepository::updateGroupPlayer(
       throw std::invalid_argument("version cannot be negative, got: " + std::to_string(group_player.version));
     }
   } catch (const std::invalid_argument& e) {
-    logger->error("GroupRepository::updateGroupPlayer - Invalid input: " + std::string(e.what()) + 
-                  " group_player_id=" + std::to_string(group_player.id));
+    OBS_ERROR(logger, "GroupRepository::updateGroupPlayer - Invalid input: " + std::string(e.what()) + 
+                      " group_player_id=" + std::to_string(group_player.id));
     throw;
   }
   
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("GroupRepository::updateGroupPlayer - Failed to acquire database connection");
+    OBS_ERROR(logger, "GroupRepository::updateGroupPlayer - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -235,15 +249,7 @@ bool GroupRepository::updateGroupPlayer(
     pqxx::work txn(*conn);
     
     // Optimistic locking: update with version check
-    auto result = txn.exec_params(
-      "UPDATE group_players SET "
-      "current_elo = $1, "
-      "matches_played = $2, "
-      "matches_won = $3, "
-      "matches_lost = $4, "
-      "version = version + 1, "
-      "updated_at = NOW() "
-      "WHERE id = $5 AND version = $6",
+    auto result = database::execPrepared(txn, database::statements::kGroupPlayerUpdateVersioned,
       group_player.current_elo,
       group_player.matches_played,
       group_player.matches_won,
@@ -253,33 +259,43 @@ bool GroupRepository::updateGroupPlayer(
     );
     
     txn.commit();
-    pool_->release(conn);
     
     bool success = result.affected_rows() > 0;
+    if (cache_) {
+      GroupPlayerKey key{group_player.group_id, group_player.player_id};
+      if (success) {
+        // Write-through: the row now holds these values at the next version
+        models::GroupPlayer updated = group_player;
+        updated.version = group_player.version + 1;
+        updated.updated_at = std::chrono::system_clock::now();
+        cache_->group_players.put(key, updated);
+        cache_->leaderboard.update(group_player.group_id, group_player.player_id,
+                                   group_player.current_elo);
+      } else {
+        cache_->group_players.erase(key);
+      }
+    }
     if (success) {
-      logger->info("GroupRepository::updateGroupPlayer - Successfully updated group_player_id=" + 
-                   std::to_string(group_player.id) + " new_elo=" + std::to_string(group_player.current_elo));
+      OBS_INFO(logger, "GroupRepository::updateGroupPlayer - Successfully updated group_player_id=" + 
+                       std::to_string(group_player.id) + " new_elo=" + std::to_string(group_player.current_elo));
     } else {
-      logger->warn("GroupRepository::updateGroupPlayer - Optimistic lock conflict: group_player_id=" + 
-                    std::to_string(group_player.id) + " version=" + std::to_string(group_player.version));
+      OBS_WARN(logger, "GroupRepository::updateGroupPlayer - Optimistic lock conflict: group_player_id=" + 
+                        std::to_string(group_player.id) + " version=" + std::to_string(group_player.version));
     }
     
     // Return true if any rows were affected (optimistic lock succeeded)
     return success;
   } catch (const pqxx::check_violation& e) {
-    pool_->release(conn);
-    logger->error("GroupRepository::updateGroupPlayer - Check constraint violation: " + std::string(e.what()) + 
-                  " group_player_id=" + std::to_string(group_player.id) + " elo=" + std::to_string(group_player.current_elo));
+    OBS_ERROR(logger, "GroupRepository::updateGroupPlayer - Check constraint violation: " + std::string(e.what()) + 
+                      " group_player_id=" + std::to_string(group_player.id) + " elo=" + std::to_string(group_player.current_elo));
     throw std::runtime_error("ELO value violates database constraints: " + std::string(e.what()));
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("GroupRepository::updateGroupPlayer - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
-                  " group_player_id=" + std::to_string(group_player.id));
+    OBS_ERROR(logger, "GroupRepository::updateGroupPlayer - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
+                      " group_player_id=" + std::to_string(group_player.id));
     throw std::runtime_error("Database error in updateGroupPlayer: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("GroupRepository::updateGroupPlayer - Error: " + std::string(e.what()) + 
-                  " group_player_id=" + std::to_string(group_player.id));
+    OBS_ERROR(logger, "GroupRepository::updateGroupPlayer - Error: " + std::string(e.what()) + 
+                      " group_player_id=" + std::to_string(group_player.id));
     throw;
   }
 }
@@ -302,18 +318,11 @@ std::vector<models::GroupPlayer> GroupRepository::getRankings(
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, group_id, player_id, current_elo, matches_played, "
-      "matches_won, matches_lost, version, created_at, updated_at "
-      "FROM group_players "
-      "WHERE group_id = $1 "
-      "ORDER BY current_elo DESC "
-      "LIMIT $2",
+    auto result = database::execPrepared(txn, database::statements::kGroupPlayerRankings,
       group_id, limit
     );
     
     txn.commit();
-    pool_->release(conn);
     
     std::vector<models::GroupPlayer> rankings;
     rankings.reserve(result.size());
@@ -324,31 +333,30 @@ std::vector<models::GroupPlayer> GroupRepository::getRankings(
     
     return rankings;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getRankings: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getRankings: " + std::string(e.what()));
     throw;
   }
 }
 
 void GroupRepository::configureTopic(const models::GroupTopic& topic) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("GroupRepository::configureTopic called with group_id=" + std::to_string(topic.group_id) + 
-                " topic_type=" + topic.topic_type);
+  OBS_DEBUG(logger, "GroupRepository::configureTopic called with group_id=" + std::to_string(topic.group_id) + 
+                    " topic_type=" + topic.topic_type);
   
   // Input validation
   try {
     utils::validateId(topic.group_id, "topic.group_id");
     utils::validateTopicType(topic.topic_type);
   } catch (const std::invalid_argument& e) {
-    logger->error("GroupRepository::configureTopic - Invalid input: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(topic.group_id));
+    OBS_ERROR(logger, "GroupRepository::configureTopic - Invalid input: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(topic.group_id));
     throw;
   }
   
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("GroupRepository::configureTopic - Failed to acquire database connection");
+    OBS_ERROR(logger, "GroupRepository::configureTopic - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -356,22 +364,14 @@ void GroupRepository::configureTopic(const models::GroupTopic& topic) {
     pqxx::work txn(*conn);
     
     if (topic.telegram_topic_id.has_value()) {
-      txn.exec_params(
-        "INSERT INTO group_topics (group_id, telegram_topic_id, topic_type, is_active, created_at) "
-        "VALUES ($1, $2, $3, $4, NOW()) "
-        "ON CONFLICT (group_id, telegram_topic_id, topic_type) "
-        "DO UPDATE SET is_active = $4",
+      database::execPrepared(txn, database::statements::kGroupTopicUpsert,
         topic.group_id,
         topic.telegram_topic_id.value(),
         topic.topic_type,
         topic.is_active
       );
     } else {
-      txn.exec_params(
-        "INSERT INTO group_topics (group_id, telegram_topic_id, topic_type, is_active, created_at) "
-        "VALUES ($1, NULL, $2, $3, NOW()) "
-        "ON CONFLICT (group_id, telegram_topic_id, topic_type) "
-        "DO UPDATE SET is_active = $3",
+      database::execPrepared(txn, database::statements::kGroupTopicUpsertNoThread,
         topic.group_id,
         topic.topic_type,
         topic.is_active
@@ -379,18 +379,18 @@ void GroupRepository::configureTopic(const models::GroupTopic& topic) {
     }
     
     txn.commit();
-    pool_->release(conn);
-    logger->info("GroupRepository::configureTopic - Successfully configured topic group_id=" + 
-                 std::to_string(topic.group_id) + " topic_type=" + topic.topic_type);
+    if (cache_) {
+      cache_->topics.erase(topic.group_id);
+    }
+    OBS_INFO(logger, "GroupRepository::configureTopic - Successfully configured topic group_id=" + 
+                     std::to_string(topic.group_id) + " topic_type=" + topic.topic_type);
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("GroupRepository::configureTopic - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
-                  " group_id=" + std::to_string(topic.group_id));
+    OBS_ERROR(logger, "GroupRepository::configureTopic - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
+                      " group_id=" + std::to_string(topic.group_id));
     throw std::runtime_error("Database error in configureTopic: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("GroupRepository::configureTopic - Error: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(topic.group_id));
+    OBS_ERROR(logger, "GroupRepository::configureTopic - Error: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(topic.group_id));
     throw;
   }
 }
@@ -401,6 +401,15 @@ std::optional<models::GroupTopic> GroupRepository::getTopic(
     return std::nullopt;
   }
   
+  if (cache_) {
+    for (const auto& topic : cachedTopics(group_id)) {
+      if (topic.telegram_topic_id == telegram_topic_id && topic.topic_type == topic_type) {
+        return topic;
+      }
+    }
+    return std::nullopt;
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -409,15 +418,11 @@ std::optional<models::GroupTopic> GroupRepository::getTopic(
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, group_id, telegram_topic_id, topic_type, is_active, created_at "
-      "FROM group_topics "
-      "WHERE group_id = $1 AND telegram_topic_id = $2 AND topic_type = $3",
+    auto result = database::execPrepared(txn, database::statements::kGroupTopicGet,
       group_id, telegram_topic_id, topic_type
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
@@ -425,9 +430,8 @@ std::optional<models::GroupTopic> GroupRepository::getTopic(
     
     return rowToGroupTopic(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getTopic: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getTopic: " + std::string(e.what()));
     throw;
   }
 }
@@ -438,6 +442,15 @@ std::optional<models::GroupTopic> GroupRepository::getTopicByType(
     return std::nullopt;
   }
 
+  if (cache_) {
+    for (const auto& topic : cachedTopics(group_id)) {
+      if (topic.topic_type == topic_type) {
+        return topic;
+      }
+    }
+    return std::nullopt;
+  }
+
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -446,15 +459,11 @@ std::optional<models::GroupTopic> GroupRepository::getTopicByType(
   try {
     pqxx::work txn(*conn);
 
-    auto result = txn.exec_params(
-      "SELECT id, group_id, telegram_topic_id, topic_type, is_active, created_at "
-      "FROM group_topics "
-      "WHERE group_id = $1 AND topic_type = $2",
+    auto result = database::execPrepared(txn, database::statements::kGroupTopicGetByType,
       group_id, topic_type
     );
 
     txn.commit();
-    pool_->release(conn);
 
     if (result.empty()) {
       return std::nullopt;
@@ -462,9 +471,338 @@ std::optional<models::GroupTopic> GroupRepository::getTopicByType(
 
     return rowToGroupTopic(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getTopicByType: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getTopicByType: " + std::string(e.what()));
+    throw;
+  }
+}
+
+bool GroupRepository::migrateTelegramId(int64_t old_telegram_group_id,
+                                        int64_t new_telegram_group_id) {
+  if (old_telegram_group_id == 0 || new_telegram_group_id == 0) {
+    throw std::invalid_argument("telegram_group_id cannot be zero");
+  }
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupMigrate,
+      old_telegram_group_id, new_telegram_group_id
+    );
+    
+    txn.commit();
+    
+    if (cache_) {
+      cache_->groups.erase(old_telegram_group_id);
+      cache_->groups.erase(new_telegram_group_id);
+    }
+    
+    return result.affected_rows() > 0;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in migrateTelegramId: " + std::string(e.what()));
+    throw;
+  }
+}
+
+bool GroupRepository::setActive(int64_t telegram_group_id, bool is_active) {
+  if (telegram_group_id == 0) {
+    throw std::invalid_argument("telegram_group_id cannot be zero");
+  }
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupSetActive,
+      telegram_group_id, is_active
+    );
+    
+    txn.commit();
+    
+    if (cache_) {
+      cache_->groups.erase(telegram_group_id);
+    }
+    
+    return result.affected_rows() > 0;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in setActive: " + std::string(e.what()));
+    throw;
+  }
+}
+
+bool GroupRepository::setRatingSystem(int64_t telegram_group_id,
+                                      const std::string& rating_system) {
+  if (telegram_group_id == 0) {
+    throw std::invalid_argument("telegram_group_id cannot be zero");
+  }
+  if (!utils::parseRatingSystem(rating_system)) {
+    throw std::invalid_argument("Unknown rating system: " + rating_system);
+  }
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupSetRatingSystem,
+      telegram_group_id, rating_system
+    );
+    
+    txn.commit();
+    
+    if (cache_) {
+      cache_->groups.erase(telegram_group_id);
+    }
+    
+    return result.affected_rows() > 0;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in setRatingSystem: " + std::string(e.what()));
+    throw;
+  }
+}
+
+bool GroupRepository::setKFactorPolicy(int64_t telegram_group_id, const std::string& policy_json) {
+  if (telegram_group_id == 0) {
+    throw std::invalid_argument("telegram_group_id cannot be zero");
+  }
+  // Validate and store the normalized form (sorted bands, every field set)
+  std::string normalized =
+      utils::KFactorPolicy::fromJson(policy_json, utils::KFactorPolicy{}).toJson().dump();
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupSetKPolicy,
+      telegram_group_id, normalized
+    );
+    
+    txn.commit();
+    
+    if (cache_) {
+      cache_->groups.erase(telegram_group_id);
+    }
+    
+    return result.affected_rows() > 0;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in setKFactorPolicy: " + std::string(e.what()));
+    throw;
+  }
+}
+
+bool GroupRepository::clearKFactorPolicy(int64_t telegram_group_id) {
+  if (telegram_group_id == 0) {
+    throw std::invalid_argument("telegram_group_id cannot be zero");
+  }
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupClearKPolicy,
+      telegram_group_id
+    );
+    
+    txn.commit();
+    
+    if (cache_) {
+      cache_->groups.erase(telegram_group_id);
+    }
+    
+    return result.affected_rows() > 0;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in clearKFactorPolicy: " + std::string(e.what()));
+    throw;
+  }
+}
+
+void GroupRepository::groupPlayerChanged(int64_t group_id, int64_t player_id,
+                                         int current_elo) {
+  if (cache_) {
+    cache_->group_players.erase({group_id, player_id});
+    cache_->leaderboard.update(group_id, player_id, current_elo);
+  }
+}
+
+size_t GroupRepository::rebuildLeaderboard() {
+  if (!cache_) {
+    return 0;
+  }
+  
+  auto token = cache_->leaderboard.clear();
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    auto result = database::execPrepared(txn, database::statements::kGroupPlayerElos);
+    txn.commit();
+    
+    std::unordered_map<int64_t, std::vector<std::pair<int64_t, int>>> groups;
+    for (const auto& row : result) {
+      groups[row["group_id"].as<int64_t>()].emplace_back(
+          row["player_id"].as<int64_t>(), row["current_elo"].as<int>());
+    }
+    
+    size_t loaded = 0;
+    for (const auto& [group_id, players] : groups) {
+      // Groups skipped here (a match landed meanwhile) load on first query
+      if (cache_->leaderboard.loadGroup(group_id, players, token)) {
+        loaded++;
+      }
+    }
+    return loaded;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in rebuildLeaderboard: " + std::string(e.what()));
+    throw;
+  }
+}
+
+template<typename Query>
+auto GroupRepository::withLeaderboard(int64_t group_id, Query query) {
+  if (cache_) {
+    if (auto cached = cache_->leaderboard.tryQuery(group_id, query)) {
+      return std::move(*cached);
+    }
+  }
+  
+  Leaderboard local;
+  auto token = cache_ ? cache_->leaderboard.loadToken(group_id) : local.loadToken(group_id);
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  std::vector<std::pair<int64_t, int>> players;
+  try {
+    pqxx::work txn(*conn);
+    auto result = database::execPrepared(txn, database::statements::kGroupPlayerElosByGroup, group_id);
+    txn.commit();
+    
+    players.reserve(result.size());
+    for (const auto& row : result) {
+      players.emplace_back(row["player_id"].as<int64_t>(), row["current_elo"].as<int>());
+    }
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error loading leaderboard: " + std::string(e.what()));
+    throw;
+  }
+  
+  if (cache_ && cache_->leaderboard.loadGroup(group_id, players, token)) {
+    // A clear() may still land before this query; then answer from the read below
+    if (auto cached = cache_->leaderboard.tryQuery(group_id, query)) {
+      return std::move(*cached);
+    }
+  }
+  // Raced with a rating write: answer from this read without installing it
+  local.loadGroup(group_id, players, local.loadToken(group_id));
+  return std::move(*local.tryQuery(group_id, query));
+}
+
+std::vector<Leaderboard::Entry> GroupRepository::getLeaderboard(int64_t group_id, int limit) {
+  if (group_id <= 0) {
+    return {};
+  }
+  if (limit <= 0) {
+    limit = 10;
+  }
+  return withLeaderboard(group_id, [&](const Leaderboard::GroupView& board) {
+    return board.top(limit);
+  });
+}
+
+std::optional<Leaderboard::Entry> GroupRepository::getPlayerRank(int64_t group_id,
+                                                                 int64_t player_id) {
+  if (group_id <= 0 || player_id <= 0) {
+    return std::nullopt;
+  }
+  return withLeaderboard(group_id, [&](const Leaderboard::GroupView& board) {
+    return board.rankOf(player_id);
+  });
+}
+
+std::vector<Leaderboard::Entry> GroupRepository::getPlayersAround(int64_t group_id,
+                                                                  int64_t player_id,
+                                                                  int radius) {
+  if (group_id <= 0 || player_id <= 0) {
+    return {};
+  }
+  return withLeaderboard(group_id, [&](const Leaderboard::GroupView& board) {
+    return board.around(player_id, radius);
+  });
+}
+
+utils::ShardedLruCache<int64_t, std::vector<models::GroupTopic>>::Stats
+GroupRepository::topicCacheStats() const {
+  if (!cache_) {
+    return {};
+  }
+  return cache_->topics.stats();
+}
+
+std::vector<models::GroupTopic> GroupRepository::cachedTopics(int64_t group_id) {
+  if (auto cached = cache_->topics.get(group_id)) {
+    return std::move(*cached);
+  }
+  auto snapshot = cache_->topics.snapshot(group_id);
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kGroupTopicsByGroup,
+      group_id
+    );
+    
+    txn.commit();
+    
+    std::vector<models::GroupTopic> topics;
+    topics.reserve(result.size());
+    for (const auto& row : result) {
+      topics.push_back(rowToGroupTopic(row));
+    }
+    
+    // Groups without topic configuration are cached too (empty list)
+    cache_->topics.putIfUnchanged(group_id, topics, snapshot);
+    return topics;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in cachedTopics: " + std::string(e.what()));
     throw;
   }
 }
@@ -479,6 +817,10 @@ models::Group GroupRepository::rowToGroup(const pqxx::row& row) {
   }
   
   group.is_active = row["is_active"].as<bool>();
+  group.rating_system = row["rating_system"].as<std::string>();
+  if (!row["k_policy"].is_null()) {
+    group.k_policy = row["k_policy"].as<std::string>();
+  }
   
   // Parse timestamps
   auto parseTimestamp = [](const std::string& timestamp_str) -> std::chrono::system_clock::time_point {
@@ -515,6 +857,8 @@ models::GroupPlayer GroupRepository::rowToGroupPlayer(const pqxx::row& row) {
   gp.matches_won = row["matches_won"].as<int>();
   gp.matches_lost = row["matches_lost"].as<int>();
   gp.version = row["version"].as<int>();
+  gp.rating_deviation = row["rating_deviation"].as<double>();
+  gp.rating_volatility = row["rating_volatility"].as<double>();
   
   // Parse timestamps
   auto parseTimestamp = [](const std::string& timestamp_str) -> std::chrono::system_clock::time_point {
@@ -0,0 +1,198 @@
+#include "repositories/leaderboard.h"
+#include "utils/validation.h"
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+
+namespace repositories {
+
+Leaderboard::Board::Board() : counts(utils::MAX_ELO + 1) {}
+
+void Leaderboard::Board::set(int64_t player_id, int elo) {
+  auto it = elo_by_player.find(player_id);
+  if (it != elo_by_player.end()) {
+    if (it->second == elo) {
+      return;
+    }
+    counts.add(it->second, -1);
+    auto bucket = players_by_elo.find(it->second);
+    bucket->second.erase(player_id);
+    if (bucket->second.empty()) {
+      players_by_elo.erase(bucket);
+    }
+    it->second = elo;
+  } else {
+    elo_by_player.emplace(player_id, elo);
+  }
+  counts.add(elo, 1);
+  players_by_elo[elo].insert(player_id);
+}
+
+int Leaderboard::Board::rankOf(int elo) const {
+  return static_cast<int>(counts.suffixSumAfter(elo)) + 1;
+}
+
+int Leaderboard::clampElo(int elo) {
+  return std::clamp(elo, utils::MIN_ELO, utils::MAX_ELO);
+}
+
+const Leaderboard::Board* Leaderboard::find(int64_t group_id) const {
+  auto it = boards_.find(group_id);
+  return it == boards_.end() ? nullptr : it->second.get();
+}
+
+Leaderboard::LoadToken Leaderboard::loadToken(int64_t group_id) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = versions_.find(group_id);
+  return {generation_, it == versions_.end() ? 0 : it->second};
+}
+
+bool Leaderboard::loadGroup(int64_t group_id,
+                            const std::vector<std::pair<int64_t, int>>& players,
+                            LoadToken token) {
+  // Build outside the lock; a group is a few hundred players at most
+  auto board = std::make_unique<Board>();
+  for (const auto& [player_id, elo] : players) {
+    board->set(player_id, clampElo(elo));
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto version = versions_.find(group_id);
+  if (generation_ != token.generation ||
+      (version == versions_.end() ? 0 : version->second) != token.version) {
+    return false;
+  }
+  boards_[group_id] = std::move(board);
+  return true;
+}
+
+bool Leaderboard::hasGroup(int64_t group_id) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return find(group_id) != nullptr;
+}
+
+Leaderboard::LoadToken Leaderboard::clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  boards_.clear();
+  versions_.clear();
+  generation_++;
+  return {generation_, 0};
+}
+
+void Leaderboard::update(int64_t group_id, int64_t player_id, int elo) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  versions_[group_id]++;
+  auto it = boards_.find(group_id);
+  if (it != boards_.end()) {
+    it->second->set(player_id, clampElo(elo));
+  }
+}
+
+void Leaderboard::addIfAbsent(int64_t group_id, int64_t player_id, int elo) {
+  // Reads are not writes: they leave versions_ alone, so they never fail a load
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = boards_.find(group_id);
+  if (it != boards_.end() && !it->second->elo_by_player.count(player_id)) {
+    it->second->set(player_id, clampElo(elo));
+  }
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::GroupView::top(int limit) const {
+  std::vector<Entry> entries;
+  const Board* board = &board_;
+  if (limit <= 0) {
+    return entries;
+  }
+
+  entries.reserve(std::min<size_t>(limit, board->elo_by_player.size()));
+  int rank = 1;
+  for (const auto& [elo, players] : board->players_by_elo) {
+    for (int64_t player_id : players) {
+      if (static_cast<int>(entries.size()) == limit) {
+        return entries;
+      }
+      entries.push_back({player_id, elo, rank});
+    }
+    rank += static_cast<int>(players.size());
+  }
+  return entries;
+}
+
+std::optional<Leaderboard::Entry> Leaderboard::GroupView::rankOf(int64_t player_id) const {
+  const Board* board = &board_;
+  auto it = board->elo_by_player.find(player_id);
+  if (it == board->elo_by_player.end()) {
+    return std::nullopt;
+  }
+  return Entry{player_id, it->second, board->rankOf(it->second)};
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::GroupView::around(int64_t player_id, int radius) const {
+  std::vector<Entry> entries;
+  const Board* board = &board_;
+  if (radius < 0) {
+    return entries;
+  }
+  auto it = board->elo_by_player.find(player_id);
+  if (it == board->elo_by_player.end()) {
+    return entries;
+  }
+
+  // Walk up from the player, then down, over (elo, player_id) in rank order
+  auto bucket = board->players_by_elo.find(it->second);
+  std::vector<Entry> above;
+  {
+    auto b = bucket;
+    auto p = b->second.find(player_id);
+    while (static_cast<int>(above.size()) < radius) {
+      if (p == b->second.begin()) {
+        if (b == board->players_by_elo.begin()) {
+          break;
+        }
+        --b;
+        p = b->second.end();
+      }
+      --p;
+      above.push_back({*p, b->first, board->rankOf(b->first)});
+    }
+  }
+  entries.assign(above.rbegin(), above.rend());
+  entries.push_back({player_id, it->second, board->rankOf(it->second)});
+  {
+    auto b = bucket;
+    auto p = std::next(b->second.find(player_id));
+    int below = 0;
+    while (below < radius) {
+      if (p == b->second.end()) {
+        ++b;
+        if (b == board->players_by_elo.end()) {
+          break;
+        }
+        p = b->second.begin();
+      }
+      entries.push_back({*p, b->first, board->rankOf(b->first)});
+      ++p;
+      below++;
+    }
+  }
+  return entries;
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::top(int64_t group_id, int limit) const {
+  return tryQuery(group_id, [&](const GroupView& group) { return group.top(limit); })
+      .value_or(std::vector<Entry>{});
+}
+
+std::optional<Leaderboard::Entry> Leaderboard::rankOf(int64_t group_id,
+                                                      int64_t player_id) const {
+  return tryQuery(group_id, [&](const GroupView& group) { return group.rankOf(player_id); })
+      .value_or(std::nullopt);
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::around(int64_t group_id, int64_t player_id,
+                                                    int radius) const {
+  return tryQuery(group_id, [&](const GroupView& group) { return group.around(player_id, radius); })
+      .value_or(std::vector<Entry>{});
+}
+
+}  // namespace repositories
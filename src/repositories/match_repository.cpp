@@ -1,7 +1,10 @@
 #include "repositories/match_repository.h"
 #include "database/connection_pool.h"
+#include "database/prepared_statements.h"
 #include "database/transaction.h"
 #include "observability/logger.h"
+#include "repositories/entity_cache.h"
+#include "utils/retry.h"
 #include "utils/validation.h"
 #include <stdexcept>
 #include <sstream>
@@ -10,8 +13,9 @@
 
 namespace repositories {
 
-MatchRepository::MatchRepository(std::shared_ptr<database::ConnectionPool> pool)
-    : pool_(pool) {
+MatchRepository::MatchRepository(std::shared_ptr<database::ConnectionPool> pool,
+                                 std::shared_ptr<EntityCache> cache)
+    : pool_(pool), cache_(std::move(cache)) {
   if (!pool_) {
     throw std::runtime_error("ConnectionPool is null");
   }
@@ -19,8 +23,8 @@ MatchRepository::MatchRepository(std::shared_ptr<database::ConnectionPool> pool)
 
 models::Match MatchRepository::create(const models::Match& match) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("MatchRepository::create called with group_id=" + std::to_string(match.group_id) + 
-                " player1_id=" + std::to_string(match.player1_id) + " player2_id=" + std::to_string(match.player2_id));
+  OBS_DEBUG(logger, "MatchRepository::create called with group_id=" + std::to_string(match.group_id) + 
+                    " player1_id=" + std::to_string(match.player1_id) + " player2_id=" + std::to_string(match.player2_id));
   
   // Input validation
   try {
@@ -41,14 +45,14 @@ models::Match MatchRepository::create(const models::Match& match) {
     utils::validateElo(match.player1_elo_after, "player1_elo_after");
     utils::validateElo(match.player2_elo_after, "player2_elo_after");
   } catch (const std::invalid_argument& e) {
-    logger->error("MatchRepository::create - Invalid input: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(match.group_id));
+    OBS_ERROR(logger, "MatchRepository::create - Invalid input: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(match.group_id));
     throw;
   }
   
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("MatchRepository::create - Failed to acquire database connection");
+    OBS_ERROR(logger, "MatchRepository::create - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -56,12 +60,7 @@ models::Match MatchRepository::create(const models::Match& match) {
     pqxx::work txn(*conn);
     
     // Insert match and get the ID back
-    auto result = txn.exec_params(
-      "INSERT INTO matches (group_id, player1_id, player2_id, player1_score, player2_score, "
-      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-      "idempotency_key, created_by_telegram_user_id, created_at, is_undone) "
-      "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, NOW(), FALSE) "
-      "RETURNING id, created_at",
+    auto result = database::execPrepared(txn, database::statements::kMatchInsert,
       match.group_id,
       match.player1_id,
       match.player2_id,
@@ -76,10 +75,9 @@ models::Match MatchRepository::create(const models::Match& match) {
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
-      logger->error("MatchRepository::create - Failed to create match (no result returned)");
+      OBS_ERROR(logger, "MatchRepository::create - Failed to create match (no result returned)");
       throw std::runtime_error("Failed to create match");
     }
     
@@ -103,31 +101,26 @@ models::Match MatchRepository::create(const models::Match& match) {
       created_match.created_at = std::chrono::system_clock::now();
     }
     
-    logger->info("MatchRepository::create - Successfully created match id=" + std::to_string(created_match.id) + 
-                 " group_id=" + std::to_string(match.group_id));
+    OBS_INFO(logger, "MatchRepository::create - Successfully created match id=" + std::to_string(created_match.id) + 
+                     " group_id=" + std::to_string(match.group_id));
     return created_match;
   } catch (const pqxx::unique_violation& e) {
-    pool_->release(conn);
-    logger->warn("MatchRepository::create - Duplicate idempotency_key: " + match.idempotency_key);
+    OBS_WARN(logger, "MatchRepository::create - Duplicate idempotency_key: " + match.idempotency_key);
     throw std::runtime_error("Match with this idempotency key already exists");
   } catch (const pqxx::foreign_key_violation& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::create - Foreign key violation: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(match.group_id));
+    OBS_ERROR(logger, "MatchRepository::create - Foreign key violation: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(match.group_id));
     throw std::runtime_error("Invalid group_id, player1_id, or player2_id (foreign key violation)");
   } catch (const pqxx::check_violation& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::create - Check constraint violation: " + std::string(e.what()));
+    OBS_ERROR(logger, "MatchRepository::create - Check constraint violation: " + std::string(e.what()));
     throw std::runtime_error("Match data violates database constraints: " + std::string(e.what()));
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::create - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
-                  " group_id=" + std::to_string(match.group_id));
+    OBS_ERROR(logger, "MatchRepository::create - SQL error: " + std::string(e.what()) + " Query: " + e.query() + 
+                      " group_id=" + std::to_string(match.group_id));
     throw std::runtime_error("Database error in create: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::create - Error: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(match.group_id));
+    OBS_ERROR(logger, "MatchRepository::create - Error: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(match.group_id));
     throw;
   }
 }
@@ -145,18 +138,11 @@ std::optional<models::Match> MatchRepository::getById(int64_t id) {
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, group_id, player1_id, player2_id, player1_score, player2_score, "
-      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-      "idempotency_key, created_by_telegram_user_id, created_at, is_undone, "
-      "undone_at, undone_by_telegram_user_id "
-      "FROM matches "
-      "WHERE id = $1",
+    auto result = database::execPrepared(txn, database::statements::kMatchById,
       id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
@@ -164,9 +150,8 @@ std::optional<models::Match> MatchRepository::getById(int64_t id) {
     
     return rowToMatch(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getById: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getById: " + std::string(e.what()));
     throw;
   }
 }
@@ -185,18 +170,11 @@ std::optional<models::Match> MatchRepository::getByIdempotencyKey(
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, group_id, player1_id, player2_id, player1_score, player2_score, "
-      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-      "idempotency_key, created_by_telegram_user_id, created_at, is_undone, "
-      "undone_at, undone_by_telegram_user_id "
-      "FROM matches "
-      "WHERE idempotency_key = $1",
+    auto result = database::execPrepared(txn, database::statements::kMatchByIdempotencyKey,
       idempotency_key
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
@@ -204,9 +182,8 @@ std::optional<models::Match> MatchRepository::getByIdempotencyKey(
     
     return rowToMatch(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getByIdempotencyKey: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getByIdempotencyKey: " + std::string(e.what()));
     throw;
   }
 }
@@ -233,20 +210,11 @@ std::vector<models::Match> MatchRepository::getByGroupId(int64_t group_id,
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, group_id, player1_id, player2_id, player1_score, player2_score, "
-      "player1_elo_before, player2_elo_before, player1_elo_after, player2_elo_after, "
-      "idempotency_key, created_by_telegram_user_id, created_at, is_undone, "
-      "undone_at, undone_by_telegram_user_id "
-      "FROM matches "
-      "WHERE group_id = $1 "
-      "ORDER BY created_at DESC "
-      "LIMIT $2 OFFSET $3",
+    auto result = database::execPrepared(txn, database::statements::kMatchesByGroup,
       group_id, limit, offset
     );
     
     txn.commit();
-    pool_->release(conn);
     
     std::vector<models::Match> matches;
     matches.reserve(result.size());
@@ -257,9 +225,8 @@ std::vector<models::Match> MatchRepository::getByGroupId(int64_t group_id,
     
     return matches;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getByGroupId: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getByGroupId: " + std::string(e.what()));
     throw;
   }
 }
@@ -278,30 +245,23 @@ void MatchRepository::undoMatch(int64_t match_id,
   try {
     pqxx::work txn(*conn);
     
-    txn.exec_params(
-      "UPDATE matches SET "
-      "is_undone = TRUE, "
-      "undone_at = NOW(), "
-      "undone_by_telegram_user_id = $1 "
-      "WHERE id = $2 AND is_undone = FALSE",
+    database::execPrepared(txn, database::statements::kMatchMarkUndone,
       undone_by_user_id,
       match_id
     );
     
     txn.commit();
-    pool_->release(conn);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in undoMatch: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in undoMatch: " + std::string(e.what()));
     throw;
   }
 }
 
 void MatchRepository::createEloHistory(const models::EloHistory& history) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("MatchRepository::createEloHistory called with group_id=" + std::to_string(history.group_id) + 
-                " player_id=" + std::to_string(history.player_id));
+  OBS_DEBUG(logger, "MatchRepository::createEloHistory called with group_id=" + std::to_string(history.group_id) + 
+                    " player_id=" + std::to_string(history.player_id));
   
   // Input validation
   try {
@@ -315,18 +275,18 @@ void MatchRepository::createEloHistory(const models::EloHistory& history) {
     // Validate elo_change matches the difference
     int expected_change = history.elo_after - history.elo_before;
     if (std::abs(history.elo_change - expected_change) > 1) {
-      logger->warn("MatchRepository::createEloHistory - ELO change mismatch: expected=" + 
-                   std::to_string(expected_change) + " got=" + std::to_string(history.elo_change));
+      OBS_WARN(logger, "MatchRepository::createEloHistory - ELO change mismatch: expected=" + 
+                       std::to_string(expected_change) + " got=" + std::to_string(history.elo_change));
     }
   } catch (const std::invalid_argument& e) {
-    logger->error("MatchRepository::createEloHistory - Invalid input: " + std::string(e.what()) + 
-                  " group_id=" + std::to_string(history.group_id) + " player_id=" + std::to_string(history.player_id));
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - Invalid input: " + std::string(e.what()) + 
+                      " group_id=" + std::to_string(history.group_id) + " player_id=" + std::to_string(history.player_id));
     throw;
   }
   
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("MatchRepository::createEloHistory - Failed to acquire database connection");
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -334,10 +294,7 @@ void MatchRepository::createEloHistory(const models::EloHistory& history) {
     pqxx::work txn(*conn);
     
     if (history.match_id.has_value()) {
-      txn.exec_params(
-        "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-        "elo_after, elo_change, created_at, is_undone) "
-        "VALUES ($1, $2, $3, $4, $5, $6, NOW(), $7)",
+      database::execPrepared(txn, database::statements::kEloHistoryInsert,
         history.match_id.value(),
         history.group_id,
         history.player_id,
@@ -347,10 +304,7 @@ void MatchRepository::createEloHistory(const models::EloHistory& history) {
         history.is_undone
       );
     } else {
-      txn.exec_params(
-        "INSERT INTO elo_history (match_id, group_id, player_id, elo_before, "
-        "elo_after, elo_change, created_at, is_undone) "
-        "VALUES (NULL, $1, $2, $3, $4, $5, NOW(), $6)",
+      database::execPrepared(txn, database::statements::kEloHistoryInsertNoMatch,
         history.group_id,
         history.player_id,
         history.elo_before,
@@ -361,26 +315,183 @@ void MatchRepository::createEloHistory(const models::EloHistory& history) {
     }
     
     txn.commit();
-    pool_->release(conn);
-    logger->info("MatchRepository::createEloHistory - Successfully created ELO history group_id=" + 
-                 std::to_string(history.group_id) + " player_id=" + std::to_string(history.player_id) + 
-                 " elo_change=" + std::to_string(history.elo_change));
+    OBS_INFO(logger, "MatchRepository::createEloHistory - Successfully created ELO history group_id=" + 
+                     std::to_string(history.group_id) + " player_id=" + std::to_string(history.player_id) + 
+                     " elo_change=" + std::to_string(history.elo_change));
   } catch (const pqxx::check_violation& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::createEloHistory - Check constraint violation: " + std::string(e.what()) + 
-                  " elo_after=" + std::to_string(history.elo_after));
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - Check constraint violation: " + std::string(e.what()) + 
+                      " elo_after=" + std::to_string(history.elo_after));
     throw std::runtime_error("ELO value violates database constraints: " + std::string(e.what()));
   } catch (const pqxx::foreign_key_violation& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::createEloHistory - Foreign key violation: " + std::string(e.what()));
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - Foreign key violation: " + std::string(e.what()));
     throw std::runtime_error("Invalid group_id, player_id, or match_id (foreign key violation)");
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::createEloHistory - SQL error: " + std::string(e.what()) + " Query: " + e.query());
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - SQL error: " + std::string(e.what()) + " Query: " + e.query());
     throw std::runtime_error("Database error in createEloHistory: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("MatchRepository::createEloHistory - Error: " + std::string(e.what()));
+    OBS_ERROR(logger, "MatchRepository::createEloHistory - Error: " + std::string(e.what()));
+    throw;
+  }
+}
+
+std::pair<models::PlayerRating, models::PlayerRating> MatchRepository::getRatings(
+    int64_t telegram_group_id, int64_t player1_telegram_user_id,
+    int64_t player2_telegram_user_id) {
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kMatchRatings,
+      telegram_group_id, player1_telegram_user_id, player2_telegram_user_id
+    );
+    
+    txn.commit();
+    
+    if (result.size() != 2) {
+      throw std::runtime_error("Failed to read player ratings");
+    }
+    
+    auto toRating = [](const pqxx::row& row) {
+      models::PlayerRating rating;
+      rating.current_elo = row["current_elo"].as<int>();
+      rating.version = row["version"].as<int>();
+      rating.matches_played = row["matches_played"].as<int>();
+      rating.rating_deviation = row["rating_deviation"].as<double>();
+      rating.rating_volatility = row["rating_volatility"].as<double>();
+      return rating;
+    };
+    return {toRating(result[0]), toRating(result[1])};
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in getRatings: " + std::string(e.what()));
+    throw;
+  }
+}
+
+models::Match MatchRepository::registerMatch(const models::MatchRegistration& registration) {
+  auto logger = observability::Logger::getInstance();
+  
+  // Input validation
+  try {
+    utils::validateId(registration.player1_telegram_user_id, "player1_telegram_user_id");
+    utils::validateId(registration.player2_telegram_user_id, "player2_telegram_user_id");
+    if (registration.player1_telegram_user_id == registration.player2_telegram_user_id) {
+      throw std::invalid_argument("player1 and player2 must be different (no self-matches)");
+    }
+    if (registration.telegram_group_id == 0) {
+      throw std::invalid_argument("telegram_group_id cannot be zero");
+    }
+    utils::validateIdempotencyKey(registration.idempotency_key);
+    utils::validateScore(registration.player1_score, "player1_score");
+    utils::validateScore(registration.player2_score, "player2_score");
+    if (registration.player1_score == 0 && registration.player2_score == 0) {
+      throw std::invalid_argument("At least one score must be greater than 0");
+    }
+    utils::validateElo(registration.player1_elo_after, "player1_elo_after");
+    utils::validateElo(registration.player2_elo_after, "player2_elo_after");
+  } catch (const std::invalid_argument& e) {
+    OBS_ERROR(logger, "MatchRepository::registerMatch - Invalid input: " + std::string(e.what()) +
+                      " telegram_group_id=" + std::to_string(registration.telegram_group_id));
+    throw;
+  }
+  
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    OBS_ERROR(logger, "MatchRepository::registerMatch - Failed to acquire database connection");
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+  
+  try {
+    pqxx::work txn(*conn);
+    
+    auto result = database::execPrepared(txn, database::statements::kRegisterMatch,
+      registration.telegram_group_id,
+      registration.group_name,
+      registration.player1_telegram_user_id,
+      registration.player2_telegram_user_id,
+      registration.player1_score,
+      registration.player2_score,
+      registration.player1_before.version,
+      registration.player2_before.version,
+      registration.player1_elo_after,
+      registration.player2_elo_after,
+      registration.idempotency_key,
+      registration.created_by_telegram_user_id,
+      registration.player1_deviation_after,
+      registration.player2_deviation_after,
+      registration.player1_volatility_after,
+      registration.player2_volatility_after,
+      registration.rating_system,
+      registration.player1_k_factor,
+      registration.player2_k_factor
+    );
+    
+    txn.commit();
+    
+    if (result.empty()) {
+      throw std::runtime_error("Failed to register match");
+    }
+    
+    const auto& row = result[0];
+    models::Match match;
+    match.id = row["match_id"].as<int64_t>();
+    match.group_id = row["group_id"].as<int64_t>();
+    match.player1_id = row["player1_id"].as<int64_t>();
+    match.player2_id = row["player2_id"].as<int64_t>();
+    match.player1_score = registration.player1_score;
+    match.player2_score = registration.player2_score;
+    match.player1_elo_before = row["player1_elo_before"].as<int>();
+    match.player2_elo_before = row["player2_elo_before"].as<int>();
+    match.player1_elo_after = registration.player1_elo_after;
+    match.player2_elo_after = registration.player2_elo_after;
+    match.idempotency_key = registration.idempotency_key;
+    match.created_by_telegram_user_id = registration.created_by_telegram_user_id;
+    match.is_undone = false;
+    
+    auto created_at_str = row["created_at"].as<std::string>();
+    std::tm tm = {};
+    std::istringstream ss(created_at_str);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (ss.fail()) {
+      ss.clear();
+      ss.str(created_at_str);
+      ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    }
+    if (!ss.fail()) {
+      match.created_at = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    } else {
+      match.created_at = std::chrono::system_clock::now();
+    }
+    
+    if (cache_) {
+      cache_->group_players.erase({match.group_id, match.player1_id});
+      cache_->group_players.erase({match.group_id, match.player2_id});
+      cache_->leaderboard.update(match.group_id, match.player1_id, match.player1_elo_after);
+      cache_->leaderboard.update(match.group_id, match.player2_id, match.player2_elo_after);
+    }
+    
+    OBS_INFO(logger, "MatchRepository::registerMatch - Registered match id=" + std::to_string(match.id) +
+                     " group_id=" + std::to_string(match.group_id));
+    return match;
+  } catch (const pqxx::unique_violation& e) {
+    OBS_WARN(logger, "MatchRepository::registerMatch - Duplicate idempotency_key: " + registration.idempotency_key);
+    throw DuplicateMatchException();
+  } catch (const pqxx::sql_error& e) {
+    if (e.sqlstate() == "TT001") {
+      // Raised by register_match() when a version moved since getRatings()
+      OBS_WARN(logger, "MatchRepository::registerMatch - Optimistic lock conflict: " + std::string(e.what()));
+      throw utils::OptimisticLockException(e.what());
+    }
+    OBS_ERROR(logger, "MatchRepository::registerMatch - SQL error: " + std::string(e.what()) +
+                      " telegram_group_id=" + std::to_string(registration.telegram_group_id));
+    throw std::runtime_error("Database error in registerMatch: " + std::string(e.what()));
+  } catch (const std::exception& e) {
+    OBS_ERROR(logger, "MatchRepository::registerMatch - Error: " + std::string(e.what()) +
+                      " telegram_group_id=" + std::to_string(registration.telegram_group_id));
     throw;
   }
 }
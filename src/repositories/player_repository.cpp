@@ -1,7 +1,9 @@
 #include "repositories/player_repository.h"
 #include "database/connection_pool.h"
+#include "database/prepared_statements.h"
 #include "database/transaction.h"
 #include "observability/logger.h"
+#include "repositories/entity_cache.h"
 #include "utils/validation.h"
 #include <stdexcept>
 #include <sstream>
@@ -10,8 +12,9 @@
 
 namespace repositories {
 
-PlayerRepository::PlayerRepository(std::shared_ptr<database::ConnectionPool> pool)
-    : pool_(pool) {
+PlayerRepository::PlayerRepository(std::shared_ptr<database::ConnectionPool> pool,
+                                   std::shared_ptr<EntityCache> cache)
+    : pool_(pool), cache_(std::move(cache)) {
   if (!pool_) {
     throw std::runtime_error("ConnectionPool is null");
   }
@@ -19,19 +22,27 @@ PlayerRepository::PlayerRepository(std::shared_ptr<database::ConnectionPool> poo
 
 models::Player PlayerRepository::createOrGet(int64_t telegram_user_id) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("PlayerRepository::createOrGet called with telegram_user_id=" + std::to_string(telegram_user_id));
+  OBS_DEBUG(logger, "PlayerRepository::createOrGet called with telegram_user_id=" + std::to_string(telegram_user_id));
   
   // Input validation
   try {
     utils::validateId(telegram_user_id, "telegram_user_id");
   } catch (const std::invalid_argument& e) {
-    logger->error("PlayerRepository::createOrGet - Invalid input: " + std::string(e.what()));
+    OBS_ERROR(logger, "PlayerRepository::createOrGet - Invalid input: " + std::string(e.what()));
     throw;
   }
   
+  uint64_t snapshot = 0;
+  if (cache_) {
+    if (auto cached = cache_->players.get(telegram_user_id)) {
+      return *cached;
+    }
+    snapshot = cache_->players.snapshot(telegram_user_id);
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("PlayerRepository::createOrGet - Failed to acquire database connection");
+    OBS_ERROR(logger, "PlayerRepository::createOrGet - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -39,36 +50,30 @@ models::Player PlayerRepository::createOrGet(int64_t telegram_user_id) {
     pqxx::work txn(*conn);
     
     // Try to insert, ignore if already exists
-    txn.exec_params(
-      "INSERT INTO players (telegram_user_id, created_at, updated_at) "
-      "VALUES ($1, NOW(), NOW()) "
-      "ON CONFLICT (telegram_user_id) WHERE deleted_at IS NULL DO NOTHING",
+    database::execPrepared(txn, database::statements::kPlayerInsert,
       telegram_user_id
     );
     
     // Get the player (either newly created or existing)
-    auto result = txn.exec_params(
-      "SELECT id, telegram_user_id, school_nickname, is_verified_student, "
-      "is_allowed_non_student, created_at, updated_at, deleted_at "
-      "FROM players "
-      "WHERE telegram_user_id = $1 AND deleted_at IS NULL",
+    auto result = database::execPrepared(txn, database::statements::kPlayerByTelegramId,
       telegram_user_id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
-      logger->error("PlayerRepository::createOrGet - Failed to create or retrieve player with telegram_user_id=" + std::to_string(telegram_user_id));
+      OBS_ERROR(logger, "PlayerRepository::createOrGet - Failed to create or retrieve player with telegram_user_id=" + std::to_string(telegram_user_id));
       throw std::runtime_error("Failed to create or retrieve player");
     }
     
     auto player = rowToPlayer(result[0]);
-    logger->info("PlayerRepository::createOrGet - Successfully retrieved player id=" + std::to_string(player.id) + " telegram_user_id=" + std::to_string(telegram_user_id));
+    if (cache_) {
+      cache_->players.putIfUnchanged(telegram_user_id, player, snapshot);
+    }
+    OBS_INFO(logger, "PlayerRepository::createOrGet - Successfully retrieved player id=" + std::to_string(player.id) + " telegram_user_id=" + std::to_string(telegram_user_id));
     return player;
   } catch (const pqxx::unique_violation& e) {
-    pool_->release(conn);
-    logger->warn("PlayerRepository::createOrGet - Unique violation (should not happen): " + std::string(e.what()));
+    OBS_WARN(logger, "PlayerRepository::createOrGet - Unique violation (should not happen): " + std::string(e.what()));
     // Retry to get existing player
     auto existing = getByTelegramId(telegram_user_id);
     if (existing.has_value()) {
@@ -76,12 +81,10 @@ models::Player PlayerRepository::createOrGet(int64_t telegram_user_id) {
     }
     throw std::runtime_error("Failed to create or retrieve player after unique violation");
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("PlayerRepository::createOrGet - SQL error: " + std::string(e.what()) + " Query: " + e.query());
+    OBS_ERROR(logger, "PlayerRepository::createOrGet - SQL error: " + std::string(e.what()) + " Query: " + e.query());
     throw std::runtime_error("Database error in createOrGet: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("PlayerRepository::createOrGet - Error: " + std::string(e.what()) + " telegram_user_id=" + std::to_string(telegram_user_id));
+    OBS_ERROR(logger, "PlayerRepository::createOrGet - Error: " + std::string(e.what()) + " telegram_user_id=" + std::to_string(telegram_user_id));
     throw;
   }
 }
@@ -92,6 +95,14 @@ std::optional<models::Player> PlayerRepository::getByTelegramId(
     return std::nullopt;
   }
   
+  uint64_t snapshot = 0;
+  if (cache_) {
+    if (auto cached = cache_->players.get(telegram_user_id)) {
+      return cached;
+    }
+    snapshot = cache_->players.snapshot(telegram_user_id);
+  }
+  
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
     throw std::runtime_error("Failed to acquire database connection");
@@ -100,26 +111,24 @@ std::optional<models::Player> PlayerRepository::getByTelegramId(
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, telegram_user_id, school_nickname, is_verified_student, "
-      "is_allowed_non_student, created_at, updated_at, deleted_at "
-      "FROM players "
-      "WHERE telegram_user_id = $1 AND deleted_at IS NULL",
+    auto result = database::execPrepared(txn, database::statements::kPlayerByTelegramId,
       telegram_user_id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
     }
     
-    return rowToPlayer(result[0]);
+    auto player = rowToPlayer(result[0]);
+    if (cache_) {
+      cache_->players.putIfUnchanged(telegram_user_id, player, snapshot);
+    }
+    return player;
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getByTelegramId: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getByTelegramId: " + std::string(e.what()));
     throw;
   }
 }
@@ -137,16 +146,11 @@ std::optional<models::Player> PlayerRepository::getById(int64_t id) {
   try {
     pqxx::work txn(*conn);
     
-    auto result = txn.exec_params(
-      "SELECT id, telegram_user_id, school_nickname, is_verified_student, "
-      "is_allowed_non_student, created_at, updated_at, deleted_at "
-      "FROM players "
-      "WHERE id = $1",
+    auto result = database::execPrepared(txn, database::statements::kPlayerById,
       id
     );
     
     txn.commit();
-    pool_->release(conn);
     
     if (result.empty()) {
       return std::nullopt;
@@ -154,16 +158,15 @@ std::optional<models::Player> PlayerRepository::getById(int64_t id) {
     
     return rowToPlayer(result[0]);
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in getById: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in getById: " + std::string(e.what()));
     throw;
   }
 }
 
 void PlayerRepository::update(const models::Player& player) {
   auto logger = observability::Logger::getInstance();
-  logger->debug("PlayerRepository::update called with player_id=" + std::to_string(player.id));
+  OBS_DEBUG(logger, "PlayerRepository::update called with player_id=" + std::to_string(player.id));
   
   // Input validation
   try {
@@ -172,13 +175,13 @@ void PlayerRepository::update(const models::Player& player) {
       utils::validateStringLength(player.school_nickname.value(), utils::MAX_STRING_LENGTH, "school_nickname");
     }
   } catch (const std::invalid_argument& e) {
-    logger->error("PlayerRepository::update - Invalid input: " + std::string(e.what()) + " player_id=" + std::to_string(player.id));
+    OBS_ERROR(logger, "PlayerRepository::update - Invalid input: " + std::string(e.what()) + " player_id=" + std::to_string(player.id));
     throw;
   }
   
   auto conn = pool_->acquire();
   if (!conn || !conn->is_open()) {
-    logger->error("PlayerRepository::update - Failed to acquire database connection");
+    OBS_ERROR(logger, "PlayerRepository::update - Failed to acquire database connection");
     throw std::runtime_error("Failed to acquire database connection");
   }
   
@@ -186,50 +189,39 @@ void PlayerRepository::update(const models::Player& player) {
     pqxx::work txn(*conn);
     
     if (player.school_nickname.has_value()) {
-      txn.exec_params(
-        "UPDATE players SET "
-        "school_nickname = $1, "
-        "is_verified_student = $2, "
-        "is_allowed_non_student = $3, "
-        "updated_at = NOW() "
-        "WHERE id = $4",
+      database::execPrepared(txn, database::statements::kPlayerUpdate,
         player.school_nickname.value(),
         player.is_verified_student,
         player.is_allowed_non_student,
         player.id
       );
     } else {
-      txn.exec_params(
-        "UPDATE players SET "
-        "school_nickname = NULL, "
-        "is_verified_student = $1, "
-        "is_allowed_non_student = $2, "
-        "updated_at = NOW() "
-        "WHERE id = $3",
+      database::execPrepared(txn, database::statements::kPlayerUpdateNoNickname,
         player.is_verified_student,
         player.is_allowed_non_student,
         player.id
       );
     }
     
-    auto affected = txn.exec_params("SELECT COUNT(*) as cnt FROM players WHERE id = $1", player.id);
+    auto affected = database::execPrepared(txn, database::statements::kPlayerCount, player.id);
     if (affected.empty() || affected[0]["cnt"].as<int>() == 0) {
-      logger->warn("PlayerRepository::update - Player not found: player_id=" + std::to_string(player.id));
+      OBS_WARN(logger, "PlayerRepository::update - Player not found: player_id=" + std::to_string(player.id));
       txn.commit();
-      pool_->release(conn);
       throw std::runtime_error("Player not found");
     }
     
     txn.commit();
-    pool_->release(conn);
-    logger->info("PlayerRepository::update - Successfully updated player_id=" + std::to_string(player.id));
+    if (cache_ && player.telegram_user_id > 0) {
+      cache_->players.erase(player.telegram_user_id);
+    } else {
+      invalidatePlayer(player.id);
+    }
+    OBS_INFO(logger, "PlayerRepository::update - Successfully updated player_id=" + std::to_string(player.id));
   } catch (const pqxx::sql_error& e) {
-    pool_->release(conn);
-    logger->error("PlayerRepository::update - SQL error: " + std::string(e.what()) + " Query: " + e.query() + " player_id=" + std::to_string(player.id));
+    OBS_ERROR(logger, "PlayerRepository::update - SQL error: " + std::string(e.what()) + " Query: " + e.query() + " player_id=" + std::to_string(player.id));
     throw std::runtime_error("Database error in update: " + std::string(e.what()));
   } catch (const std::exception& e) {
-    pool_->release(conn);
-    logger->error("PlayerRepository::update - Error: " + std::string(e.what()) + " player_id=" + std::to_string(player.id));
+    OBS_ERROR(logger, "PlayerRepository::update - Error: " + std::string(e.what()) + " player_id=" + std::to_string(player.id));
     throw;
   }
 }
@@ -247,22 +239,34 @@ void PlayerRepository::softDelete(int64_t player_id) {
   try {
     pqxx::work txn(*conn);
     
-    txn.exec_params(
-      "UPDATE players SET deleted_at = NOW(), updated_at = NOW() "
-      "WHERE id = $1 AND deleted_at IS NULL",
+    database::execPrepared(txn, database::statements::kPlayerSoftDelete,
       player_id
     );
     
     txn.commit();
-    pool_->release(conn);
+    invalidatePlayer(player_id);
+    if (cache_) {
+      cache_->group_players.eraseIf([player_id](const GroupPlayerKey& key, const models::GroupPlayer&) {
+        return key.player_id == player_id;
+      });
+    }
   } catch (const std::exception& e) {
-    pool_->release(conn);
     auto logger = observability::Logger::getInstance();
-    logger->error("Error in softDelete: " + std::string(e.what()));
+    OBS_ERROR(logger, "Error in softDelete: " + std::string(e.what()));
     throw;
   }
 }
 
+void PlayerRepository::invalidatePlayer(int64_t player_id) {
+  if (!cache_) {
+    return;
+  }
+  // Cached by telegram_user_id, so find the entry by row id
+  cache_->players.eraseIf([player_id](int64_t, const models::Player& cached) {
+    return cached.id == player_id;
+  });
+}
+
 models::Player PlayerRepository::rowToPlayer(const pqxx::row& row) {
   models::Player player;
   player.id = row["id"].as<int64_t>();
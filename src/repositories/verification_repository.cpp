@@ -0,0 +1,91 @@
+#include "repositories/verification_repository.h"
+#include "database/connection_pool.h"
+#include "database/prepared_statements.h"
+#include "observability/logger.h"
+#include "utils/validation.h"
+#include <stdexcept>
+#include <pqxx/pqxx>
+
+namespace repositories {
+
+VerificationRepository::VerificationRepository(std::shared_ptr<database::ConnectionPool> pool)
+    : pool_(std::move(pool)) {
+  if (!pool_) {
+    throw std::runtime_error("ConnectionPool is null");
+  }
+}
+
+std::optional<models::PlayerVerification> VerificationRepository::findFresh(
+    const std::string& school_nickname) {
+  if (school_nickname.empty()) {
+    return std::nullopt;
+  }
+
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+
+  try {
+    pqxx::work txn(*conn);
+
+    auto result = database::execPrepared(txn, database::statements::kVerificationFresh,
+      school_nickname
+    );
+
+    txn.commit();
+
+    if (result.empty()) {
+      return std::nullopt;
+    }
+
+    models::PlayerVerification verification;
+    verification.school_nickname = result[0]["school_nickname"].as<std::string>();
+    verification.verification_status = result[0]["verification_status"].as<std::string>();
+    verification.expires_at = std::chrono::system_clock::time_point(
+        std::chrono::seconds(result[0]["expires_at_epoch"].as<int64_t>()));
+    return verification;
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in VerificationRepository::findFresh: " + std::string(e.what()));
+    throw;
+  }
+}
+
+void VerificationRepository::record(int64_t player_id, int64_t group_id,
+                                    const std::string& school_nickname,
+                                    const std::string& verification_status,
+                                    int64_t telegram_message_id,
+                                    std::chrono::seconds ttl) {
+  utils::validateId(player_id, "player_id");
+  utils::validateId(group_id, "group_id");
+  if (school_nickname.empty() || verification_status.empty()) {
+    throw std::invalid_argument("school_nickname and verification_status must not be empty");
+  }
+
+  auto conn = pool_->acquire();
+  if (!conn || !conn->is_open()) {
+    throw std::runtime_error("Failed to acquire database connection");
+  }
+
+  try {
+    pqxx::work txn(*conn);
+
+    database::execPrepared(txn, database::statements::kVerificationInsert,
+      player_id,
+      group_id,
+      school_nickname,
+      verification_status,
+      telegram_message_id,
+      static_cast<int64_t>(ttl.count())
+    );
+
+    txn.commit();
+  } catch (const std::exception& e) {
+    auto logger = observability::Logger::getInstance();
+    OBS_ERROR(logger, "Error in VerificationRepository::record: " + std::string(e.what()));
+    throw;
+  }
+}
+
+}  // namespace repositories
@@ -7,9 +7,16 @@
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 #include "observability/logger.h"
+#include "observability/metrics.h"
+#include "observability/tracing.h"
 
 namespace school21 {
 
+observability::Histogram& requestLatency(const char* method) {
+  return observability::MetricsRegistry::getInstance().histogram(
+      "school21_request_duration_seconds", "School21 API request latency", {{"method", method}});
+}
+
 ApiClient::ApiClient(const Config& config) : config_(config) {
   curl_global_init(CURL_GLOBAL_DEFAULT);
 }
@@ -34,7 +41,7 @@ std::string ApiClient::getAccessToken() {
   
   if (isTokenValid()) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->debug("School21: reusing cached access token");
+      OBS_DEBUG(logger, "School21: reusing cached access token");
     }
     return token_->access_token;
   }
@@ -43,24 +50,24 @@ std::string ApiClient::getAccessToken() {
   if (token_ && token_->refresh_token.empty() == false) {
     try {
       if (auto logger = observability::Logger::getInstance()) {
-        logger->info("School21: attempting token refresh");
+        OBS_INFO(logger, "School21: attempting token refresh");
       }
       *token_ = refreshToken(token_->refresh_token);
       return token_->access_token;
     } catch (const std::exception&) {
       // Refresh failed, re-authenticate
       if (auto logger = observability::Logger::getInstance()) {
-        logger->warn("School21: token refresh failed, re-authenticating");
+        OBS_WARN(logger, "School21: token refresh failed, re-authenticating");
       }
     }
   }
   
   if (auto logger = observability::Logger::getInstance()) {
-    logger->info("School21: authenticating for new token");
+    OBS_INFO(logger, "School21: authenticating for new token");
   }
   token_ = authenticate();
   if (auto logger = observability::Logger::getInstance()) {
-    logger->info("School21: authentication succeeded, token acquired");
+    OBS_INFO(logger, "School21: authentication succeeded, token acquired");
   }
   return token_->access_token;
 }
@@ -103,40 +110,43 @@ std::optional<Participant> ApiClient::getParticipant(const std::string& login) {
     std::string url = config_.base_url + "/v1/participants/" + login;
     
     if (auto logger = observability::Logger::getInstance()) {
-      logger->debug("School21: fetching participant '" + login + "' from " + url);
+      OBS_DEBUG(logger, "School21: fetching participant '" + login + "' from " + url);
     }
 
     std::string response = httpGet(url, token);
-    
-    auto json = nlohmann::json::parse(response);
-    Participant participant;
-    participant.login = json.value("login", login);
-    
-    // status may be null in some responses; treat null as empty string
-    if (json.contains("status") && json["status"].is_string()) {
-      participant.status = json["status"].get<std::string>();
-    } else {
-      participant.status = "";
-    }
-
-    // Optional fields
-    if (json.contains("className") && json["className"].is_string()) {
-      participant.class_name = json["className"].get<std::string>();
-    }
-    if (json.contains("parallelName") && json["parallelName"].is_string()) {
-      participant.parallel_name = json["parallelName"].get<std::string>();
-    }
-    
-    return participant;
+    return parseParticipant(response, login);
   } catch (const std::exception& e) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error("School21 getParticipant failed for login '" + login +
-                    "': " + e.what());
+      OBS_ERROR(logger, "School21 getParticipant failed for login '" + login +
+                        "': " + e.what());
     }
     return std::nullopt;
   }
 }
 
+Participant ApiClient::parseParticipant(const std::string& body, const std::string& login) {
+  auto json = nlohmann::json::parse(body);
+  Participant participant;
+  participant.login = json.value("login", login);
+  
+  // status may be null in some responses; treat null as empty string
+  if (json.contains("status") && json["status"].is_string()) {
+    participant.status = json["status"].get<std::string>();
+  } else {
+    participant.status = "";
+  }
+
+  // Optional fields
+  if (json.contains("className") && json["className"].is_string()) {
+    participant.class_name = json["className"].get<std::string>();
+  }
+  if (json.contains("parallelName") && json["parallelName"].is_string()) {
+    participant.parallel_name = json["parallelName"].get<std::string>();
+  }
+  
+  return participant;
+}
+
 bool ApiClient::verifyParticipant(const std::string& login) {
   auto participant = getParticipant(login);
   if (!participant) {
@@ -158,7 +168,7 @@ std::string ApiClient::httpGet(const std::string& url,
   CURL* curl = curl_easy_init();
   if (!curl) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error("School21 httpGet: failed to initialize CURL");
+      OBS_ERROR(logger, "School21 httpGet: failed to initialize CURL");
     }
     throw std::runtime_error("Failed to initialize CURL");
   }
@@ -178,15 +188,21 @@ std::string ApiClient::httpGet(const std::string& url,
   }
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
   
+  static auto& latency = requestLatency("GET");
+  auto span = observability::Tracer::getInstance().startSpan("school21.request", observability::SpanKind::kClient);
+  span.setAttribute("http.request.method", "GET");
+  auto started = std::chrono::steady_clock::now();
   CURLcode res = curl_easy_perform(curl);
+  latency.observe(std::chrono::steady_clock::now() - started);
   curl_slist_free_all(headers);
   curl_easy_cleanup(curl);
   
   if (res != CURLE_OK) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error(std::string("School21 httpGet failed: ") +
-                    curl_easy_strerror(res) + " url=" + url);
+      OBS_ERROR(logger, std::string("School21 httpGet failed: ") +
+                        curl_easy_strerror(res) + " url=" + url);
     }
+    span.setError(curl_easy_strerror(res));
     throw std::runtime_error("HTTP GET failed: " + 
                             std::string(curl_easy_strerror(res)));
   }
@@ -200,7 +216,7 @@ std::string ApiClient::httpPost(const std::string& url,
   CURL* curl = curl_easy_init();
   if (!curl) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error("School21 httpPost: failed to initialize CURL");
+      OBS_ERROR(logger, "School21 httpPost: failed to initialize CURL");
     }
     throw std::runtime_error("Failed to initialize CURL");
   }
@@ -221,15 +237,21 @@ std::string ApiClient::httpPost(const std::string& url,
   }
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
   
+  static auto& latency = requestLatency("POST");
+  auto span = observability::Tracer::getInstance().startSpan("school21.request", observability::SpanKind::kClient);
+  span.setAttribute("http.request.method", "POST");
+  auto started = std::chrono::steady_clock::now();
   CURLcode res = curl_easy_perform(curl);
+  latency.observe(std::chrono::steady_clock::now() - started);
   curl_slist_free_all(headers);
   curl_easy_cleanup(curl);
   
   if (res != CURLE_OK) {
     if (auto logger = observability::Logger::getInstance()) {
-      logger->error(std::string("School21 httpPost failed: ") +
-                    curl_easy_strerror(res) + " url=" + url);
+      OBS_ERROR(logger, std::string("School21 httpPost failed: ") +
+                        curl_easy_strerror(res) + " url=" + url);
     }
+    span.setError(curl_easy_strerror(res));
     throw std::runtime_error("HTTP POST failed: " + 
                             std::string(curl_easy_strerror(res)));
   }
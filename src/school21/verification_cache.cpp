@@ -0,0 +1,93 @@
+#include "school21/verification_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include "observability/logger.h"
+#include "repositories/verification_repository.h"
+
+namespace school21 {
+
+VerificationCache::VerificationCache(Options options,
+                                     std::shared_ptr<repositories::VerificationRepository> repository)
+    : options_(options),
+      repository_(std::move(repository)),
+      memory_(options.capacity, options.shards) {}
+
+std::string VerificationCache::key(const std::string& login) {
+  std::string lowered = login;
+  std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return lowered;
+}
+
+std::optional<Lookup> VerificationCache::get(const std::string& login) {
+  auto now = std::chrono::system_clock::now();
+  auto cache_key = key(login);
+
+  if (auto entry = memory_.get(cache_key)) {
+    if (entry->expires_at > now) {
+      memory_hits_.fetch_add(1, std::memory_order_relaxed);
+      return entry->lookup;
+    }
+    memory_.erase(cache_key);
+  }
+
+  if (repository_) {
+    try {
+      if (auto row = repository_->findFresh(login)) {
+        Entry entry;
+        if (row->verification_status == kNotFoundStatus) {
+          entry.lookup.status = LookupStatus::kNotFound;
+        } else {
+          entry.lookup.status = LookupStatus::kFound;
+          entry.lookup.participant = Participant{row->school_nickname, row->verification_status,
+                                                 std::nullopt, std::nullopt};
+        }
+        entry.expires_at = row->expires_at;
+        memory_.put(cache_key, entry);
+        database_hits_.fetch_add(1, std::memory_order_relaxed);
+        return entry.lookup;
+      }
+    } catch (const std::exception& e) {
+      OBS_WARN(observability::Logger::getInstance(), 
+          "Verification cache: database lookup failed for '" + login + "': " + e.what());
+    }
+  }
+
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  return std::nullopt;
+}
+
+void VerificationCache::put(const std::string& login, const Lookup& lookup,
+                            int64_t player_id, int64_t group_id, int64_t telegram_message_id) {
+  if (lookup.status == LookupStatus::kError ||
+      (lookup.status == LookupStatus::kFound && !lookup.participant)) {
+    return;
+  }
+
+  bool found = lookup.status == LookupStatus::kFound;
+  auto ttl = found ? options_.success_ttl : options_.failure_ttl;
+  memory_.put(key(login), Entry{lookup, std::chrono::system_clock::now() + ttl});
+
+  if (!repository_) {
+    return;
+  }
+  try {
+    repository_->record(player_id, group_id, login,
+                        found ? lookup.participant->status : kNotFoundStatus,
+                        telegram_message_id, ttl);
+  } catch (const std::exception& e) {
+    OBS_WARN(observability::Logger::getInstance(), 
+        "Verification cache: failed to store the lookup of '" + login + "': " + e.what());
+  }
+}
+
+VerificationCache::Stats VerificationCache::getStats() const {
+  Stats stats;
+  stats.memory_hits = memory_hits_.load(std::memory_order_relaxed);
+  stats.database_hits = database_hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace school21
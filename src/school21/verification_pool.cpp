@@ -0,0 +1,228 @@
+#include "school21/verification_pool.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <curl/curl.h>
+#include "observability/logger.h"
+#include "observability/metrics.h"
+#include "observability/tracing.h"
+
+namespace school21 {
+
+namespace {
+
+size_t writeBody(void* contents, size_t size, size_t nmemb, std::string* body) {
+  body->append(static_cast<char*>(contents), size * nmemb);
+  return size * nmemb;
+}
+
+CURLM* asMulti(void* multi) {
+  return static_cast<CURLM*>(multi);
+}
+
+}  // namespace
+
+// One request on the multi handle
+struct VerificationPool::Transfer {
+  Job job;
+  CURL* easy = nullptr;
+  curl_slist* headers = nullptr;
+  std::string body;
+  observability::Span span;  // Ends when the transfer is deleted
+};
+
+VerificationPool::VerificationPool(Options options, TokenProvider token_provider)
+    : options_(std::move(options)), token_provider_(std::move(token_provider)) {
+  if (!token_provider_) {
+    throw std::invalid_argument("VerificationPool requires a token provider");
+  }
+  if (options_.max_concurrent == 0) {
+    options_.max_concurrent = 1;
+  }
+
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+  multi_ = curl_multi_init();
+  if (!multi_) {
+    curl_global_cleanup();
+    throw std::runtime_error("Failed to initialize CURL multi handle");
+  }
+  // Keep a warm connection per concurrent request
+  curl_multi_setopt(asMulti(multi_), CURLMOPT_MAXCONNECTS, static_cast<long>(options_.max_concurrent));
+
+  callbacks_ = std::make_unique<utils::ThreadPool>(
+      std::max<size_t>(options_.callback_threads, 1), options_.max_queue + options_.max_concurrent);
+  loop_ = std::thread([this]() { eventLoop(); });
+}
+
+VerificationPool::~VerificationPool() {
+  shutdown();
+  if (multi_) {
+    curl_multi_cleanup(asMulti(multi_));
+    multi_ = nullptr;
+    curl_global_cleanup();
+  }
+}
+
+bool VerificationPool::submit(const std::string& login, Callback callback) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || pending_.size() >= options_.max_queue) {
+      return false;
+    }
+    pending_.push_back(Job{login, std::move(callback), observability::currentContext()});
+  }
+  curl_multi_wakeup(asMulti(multi_));
+  return true;
+}
+
+void VerificationPool::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  if (multi_) {
+    curl_multi_wakeup(asMulti(multi_));
+  }
+  if (loop_.joinable()) {
+    loop_.join();
+  }
+  if (callbacks_) {
+    callbacks_->shutdown();
+  }
+}
+
+void VerificationPool::complete(Job& job, Lookup lookup) {
+  auto task = [callback = std::move(job.callback), lookup = std::move(lookup), context = job.trace_context]() {
+    observability::ContextScope scope(context);
+    callback(lookup);
+  };
+  // The callback queue is sized for every lookup we accept; inline is a last resort
+  if (!callbacks_->trySubmit(task)) {
+    task();
+  }
+}
+
+void VerificationPool::eventLoop() {
+  auto logger = observability::Logger::getInstance();
+  CURLM* multi = asMulti(multi_);
+  auto& latency = requestLatency("GET");
+  size_t active = 0;
+
+  while (true) {
+    std::vector<Job> starting;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (!pending_.empty() && active + starting.size() < options_.max_concurrent) {
+        starting.push_back(std::move(pending_.front()));
+        pending_.pop_front();
+      }
+      if (stopping_ && starting.empty() && pending_.empty() && active == 0) {
+        break;
+      }
+    }
+
+    if (!starting.empty()) {
+      std::string token;
+      try {
+        token = token_provider_();
+      } catch (const std::exception& e) {
+        OBS_ERROR(logger, "School21 verification: failed to get access token: " + std::string(e.what()));
+        for (auto& job : starting) {
+          complete(job, Lookup{});
+        }
+        starting.clear();
+      }
+
+      for (auto& job : starting) {
+        auto* transfer = new Transfer{std::move(job), nullptr, nullptr, {}, {}};
+        transfer->span = observability::Tracer::getInstance().startSpan(
+            "school21.request", observability::SpanKind::kClient, transfer->job.trace_context);
+        transfer->span.setAttribute("http.request.method", "GET");
+        transfer->easy = curl_easy_init();
+        if (!transfer->easy) {
+          OBS_ERROR(logger, "School21 verification: failed to initialize CURL");
+          complete(transfer->job, Lookup{});
+          delete transfer;
+          continue;
+        }
+
+        char* escaped = curl_easy_escape(transfer->easy, transfer->job.login.c_str(),
+                                         static_cast<int>(transfer->job.login.size()));
+        std::string url = options_.base_url + "/v1/participants/" + (escaped ? escaped : "");
+        curl_free(escaped);
+
+        transfer->headers = curl_slist_append(transfer->headers, "Content-Type: application/json");
+        if (!token.empty()) {
+          std::string auth_header = "Authorization: Bearer " + token;
+          transfer->headers = curl_slist_append(transfer->headers, auth_header.c_str());
+        }
+        curl_easy_setopt(transfer->easy, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(transfer->easy, CURLOPT_HTTPHEADER, transfer->headers);
+        curl_easy_setopt(transfer->easy, CURLOPT_WRITEFUNCTION, writeBody);
+        curl_easy_setopt(transfer->easy, CURLOPT_WRITEDATA, &transfer->body);
+        curl_easy_setopt(transfer->easy, CURLOPT_TIMEOUT, static_cast<long>(options_.timeout_seconds));
+        curl_easy_setopt(transfer->easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(transfer->easy, CURLOPT_PRIVATE, transfer);
+        curl_multi_add_handle(multi, transfer->easy);
+        ++active;
+      }
+    }
+
+    int running = 0;
+    curl_multi_perform(multi, &running);
+
+    bool finished = false;
+    int queued_messages = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &queued_messages)) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+      Transfer* transfer = nullptr;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+      long status = 0;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_RESPONSE_CODE, &status);
+      curl_off_t total_micros = 0;
+      if (curl_easy_getinfo(message->easy_handle, CURLINFO_TOTAL_TIME_T, &total_micros) == CURLE_OK) {
+        latency.observe(std::chrono::microseconds(total_micros));
+      }
+
+      Lookup lookup;
+      const std::string& login = transfer->job.login;
+      if (message->data.result != CURLE_OK) {
+        OBS_ERROR(logger, "School21 verification failed for login '" + login + "': " +
+                          curl_easy_strerror(message->data.result));
+      } else if (status == 200) {
+        try {
+          lookup.participant = ApiClient::parseParticipant(transfer->body, login);
+          lookup.status = LookupStatus::kFound;
+        } catch (const std::exception& e) {
+          OBS_ERROR(logger, "School21 verification: bad response for login '" + login + "': " + e.what());
+        }
+      } else if (status == 404) {
+        lookup.status = LookupStatus::kNotFound;
+      } else {
+        OBS_WARN(logger, "School21 verification: HTTP " + std::to_string(status) + " for login '" + login + "'");
+      }
+
+      curl_multi_remove_handle(multi, transfer->easy);
+      curl_easy_cleanup(transfer->easy);
+      curl_slist_free_all(transfer->headers);
+      if (lookup.status == LookupStatus::kError) {
+        transfer->span.setError("lookup failed");
+      }
+      complete(transfer->job, std::move(lookup));
+      delete transfer;
+      --active;
+      finished = true;
+    }
+
+    // Freed slots go straight to the queued lookups; otherwise sleep until a
+    // socket is ready, a curl timeout fires or submit() wakes us
+    if (!finished) {
+      curl_multi_poll(multi, nullptr, 0, 1000, nullptr);
+    }
+  }
+}
+
+}  // namespace school21
@@ -1,22 +1,136 @@
 #include "utils/elo_calculator.h"
 
+#include <array>
 #include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "utils/validation.h"
 
 namespace utils {
 
-EloCalculator::EloCalculator(int k_factor) : k_factor_(k_factor) {}
+namespace {
 
-double EloCalculator::expectedScore(int elo1, int elo2) {
-  return 1.0 / (1.0 + std::pow(10.0, (elo2 - elo1) / 400.0));
+// Ratings live in [MIN_ELO, MAX_ELO], so elo2 - elo1 fits this range
+constexpr int kMaxDiff = MAX_ELO - MIN_ELO;
+
+double expectedScoreForDiff(int diff) {
+  return 1.0 / (1.0 + std::pow(10.0, diff / 400.0));
+}
+
+// Player1's expected score indexed by (elo2 - elo1) + kMaxDiff
+const std::vector<double>& expectedScoreTable() {
+  static const std::vector<double> table = [] {
+    std::vector<double> values(2 * kMaxDiff + 1);
+    for (int diff = -kMaxDiff; diff <= kMaxDiff; ++diff) {
+      values[diff + kMaxDiff] = expectedScoreForDiff(diff);
+    }
+    return values;
+  }();
+  return table;
+}
+
+// exp(x) by Taylor series; only used at compile time for x in [0, ln 10)
+constexpr double constexprExp(double x) {
+  double term = 1.0;
+  double sum = 1.0;
+  for (int n = 1; n < 40; ++n) {
+    term *= x / n;
+    sum += term;
+  }
+  return sum;
+}
+
+constexpr double kLn10 = 2.302585092994045684017991454684364208;
+constexpr int kDecade = 400;  // Rating points per factor of 10 in the odds
+
+// 10^(diff / 400) is 10^q * 10^(r / 400) with diff = 400q + r, 0 <= r < 400.
+// The table is filled one decade (fixed q) at a time from 400 series values
+// and exact powers of ten, which keeps it within the default constexpr step
+// limits of GCC, Clang and MSVC; a series per entry would not.
+constexpr std::array<double, 2 * kMaxDiff + 1> makeExpectedScoreTable() {
+  static_assert(kMaxDiff % kDecade == 0, "table must start on a decade boundary");
+  constexpr int kMaxQuotient = kMaxDiff / kDecade;
+
+  std::array<double, kDecade> fractions{};
+  for (int r = 0; r < kDecade; ++r) {
+    fractions[r] = constexprExp(r * kLn10 / kDecade);
+  }
+  std::array<double, kMaxQuotient + 1> tens{};
+  tens[0] = 1.0;
+  for (int q = 1; q <= kMaxQuotient; ++q) {
+    tens[q] = tens[q - 1] * 10.0;
+  }
+
+  std::array<double, 2 * kMaxDiff + 1> values{};
+  size_t index = 0;  // diff + kMaxDiff
+  for (int q = -kMaxQuotient; q < kMaxQuotient; ++q) {
+    double whole = q >= 0 ? tens[q] : 1.0 / tens[-q];
+    for (int r = 0; r < kDecade; ++r) {
+      values[index++] = 1.0 / (1.0 + whole * fractions[r]);
+    }
+  }
+  values[index] = 1.0 / (1.0 + tens[kMaxQuotient]);  // diff == kMaxDiff
+  return values;
+}
+
+// Same layout as expectedScoreTable(), generated by the compiler
+constexpr auto kCompileTimeTable = makeExpectedScoreTable();
+
+// Table lookup; outside the table `exact` falls back to libm, the
+// compile-time table clamps instead (the score is within 1e-25 of 0 or 1)
+inline double tableExpectedScore(const double* table, bool exact, int elo1, int elo2) {
+  int diff = elo2 - elo1;
+  if (diff < -kMaxDiff || diff > kMaxDiff) {
+    if (exact) {
+      return expectedScoreForDiff(diff);
+    }
+    diff = diff < 0 ? -kMaxDiff : kMaxDiff;
+  }
+  return table[diff + kMaxDiff];
+}
+
+// Branch-free body, same arithmetic as calculate() term by term; k1/k2 map
+// the match index to each player's K
+template<typename K1, typename K2>
+void batchKernel(const double* table, bool exact,
+                 std::span<const int> elo1, std::span<const int> elo2,
+                 std::span<const int> score1, std::span<const int> score2,
+                 std::span<int> new_elo1, std::span<int> new_elo2, K1 k1, K2 k2) {
+  const size_t n = elo1.size();
+  for (size_t i = 0; i < n; ++i) {
+    double expected1 = tableExpectedScore(table, exact, elo1[i], elo2[i]);
+    double expected2 = 1.0 - expected1;
+    double actual1 = score1[i] > score2[i] ? 1.0 : (score1[i] < score2[i] ? 0.0 : 0.5);
+    double actual2 = 1.0 - actual1;
+    new_elo1[i] = elo1[i] + static_cast<int>(k1(i) * (actual1 - expected1));
+    new_elo2[i] = elo2[i] + static_cast<int>(k2(i) * (actual2 - expected2));
+  }
+}
+
+}  // namespace
+
+EloCalculator::EloCalculator(int k_factor, ExpectedScoreMode mode)
+    : k_factor_(k_factor), mode_(mode) {}
+
+double EloCalculator::expectedScore(int elo1, int elo2) const {
+  if (mode_ == ExpectedScoreMode::kTable) {
+    return tableExpectedScore(kCompileTimeTable.data(), false, elo1, elo2);
+  }
+  return expectedScoreForDiff(elo2 - elo1);
 }
 
 int EloCalculator::calculateChange(int elo, double expected_score, 
-                                   double actual_score) {
+                                   double actual_score) const {
   return static_cast<int>(k_factor_ * (actual_score - expected_score));
 }
 
 std::pair<int, int> EloCalculator::calculate(int elo1, int elo2,
-                                             int score1, int score2) {
+                                             int score1, int score2) const {
+  return calculate(elo1, elo2, score1, score2, k_factor_, k_factor_);
+}
+
+std::pair<int, int> EloCalculator::calculate(int elo1, int elo2, int score1, int score2,
+                                             int k_factor1, int k_factor2) const {
   double expected1 = expectedScore(elo1, elo2);
   double expected2 = 1.0 - expected1;
   
@@ -35,8 +149,8 @@ std::pair<int, int> EloCalculator::calculate(int elo1, int elo2,
     actual2 = 0.5;
   }
   
-  int change1 = calculateChange(elo1, expected1, actual1);
-  int change2 = calculateChange(elo2, expected2, actual2);
+  int change1 = static_cast<int>(k_factor1 * (actual1 - expected1));
+  int change2 = static_cast<int>(k_factor2 * (actual2 - expected2));
   
   int new_elo1 = elo1 + change1;
   int new_elo2 = elo2 + change2;
@@ -44,5 +158,49 @@ std::pair<int, int> EloCalculator::calculate(int elo1, int elo2,
   return {new_elo1, new_elo2};
 }
 
+void EloCalculator::expectedScores(std::span<const int> elo1, std::span<const int> elo2,
+                                   std::span<double> expected1) const {
+  if (elo2.size() != elo1.size() || expected1.size() != elo1.size()) {
+    throw std::invalid_argument("expectedScores: spans must have the same length");
+  }
+  const bool exact = mode_ == ExpectedScoreMode::kExact;
+  const double* table = exact ? expectedScoreTable().data() : kCompileTimeTable.data();
+  const size_t n = elo1.size();
+  for (size_t i = 0; i < n; ++i) {
+    expected1[i] = tableExpectedScore(table, exact, elo1[i], elo2[i]);
+  }
+}
+
+void EloCalculator::calculateBatch(std::span<const int> elo1, std::span<const int> elo2,
+                                   std::span<const int> score1, std::span<const int> score2,
+                                   std::span<int> new_elo1, std::span<int> new_elo2) const {
+  const size_t n = elo1.size();
+  if (elo2.size() != n || score1.size() != n || score2.size() != n ||
+      new_elo1.size() != n || new_elo2.size() != n) {
+    throw std::invalid_argument("calculateBatch: spans must have the same length");
+  }
+  const bool exact = mode_ == ExpectedScoreMode::kExact;
+  const double* table = exact ? expectedScoreTable().data() : kCompileTimeTable.data();
+  auto k = [k = k_factor_](size_t) { return k; };
+  batchKernel(table, exact, elo1, elo2, score1, score2, new_elo1, new_elo2, k, k);
+}
+
+void EloCalculator::calculateBatch(std::span<const int> elo1, std::span<const int> elo2,
+                                   std::span<const int> score1, std::span<const int> score2,
+                                   std::span<const int> k_factor1, std::span<const int> k_factor2,
+                                   std::span<int> new_elo1, std::span<int> new_elo2) const {
+  const size_t n = elo1.size();
+  if (elo2.size() != n || score1.size() != n || score2.size() != n ||
+      k_factor1.size() != n || k_factor2.size() != n ||
+      new_elo1.size() != n || new_elo2.size() != n) {
+    throw std::invalid_argument("calculateBatch: spans must have the same length");
+  }
+  const bool exact = mode_ == ExpectedScoreMode::kExact;
+  const double* table = exact ? expectedScoreTable().data() : kCompileTimeTable.data();
+  batchKernel(table, exact, elo1, elo2, score1, score2, new_elo1, new_elo2,
+              [k_factor1](size_t i) { return k_factor1[i]; },
+              [k_factor2](size_t i) { return k_factor2[i]; });
+}
+
 }  // namespace utils
 
@@ -0,0 +1,89 @@
+#include "utils/elo_replay.h"
+
+namespace utils {
+
+EloReplay::EloReplay(const RatingEngine& engine, int initial_elo)
+    : engine_(&engine), initial_elo_(initial_elo) {}
+
+EloReplay::EloReplay(const EloCalculator& calculator, int initial_elo)
+    : owned_engine_(std::make_unique<EloEngine>(calculator)),
+      engine_(owned_engine_.get()),
+      initial_elo_(initial_elo) {}
+
+size_t EloReplay::indexOf(int64_t player_id) {
+  auto [it, inserted] = index_.try_emplace(player_id, player_ids_.size());
+  if (inserted) {
+    player_ids_.push_back(player_id);
+    elo_.push_back(initial_elo_);
+    deviation_.push_back(kInitialDeviation);
+    volatility_.push_back(kInitialVolatility);
+    played_.push_back(0);
+    won_.push_back(0);
+    lost_.push_back(0);
+  }
+  return it->second;
+}
+
+void EloReplay::addPlayer(int64_t player_id) {
+  indexOf(player_id);
+}
+
+std::vector<ReplayedMatch> EloReplay::replay(const std::vector<ReplayMatch>& matches) {
+  std::vector<ReplayedMatch> replayed;
+  replayed.reserve(matches.size());
+
+  for (const auto& match : matches) {
+    size_t p1 = indexOf(match.player1_id);
+    size_t p2 = indexOf(match.player2_id);
+
+    ReplayedMatch result;
+    result.player1_elo_before = elo_[p1];
+    result.player2_elo_before = elo_[p2];
+    Rating player1{elo_[p1], deviation_[p1], volatility_[p1]};
+    Rating player2{elo_[p2], deviation_[p2], volatility_[p2]};
+    player1.k_factor = match.player1_k_factor;
+    player2.k_factor = match.player2_k_factor;
+    const RatingEngine& engine = engines_ && match.system ? engines_->get(*match.system) : *engine_;
+    if (k_policy_ && player1.k_factor == 0) {
+      player1.k_factor = k_policy_->kFor(elo_[p1], played_[p1], match.player1_score, match.player2_score,
+                                         engine.system());
+    }
+    if (k_policy_ && player2.k_factor == 0) {
+      player2.k_factor = k_policy_->kFor(elo_[p2], played_[p2], match.player1_score, match.player2_score,
+                                         engine.system());
+    }
+    auto [new1, new2] = engine.rate(player1, player2, match.player1_score, match.player2_score);
+    result.player1_elo_after = new1.rating;
+    result.player2_elo_after = new2.rating;
+    replayed.push_back(result);
+
+    elo_[p1] = new1.rating;
+    elo_[p2] = new2.rating;
+    deviation_[p1] = new1.deviation;
+    deviation_[p2] = new2.deviation;
+    volatility_[p1] = new1.volatility;
+    volatility_[p2] = new2.volatility;
+    played_[p1]++;
+    played_[p2]++;
+    if (match.player1_score > match.player2_score) {
+      won_[p1]++;
+      lost_[p2]++;
+    } else if (match.player1_score < match.player2_score) {
+      lost_[p1]++;
+      won_[p2]++;
+    }
+  }
+  return replayed;
+}
+
+std::vector<ReplayedPlayer> EloReplay::players() const {
+  std::vector<ReplayedPlayer> players;
+  players.reserve(player_ids_.size());
+  for (size_t i = 0; i < player_ids_.size(); ++i) {
+    players.push_back({player_ids_[i], elo_[i], played_[i], won_[i], lost_[i],
+                       deviation_[i], volatility_[i]});
+  }
+  return players;
+}
+
+}  // namespace utils
@@ -0,0 +1,96 @@
+#include "utils/k_factor_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace utils {
+
+namespace {
+
+// Keeps a mistyped policy from turning one match into a rating wipe-out
+constexpr int kMaxKFactor = 200;
+
+void checkK(int k_factor, const std::string& field) {
+  if (k_factor < 1 || k_factor > kMaxKFactor) {
+    throw std::invalid_argument(field + " must be between 1 and " + std::to_string(kMaxKFactor) +
+                                ", got: " + std::to_string(k_factor));
+  }
+}
+
+}  // namespace
+
+int KFactorPolicy::kFor(int rating, int matches_played, int score1, int score2,
+                        RatingSystem system) const {
+  int k = k_factor;
+  if (matches_played < provisional_matches) {
+    k = provisional_k_factor;
+  } else {
+    // Bands are kept sorted by min_rating
+    for (auto it = bands.rbegin(); it != bands.rend(); ++it) {
+      if (rating >= it->min_rating) {
+        k = it->k_factor;
+        break;
+      }
+    }
+  }
+  int margin = std::abs(score1 - score2);
+  if (margin_weight > 0.0 && margin > 1 && system != RatingSystem::kMarginElo) {
+    k = static_cast<int>(std::lround(k * (1.0 + margin_weight * std::log(margin))));
+  }
+  return std::clamp(k, 1, kMaxKFactor);
+}
+
+KFactorPolicy KFactorPolicy::fromJson(const std::string& json, const KFactorPolicy& defaults) {
+  KFactorPolicy policy = defaults;
+  try {
+    auto parsed = nlohmann::json::parse(json);
+    if (!parsed.is_object()) {
+      throw std::invalid_argument("K-factor policy must be a JSON object");
+    }
+    policy.k_factor = parsed.value("k_factor", policy.k_factor);
+    policy.provisional_matches = parsed.value("provisional_matches", policy.provisional_matches);
+    policy.provisional_k_factor = parsed.value("provisional_k_factor", policy.provisional_k_factor);
+    policy.margin_weight = parsed.value("margin_weight", policy.margin_weight);
+    if (parsed.contains("bands")) {
+      policy.bands.clear();
+      for (const auto& band : parsed.at("bands")) {
+        policy.bands.push_back({band.at("min_rating").get<int>(), band.at("k_factor").get<int>()});
+      }
+    }
+  } catch (const nlohmann::json::exception& e) {
+    throw std::invalid_argument("Invalid K-factor policy: " + std::string(e.what()));
+  }
+
+  checkK(policy.k_factor, "k_factor");
+  checkK(policy.provisional_k_factor, "provisional_k_factor");
+  if (policy.provisional_matches < 0) {
+    throw std::invalid_argument("provisional_matches cannot be negative");
+  }
+  if (policy.margin_weight < 0.0 || policy.margin_weight > 2.0) {
+    throw std::invalid_argument("margin_weight must be between 0 and 2");
+  }
+  for (const auto& band : policy.bands) {
+    checkK(band.k_factor, "bands.k_factor");
+  }
+  std::sort(policy.bands.begin(), policy.bands.end(),
+            [](const Band& a, const Band& b) { return a.min_rating < b.min_rating; });
+  return policy;
+}
+
+nlohmann::json KFactorPolicy::toJson() const {
+  nlohmann::json json = {
+    {"k_factor", k_factor},
+    {"provisional_matches", provisional_matches},
+    {"provisional_k_factor", provisional_k_factor},
+    {"margin_weight", margin_weight},
+    {"bands", nlohmann::json::array()},
+  };
+  for (const auto& band : bands) {
+    json["bands"].push_back({{"min_rating", band.min_rating}, {"k_factor", band.k_factor}});
+  }
+  return json;
+}
+
+}  // namespace utils
@@ -0,0 +1,238 @@
+#include "utils/rating_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace utils {
+
+namespace {
+
+// Glicko-2 works on a scale where 1500 / 350 map to 0 / 2.01
+constexpr double kGlickoScale = 173.7178;
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kVolatilityTolerance = 1e-6;
+
+double actualScore(int score1, int score2) {
+  return score1 > score2 ? 1.0 : (score1 < score2 ? 0.0 : 0.5);
+}
+
+// Player's own K when a policy set one
+int kOr(const Rating& player, int k_factor) {
+  return player.k_factor > 0 ? player.k_factor : k_factor;
+}
+
+double glickoG(double phi) {
+  return 1.0 / std::sqrt(1.0 + 3.0 * phi * phi / (kPi * kPi));
+}
+
+}  // namespace
+
+std::string_view toString(RatingSystem system) {
+  switch (system) {
+    case RatingSystem::kElo:
+      return "elo";
+    case RatingSystem::kGlicko2:
+      return "glicko2";
+    case RatingSystem::kMarginElo:
+      return "margin_elo";
+  }
+  return "elo";
+}
+
+std::optional<RatingSystem> parseRatingSystem(std::string_view name) {
+  for (auto system : {RatingSystem::kElo, RatingSystem::kGlicko2, RatingSystem::kMarginElo}) {
+    if (toString(system) == name) {
+      return system;
+    }
+  }
+  return std::nullopt;
+}
+
+void RatingBatch::validate() const {
+  const size_t n = rating1.size();
+  if (rating2.size() != n || deviation1.size() != n || deviation2.size() != n ||
+      volatility1.size() != n || volatility2.size() != n ||
+      score1.size() != n || score2.size() != n) {
+    throw std::invalid_argument("RatingBatch: spans must have the same length");
+  }
+  if (k_factor1.size() != k_factor2.size() || (!k_factor1.empty() && k_factor1.size() != n)) {
+    throw std::invalid_argument("RatingBatch: K-factor spans must be empty or match the batch");
+  }
+}
+
+// ============================================================================
+// ELO
+// ============================================================================
+
+std::pair<Rating, Rating> EloEngine::rate(const Rating& player1, const Rating& player2,
+                                          int score1, int score2) const {
+  auto [elo1, elo2] = calculator_.calculate(player1.rating, player2.rating, score1, score2,
+                                            kOr(player1, calculator_.kFactor()),
+                                            kOr(player2, calculator_.kFactor()));
+  Rating new1 = player1;
+  Rating new2 = player2;
+  new1.rating = elo1;
+  new2.rating = elo2;
+  return {new1, new2};
+}
+
+void EloEngine::rateBatch(const RatingBatch& batch) const {
+  batch.validate();
+  // calculateBatch reads element i before writing it, so in place is fine
+  if (batch.k_factor1.empty()) {
+    calculator_.calculateBatch(batch.rating1, batch.rating2, batch.score1, batch.score2,
+                               batch.rating1, batch.rating2);
+  } else {
+    calculator_.calculateBatch(batch.rating1, batch.rating2, batch.score1, batch.score2,
+                               batch.k_factor1, batch.k_factor2, batch.rating1, batch.rating2);
+  }
+}
+
+// ============================================================================
+// Margin-aware ELO
+// ============================================================================
+
+double MarginEloEngine::marginMultiplier(int rating1, int rating2, int score1, int score2) {
+  if (score1 == score2) {
+    return 1.0;
+  }
+  int margin = std::abs(score1 - score2);
+  // Positive when the favourite won; floored so big upsets stay bounded
+  int winner_diff = std::max(score1 > score2 ? rating1 - rating2 : rating2 - rating1, -1000);
+  return std::log(margin + 1.0) * 2.2 / (winner_diff * 0.001 + 2.2);
+}
+
+std::pair<Rating, Rating> MarginEloEngine::rate(const Rating& player1, const Rating& player2,
+                                                int score1, int score2) const {
+  double expected1 = calculator_.expectedScore(player1.rating, player2.rating);
+  double actual1 = actualScore(score1, score2);
+  double multiplier = marginMultiplier(player1.rating, player2.rating, score1, score2);
+  double k1 = kOr(player1, k_factor_) * multiplier;
+  double k2 = kOr(player2, k_factor_) * multiplier;
+  Rating new1 = player1;
+  Rating new2 = player2;
+  new1.rating += static_cast<int>(k1 * (actual1 - expected1));
+  new2.rating += static_cast<int>(k2 * ((1.0 - actual1) - (1.0 - expected1)));
+  return {new1, new2};
+}
+
+void MarginEloEngine::rateBatch(const RatingBatch& batch) const {
+  batch.validate();
+  const size_t n = batch.size();
+  std::vector<double> expected(n);
+  calculator_.expectedScores(batch.rating1, batch.rating2, expected);
+  const bool per_player = !batch.k_factor1.empty();
+  for (size_t i = 0; i < n; ++i) {
+    int r1 = batch.rating1[i];
+    int r2 = batch.rating2[i];
+    double actual1 = actualScore(batch.score1[i], batch.score2[i]);
+    double multiplier = marginMultiplier(r1, r2, batch.score1[i], batch.score2[i]);
+    double k1 = (per_player ? batch.k_factor1[i] : k_factor_) * multiplier;
+    double k2 = (per_player ? batch.k_factor2[i] : k_factor_) * multiplier;
+    batch.rating1[i] = r1 + static_cast<int>(k1 * (actual1 - expected[i]));
+    batch.rating2[i] = r2 + static_cast<int>(k2 * ((1.0 - actual1) - (1.0 - expected[i])));
+  }
+}
+
+// ============================================================================
+// Glicko-2
+// ============================================================================
+
+Rating Glicko2Engine::update(const Rating& player, const Rating& opponent, double score) const {
+  double mu = (player.rating - kInitialRating) / kGlickoScale;
+  double phi = player.deviation / kGlickoScale;
+  double opponent_mu = (opponent.rating - kInitialRating) / kGlickoScale;
+  double g = glickoG(opponent.deviation / kGlickoScale);
+  double expected = 1.0 / (1.0 + std::exp(-g * (mu - opponent_mu)));
+  double v = 1.0 / (g * g * expected * (1.0 - expected));
+  double delta = v * g * (score - expected);
+
+  // New volatility: root of f by the Illinois algorithm (step 5 of the paper)
+  double a = std::log(player.volatility * player.volatility);
+  double tau2 = tau_ * tau_;
+  auto f = [&](double x) {
+    double ex = std::exp(x);
+    double denom = phi * phi + v + ex;
+    return ex * (delta * delta - phi * phi - v - ex) / (2.0 * denom * denom) - (x - a) / tau2;
+  };
+  double lower = a;
+  double upper;
+  if (delta * delta > phi * phi + v) {
+    upper = std::log(delta * delta - phi * phi - v);
+  } else {
+    int k = 1;
+    while (f(a - k * tau_) < 0) {
+      k++;
+    }
+    upper = a - k * tau_;
+  }
+  double f_lower = f(lower);
+  double f_upper = f(upper);
+  for (int i = 0; i < 100 && std::abs(upper - lower) > kVolatilityTolerance; ++i) {
+    double c = lower + (lower - upper) * f_lower / (f_upper - f_lower);
+    double f_c = f(c);
+    if (f_c * f_upper < 0) {
+      lower = upper;
+      f_lower = f_upper;
+    } else {
+      f_lower /= 2.0;
+    }
+    upper = c;
+    f_upper = f_c;
+  }
+  double volatility = std::exp(lower / 2.0);
+
+  double phi_star = std::sqrt(phi * phi + volatility * volatility);
+  double new_phi = 1.0 / std::sqrt(1.0 / (phi_star * phi_star) + 1.0 / v);
+  double new_mu = mu + new_phi * new_phi * g * (score - expected);
+
+  Rating result;
+  result.rating = static_cast<int>(std::lround(new_mu * kGlickoScale + kInitialRating));
+  result.deviation = std::min(new_phi * kGlickoScale, kInitialDeviation);
+  result.volatility = volatility;
+  return result;
+}
+
+std::pair<Rating, Rating> Glicko2Engine::rate(const Rating& player1, const Rating& player2,
+                                              int score1, int score2) const {
+  double actual1 = actualScore(score1, score2);
+  // Both updates use the ratings from before the match
+  return {update(player1, player2, actual1), update(player2, player1, 1.0 - actual1)};
+}
+
+void Glicko2Engine::rateBatch(const RatingBatch& batch) const {
+  batch.validate();
+  const size_t n = batch.size();
+  for (size_t i = 0; i < n; ++i) {
+    Rating player1{batch.rating1[i], batch.deviation1[i], batch.volatility1[i]};
+    Rating player2{batch.rating2[i], batch.deviation2[i], batch.volatility2[i]};
+    auto [new1, new2] = rate(player1, player2, batch.score1[i], batch.score2[i]);
+    batch.rating1[i] = new1.rating;
+    batch.deviation1[i] = new1.deviation;
+    batch.volatility1[i] = new1.volatility;
+    batch.rating2[i] = new2.rating;
+    batch.deviation2[i] = new2.deviation;
+    batch.volatility2[i] = new2.volatility;
+  }
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+RatingEngines::RatingEngines(const Options& options) {
+  engines_[static_cast<size_t>(RatingSystem::kElo)] =
+      std::make_unique<EloEngine>(EloCalculator(options.k_factor, options.mode));
+  engines_[static_cast<size_t>(RatingSystem::kGlicko2)] =
+      std::make_unique<Glicko2Engine>(options.glicko_tau);
+  engines_[static_cast<size_t>(RatingSystem::kMarginElo)] =
+      std::make_unique<MarginEloEngine>(options.k_factor, options.mode);
+}
+
+const RatingEngine& RatingEngines::get(RatingSystem system) const {
+  return *engines_[static_cast<size_t>(system)];
+}
+
+}  // namespace utils
@@ -0,0 +1,105 @@
+#include "utils/thread_pool.h"
+
+#include <exception>
+#include <stdexcept>
+#include "observability/logger.h"
+
+namespace utils {
+
+ThreadPool::ThreadPool(size_t num_threads, size_t max_queue_depth)
+    : max_queue_depth_(max_queue_depth) {
+  if (num_threads == 0) {
+    throw std::invalid_argument("ThreadPool requires at least one thread");
+  }
+
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  shutdown();
+}
+
+bool ThreadPool::trySubmit(Task task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ || tasks_.size() >= max_queue_depth_) {
+      return false;
+    }
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+  return true;
+}
+
+void ThreadPool::shutdown() {
+  // Take the workers under the lock so concurrent calls (an explicit
+  // shutdown() racing the destructor) never join the same thread twice
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_ && workers_.empty()) {
+      return;
+    }
+    stopping_ = true;
+    workers.swap(workers_);
+  }
+  cv_.notify_all();
+
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+size_t ThreadPool::getQueueDepth() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+size_t ThreadPool::getBusyWorkers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return busy_workers_;
+}
+
+size_t ThreadPool::getThreadCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return workers_.size();
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+
+      // Drain remaining work before exiting so accepted requests are answered
+      if (tasks_.empty()) {
+        return;
+      }
+
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      busy_workers_++;
+    }
+
+    try {
+      task();
+    } catch (const std::exception& e) {
+      OBS_ERROR(observability::Logger::getInstance(), "ThreadPool: task threw: " + std::string(e.what()));
+    } catch (...) {
+      OBS_ERROR(observability::Logger::getInstance(), "ThreadPool: task threw unknown exception");
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      busy_workers_--;
+    }
+  }
+}
+
+}  // namespace utils
@@ -121,7 +121,6 @@ class BotScenariosTest : public ::testing::Test {
       txn.exec("DELETE FROM groups WHERE telegram_group_id > 1000000");
       txn.exec("DELETE FROM players WHERE telegram_user_id > 1000000");
       txn.commit();
-      db_pool_->release(conn);
     } catch (const std::exception&) {
       // Ignore cleanup errors
     }
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "database/connection_pool.h"
+#include "repositories/elo_replay_engine.h"
+#include "repositories/group_repository.h"
+#include "repositories/match_repository.h"
+#include "utils/elo_calculator.h"
+#include "utils/rating_engine.h"
+#include <cstdlib>
+#include <string>
+#include <pqxx/pqxx>
+
+class EloReplayEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Get database connection string from environment
+    const char* db_url = std::getenv("DATABASE_URL");
+    if (!db_url) {
+      std::string host = std::getenv("POSTGRES_HOST") ? std::getenv("POSTGRES_HOST") : "localhost";
+      std::string port = std::getenv("POSTGRES_PORT") ? std::getenv("POSTGRES_PORT") : "5432";
+      std::string db = std::getenv("POSTGRES_DB") ? std::getenv("POSTGRES_DB") : "school_tg_bot";
+      std::string user = std::getenv("POSTGRES_USER") ? std::getenv("POSTGRES_USER") : "postgres";
+      std::string password = std::getenv("POSTGRES_PASSWORD") ? std::getenv("POSTGRES_PASSWORD") : "postgres";
+
+      connection_string_ = "postgresql://" + user + ":" + password + "@" + host + ":" + port + "/" + db;
+    } else {
+      connection_string_ = db_url;
+    }
+
+    database::ConnectionPool::Config config;
+    config.connection_string = connection_string_;
+    config.min_size = 1;
+    config.max_size = 3;
+    pool_ = std::shared_ptr<database::ConnectionPool>(database::ConnectionPool::create(config));
+    if (!pool_->healthCheck()) {
+      FAIL() << "Database connection failed. Cannot run replay tests.";
+    }
+    match_repo_ = std::make_unique<repositories::MatchRepository>(pool_);
+    group_repo_ = std::make_unique<repositories::GroupRepository>(pool_);
+    cleanupTestData();
+  }
+
+  void TearDown() override {
+    cleanupTestData();
+  }
+
+  void cleanupTestData() {
+    try {
+      auto conn = pool_->acquire();
+      pqxx::work txn(*conn);
+      txn.exec("DELETE FROM elo_history WHERE group_id IN (SELECT id FROM groups WHERE telegram_group_id = " + std::to_string(kGroup) + ")");
+      txn.exec("DELETE FROM matches WHERE group_id IN (SELECT id FROM groups WHERE telegram_group_id = " + std::to_string(kGroup) + ")");
+      txn.exec("DELETE FROM group_players WHERE group_id IN (SELECT id FROM groups WHERE telegram_group_id = " + std::to_string(kGroup) + ")");
+      txn.exec("DELETE FROM groups WHERE telegram_group_id = " + std::to_string(kGroup));
+      txn.exec("DELETE FROM players WHERE telegram_user_id BETWEEN 4000001 AND 4000003");
+      txn.commit();
+    } catch (const std::exception&) {
+      // Ignore cleanup errors
+    }
+  }
+
+  // Register p1 vs p2 at the ratings the calculator gives for the current state
+  models::Match play(int64_t p1, int64_t p2, int score1, int score2) {
+    auto [r1, r2] = match_repo_->getRatings(kGroup, p1, p2);
+    auto [elo1, elo2] = calculator_.calculate(r1.current_elo, r2.current_elo, score1, score2);
+    models::MatchRegistration registration;
+    registration.telegram_group_id = kGroup;
+    registration.player1_telegram_user_id = p1;
+    registration.player2_telegram_user_id = p2;
+    registration.player1_score = score1;
+    registration.player2_score = score2;
+    registration.player1_before = r1;
+    registration.player2_before = r2;
+    registration.player1_elo_after = elo1;
+    registration.player2_elo_after = elo2;
+    registration.idempotency_key = "replay_" + std::to_string(++matches_);
+    registration.created_by_telegram_user_id = p1;
+    return match_repo_->registerMatch(registration);
+  }
+
+  static constexpr int64_t kGroup = 4000000;
+  static constexpr int64_t kA = 4000001;
+  static constexpr int64_t kB = 4000002;
+  static constexpr int64_t kC = 4000003;
+
+  std::string connection_string_;
+  std::shared_ptr<database::ConnectionPool> pool_;
+  std::unique_ptr<repositories::MatchRepository> match_repo_;
+  std::unique_ptr<repositories::GroupRepository> group_repo_;
+  utils::EloCalculator calculator_{32};
+  int matches_ = 0;
+};
+
+TEST_F(EloReplayEngineTest, UndoingAnOldMatchReratesLaterMatches) {
+  auto first = play(kA, kB, 11, 3);
+  play(kA, kC, 11, 8);
+  auto third = play(kB, kC, 11, 9);
+
+  auto conn = pool_->acquire();
+  {
+    pqxx::work work(*conn);
+    work.exec_params("UPDATE matches SET is_undone = TRUE WHERE id = $1", first.id);
+    repositories::EloReplayEngine engine(calculator_);
+    auto result = engine.recompute(work, first.group_id);
+    EXPECT_EQ(result.matches, 2u);
+    EXPECT_EQ(result.matches_changed, 2u);
+    work.commit();
+  }
+
+  // Expected: only A-C and B-C were ever played
+  auto [a, c] = calculator_.calculate(1500, 1500, 11, 8);
+  auto [b, c2] = calculator_.calculate(1500, c, 11, 9);
+
+  pqxx::work check(*conn);
+  auto row = check.exec_params1(
+      "SELECT player1_elo_before, player2_elo_before, player1_elo_after FROM matches WHERE id = $1",
+      third.id);
+  EXPECT_EQ(row[0].as<int>(), 1500);
+  EXPECT_EQ(row[1].as<int>(), c);
+  EXPECT_EQ(row[2].as<int>(), b);
+
+  auto player_a = group_repo_->getOrCreateGroupPlayer(first.group_id, first.player1_id);
+  EXPECT_EQ(player_a.current_elo, a);
+  EXPECT_EQ(player_a.matches_played, 1);
+  auto player_b = group_repo_->getOrCreateGroupPlayer(first.group_id, first.player2_id);
+  EXPECT_EQ(player_b.current_elo, b);
+  EXPECT_EQ(player_b.matches_lost, 0);
+
+  auto history = check.exec_params1(
+      "SELECT elo_before, elo_after, elo_change FROM elo_history "
+      "WHERE match_id = $1 AND player_id = $2 AND is_undone = FALSE",
+      third.id, third.player2_id);
+  EXPECT_EQ(history[0].as<int>(), c);
+  EXPECT_EQ(history[1].as<int>(), c2);
+  EXPECT_EQ(history[2].as<int>(), c2 - c);
+  check.commit();
+}
+
+TEST_F(EloReplayEngineTest, KeepsTheSystemAndKEachMatchWasRatedWith) {
+  // A margin_elo match with policy K-factors, then the group goes back to
+  // plain ELO without a policy
+  utils::RatingEngines engines;
+  const auto& margin = engines.get(utils::RatingSystem::kMarginElo);
+  auto [r1, r2] = match_repo_->getRatings(kGroup, kA, kB);
+  utils::Rating player1{r1.current_elo};
+  player1.k_factor = 40;
+  utils::Rating player2{r2.current_elo};
+  player2.k_factor = 16;
+  auto [new1, new2] = margin.rate(player1, player2, 11, 1);
+  models::MatchRegistration registration;
+  registration.telegram_group_id = kGroup;
+  registration.player1_telegram_user_id = kA;
+  registration.player2_telegram_user_id = kB;
+  registration.player1_score = 11;
+  registration.player2_score = 1;
+  registration.player1_before = r1;
+  registration.player2_before = r2;
+  registration.player1_elo_after = new1.rating;
+  registration.player2_elo_after = new2.rating;
+  registration.rating_system = "margin_elo";
+  registration.player1_k_factor = 40;
+  registration.player2_k_factor = 16;
+  registration.idempotency_key = "replay_margin";
+  registration.created_by_telegram_user_id = kA;
+  auto match = match_repo_->registerMatch(registration);
+
+  auto conn = pool_->acquire();
+  pqxx::work work(*conn);
+  repositories::EloReplayEngine engine(engines.get(utils::RatingSystem::kElo));
+  engine.setEngines(&engines);
+  auto result = engine.recompute(work, match.group_id);
+  EXPECT_EQ(result.matches, 1u);
+  EXPECT_EQ(result.matches_changed, 0u);
+  EXPECT_TRUE(result.changed_players.empty());
+  auto row = work.exec_params1(
+      "SELECT rating_system, player1_k_factor, player2_k_factor FROM matches WHERE id = $1", match.id);
+  EXPECT_EQ(row[0].as<std::string>(), "margin_elo");
+  EXPECT_EQ(row[1].as<int>(), 40);
+  EXPECT_EQ(row[2].as<int>(), 16);
+}
@@ -2,6 +2,8 @@
 #include "repositories/group_repository.h"
 #include "repositories/player_repository.h"
 #include "database/connection_pool.h"
+#include "repositories/entity_cache.h"
+#include "utils/k_factor_policy.h"
 #include <cstdlib>
 #include <pqxx/pqxx>
 
@@ -63,7 +65,6 @@ class GroupRepositoryTest : public ::testing::Test {
       txn.exec("DELETE FROM group_players WHERE group_id IN (SELECT id FROM groups WHERE telegram_group_id > 1000000)");
       txn.exec("DELETE FROM groups WHERE telegram_group_id > 1000000");
       txn.commit();
-      pool_->release(conn);
     } catch (const std::exception&) {
       // Ignore cleanup errors
     }
@@ -241,7 +242,6 @@ TEST_F(GroupRepositoryTest, UpdateGroupPlayerOptimisticLockFailure) {
       gp1.id
     );
     txn.commit();
-    pool_->release(conn);
   }
   
   // Try to update with old version (should fail)
@@ -376,3 +376,150 @@ TEST_F(GroupRepositoryTest, GetTopicNonExistent) {
   EXPECT_FALSE(found.has_value());
 }
 
+
+TEST_F(GroupRepositoryTest, MigrateTelegramId) {
+  int64_t old_telegram_id = getNextTestGroupId();
+  int64_t new_telegram_id = getNextTestGroupId();
+  
+  auto group = group_repo_->createOrGet(old_telegram_id, "Migrating Group");
+  EXPECT_TRUE(group_repo_->migrateTelegramId(old_telegram_id, new_telegram_id));
+  
+  EXPECT_FALSE(group_repo_->getByTelegramId(old_telegram_id).has_value());
+  auto migrated = group_repo_->getByTelegramId(new_telegram_id);
+  ASSERT_TRUE(migrated.has_value());
+  EXPECT_EQ(migrated->id, group.id);
+  
+  // Target chat already has a group
+  int64_t other_telegram_id = getNextTestGroupId();
+  group_repo_->createOrGet(other_telegram_id);
+  EXPECT_FALSE(group_repo_->migrateTelegramId(other_telegram_id, new_telegram_id));
+}
+
+TEST_F(GroupRepositoryTest, SetRatingSystem) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  auto group = group_repo_->createOrGet(telegram_group_id, "Glicko Group");
+  EXPECT_EQ(group.rating_system, "elo");
+  
+  EXPECT_TRUE(group_repo_->setRatingSystem(telegram_group_id, "glicko2"));
+  auto updated = group_repo_->getByTelegramId(telegram_group_id);
+  ASSERT_TRUE(updated.has_value());
+  EXPECT_EQ(updated->rating_system, "glicko2");
+  
+  EXPECT_THROW(group_repo_->setRatingSystem(telegram_group_id, "trueskill"), std::invalid_argument);
+  EXPECT_FALSE(group_repo_->setRatingSystem(getNextTestGroupId(), "elo"));
+}
+
+TEST_F(GroupRepositoryTest, SetKFactorPolicy) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  auto group = group_repo_->createOrGet(telegram_group_id, "Policy Group");
+  EXPECT_FALSE(group.k_policy.has_value());
+  
+  EXPECT_TRUE(group_repo_->setKFactorPolicy(
+      telegram_group_id, R"({"provisional_matches": 10, "bands": [{"min_rating": 2000, "k_factor": 16}]})"));
+  auto updated = group_repo_->getByTelegramId(telegram_group_id);
+  ASSERT_TRUE(updated.has_value());
+  ASSERT_TRUE(updated->k_policy.has_value());
+  auto policy = utils::KFactorPolicy::fromJson(*updated->k_policy, utils::KFactorPolicy{});
+  EXPECT_EQ(policy.provisional_matches, 10);
+  ASSERT_EQ(policy.bands.size(), 1u);
+  EXPECT_EQ(policy.bands[0].k_factor, 16);
+  
+  EXPECT_THROW(group_repo_->setKFactorPolicy(telegram_group_id, R"({"k_factor": 0})"),
+               std::invalid_argument);
+  EXPECT_TRUE(group_repo_->clearKFactorPolicy(telegram_group_id));
+  EXPECT_FALSE(group_repo_->getByTelegramId(telegram_group_id)->k_policy.has_value());
+  EXPECT_FALSE(group_repo_->clearKFactorPolicy(getNextTestGroupId()));
+}
+
+TEST_F(GroupRepositoryTest, CachedRepositoriesSeeEachOthersWrites) {
+  auto cache = std::make_shared<repositories::EntityCache>();
+  repositories::GroupRepository cached_groups(pool_, cache);
+  repositories::PlayerRepository cached_players(pool_, cache);
+  int64_t telegram_group_id = getNextTestGroupId();
+  int64_t telegram_player_id = getNextTestPlayerId();
+  
+  auto group = cached_groups.createOrGet(telegram_group_id);
+  EXPECT_TRUE(cached_groups.getByTelegramId(telegram_group_id)->is_active);
+  EXPECT_EQ(cache->groups.size(), 1u);
+  
+  EXPECT_TRUE(cached_groups.setActive(telegram_group_id, false));
+  EXPECT_FALSE(cached_groups.getByTelegramId(telegram_group_id)->is_active);
+  
+  auto player = cached_players.createOrGet(telegram_player_id);
+  auto group_player = cached_groups.getOrCreateGroupPlayer(group.id, player.id);
+  group_player.current_elo = 1600;
+  group_player.matches_played = 1;
+  group_player.matches_won = 1;
+  ASSERT_TRUE(cached_groups.updateGroupPlayer(group_player));
+  
+  // Served from the cache at the version the database now holds
+  auto reread = cached_groups.getOrCreateGroupPlayer(group.id, player.id);
+  EXPECT_EQ(reread.current_elo, 1600);
+  EXPECT_EQ(reread.version, group_player.version + 1);
+  reread.current_elo = 1610;
+  EXPECT_TRUE(cached_groups.updateGroupPlayer(reread));
+  
+  cached_players.softDelete(player.id);
+  EXPECT_FALSE(cached_players.getByTelegramId(telegram_player_id).has_value());
+  EXPECT_EQ(cache->group_players.size(), 0u);
+}
+
+TEST_F(GroupRepositoryTest, TopicChecksAreServedFromCache) {
+  auto cache = std::make_shared<repositories::EntityCache>();
+  repositories::GroupRepository cached_groups(pool_, cache);
+  auto group = cached_groups.createOrGet(getNextTestGroupId());
+  
+  // Unconfigured groups are cached as well
+  EXPECT_FALSE(cached_groups.getTopic(group.id, 789, "matches").has_value());
+  EXPECT_FALSE(cached_groups.getTopicByType(group.id, "matches").has_value());
+  EXPECT_EQ(cached_groups.topicCacheStats().misses, 1u);
+  EXPECT_EQ(cached_groups.topicCacheStats().hits, 1u);
+  
+  models::GroupTopic topic;
+  topic.group_id = group.id;
+  topic.telegram_topic_id = 789;
+  topic.topic_type = "matches";
+  topic.is_active = true;
+  cached_groups.configureTopic(topic);
+  
+  auto found = cached_groups.getTopic(group.id, 789, "matches");
+  ASSERT_TRUE(found.has_value());
+  EXPECT_TRUE(found->is_active);
+  EXPECT_FALSE(cached_groups.getTopic(group.id, 790, "matches").has_value());
+  ASSERT_TRUE(cached_groups.getTopicByType(group.id, "matches").has_value());
+  EXPECT_EQ(cached_groups.topicCacheStats().misses, 2u);
+  EXPECT_EQ(cached_groups.topicCacheStats().hits, 3u);
+  
+  topic.is_active = false;
+  cached_groups.configureTopic(topic);
+  EXPECT_FALSE(cached_groups.getTopic(group.id, 789, "matches")->is_active);
+}
+
+TEST_F(GroupRepositoryTest, LeaderboardFollowsRatingWrites) {
+  auto cache = std::make_shared<repositories::EntityCache>();
+  repositories::GroupRepository cached_groups(pool_, cache);
+  auto group = cached_groups.createOrGet(getNextTestGroupId());
+  auto player1 = player_repo_->createOrGet(getNextTestPlayerId());
+  auto player2 = player_repo_->createOrGet(getNextTestPlayerId());
+  
+  cached_groups.getOrCreateGroupPlayer(group.id, player1.id);
+  auto group_player2 = cached_groups.getOrCreateGroupPlayer(group.id, player2.id);
+  
+  // Uncached repository reads the same ranking straight from group_players
+  EXPECT_EQ(group_repo_->getPlayerRank(group.id, player1.id)->rank, 1);
+  EXPECT_EQ(cached_groups.getLeaderboard(group.id).size(), 2u);
+  EXPECT_TRUE(cache->leaderboard.hasGroup(group.id));
+  
+  group_player2.current_elo = 1600;
+  group_player2.matches_played = 1;
+  group_player2.matches_won = 1;
+  ASSERT_TRUE(cached_groups.updateGroupPlayer(group_player2));
+  
+  auto top = cached_groups.getLeaderboard(group.id, 1);
+  ASSERT_EQ(top.size(), 1u);
+  EXPECT_EQ(top[0].player_id, player2.id);
+  EXPECT_EQ(cached_groups.getPlayerRank(group.id, player1.id)->rank, 2);
+  EXPECT_EQ(cached_groups.getPlayersAround(group.id, player1.id, 1).size(), 2u);
+  EXPECT_GE(cached_groups.rebuildLeaderboard(), 1u);
+  EXPECT_EQ(cached_groups.getPlayerRank(group.id, player2.id)->elo, 1600);
+}
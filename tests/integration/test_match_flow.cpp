@@ -74,7 +74,6 @@ class MatchFlowTest : public ::testing::Test {
       txn.exec("DELETE FROM groups WHERE telegram_group_id > 1000000");
       txn.exec("DELETE FROM players WHERE telegram_user_id > 1000000");
       txn.commit();
-      pool_->release(conn);
     } catch (const std::exception&) {
       // Ignore cleanup errors
     }
@@ -582,7 +581,6 @@ TEST_F(MatchFlowTest, RegisterMatchOptimisticLocking) {
       gp1.id
     );
     txn.commit();
-    pool_->release(conn);
   }
   
   // Register match (should retry and succeed)
@@ -3,6 +3,7 @@
 #include "repositories/group_repository.h"
 #include "repositories/player_repository.h"
 #include "database/connection_pool.h"
+#include "utils/retry.h"
 #include <cstdlib>
 #include <thread>
 #include <chrono>
@@ -71,7 +72,6 @@ class MatchRepositoryTest : public ::testing::Test {
       txn.exec("DELETE FROM groups WHERE telegram_group_id > 1000000");
       txn.exec("DELETE FROM players WHERE telegram_user_id > 1000000");
       txn.commit();
-      pool_->release(conn);
     } catch (const std::exception&) {
       // Ignore cleanup errors
     }
@@ -341,7 +341,6 @@ TEST_F(MatchRepositoryTest, CreateEloHistory) {
     created_match.id, player.id
   );
   txn.commit();
-  pool_->release(conn);
   
   EXPECT_FALSE(result.empty());
   EXPECT_GT(result[0]["cnt"].as<int>(), 0);
@@ -375,7 +374,6 @@ TEST_F(MatchRepositoryTest, CreateEloHistoryWithoutMatchId) {
     player.id
   );
   txn.commit();
-  pool_->release(conn);
   
   EXPECT_FALSE(result.empty());
   EXPECT_GT(result[0]["cnt"].as<int>(), 0);
@@ -414,3 +412,119 @@ TEST_F(MatchRepositoryTest, CreateEloHistoryInvalidInput) {
   EXPECT_THROW(match_repo_->createEloHistory(history), std::invalid_argument);
 }
 
+
+TEST_F(MatchRepositoryTest, RegisterMatchCreatesRows) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  int64_t telegram_player1_id = getNextTestPlayerId();
+  int64_t telegram_player2_id = getNextTestPlayerId();
+  
+  auto ratings = match_repo_->getRatings(telegram_group_id, telegram_player1_id, telegram_player2_id);
+  EXPECT_EQ(ratings.first.current_elo, 1500);
+  EXPECT_EQ(ratings.first.version, 0);
+  
+  models::MatchRegistration registration;
+  registration.telegram_group_id = telegram_group_id;
+  registration.player1_telegram_user_id = telegram_player1_id;
+  registration.player2_telegram_user_id = telegram_player2_id;
+  registration.player1_score = 3;
+  registration.player2_score = 1;
+  registration.player1_before = ratings.first;
+  registration.player2_before = ratings.second;
+  registration.player1_elo_after = 1520;
+  registration.player2_elo_after = 1480;
+  registration.idempotency_key = getNextIdempotencyKey();
+  registration.created_by_telegram_user_id = telegram_player1_id;
+  
+  auto match = match_repo_->registerMatch(registration);
+  EXPECT_GT(match.id, 0);
+  EXPECT_EQ(match.player1_elo_before, 1500);
+  EXPECT_EQ(match.player2_elo_before, 1500);
+  
+  auto group_player = group_repo_->getOrCreateGroupPlayer(match.group_id, match.player1_id);
+  EXPECT_EQ(group_player.current_elo, 1520);
+  EXPECT_EQ(group_player.matches_played, 1);
+  EXPECT_EQ(group_player.matches_won, 1);
+  
+  ratings = match_repo_->getRatings(telegram_group_id, telegram_player1_id, telegram_player2_id);
+  EXPECT_EQ(ratings.first.current_elo, 1520);
+  EXPECT_EQ(ratings.second.current_elo, 1480);
+  EXPECT_EQ(ratings.first.version, group_player.version);
+}
+
+TEST_F(MatchRepositoryTest, RegisterMatchStoresGlickoState) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  int64_t telegram_player1_id = getNextTestPlayerId();
+  int64_t telegram_player2_id = getNextTestPlayerId();
+  
+  auto ratings = match_repo_->getRatings(telegram_group_id, telegram_player1_id, telegram_player2_id);
+  EXPECT_DOUBLE_EQ(ratings.first.rating_deviation, 350.0);
+  EXPECT_DOUBLE_EQ(ratings.first.rating_volatility, 0.06);
+  
+  models::MatchRegistration registration;
+  registration.telegram_group_id = telegram_group_id;
+  registration.player1_telegram_user_id = telegram_player1_id;
+  registration.player2_telegram_user_id = telegram_player2_id;
+  registration.player1_score = 11;
+  registration.player2_score = 4;
+  registration.player1_before = ratings.first;
+  registration.player2_before = ratings.second;
+  registration.player1_elo_after = 1662;
+  registration.player2_elo_after = 1338;
+  registration.player1_deviation_after = 290.3;
+  registration.player2_deviation_after = 290.3;
+  registration.player1_volatility_after = 0.059999;
+  registration.player2_volatility_after = 0.06;
+  registration.idempotency_key = getNextIdempotencyKey();
+  registration.created_by_telegram_user_id = telegram_player1_id;
+  match_repo_->registerMatch(registration);
+  
+  ratings = match_repo_->getRatings(telegram_group_id, telegram_player1_id, telegram_player2_id);
+  EXPECT_EQ(ratings.first.current_elo, 1662);
+  EXPECT_DOUBLE_EQ(ratings.first.rating_deviation, 290.3);
+  EXPECT_DOUBLE_EQ(ratings.first.rating_volatility, 0.059999);
+  EXPECT_DOUBLE_EQ(ratings.second.rating_deviation, 290.3);
+}
+
+TEST_F(MatchRepositoryTest, RegisterMatchStaleVersionConflicts) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  int64_t telegram_player1_id = getNextTestPlayerId();
+  int64_t telegram_player2_id = getNextTestPlayerId();
+  
+  models::MatchRegistration registration;
+  registration.telegram_group_id = telegram_group_id;
+  registration.player1_telegram_user_id = telegram_player1_id;
+  registration.player2_telegram_user_id = telegram_player2_id;
+  registration.player1_score = 3;
+  registration.player2_score = 1;
+  registration.player1_elo_after = 1520;
+  registration.player2_elo_after = 1480;
+  registration.idempotency_key = getNextIdempotencyKey();
+  match_repo_->registerMatch(registration);
+  
+  // Same (now stale) versions as the first registration
+  registration.idempotency_key = getNextIdempotencyKey();
+  EXPECT_THROW(match_repo_->registerMatch(registration), utils::OptimisticLockException);
+  EXPECT_FALSE(match_repo_->getByIdempotencyKey(registration.idempotency_key).has_value());
+}
+
+TEST_F(MatchRepositoryTest, RegisterMatchDuplicateKey) {
+  int64_t telegram_group_id = getNextTestGroupId();
+  int64_t telegram_player1_id = getNextTestPlayerId();
+  int64_t telegram_player2_id = getNextTestPlayerId();
+  
+  models::MatchRegistration registration;
+  registration.telegram_group_id = telegram_group_id;
+  registration.player1_telegram_user_id = telegram_player1_id;
+  registration.player2_telegram_user_id = telegram_player2_id;
+  registration.player1_score = 3;
+  registration.player2_score = 1;
+  registration.player1_elo_after = 1520;
+  registration.player2_elo_after = 1480;
+  registration.idempotency_key = getNextIdempotencyKey();
+  match_repo_->registerMatch(registration);
+  
+  auto ratings = match_repo_->getRatings(telegram_group_id, telegram_player1_id, telegram_player2_id);
+  registration.player1_before = ratings.first;
+  registration.player2_before = ratings.second;
+  EXPECT_THROW(match_repo_->registerMatch(registration), repositories::DuplicateMatchException);
+}
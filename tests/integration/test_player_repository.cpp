@@ -57,7 +57,6 @@ class PlayerRepositoryTest : public ::testing::Test {
       // Delete test players (those with telegram_user_id > 1000000)
       txn.exec("DELETE FROM players WHERE telegram_user_id > 1000000");
       txn.commit();
-      pool_->release(conn);
     } catch (const std::exception&) {
       // Ignore cleanup errors
     }
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "database/connection_pool.h"
+#include "database/prepared_statements.h"
+#include <cstdlib>
+#include <set>
+#include <string>
+#include <pqxx/pqxx>
+
+class PreparedStatementsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Get database connection string from environment
+    const char* db_url = std::getenv("DATABASE_URL");
+    if (!db_url) {
+      std::string host = std::getenv("POSTGRES_HOST") ? std::getenv("POSTGRES_HOST") : "localhost";
+      std::string port = std::getenv("POSTGRES_PORT") ? std::getenv("POSTGRES_PORT") : "5432";
+      std::string db = std::getenv("POSTGRES_DB") ? std::getenv("POSTGRES_DB") : "school_tg_bot";
+      std::string user = std::getenv("POSTGRES_USER") ? std::getenv("POSTGRES_USER") : "postgres";
+      std::string password = std::getenv("POSTGRES_PASSWORD") ? std::getenv("POSTGRES_PASSWORD") : "postgres";
+
+      connection_string_ = "postgresql://" + user + ":" + password + "@" + host + ":" + port + "/" + db;
+    } else {
+      connection_string_ = db_url;
+    }
+  }
+
+  std::string connection_string_;
+};
+
+TEST_F(PreparedStatementsTest, NamesAreUnique) {
+  std::set<std::string> names;
+  for (const auto& statement : database::preparedStatements()) {
+    EXPECT_TRUE(names.insert(statement.name).second) << "duplicate statement " << statement.name;
+  }
+}
+
+TEST_F(PreparedStatementsTest, EveryStatementPreparesAgainstSchema) {
+  pqxx::connection conn(connection_string_);
+  EXPECT_EQ(database::prepareStatements(conn),
+            static_cast<int>(database::preparedStatements().size()));
+}
+
+TEST_F(PreparedStatementsTest, PooledConnectionsArePrepared) {
+  database::ConnectionPool::Config config;
+  config.connection_string = connection_string_;
+  config.min_size = 1;
+  config.max_size = 2;
+  auto pool = database::ConnectionPool::create(config);
+
+  auto conn = pool->acquire();
+  pqxx::work txn(*conn);
+  auto result = txn.exec_prepared(database::statements::kGroupById, int64_t{-1});
+  EXPECT_TRUE(result.empty());
+  txn.commit();
+}
@@ -59,7 +59,6 @@ class RepositoryValidationTest : public ::testing::Test {
       txn.exec("DELETE FROM groups WHERE telegram_group_id > 2000000");
       txn.exec("DELETE FROM players WHERE telegram_user_id > 2000000");
       txn.commit();
-      pool_->release(conn);
     } catch (const std::exception&) {}
   }
   
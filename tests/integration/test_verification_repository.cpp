@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "repositories/verification_repository.h"
+#include "repositories/group_repository.h"
+#include "repositories/player_repository.h"
+#include "school21/verification_cache.h"
+#include "database/connection_pool.h"
+#include <chrono>
+#include <cstdlib>
+#include <pqxx/pqxx>
+
+class VerificationRepositoryTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const char* db_url = std::getenv("DATABASE_URL");
+    if (!db_url) {
+      std::string host = std::getenv("POSTGRES_HOST") ? std::getenv("POSTGRES_HOST") : "localhost";
+      std::string port = std::getenv("POSTGRES_PORT") ? std::getenv("POSTGRES_PORT") : "5432";
+      std::string db = std::getenv("POSTGRES_DB") ? std::getenv("POSTGRES_DB") : "school_tg_bot";
+      std::string user = std::getenv("POSTGRES_USER") ? std::getenv("POSTGRES_USER") : "postgres";
+      std::string password = std::getenv("POSTGRES_PASSWORD") ? std::getenv("POSTGRES_PASSWORD") : "postgres";
+      
+      connection_string_ = "postgresql://" + user + ":" + password + "@" + host + ":" + port + "/" + db;
+    } else {
+      connection_string_ = db_url;
+    }
+    
+    database::ConnectionPool::Config config;
+    config.connection_string = connection_string_;
+    config.min_size = 1;
+    config.max_size = 5;
+    
+    auto pool_unique = database::ConnectionPool::create(config);
+    pool_ = std::shared_ptr<database::ConnectionPool>(std::move(pool_unique));
+    
+    if (!pool_->healthCheck()) {
+      FAIL() << "Database connection failed. Cannot run repository tests.";
+    }
+    
+    repo_ = std::make_shared<repositories::VerificationRepository>(pool_);
+    
+    cleanupTestData();
+    
+    group_id_ = repositories::GroupRepository(pool_).createOrGet(2000001, "Verification test").id;
+    player_id_ = repositories::PlayerRepository(pool_).createOrGet(2000001).id;
+  }
+  
+  void TearDown() override {
+    cleanupTestData();
+    repo_.reset();
+    pool_.reset();
+  }
+  
+  void cleanupTestData() {
+    if (!pool_) return;
+    
+    try {
+      auto conn = pool_->acquire();
+      pqxx::work txn(*conn);
+      // player_verifications rows go with their group and player
+      txn.exec("DELETE FROM groups WHERE telegram_group_id = 2000001");
+      txn.exec("DELETE FROM players WHERE telegram_user_id = 2000001");
+      txn.commit();
+    } catch (const std::exception&) {
+      // Ignore cleanup errors
+    }
+  }
+  
+  std::string connection_string_;
+  std::shared_ptr<database::ConnectionPool> pool_;
+  std::shared_ptr<repositories::VerificationRepository> repo_;
+  int64_t group_id_ = 0;
+  int64_t player_id_ = 0;
+};
+
+TEST_F(VerificationRepositoryTest, FindsFreshRecords) {
+  EXPECT_FALSE(repo_->findFresh("vtest_alice").has_value());
+  
+  repo_->record(player_id_, group_id_, "vtest_Alice", "ACTIVE", 42, std::chrono::hours(1));
+  
+  auto found = repo_->findFresh("VTEST_alice");
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->school_nickname, "vtest_Alice");
+  EXPECT_EQ(found->verification_status, "ACTIVE");
+  EXPECT_GT(found->expires_at, std::chrono::system_clock::now() + std::chrono::minutes(59));
+}
+
+TEST_F(VerificationRepositoryTest, IgnoresExpiredRecords) {
+  repo_->record(player_id_, group_id_, "vtest_bob", "NOT_FOUND", 43, std::chrono::seconds(0));
+  EXPECT_FALSE(repo_->findFresh("vtest_bob").has_value());
+}
+
+TEST_F(VerificationRepositoryTest, CacheReadsThroughTheDatabase) {
+  school21::VerificationCache writer(school21::VerificationCache::Options{}, repo_);
+  school21::Lookup lookup;
+  lookup.status = school21::LookupStatus::kNotFound;
+  writer.put("vtest_ghost", lookup, player_id_, group_id_, 44);
+  
+  // A fresh process starts with an empty memory tier
+  school21::VerificationCache reader(school21::VerificationCache::Options{}, repo_);
+  auto cached = reader.get("vtest_ghost");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->status, school21::LookupStatus::kNotFound);
+  EXPECT_EQ(reader.getStats().database_hits, 1u);
+  
+  ASSERT_TRUE(reader.get("vtest_ghost").has_value());
+  EXPECT_EQ(reader.getStats().memory_hits, 1u);
+}
@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+#include "database/connection_pool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class ConnectionPoolTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Get database connection string from environment
+    const char* db_url = std::getenv("DATABASE_URL");
+    if (!db_url) {
+      std::string host = std::getenv("POSTGRES_HOST") ? std::getenv("POSTGRES_HOST") : "localhost";
+      std::string port = std::getenv("POSTGRES_PORT") ? std::getenv("POSTGRES_PORT") : "5432";
+      std::string db = std::getenv("POSTGRES_DB") ? std::getenv("POSTGRES_DB") : "school_tg_bot";
+      std::string user = std::getenv("POSTGRES_USER") ? std::getenv("POSTGRES_USER") : "postgres";
+      std::string password = std::getenv("POSTGRES_PASSWORD") ? std::getenv("POSTGRES_PASSWORD") : "postgres";
+
+      connection_string_ = "postgresql://" + user + ":" + password + "@" + host + ":" + port + "/" + db;
+    } else {
+      connection_string_ = db_url;
+    }
+  }
+
+  std::unique_ptr<database::ConnectionPool> makePool(int max_size, int acquire_timeout_ms = 5000) {
+    database::ConnectionPool::Config config;
+    config.min_size = 1;
+    config.max_size = max_size;
+    config.acquire_timeout_ms = acquire_timeout_ms;
+    return makePool(config);
+  }
+
+  std::unique_ptr<database::ConnectionPool> makePool(database::ConnectionPool::Config config) {
+    config.connection_string = connection_string_;
+    auto pool = database::ConnectionPool::create(config);
+    if (!pool->healthCheck()) {
+      ADD_FAILURE() << "Database connection failed. Cannot run connection pool tests.";
+    }
+    return pool;
+  }
+
+  // Wait until `count` acquirers are queued on the pool
+  static void waitForWaiters(database::ConnectionPool& pool, int count) {
+    for (int i = 0; i < 2000 && pool.getWaitingCount() < count; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(pool.getWaitingCount(), count);
+  }
+
+  // Poll the pool until `condition` holds or the timeout expires
+  template <typename Condition>
+  static bool eventually(Condition condition, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+  }
+
+  std::string connection_string_;
+};
+
+TEST_F(ConnectionPoolTest, WaitsForReleasedConnectionInsteadOfFailing) {
+  auto pool = makePool(2);
+  auto first = pool->acquire();
+  auto second = pool->acquire();
+  pqxx::connection* first_raw = first.get();
+
+  database::PooledConnection third;
+  std::thread waiter([&]() { third = pool->acquire(); });
+
+  waitForWaiters(*pool, 1);
+  first.release();
+  waiter.join();
+
+  ASSERT_TRUE(third);
+  EXPECT_EQ(third.get(), first_raw);  // Handed over directly
+  EXPECT_EQ(pool->getTotalConnections(), 2);
+}
+
+TEST_F(ConnectionPoolTest, AcquireTimesOut) {
+  auto pool = makePool(1);
+  auto held = pool->acquire();
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_THROW(pool->acquire(std::chrono::milliseconds(50)), std::runtime_error);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+  EXPECT_EQ(pool->getWaitingCount(), 0);
+}
+
+TEST_F(ConnectionPoolTest, WaitersAreServedInArrivalOrder) {
+  auto pool = makePool(1);
+  auto held = pool->acquire();
+
+  std::mutex order_mutex;
+  std::vector<int> order;
+  auto worker = [&](int id) {
+    auto conn = pool->acquire();
+    std::lock_guard<std::mutex> lock(order_mutex);
+    order.push_back(id);
+  };
+
+  std::thread a(worker, 1);
+  waitForWaiters(*pool, 1);
+  std::thread b(worker, 2);
+  waitForWaiters(*pool, 2);
+  std::thread c(worker, 3);
+  waitForWaiters(*pool, 3);
+
+  held.release();
+  a.join();
+  b.join();
+  c.join();
+
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST_F(ConnectionPoolTest, BurstLargerThanPoolDoesNotFail) {
+  constexpr int kMaxSize = 4;
+  auto pool = makePool(kMaxSize);
+
+  std::atomic<int> failures{0};
+  std::atomic<int> max_seen{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 16; ++t) {
+    threads.emplace_back([&]() {
+      for (int i = 0; i < 20; ++i) {
+        try {
+          auto conn = pool->acquire();
+          int total = pool->getTotalConnections();
+          int seen = max_seen.load();
+          while (total > seen && !max_seen.compare_exchange_weak(seen, total)) {}
+          std::this_thread::sleep_for(std::chrono::microseconds(200));
+        } catch (const std::exception&) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(failures.load(), 0);
+  EXPECT_LE(max_seen.load(), kMaxSize);
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, LeaseReleasesOnScopeExit) {
+  auto pool = makePool(1);
+  {
+    auto conn = pool->acquire();
+    EXPECT_EQ(pool->getActiveConnections(), 1);
+  }
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+
+  // Releasing twice is a no-op, not a double return
+  auto conn = pool->acquire();
+  conn.release();
+  conn.release();
+  EXPECT_FALSE(conn);
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+  EXPECT_EQ(pool->getTotalConnections(), 1);
+}
+
+TEST_F(ConnectionPoolTest, MovedLeaseReleasesOnce) {
+  auto pool = makePool(2);
+  auto original = pool->acquire();
+  database::PooledConnection moved = std::move(original);
+  EXPECT_FALSE(original);
+  EXPECT_TRUE(moved);
+  EXPECT_EQ(pool->getActiveConnections(), 1);
+  moved.release();
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, BrokenConnectionsDoNotShrinkCapacity) {
+  constexpr int kMaxSize = 2;
+  auto pool = makePool(kMaxSize);
+
+  // Break every connection repeatedly; capacity must stay at max_size
+  for (int round = 0; round < 5; ++round) {
+    auto a = pool->acquire(std::chrono::milliseconds(100));
+    auto b = pool->acquire(std::chrono::milliseconds(100));
+    a.invalidate();
+    b.invalidate();
+    EXPECT_EQ(pool->getActiveConnections(), 0);
+  }
+
+  auto a = pool->acquire(std::chrono::milliseconds(100));
+  auto b = pool->acquire(std::chrono::milliseconds(100));
+  EXPECT_TRUE(a);
+  EXPECT_TRUE(b);
+  EXPECT_EQ(pool->getTotalConnections(), kMaxSize);
+}
+
+TEST_F(ConnectionPoolTest, WaiterGetsSlotOfBrokenConnection) {
+  auto pool = makePool(1);
+  auto held = pool->acquire();
+
+  database::PooledConnection replacement;
+  std::thread waiter([&]() { replacement = pool->acquire(); });
+
+  waitForWaiters(*pool, 1);
+  held.invalidate();
+  waiter.join();
+
+  EXPECT_TRUE(replacement);
+  EXPECT_EQ(pool->getTotalConnections(), 1);
+}
+
+TEST_F(ConnectionPoolTest, ReapsIdleConnectionsDownToMinSize) {
+  database::ConnectionPool::Config config;
+  config.min_size = 1;
+  config.max_size = 3;
+  config.idle_timeout_seconds = 1;
+  config.maintenance_interval_seconds = 1;
+  auto pool = makePool(config);
+
+  {
+    auto a = pool->acquire();
+    auto b = pool->acquire();
+    auto c = pool->acquire();
+  }
+  EXPECT_EQ(pool->getTotalConnections(), 3);
+
+  EXPECT_TRUE(eventually([&] { return pool->getTotalConnections() == 1; }));
+  EXPECT_TRUE(pool->healthCheck());
+}
+
+TEST_F(ConnectionPoolTest, ExpiredConnectionIsNotReturnedToPool) {
+  database::ConnectionPool::Config config;
+  config.min_size = 1;
+  config.max_size = 2;
+  config.max_lifetime_seconds = 1;
+  config.maintenance_interval_seconds = 0;  // Only the release path rotates
+  auto pool = makePool(config);
+
+  auto conn = pool->acquire();
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  conn.release();
+
+  EXPECT_EQ(pool->getTotalConnections(), 0);
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, WarmUpRestoresMinSize) {
+  database::ConnectionPool::Config config;
+  config.min_size = 2;
+  config.max_size = 4;
+  config.maintenance_interval_seconds = 1;
+  auto pool = makePool(config);
+
+  {
+    auto a = pool->acquire();
+    auto b = pool->acquire();
+    a.invalidate();
+    b.invalidate();
+  }
+  EXPECT_EQ(pool->getTotalConnections(), 0);
+
+  EXPECT_TRUE(eventually([&] { return pool->getTotalConnections() == 2; }));
+  EXPECT_EQ(pool->getActiveConnections(), 0);
+}
+
+TEST_F(ConnectionPoolTest, StaleIdleConnectionIsValidatedBeforeLending) {
+  database::ConnectionPool::Config config;
+  config.min_size = 1;
+  config.max_size = 1;
+  config.validation_idle_seconds = 0;  // Validate on every checkout
+  config.maintenance_interval_seconds = 0;
+  auto pool = makePool(config);
+
+  int backend_pid = 0;
+  {
+    auto conn = pool->acquire();
+    backend_pid = conn->backendpid();
+  }
+
+  // Kill the idle connection server-side; libpq does not notice until it is used
+  pqxx::connection admin(connection_string_);
+  pqxx::nontransaction admin_txn(admin);
+  admin_txn.exec("SELECT pg_terminate_backend(" + std::to_string(backend_pid) + ")");
+
+  auto conn = pool->acquire();
+  EXPECT_NE(conn->backendpid(), backend_pid);
+  pqxx::work txn(*conn);
+  EXPECT_NO_THROW(txn.exec("SELECT 1"));
+}
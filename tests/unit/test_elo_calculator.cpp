@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "utils/elo_calculator.h"
+#include "utils/validation.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+TEST(EloCalculatorTest, BatchMatchesScalarBitForBit) {
+  utils::EloCalculator calculator(32);
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> elo(utils::MIN_ELO, utils::MAX_ELO);
+  std::uniform_int_distribution<int> score(0, 11);
+
+  const size_t n = 10000;
+  std::vector<int> elo1(n), elo2(n), score1(n), score2(n);
+  for (size_t i = 0; i < n; ++i) {
+    elo1[i] = elo(rng);
+    // Half the pairs close together, where most real matches are
+    elo2[i] = i % 2 ? elo(rng) : std::clamp(elo1[i] + (elo(rng) % 801) - 400, utils::MIN_ELO, utils::MAX_ELO);
+    score1[i] = score(rng);
+    score2[i] = i % 7 == 0 ? score1[i] : score(rng);
+  }
+  // Both ends of the difference range
+  elo1[0] = utils::MIN_ELO;
+  elo2[0] = utils::MAX_ELO;
+  elo1[1] = utils::MAX_ELO;
+  elo2[1] = utils::MIN_ELO;
+
+  std::vector<double> expected(n);
+  calculator.expectedScores(elo1, elo2, expected);
+  std::vector<int> new1(n), new2(n);
+  calculator.calculateBatch(elo1, elo2, score1, score2, new1, new2);
+
+  for (size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(expected[i], calculator.expectedScore(elo1[i], elo2[i])) << "i = " << i;
+    auto [scalar1, scalar2] = calculator.calculate(elo1[i], elo2[i], score1[i], score2[i]);
+    ASSERT_EQ(new1[i], scalar1) << "i = " << i;
+    ASSERT_EQ(new2[i], scalar2) << "i = " << i;
+  }
+}
+
+TEST(EloCalculatorTest, BatchHandlesRatingsOutsideTheTable) {
+  utils::EloCalculator calculator(32);
+  std::vector<int> elo1 = {-500, 12000};
+  std::vector<int> elo2 = {12000, -500};
+  std::vector<int> score1 = {11, 3};
+  std::vector<int> score2 = {3, 11};
+  std::vector<int> new1(2), new2(2);
+  calculator.calculateBatch(elo1, elo2, score1, score2, new1, new2);
+  for (size_t i = 0; i < 2; ++i) {
+    auto [scalar1, scalar2] = calculator.calculate(elo1[i], elo2[i], score1[i], score2[i]);
+    EXPECT_EQ(new1[i], scalar1);
+    EXPECT_EQ(new2[i], scalar2);
+  }
+}
+
+TEST(EloCalculatorTest, BatchRejectsMismatchedSpans) {
+  utils::EloCalculator calculator(32);
+  std::vector<int> two(2, 1500), three(3, 1500);
+  std::vector<int> out(2);
+  std::vector<double> expected(2);
+  EXPECT_THROW(calculator.expectedScores(two, three, expected), std::invalid_argument);
+  EXPECT_THROW(calculator.calculateBatch(two, two, two, three, out, out), std::invalid_argument);
+}
+
+TEST(EloCalculatorTest, TableModeStaysWithinOnePointOfLibm) {
+  // Every rating difference the validation bounds allow, every outcome
+  const int max_diff = utils::MAX_ELO - utils::MIN_ELO;
+  for (int k_factor : {16, 32, 64}) {
+    utils::EloCalculator exact(k_factor);
+    utils::EloCalculator table(k_factor, utils::ExpectedScoreMode::kTable);
+    double max_error = 0.0;
+    int max_delta_diff = 0;
+    for (int diff = -max_diff; diff <= max_diff; ++diff) {
+      int elo1 = diff < 0 ? utils::MIN_ELO - diff : utils::MIN_ELO;
+      int elo2 = elo1 + diff;
+      double libm = 1.0 / (1.0 + std::pow(10.0, diff / 400.0));
+      max_error = std::max(max_error, std::abs(table.expectedScore(elo1, elo2) - libm) * k_factor);
+      for (auto [s1, s2] : {std::pair{11, 5}, std::pair{5, 11}, std::pair{7, 7}}) {
+        auto [exact1, exact2] = exact.calculate(elo1, elo2, s1, s2);
+        auto [table1, table2] = table.calculate(elo1, elo2, s1, s2);
+        max_delta_diff = std::max({max_delta_diff, std::abs(table1 - exact1), std::abs(table2 - exact2)});
+      }
+    }
+    // Error in rating points before rounding, then in the rounded ratings
+    EXPECT_LT(max_error, 1e-9) << "k_factor = " << k_factor;
+    EXPECT_LT(max_delta_diff, 1) << "k_factor = " << k_factor;
+  }
+}
+
+TEST(EloCalculatorTest, TableModeBatchMatchesTableModeScalar) {
+  utils::EloCalculator calculator(32, utils::ExpectedScoreMode::kTable);
+  std::vector<int> elo1 = {1500, 1200, 0, 10000, 20000};
+  std::vector<int> elo2 = {1500, 1800, 10000, 0, -5000};
+  std::vector<int> score1 = {11, 11, 3, 3, 11};
+  std::vector<int> score2 = {9, 2, 11, 11, 0};
+  std::vector<int> new1(elo1.size()), new2(elo1.size());
+  calculator.calculateBatch(elo1, elo2, score1, score2, new1, new2);
+  for (size_t i = 0; i < elo1.size(); ++i) {
+    auto [scalar1, scalar2] = calculator.calculate(elo1[i], elo2[i], score1[i], score2[i]);
+    EXPECT_EQ(new1[i], scalar1);
+    EXPECT_EQ(new2[i], scalar2);
+  }
+}
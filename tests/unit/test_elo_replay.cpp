@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include "utils/elo_calculator.h"
+#include "utils/elo_replay.h"
+#include "utils/rating_engine.h"
+#include <vector>
+
+TEST(EloReplayTest, MatchesSequentialCalculation) {
+  utils::EloCalculator calculator(32);
+  std::vector<utils::ReplayMatch> matches = {
+    {1, 10, 20, 11, 5},
+    {2, 20, 30, 11, 9},
+    {3, 10, 30, 7, 11},
+  };
+
+  utils::EloReplay replay(calculator);
+  auto replayed = replay.replay(matches);
+  ASSERT_EQ(replayed.size(), 3u);
+
+  // Same numbers as running the calculator by hand
+  utils::EloCalculator reference(32);
+  auto [a1, b1] = reference.calculate(1500, 1500, 11, 5);
+  EXPECT_EQ(replayed[0].player1_elo_after, a1);
+  EXPECT_EQ(replayed[0].player2_elo_after, b1);
+  auto [b2, c2] = reference.calculate(b1, 1500, 11, 9);
+  EXPECT_EQ(replayed[1].player1_elo_before, b1);
+  EXPECT_EQ(replayed[1].player1_elo_after, b2);
+  auto [a3, c3] = reference.calculate(a1, c2, 7, 11);
+  EXPECT_EQ(replayed[2].player1_elo_before, a1);
+  EXPECT_EQ(replayed[2].player2_elo_before, c2);
+
+  auto players = replay.players();
+  ASSERT_EQ(players.size(), 3u);
+  EXPECT_EQ(players[0].player_id, 10);
+  EXPECT_EQ(players[0].current_elo, a3);
+  EXPECT_EQ(players[0].matches_played, 2);
+  EXPECT_EQ(players[0].matches_won, 1);
+  EXPECT_EQ(players[0].matches_lost, 1);
+  EXPECT_EQ(players[2].current_elo, c3);
+  EXPECT_EQ(players[2].matches_won, 1);
+}
+
+TEST(EloReplayTest, SeededPlayersKeepInitialRating) {
+  utils::EloCalculator calculator;
+  utils::EloReplay replay(calculator, 1200);
+  replay.addPlayer(5);
+  replay.replay({});
+  auto players = replay.players();
+  ASSERT_EQ(players.size(), 1u);
+  EXPECT_EQ(players[0].current_elo, 1200);
+  EXPECT_EQ(players[0].matches_played, 0);
+}
+
+TEST(EloReplayTest, DrawsCountAsPlayedOnly) {
+  utils::EloCalculator calculator;
+  utils::EloReplay replay(calculator);
+  auto replayed = replay.replay({{1, 1, 2, 5, 5}});
+  EXPECT_EQ(replayed[0].player1_elo_after, 1500);
+  auto players = replay.players();
+  EXPECT_EQ(players[0].matches_played, 1);
+  EXPECT_EQ(players[0].matches_won + players[0].matches_lost, 0);
+}
+
+TEST(EloReplayTest, ReplaysWithTheGroupsRatingEngine) {
+  utils::Glicko2Engine engine;
+  utils::EloReplay replay(engine);
+  auto replayed = replay.replay({{1, 1, 2, 11, 4}, {2, 2, 1, 11, 9}});
+
+  // Same as rating the two matches by hand, deviation carried over
+  auto [a1, b1] = engine.rate({}, {}, 11, 4);
+  auto [b2, a2] = engine.rate(b1, a1, 11, 9);
+  EXPECT_EQ(replayed[0].player1_elo_after, a1.rating);
+  EXPECT_EQ(replayed[1].player1_elo_after, b2.rating);
+  auto players = replay.players();
+  EXPECT_EQ(players[0].current_elo, a2.rating);
+  EXPECT_DOUBLE_EQ(players[0].rating_deviation, a2.deviation);
+  EXPECT_DOUBLE_EQ(players[1].rating_volatility, b2.volatility);
+}
+
+TEST(EloReplayTest, AppliesTheKFactorPolicy) {
+  utils::KFactorPolicy policy;
+  policy.k_factor = 16;
+  policy.provisional_matches = 1;
+  policy.provisional_k_factor = 40;
+  utils::EloCalculator calculator(32);
+  utils::EloReplay replay(calculator);
+  replay.setKFactorPolicy(policy);
+  auto replayed = replay.replay({{1, 1, 2, 11, 4}, {2, 1, 2, 11, 4}});
+
+  // Provisional K for the first match, the policy's K once a match is played
+  auto [a1, b1] = calculator.calculate(1500, 1500, 11, 4, 40, 40);
+  auto [a2, b2] = calculator.calculate(a1, b1, 11, 4, 16, 16);
+  EXPECT_EQ(replayed[0].player1_elo_after, a1);
+  EXPECT_EQ(replayed[1].player1_elo_after, a2);
+  EXPECT_EQ(replayed[1].player2_elo_after, b2);
+}
+
+TEST(EloReplayTest, RatesEachMatchWithItsOwnSystem) {
+  utils::RatingEngines engines;
+  utils::EloReplay replay(engines.get(utils::RatingSystem::kElo));
+  replay.setEngines(&engines);
+  auto replayed = replay.replay({{1, 1, 2, 11, 1, utils::RatingSystem::kMarginElo},
+                                 {2, 1, 2, 11, 1, utils::RatingSystem::kElo},
+                                 {3, 1, 2, 11, 1}});
+
+  // The group switched from margin_elo to elo; a match without a system
+  // falls back to the replay's engine
+  const auto& margin = engines.get(utils::RatingSystem::kMarginElo);
+  const auto& elo = engines.get(utils::RatingSystem::kElo);
+  auto [a1, b1] = margin.rate({}, {}, 11, 1);
+  auto [a2, b2] = elo.rate(a1, b1, 11, 1);
+  auto [a3, b3] = elo.rate(a2, b2, 11, 1);
+  EXPECT_EQ(replayed[0].player1_elo_after, a1.rating);
+  EXPECT_EQ(replayed[1].player1_elo_after, a2.rating);
+  EXPECT_EQ(replayed[2].player2_elo_after, b3.rating);
+  EXPECT_NE(a1.rating, elo.rate({}, {}, 11, 1).first.rating);
+}
+
+TEST(EloReplayTest, StoredKFactorsWinOverThePolicy) {
+  utils::KFactorPolicy policy;
+  policy.k_factor = 16;
+  utils::EloCalculator calculator(32);
+  utils::EloReplay replay(calculator);
+  replay.setKFactorPolicy(policy);
+  utils::ReplayMatch rated_with_k{1, 1, 2, 11, 4};
+  rated_with_k.player1_k_factor = 40;
+  rated_with_k.player2_k_factor = 24;
+  auto replayed = replay.replay({rated_with_k, {2, 1, 2, 11, 4}});
+
+  // The second match has no stored K and falls back to the policy
+  auto [a1, b1] = calculator.calculate(1500, 1500, 11, 4, 40, 24);
+  auto [a2, b2] = calculator.calculate(a1, b1, 11, 4, 16, 16);
+  EXPECT_EQ(replayed[0].player1_elo_after, a1);
+  EXPECT_EQ(replayed[0].player2_elo_after, b1);
+  EXPECT_EQ(replayed[1].player1_elo_after, a2);
+  EXPECT_EQ(replayed[1].player2_elo_after, b2);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "bot/http_request_parser.h"
+#include <string>
+
+namespace {
+
+std::string makeRequest(const std::string& body, const std::string& extra_headers = "") {
+  return "POST /webhook HTTP/1.1\r\n"
+         "Host: bot.example.com\r\n"
+         "Content-Type: application/json\r\n"
+         "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+         extra_headers +
+         "\r\n" + body;
+}
+
+}  // namespace
+
+class HttpRequestParserTest : public ::testing::Test {
+ protected:
+  bot::HttpRequestParser parser_{8192, 1024 * 1024};
+  bot::HttpRequestView request_;
+};
+
+TEST_F(HttpRequestParserTest, ParsesCompleteRequest) {
+  std::string body = R"({"update_id":1})";
+  std::string raw = makeRequest(body, "X-Telegram-Bot-Api-Secret-Token: s3cr3t\r\n");
+
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_EQ(request_.method, "POST");
+  EXPECT_EQ(request_.path, "/webhook");
+  EXPECT_EQ(request_.version, "HTTP/1.1");
+  EXPECT_EQ(request_.content_type, "application/json");
+  EXPECT_EQ(request_.secret_token, "s3cr3t");
+  EXPECT_EQ(request_.body, body);
+  EXPECT_TRUE(request_.keep_alive);
+  EXPECT_EQ(request_.total_size, raw.size());
+}
+
+TEST_F(HttpRequestParserTest, ViewsPointIntoBuffer) {
+  std::string raw = makeRequest("{}");
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_GE(request_.body.data(), raw.data());
+  EXPECT_LT(request_.body.data(), raw.data() + raw.size());
+}
+
+TEST_F(HttpRequestParserTest, HeaderNamesAreCaseInsensitive) {
+  std::string raw =
+      "POST /webhook HTTP/1.1\r\n"
+      "content-TYPE: application/json\r\n"
+      "CONTENT-LENGTH: 2\r\n"
+      "x-telegram-bot-api-secret-token: abc\r\n"
+      "AUTHORIZATION: Bearer xyz\r\n"
+      "connection: Close\r\n"
+      "\r\n{}";
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_EQ(request_.content_type, "application/json");
+  EXPECT_EQ(request_.secret_token, "abc");
+  EXPECT_EQ(request_.authorization, "Bearer xyz");
+  EXPECT_EQ(request_.body, "{}");
+  EXPECT_FALSE(request_.keep_alive);
+}
+
+TEST_F(HttpRequestParserTest, Http10DefaultsToClose) {
+  std::string raw = "POST /webhook HTTP/1.0\r\nContent-Length: 0\r\n\r\n";
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_FALSE(request_.keep_alive);
+}
+
+TEST_F(HttpRequestParserTest, IncrementalInput) {
+  std::string raw = makeRequest(R"({"update_id":2,"message":{"text":"/help"}})");
+
+  // Feed one byte at a time, as a slow client would
+  for (size_t i = 1; i < raw.size(); ++i) {
+    ASSERT_EQ(parser_.parse(std::string_view(raw).substr(0, i), request_),
+              bot::HttpRequestParser::Status::kIncomplete) << "at byte " << i;
+  }
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_EQ(request_.total_size, raw.size());
+}
+
+TEST_F(HttpRequestParserTest, PipelinedRequests) {
+  std::string first = makeRequest(R"({"update_id":1})");
+  std::string second = makeRequest(R"({"update_id":2})");
+  std::string raw = first + second;
+
+  ASSERT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kComplete);
+  EXPECT_EQ(request_.total_size, first.size());
+
+  parser_.reset();
+  ASSERT_EQ(parser_.parse(std::string_view(raw).substr(first.size()), request_),
+            bot::HttpRequestParser::Status::kComplete);
+  EXPECT_EQ(request_.body, R"({"update_id":2})");
+}
+
+TEST_F(HttpRequestParserTest, RejectsMalformedRequestLine) {
+  std::string raw = "GARBAGE\r\n\r\n";
+  EXPECT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kInvalid);
+}
+
+TEST_F(HttpRequestParserTest, RejectsBadContentLength) {
+  std::string raw = "POST /webhook HTTP/1.1\r\nContent-Length: 12abc\r\n\r\n";
+  EXPECT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kInvalid);
+}
+
+TEST_F(HttpRequestParserTest, RejectsChunkedEncoding) {
+  std::string raw = "POST /webhook HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n";
+  EXPECT_EQ(parser_.parse(raw, request_), bot::HttpRequestParser::Status::kInvalid);
+}
+
+TEST_F(HttpRequestParserTest, RejectsOversizedBody) {
+  bot::HttpRequestParser small(8192, 16);
+  std::string raw = makeRequest(std::string(17, 'x'));
+  EXPECT_EQ(small.parse(raw, request_), bot::HttpRequestParser::Status::kTooLarge);
+}
+
+TEST_F(HttpRequestParserTest, RejectsOversizedHeaders) {
+  bot::HttpRequestParser small(64, 1024);
+  std::string raw = "POST /webhook HTTP/1.1\r\nX-Padding: " + std::string(100, 'a');
+  EXPECT_EQ(small.parse(raw, request_), bot::HttpRequestParser::Status::kTooLarge);
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "utils/k_factor_policy.h"
+#include <stdexcept>
+
+namespace {
+constexpr auto kElo = utils::RatingSystem::kElo;
+}  // namespace
+
+TEST(KFactorPolicyTest, DefaultIsTheFixedK) {
+  utils::KFactorPolicy policy;
+  EXPECT_EQ(policy.kFor(1500, 0, 11, 0, kElo), 32);
+  EXPECT_EQ(policy.kFor(2400, 500, 5, 5, kElo), 32);
+}
+
+TEST(KFactorPolicyTest, ProvisionalThenBands) {
+  auto policy = utils::KFactorPolicy::fromJson(
+      R"({"k_factor": 24, "provisional_matches": 10, "provisional_k_factor": 40,
+          "bands": [{"min_rating": 2000, "k_factor": 16}, {"min_rating": 1800, "k_factor": 20}]})",
+      utils::KFactorPolicy{});
+  EXPECT_EQ(policy.kFor(2100, 9, 3, 1, kElo), 40);   // Provisional wins over the band
+  EXPECT_EQ(policy.kFor(1500, 10, 3, 1, kElo), 24);
+  EXPECT_EQ(policy.kFor(1800, 10, 3, 1, kElo), 20);
+  EXPECT_EQ(policy.kFor(2100, 10, 3, 1, kElo), 16);  // Highest matching band
+  ASSERT_EQ(policy.bands.size(), 2u);
+  EXPECT_EQ(policy.bands[0].min_rating, 1800);
+}
+
+TEST(KFactorPolicyTest, MarginScalesK) {
+  auto policy = utils::KFactorPolicy::fromJson(R"({"margin_weight": 0.5})", utils::KFactorPolicy{});
+  EXPECT_EQ(policy.kFor(1500, 0, 11, 10, kElo), 32);  // One-point games are unscaled
+  EXPECT_EQ(policy.kFor(1500, 0, 5, 5, kElo), 32);
+  EXPECT_GT(policy.kFor(1500, 0, 11, 0, kElo), policy.kFor(1500, 0, 11, 8, kElo));
+  EXPECT_EQ(policy.kFor(1500, 0, 0, 11, kElo), policy.kFor(1500, 0, 11, 0, kElo));
+}
+
+TEST(KFactorPolicyTest, ScaledKStaysInRange) {
+  auto policy = utils::KFactorPolicy::fromJson(R"({"k_factor": 200, "margin_weight": 2})",
+                                               utils::KFactorPolicy{});
+  EXPECT_EQ(policy.kFor(1500, 0, 21, 0, kElo), 200);
+}
+
+TEST(KFactorPolicyTest, MarginEloIgnoresMarginWeight) {
+  auto policy = utils::KFactorPolicy::fromJson(R"({"margin_weight": 0.5})", utils::KFactorPolicy{});
+  // The engine scales K by the margin itself
+  EXPECT_EQ(policy.kFor(1500, 0, 11, 0, utils::RatingSystem::kMarginElo), 32);
+  EXPECT_GT(policy.kFor(1500, 0, 11, 0, kElo), 32);
+}
+
+TEST(KFactorPolicyTest, MissingFieldsKeepDefaultsAndJsonRoundTrips) {
+  utils::KFactorPolicy defaults;
+  defaults.k_factor = 20;
+  auto policy = utils::KFactorPolicy::fromJson(R"({"provisional_matches": 5})", defaults);
+  EXPECT_EQ(policy.k_factor, 20);
+  EXPECT_EQ(policy.provisional_matches, 5);
+
+  policy.bands.push_back({2000, 12});
+  auto copy = utils::KFactorPolicy::fromJson(policy.toJson().dump(), utils::KFactorPolicy{});
+  EXPECT_EQ(copy.toJson(), policy.toJson());
+}
+
+TEST(KFactorPolicyTest, RejectsInvalidPolicies) {
+  utils::KFactorPolicy defaults;
+  EXPECT_THROW(utils::KFactorPolicy::fromJson("not json", defaults), std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson("[1, 2]", defaults), std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson(R"({"k_factor": 0})", defaults), std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson(R"({"k_factor": "32"})", defaults), std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson(R"({"provisional_matches": -1})", defaults),
+               std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson(R"({"margin_weight": 3})", defaults),
+               std::invalid_argument);
+  EXPECT_THROW(utils::KFactorPolicy::fromJson(R"({"bands": [{"min_rating": 2000}]})", defaults),
+               std::invalid_argument);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include "repositories/leaderboard.h"
+#include "utils/fenwick_tree.h"
+#include <random>
+#include <vector>
+
+TEST(FenwickTreeTest, PrefixAndSuffixSums) {
+  utils::FenwickTree tree(10);
+  tree.add(0, 1);
+  tree.add(3, 2);
+  tree.add(9, 4);
+  EXPECT_EQ(tree.prefixSum(0), 1);
+  EXPECT_EQ(tree.prefixSum(2), 1);
+  EXPECT_EQ(tree.prefixSum(3), 3);
+  EXPECT_EQ(tree.prefixSum(9), 7);
+  EXPECT_EQ(tree.suffixSumAfter(3), 4);
+  tree.add(3, -2);
+  EXPECT_EQ(tree.total(), 5);
+}
+
+class LeaderboardTest : public ::testing::Test {
+ protected:
+  void load(int64_t group_id, const std::vector<std::pair<int64_t, int>>& players) {
+    ASSERT_TRUE(board_.loadGroup(group_id, players, board_.loadToken(group_id)));
+  }
+
+  repositories::Leaderboard board_;
+};
+
+TEST_F(LeaderboardTest, TopListsByEloWithSharedRanks) {
+  load(1, {{10, 1500}, {11, 1600}, {12, 1500}, {13, 1400}});
+
+  auto top = board_.top(1, 10);
+  ASSERT_EQ(top.size(), 4u);
+  EXPECT_EQ(top[0].player_id, 11);
+  EXPECT_EQ(top[0].rank, 1);
+  EXPECT_EQ(top[1].player_id, 10);
+  EXPECT_EQ(top[1].rank, 2);
+  EXPECT_EQ(top[2].player_id, 12);
+  EXPECT_EQ(top[2].rank, 2);
+  EXPECT_EQ(top[3].rank, 4);
+
+  EXPECT_EQ(board_.top(1, 2).size(), 2u);
+  EXPECT_TRUE(board_.top(2, 10).empty());
+}
+
+TEST_F(LeaderboardTest, UpdateMovesPlayer) {
+  load(1, {{10, 1500}, {11, 1600}, {12, 1400}});
+  board_.update(1, 12, 1700);
+  EXPECT_EQ(board_.rankOf(1, 12)->rank, 1);
+  EXPECT_EQ(board_.rankOf(1, 11)->rank, 2);
+
+  // New player
+  board_.update(1, 13, 1550);
+  EXPECT_EQ(board_.rankOf(1, 13)->rank, 3);
+  EXPECT_EQ(board_.rankOf(1, 10)->rank, 4);
+
+  // Existing player keeps the rating written by the match
+  board_.addIfAbsent(1, 13, 1500);
+  EXPECT_EQ(board_.rankOf(1, 13)->elo, 1550);
+}
+
+TEST_F(LeaderboardTest, AroundReturnsNeighbours) {
+  load(1, {{1, 1000}, {2, 1100}, {3, 1200}, {4, 1300}, {5, 1400}});
+
+  auto around = board_.around(1, 3, 1);
+  ASSERT_EQ(around.size(), 3u);
+  EXPECT_EQ(around[0].player_id, 4);
+  EXPECT_EQ(around[1].player_id, 3);
+  EXPECT_EQ(around[1].rank, 3);
+  EXPECT_EQ(around[2].player_id, 2);
+
+  // Clipped at the top and bottom
+  EXPECT_EQ(board_.around(1, 5, 2).size(), 3u);
+  EXPECT_EQ(board_.around(1, 1, 2).size(), 3u);
+  EXPECT_TRUE(board_.around(1, 99, 2).empty());
+}
+
+TEST_F(LeaderboardTest, UpdatesWhileLoadingRejectTheLoad) {
+  auto token = board_.loadToken(1);
+  // A match is written after the group was read
+  board_.update(1, 10, 1600);
+  EXPECT_FALSE(board_.loadGroup(1, {{10, 1500}}, token));
+  EXPECT_FALSE(board_.hasGroup(1));
+  // Updates for groups that are not loaded are dropped
+  EXPECT_FALSE(board_.rankOf(1, 10).has_value());
+
+  // clear() fails loads that started before it
+  token = board_.loadToken(1);
+  auto cleared = board_.clear();
+  EXPECT_FALSE(board_.loadGroup(1, {{10, 1600}}, token));
+  EXPECT_TRUE(board_.loadGroup(1, {{10, 1600}}, cleared));
+}
+
+TEST_F(LeaderboardTest, OtherGroupsAndReadsDoNotRejectTheLoad) {
+  auto token = board_.loadToken(1);
+  board_.update(2, 20, 1600);
+  board_.addIfAbsent(1, 10, 1500);
+  EXPECT_TRUE(board_.loadGroup(1, {{10, 1500}}, token));
+  EXPECT_EQ(board_.rankOf(1, 10)->elo, 1500);
+}
+
+TEST_F(LeaderboardTest, TryQueryTellsUnloadedFromEmpty) {
+  using GroupView = repositories::Leaderboard::GroupView;
+  auto top = [](const GroupView& group) { return group.top(10); };
+
+  EXPECT_FALSE(board_.tryQuery(1, top).has_value());
+
+  load(1, {});
+  auto empty = board_.tryQuery(1, top);
+  ASSERT_TRUE(empty.has_value());
+  EXPECT_TRUE(empty->empty());
+
+  board_.update(1, 10, 1500);
+  auto rank = board_.tryQuery(1, [](const GroupView& group) { return group.rankOf(10); });
+  ASSERT_TRUE(rank.has_value());
+  EXPECT_EQ((*rank)->rank, 1);
+
+  board_.clear();
+  EXPECT_FALSE(board_.tryQuery(1, top).has_value());
+}
+
+TEST_F(LeaderboardTest, RankMatchesFullScan) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> elo(0, 3000);
+  std::vector<std::pair<int64_t, int>> players;
+  for (int64_t id = 1; id <= 500; ++id) {
+    players.emplace_back(id, elo(rng));
+  }
+  load(1, players);
+  for (int i = 0; i < 200; ++i) {
+    auto& player = players[rng() % players.size()];
+    player.second = elo(rng);
+    board_.update(1, player.first, player.second);
+  }
+
+  for (const auto& [id, rating] : players) {
+    int higher = 0;
+    for (const auto& other : players) {
+      higher += other.second > rating;
+    }
+    EXPECT_EQ(board_.rankOf(1, id)->rank, higher + 1);
+  }
+}
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "observability/logger.h"
+#include <unistd.h>
+#include <cstdio>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+// Points the shared logger at a temporary file for the duration of a test
+class LoggerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    logger_ = observability::Logger::getInstance();
+    file_ = std::tmpfile();
+    ASSERT_NE(file_, nullptr);
+    saved_level_ = logger_->getLevel();
+    logger_->setLevel(observability::LogLevel::TRACE);
+    logger_->setOutput(fileno(file_));
+  }
+
+  void TearDown() override {
+    logger_->setOutput(STDOUT_FILENO);
+    logger_->setLevel(saved_level_);
+    logger_->setOverflowPolicy(observability::OverflowPolicy::kDrop);
+    std::fclose(file_);
+  }
+
+  std::vector<nlohmann::json> lines() {
+    logger_->flush();
+    std::string content;
+    std::rewind(file_);
+    char buffer[4096];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file_)) > 0) {
+      content.append(buffer, n);
+    }
+    std::vector<nlohmann::json> result;
+    std::istringstream stream(content);
+    std::string line;
+    while (std::getline(stream, line)) {
+      result.push_back(nlohmann::json::parse(line));
+    }
+    return result;
+  }
+
+  std::shared_ptr<observability::Logger> logger_;
+  std::FILE* file_ = nullptr;
+  observability::LogLevel saved_level_ = observability::LogLevel::INFO;
+};
+
+}  // namespace
+
+TEST_F(LoggerTest, WritesJsonLines) {
+  logger_->info("hello");
+  logger_->log(observability::LogLevel::WARN, "with context", {{"chat_id", "42"}});
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), 2u);
+  EXPECT_EQ(written[0]["level"], "INFO");
+  EXPECT_EQ(written[0]["message"], "hello");
+  EXPECT_TRUE(written[0].contains("timestamp"));
+  EXPECT_EQ(written[1]["level"], "WARN");
+  EXPECT_EQ(written[1]["chat_id"], "42");
+}
+
+TEST_F(LoggerTest, FiltersBelowLevel) {
+  logger_->setLevel(observability::LogLevel::WARN);
+  logger_->debug("skipped");
+  logger_->info("skipped");
+  logger_->error("kept");
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), 1u);
+  EXPECT_EQ(written[0]["message"], "kept");
+}
+
+TEST_F(LoggerTest, BlockingKeepsEveryRecordFromEveryThread) {
+  logger_->setOverflowPolicy(observability::OverflowPolicy::kBlock);
+  auto dropped_before = logger_->getStats().dropped;
+
+  constexpr int kThreads = 4;
+  constexpr int kPerThread = 5000;  // Well over the buffer capacity in total
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([this, t]() {
+      for (int i = 0; i < kPerThread; ++i) {
+        logger_->info(std::to_string(t) + ":" + std::to_string(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), static_cast<size_t>(kThreads * kPerThread));
+  // Each thread's records stay in order
+  std::vector<int> next(kThreads, 0);
+  for (const auto& line : written) {
+    auto message = line["message"].get<std::string>();
+    auto colon = message.find(':');
+    int thread = std::stoi(message.substr(0, colon));
+    EXPECT_EQ(std::stoi(message.substr(colon + 1)), next[thread]++);
+  }
+  EXPECT_EQ(logger_->getStats().dropped, dropped_before);
+}
+
+TEST_F(LoggerTest, DropPolicyCountsWhatItDrops) {
+  auto before = logger_->getStats();
+  constexpr size_t kRecords = observability::Logger::kQueueCapacity * 4;
+  for (size_t i = 0; i < kRecords; ++i) {
+    logger_->info("burst");
+  }
+  auto written = lines();
+  auto after = logger_->getStats();
+  EXPECT_EQ(written.size() + (after.dropped - before.dropped), kRecords);
+  EXPECT_EQ(after.written - before.written, written.size());
+}
+
+TEST_F(LoggerTest, EscapesStrings) {
+  logger_->log(observability::LogLevel::INFO, "quote \" backslash \\ newline \n tab \t bell \a",
+               {{"key \"1\"", "line\nbreak"}});
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), 1u);
+  EXPECT_EQ(written[0]["message"], "quote \" backslash \\ newline \n tab \t bell \a");
+  EXPECT_EQ(written[0]["key \"1\""], "line\nbreak");
+}
+
+TEST_F(LoggerTest, EncodesTypedFields) {
+  std::optional<int> missing;
+  std::optional<std::string> present = "yes";
+  logger_->info("typed",
+                observability::field<"chat_id">(int64_t{-1001234567890}),
+                observability::field<"ratio">(0.5),
+                observability::field<"ok">(true),
+                observability::field<"name">("a \"b\""),
+                observability::field<"missing">(missing),
+                observability::field<"present">(present));
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), 1u);
+  EXPECT_EQ(written[0]["message"], "typed");
+  EXPECT_EQ(written[0]["chat_id"], -1001234567890);
+  EXPECT_DOUBLE_EQ(written[0]["ratio"].get<double>(), 0.5);
+  EXPECT_EQ(written[0]["ok"], true);
+  EXPECT_EQ(written[0]["name"], "a \"b\"");
+  EXPECT_TRUE(written[0]["missing"].is_null());
+  EXPECT_EQ(written[0]["present"], "yes");
+}
+
+TEST_F(LoggerTest, MacrosSkipArgumentsOfDisabledLevels) {
+  logger_->setLevel(observability::LogLevel::INFO);
+  int evaluated = 0;
+  auto message = [&evaluated]() {
+    ++evaluated;
+    return std::string("built");
+  };
+
+  OBS_DEBUG(logger_, message());
+  OBS_TRACE(logger_, message(), observability::field<"n">(evaluated));
+  EXPECT_EQ(evaluated, 0);
+
+  OBS_INFO(logger_, message(), observability::field<"n">(42));
+  EXPECT_EQ(evaluated, 1);
+
+  auto written = lines();
+  ASSERT_EQ(written.size(), 1u);
+  EXPECT_EQ(written[0]["message"], "built");
+  EXPECT_EQ(written[0]["n"], 42);
+}
+
+TEST(LogLevelTest, ParsesNames) {
+  EXPECT_EQ(observability::logLevelFromString("DEBUG"), observability::LogLevel::DEBUG);
+  EXPECT_EQ(observability::logLevelFromString("warn"), observability::LogLevel::WARN);
+  EXPECT_EQ(observability::logLevelFromString("Warning"), observability::LogLevel::WARN);
+  EXPECT_EQ(observability::logLevelFromString("verbose", observability::LogLevel::ERROR),
+            observability::LogLevel::ERROR);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include "utils/lru_cache.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(LruCacheTest, GetReturnsPutValue) {
+  utils::ShardedLruCache<int64_t, std::string> cache(16, 1);
+  EXPECT_FALSE(cache.get(1).has_value());
+  cache.put(1, "one");
+  ASSERT_TRUE(cache.get(1).has_value());
+  EXPECT_EQ(*cache.get(1), "one");
+
+  cache.put(1, "uno");
+  EXPECT_EQ(*cache.get(1), "uno");
+  EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsed) {
+  utils::ShardedLruCache<int64_t, int> cache(2, 1);
+  cache.put(1, 10);
+  cache.put(2, 20);
+  cache.get(1);  // 2 is now least recently used
+  cache.put(3, 30);
+
+  EXPECT_TRUE(cache.get(1).has_value());
+  EXPECT_FALSE(cache.get(2).has_value());
+  EXPECT_TRUE(cache.get(3).has_value());
+  EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST(LruCacheTest, EraseAndEraseIf) {
+  utils::ShardedLruCache<int64_t, int> cache(64, 4);
+  for (int64_t key = 0; key < 10; ++key) {
+    cache.put(key, static_cast<int>(key % 2));
+  }
+  EXPECT_TRUE(cache.erase(0));
+  EXPECT_FALSE(cache.erase(0));
+  EXPECT_EQ(cache.eraseIf([](int64_t, int value) { return value == 1; }), 5u);
+  EXPECT_EQ(cache.size(), 4u);
+  cache.clear();
+  EXPECT_EQ(cache.size(), 0u);
+}
+
+TEST(LruCacheTest, StaleFillIsDroppedAfterInvalidation) {
+  utils::ShardedLruCache<int64_t, int> cache(16, 1);
+  auto snapshot = cache.snapshot(1);
+  // A writer invalidates while the reader is still loading the old row
+  cache.erase(1);
+  EXPECT_FALSE(cache.putIfUnchanged(1, 100, snapshot));
+  EXPECT_FALSE(cache.get(1).has_value());
+
+  snapshot = cache.snapshot(1);
+  EXPECT_TRUE(cache.putIfUnchanged(1, 200, snapshot));
+  EXPECT_EQ(*cache.get(1), 200);
+}
+
+TEST(LruCacheTest, CountsHitsAndMisses) {
+  utils::ShardedLruCache<int64_t, int> cache;
+  cache.get(1);
+  cache.put(1, 1);
+  cache.get(1);
+  cache.get(1);
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.hits, 2u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.size, 1u);
+}
+
+TEST(LruCacheTest, ConcurrentAccessStaysBounded) {
+  utils::ShardedLruCache<int64_t, int64_t> cache(256, 8);
+  std::vector<std::thread> threads;
+  std::atomic<int> wrong{0};
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, &wrong, t] {
+      for (int64_t i = 0; i < 5000; ++i) {
+        int64_t key = (i * 7 + t) % 1000;
+        cache.put(key, key * 2);
+        if (auto value = cache.get(key); value && *value != key * 2) {
+          wrong++;
+        }
+        if (i % 50 == 0) {
+          cache.erase(key);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(wrong.load(), 0);
+  EXPECT_LE(cache.size(), 256u);
+}
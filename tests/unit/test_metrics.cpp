@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include "observability/metrics.h"
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace observability;
+using namespace std::chrono_literals;
+
+TEST(MetricsTest, CounterSumsShardsAcrossThreads) {
+  Counter counter;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&counter]() {
+      for (int i = 0; i < 10000; ++i) {
+        counter.inc();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  counter.inc(5);
+  EXPECT_EQ(counter.value(), 80005u);
+}
+
+TEST(MetricsTest, HistogramBucketsStayWithinRelativeError) {
+  for (uint64_t micros : {0ull, 1ull, 7ull, 8ull, 9ull, 100ull, 1000ull, 123456ull, 1ull << 35}) {
+    size_t index = Histogram::bucketIndex(micros);
+    ASSERT_LT(index, Histogram::kBuckets);
+    uint64_t upper = Histogram::bucketUpperBound(index);
+    EXPECT_GT(upper, micros);
+    // The bucket's lower bound is the previous bucket's upper bound
+    uint64_t lower = index == 0 ? 0 : Histogram::bucketUpperBound(index - 1);
+    EXPECT_LE(lower, micros);
+    EXPECT_LE(static_cast<double>(upper - lower), 0.125 * static_cast<double>(lower) + 1.0);
+  }
+  EXPECT_EQ(Histogram::bucketIndex(1ull << 50), Histogram::kBuckets - 1);
+}
+
+TEST(MetricsTest, HistogramQuantilesAndSum) {
+  Histogram histogram;
+  for (int i = 0; i < 90; ++i) {
+    histogram.observe(1ms);
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.observe(100ms);
+  }
+
+  auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 100u);
+  EXPECT_NEAR(snapshot.sum_seconds, 1.09, 1e-9);
+  EXPECT_NEAR(snapshot.quantile(0.5), 0.001, 0.001 * 0.125);
+  EXPECT_NEAR(snapshot.quantile(0.99), 0.1, 0.1 * 0.125);
+  EXPECT_EQ(snapshot.countBelow(1024), 90u);
+  EXPECT_EQ(Histogram().snapshot().quantile(0.5), 0.0);
+}
+
+TEST(MetricsTest, RegistryReturnsTheSameSeries) {
+  MetricsRegistry registry;
+  auto& a = registry.counter("requests_total", "Requests", {{"code", "200"}});
+  auto& b = registry.counter("requests_total", "Requests", {{"code", "200"}});
+  auto& c = registry.counter("requests_total", "Requests", {{"code", "500"}});
+  EXPECT_EQ(&a, &b);
+  EXPECT_NE(&a, &c);
+  EXPECT_THROW(registry.histogram("requests_total", "Requests"), std::invalid_argument);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+  MetricsRegistry registry;
+  registry.counter("jobs_total", "Jobs run", {{"queue", "a\"b"}}).inc(3);
+  registry.gauge("temperature", "Current temperature").set(21.5);
+  auto& histogram = registry.histogram("latency_seconds", "Latency", {{"op", "read"}});
+  histogram.observe(50us);
+  histogram.observe(2ms);
+
+  std::string text = registry.render();
+  EXPECT_NE(text.find("# HELP jobs_total Jobs run\n# TYPE jobs_total counter\n"), std::string::npos);
+  EXPECT_NE(text.find("jobs_total{queue=\"a\\\"b\"} 3\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE temperature gauge\ntemperature 21.5\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE latency_seconds histogram\n"), std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{op=\"read\",le=\"0.000128\"} 1\n"), std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{op=\"read\",le=\"0.004096\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_bucket{op=\"read\",le=\"+Inf\"} 2\n"), std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_sum{op=\"read\"} 0.00205\n"), std::string::npos);
+  EXPECT_NE(text.find("latency_seconds_count{op=\"read\"} 2\n"), std::string::npos);
+}
+
+TEST(MetricsTest, CallbackGaugeLivesAsLongAsItsHandle) {
+  MetricsRegistry registry;
+  double value = 4;
+  {
+    auto handle = registry.gaugeCallback("pool_size", "Pool size", {}, [&value]() { return value; });
+    EXPECT_NE(registry.render().find("pool_size 4\n"), std::string::npos);
+    value = 7;
+    EXPECT_NE(registry.render().find("pool_size 7\n"), std::string::npos);
+
+    // A newer registration replaces the series; the old handle leaves it alone
+    auto newer = registry.gaugeCallback("pool_size", "Pool size", {}, []() { return 1.0; });
+    handle.reset();
+    EXPECT_NE(registry.render().find("pool_size 1\n"), std::string::npos);
+  }
+  EXPECT_EQ(registry.render().find("pool_size"), std::string::npos);
+}
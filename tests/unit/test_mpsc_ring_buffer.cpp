@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "utils/mpsc_ring_buffer.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpscRingBufferTest, RoundsCapacityUpToPowerOfTwo) {
+  utils::MpscRingBuffer<int> buffer(5);
+  EXPECT_EQ(buffer.capacity(), 8u);
+}
+
+TEST(MpscRingBufferTest, RefusesPushesWhenFull) {
+  utils::MpscRingBuffer<std::string> buffer(4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(buffer.tryPush(std::to_string(i)));
+  }
+  std::string extra = "extra";
+  EXPECT_FALSE(buffer.tryPush(std::move(extra)));
+  EXPECT_EQ(extra, "extra");  // Left untouched
+
+  std::string value;
+  ASSERT_TRUE(buffer.tryPop(value));
+  EXPECT_EQ(value, "0");
+  EXPECT_TRUE(buffer.tryPush(std::move(extra)));
+  EXPECT_EQ(buffer.pushed(), 5u);
+  EXPECT_EQ(buffer.popped(), 1u);
+}
+
+TEST(MpscRingBufferTest, KeepsEveryProducersOrder) {
+  constexpr int kProducers = 4;
+  constexpr int kPerProducer = 20000;
+  utils::MpscRingBuffer<int> buffer(64);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&buffer, p]() {
+      for (int i = 0; i < kPerProducer; ++i) {
+        int value = p * kPerProducer + i;
+        while (!buffer.tryPush(std::move(value))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<int> next(kProducers, 0);
+  int received = 0;
+  while (received < kProducers * kPerProducer) {
+    int value = 0;
+    if (!buffer.tryPop(value)) {
+      std::this_thread::yield();
+      continue;
+    }
+    int producer = value / kPerProducer;
+    ASSERT_EQ(value % kPerProducer, next[producer]++);
+    ++received;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(buffer.empty());
+}
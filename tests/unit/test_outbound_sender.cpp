@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include "bot/outbound_sender.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+
+// Fast limits so tests don't wait on Telegram's real ones
+bot::OutboundSender::Options fastOptions() {
+  bot::OutboundSender::Options options;
+  options.sender_threads = 4;
+  options.per_chat_rate = 1000.0;
+  options.per_chat_burst = 1000.0;
+  options.global_rate = 10000.0;
+  options.global_burst = 10000.0;
+  return options;
+}
+
+bot::OutboundMessage text(int64_t chat_id, std::string body, bool coalesce = false) {
+  bot::OutboundMessage message;
+  message.chat_id = chat_id;
+  message.text = std::move(body);
+  message.coalesce = coalesce;
+  return message;
+}
+
+// Records deliveries; thread-safe
+struct Recorder {
+  std::mutex mutex;
+  std::vector<bot::OutboundMessage> delivered;
+
+  bot::OutboundSender::Transport transport() {
+    return [this](const bot::OutboundMessage& message) {
+      std::lock_guard<std::mutex> lock(mutex);
+      delivered.push_back(message);
+    };
+  }
+};
+
+}  // namespace
+
+TEST(OutboundSenderTest, PreservesOrderWithinChat) {
+  Recorder recorder;
+  {
+    bot::OutboundSender sender(recorder.transport(), fastOptions());
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_TRUE(sender.send(text(1, "a" + std::to_string(i))));
+      ASSERT_TRUE(sender.send(text(2, "b" + std::to_string(i))));
+    }
+    sender.shutdown();
+    EXPECT_EQ(sender.getStats().sent, 200u);
+  }
+
+  int next_a = 0, next_b = 0;
+  for (const auto& message : recorder.delivered) {
+    if (message.chat_id == 1) {
+      EXPECT_EQ(message.text, "a" + std::to_string(next_a++));
+    } else {
+      EXPECT_EQ(message.text, "b" + std::to_string(next_b++));
+    }
+  }
+  EXPECT_EQ(next_a, 100);
+  EXPECT_EQ(next_b, 100);
+}
+
+TEST(OutboundSenderTest, EnforcesPerChatRate) {
+  Recorder recorder;
+  auto options = fastOptions();
+  options.per_chat_rate = 20.0;
+  options.per_chat_burst = 1.0;
+  bot::OutboundSender sender(recorder.transport(), options);
+
+  auto started = std::chrono::steady_clock::now();
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(sender.send(text(7, std::to_string(i))));
+  }
+  sender.shutdown();
+  // One immediately, then one every 50 ms
+  EXPECT_GE(std::chrono::steady_clock::now() - started, 190ms);
+  EXPECT_EQ(recorder.delivered.size(), 5u);
+}
+
+TEST(OutboundSenderTest, EnforcesGlobalRate) {
+  Recorder recorder;
+  auto options = fastOptions();
+  options.global_rate = 20.0;
+  options.global_burst = 1.0;
+  bot::OutboundSender sender(recorder.transport(), options);
+
+  auto started = std::chrono::steady_clock::now();
+  for (int64_t chat_id = 1; chat_id <= 5; ++chat_id) {
+    ASSERT_TRUE(sender.send(text(chat_id, "hello")));
+  }
+  sender.shutdown();
+  EXPECT_GE(std::chrono::steady_clock::now() - started, 190ms);
+  EXPECT_EQ(recorder.delivered.size(), 5u);
+}
+
+TEST(OutboundSenderTest, CoalescesQueuedLogLines) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  std::vector<std::string> delivered;
+
+  // The first delivery blocks until the rest is queued behind it
+  auto transport = [&](const bot::OutboundMessage& message) {
+    std::unique_lock<std::mutex> lock(mutex);
+    delivered.push_back(message.text);
+    cv.wait(lock, [&] { return release; });
+  };
+  bot::OutboundSender sender(transport, fastOptions());
+  ASSERT_TRUE(sender.send(text(3, "first", true)));
+  while (sender.getStats().queued != 0) {
+    std::this_thread::yield();
+  }
+  ASSERT_TRUE(sender.send(text(3, "line 1", true)));
+  ASSERT_TRUE(sender.send(text(3, "line 2", true)));
+  ASSERT_TRUE(sender.send(text(3, "line 3", true)));
+  ASSERT_TRUE(sender.send(text(3, "reply")));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+  sender.shutdown();
+
+  ASSERT_EQ(delivered.size(), 3u);
+  EXPECT_EQ(delivered[0], "first");
+  EXPECT_EQ(delivered[1], "line 1\nline 2\nline 3");
+  EXPECT_EQ(delivered[2], "reply");
+  EXPECT_EQ(sender.getStats().coalesced, 2u);
+}
+
+TEST(OutboundSenderTest, RetriesTooManyRequests) {
+  std::atomic<int> attempts{0};
+  std::vector<std::chrono::steady_clock::time_point> at;
+  auto transport = [&](const bot::OutboundMessage&) {
+    at.push_back(std::chrono::steady_clock::now());
+    if (attempts++ == 0) {
+      throw std::runtime_error("Too Many Requests: retry after 1");
+    }
+  };
+  auto options = fastOptions();
+  options.sender_threads = 1;
+  bot::OutboundSender sender(transport, options);
+  ASSERT_TRUE(sender.send(text(9, "hi")));
+  sender.shutdown();
+
+  ASSERT_EQ(attempts.load(), 2);
+  EXPECT_GE(at[1] - at[0], 990ms);
+  auto stats = sender.getStats();
+  EXPECT_EQ(stats.retried, 1u);
+  EXPECT_EQ(stats.sent, 1u);
+}
+
+TEST(OutboundSenderTest, OtherErrorsAreNotRetried) {
+  std::atomic<int> attempts{0};
+  bot::OutboundSender sender([&](const bot::OutboundMessage&) {
+    attempts++;
+    throw std::runtime_error("Bad Request: chat not found");
+  }, fastOptions());
+  ASSERT_TRUE(sender.send(text(9, "hi")));
+  sender.shutdown();
+  EXPECT_EQ(attempts.load(), 1);
+  EXPECT_EQ(sender.getStats().failed, 1u);
+}
+
+TEST(OutboundSenderTest, ParsesRetryAfter) {
+  EXPECT_EQ(bot::OutboundSender::retryAfter("Too Many Requests: retry after 35"), 35s);
+  EXPECT_EQ(bot::OutboundSender::retryAfter(R"({"ok":false,"parameters":{"retry_after":7}})"), 7s);
+  EXPECT_FALSE(bot::OutboundSender::retryAfter("Bad Request: message is too long").has_value());
+  EXPECT_FALSE(bot::OutboundSender::retryAfter("retry after soon").has_value());
+}
+
+TEST(OutboundSenderTest, RefusesWhenFullOrStopped) {
+  std::mutex mutex;
+  std::unique_lock<std::mutex> hold(mutex);
+  auto options = fastOptions();
+  options.max_queue = 2;
+  options.drain_timeout = 0ms;
+  bot::OutboundSender sender([&](const bot::OutboundMessage&) {
+    std::lock_guard<std::mutex> lock(mutex);
+  }, options);
+
+  // The first message is picked up and blocks, two more fill the queue
+  ASSERT_TRUE(sender.send(text(1, "in flight")));
+  while (sender.getStats().queued != 0) {
+    std::this_thread::yield();
+  }
+  EXPECT_TRUE(sender.send(text(1, "queued 1")));
+  EXPECT_TRUE(sender.send(text(1, "queued 2")));
+  EXPECT_FALSE(sender.send(text(1, "over the limit")));
+
+  EXPECT_FALSE(sender.isShutDown());
+
+  hold.unlock();
+  sender.shutdown();
+  EXPECT_TRUE(sender.isShutDown());
+  EXPECT_FALSE(sender.send(text(1, "after shutdown")));
+  auto stats = sender.getStats();
+  EXPECT_EQ(stats.sent + stats.dropped, 3u);
+  EXPECT_EQ(stats.rejected, 1u);
+}
@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include "utils/elo_calculator.h"
+#include "utils/rating_engine.h"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Random independent matches, rated one by one and as a batch
+void expectBatchMatchesScalar(const utils::RatingEngine& engine) {
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<int> rating(800, 2400);
+  std::uniform_real_distribution<double> deviation(40.0, 350.0);
+  std::uniform_real_distribution<double> volatility(0.04, 0.09);
+  std::uniform_int_distribution<int> score(0, 11);
+
+  const size_t n = 500;
+  std::vector<int> rating1(n), rating2(n), score1(n), score2(n);
+  std::vector<double> deviation1(n), deviation2(n), volatility1(n), volatility2(n);
+  for (size_t i = 0; i < n; ++i) {
+    rating1[i] = rating(rng);
+    rating2[i] = rating(rng);
+    deviation1[i] = deviation(rng);
+    deviation2[i] = deviation(rng);
+    volatility1[i] = volatility(rng);
+    volatility2[i] = volatility(rng);
+    score1[i] = score(rng);
+    score2[i] = i % 9 == 0 ? score1[i] : score(rng);
+  }
+  auto before1 = rating1, before2 = rating2;
+  auto dev_before1 = deviation1, dev_before2 = deviation2;
+  auto vol_before1 = volatility1, vol_before2 = volatility2;
+
+  engine.rateBatch({rating1, rating2, deviation1, deviation2, volatility1, volatility2, score1, score2});
+
+  for (size_t i = 0; i < n; ++i) {
+    auto [new1, new2] = engine.rate({before1[i], dev_before1[i], vol_before1[i]},
+                                    {before2[i], dev_before2[i], vol_before2[i]},
+                                    score1[i], score2[i]);
+    ASSERT_EQ(rating1[i], new1.rating) << "i = " << i;
+    ASSERT_EQ(rating2[i], new2.rating) << "i = " << i;
+    ASSERT_EQ(deviation1[i], new1.deviation) << "i = " << i;
+    ASSERT_EQ(deviation2[i], new2.deviation) << "i = " << i;
+    ASSERT_EQ(volatility1[i], new1.volatility) << "i = " << i;
+    ASSERT_EQ(volatility2[i], new2.volatility) << "i = " << i;
+  }
+}
+
+}  // namespace
+
+TEST(RatingEngineTest, SystemNamesRoundTrip) {
+  for (auto system : {utils::RatingSystem::kElo, utils::RatingSystem::kGlicko2,
+                      utils::RatingSystem::kMarginElo}) {
+    EXPECT_EQ(utils::parseRatingSystem(utils::toString(system)), system);
+  }
+  EXPECT_FALSE(utils::parseRatingSystem("trueskill").has_value());
+
+  utils::RatingEngines engines;
+  EXPECT_EQ(engines.get(utils::RatingSystem::kGlicko2).system(), utils::RatingSystem::kGlicko2);
+  EXPECT_EQ(engines.get(utils::RatingSystem::kMarginElo).system(), utils::RatingSystem::kMarginElo);
+}
+
+TEST(RatingEngineTest, EloEngineMatchesCalculator) {
+  utils::EloCalculator calculator(32);
+  utils::EloEngine engine(calculator);
+  auto [new1, new2] = engine.rate({1600, 120.0, 0.05}, {1450}, 11, 7);
+  auto [elo1, elo2] = calculator.calculate(1600, 1450, 11, 7);
+  EXPECT_EQ(new1.rating, elo1);
+  EXPECT_EQ(new2.rating, elo2);
+  // ELO leaves the Glicko-2 state alone
+  EXPECT_EQ(new1.deviation, 120.0);
+  EXPECT_EQ(new1.volatility, 0.05);
+  expectBatchMatchesScalar(engine);
+}
+
+TEST(RatingEngineTest, MarginEloScalesWithTheMargin) {
+  utils::MarginEloEngine engine(32, utils::ExpectedScoreMode::kExact);
+  auto [close1, close2] = engine.rate({1500}, {1500}, 11, 9);
+  auto [blowout1, blowout2] = engine.rate({1500}, {1500}, 11, 0);
+  EXPECT_GT(close1.rating, 1500);
+  EXPECT_GT(blowout1.rating, close1.rating);
+  EXPECT_LT(blowout2.rating, close2.rating);
+
+  // A draw is plain ELO
+  utils::EloCalculator calculator(32);
+  auto [draw1, draw2] = engine.rate({1700}, {1500}, 5, 5);
+  auto [elo1, elo2] = calculator.calculate(1700, 1500, 5, 5);
+  EXPECT_EQ(draw1.rating, elo1);
+  EXPECT_EQ(draw2.rating, elo2);
+
+  // The favourite gains less for the same margin than the underdog would
+  EXPECT_LT(utils::MarginEloEngine::marginMultiplier(1800, 1400, 11, 5),
+            utils::MarginEloEngine::marginMultiplier(1400, 1800, 11, 5));
+  expectBatchMatchesScalar(engine);
+}
+
+TEST(RatingEngineTest, Glicko2UpdatesRatingAndDeviation) {
+  utils::Glicko2Engine engine;
+  auto [winner, loser] = engine.rate({1500}, {1500}, 11, 4);
+  EXPECT_GT(winner.rating, 1500);
+  EXPECT_LT(loser.rating, 1500);
+  EXPECT_EQ(winner.rating - 1500, 1500 - loser.rating);
+  // One result already makes both ratings more certain
+  EXPECT_LT(winner.deviation, utils::kInitialDeviation);
+  EXPECT_DOUBLE_EQ(winner.deviation, loser.deviation);
+  EXPECT_GT(winner.volatility, 0.0);
+
+  // An established player moves less than a new one for the same result
+  auto [established, opponent] = engine.rate({1500, 60.0, 0.06}, {1500}, 11, 4);
+  EXPECT_LT(established.rating, winner.rating);
+  expectBatchMatchesScalar(engine);
+}
+
+TEST(RatingEngineTest, PerPlayerKFactor) {
+  utils::EloCalculator calculator(32);
+  utils::EloEngine engine(calculator);
+  utils::Rating provisional{1500, 350.0, 0.06, 40};
+  utils::Rating established{1500, 350.0, 0.06, 16};
+  auto [new1, new2] = engine.rate(provisional, established, 11, 4);
+  auto [elo1, elo2] = calculator.calculate(1500, 1500, 11, 4, 40, 16);
+  EXPECT_EQ(new1.rating, elo1);
+  EXPECT_EQ(new2.rating, elo2);
+  EXPECT_GT(new1.rating - 1500, 1500 - new2.rating);
+
+  // Batch with K spans matches the scalar path
+  std::vector<int> rating1{1500, 1700}, rating2{1500, 1400}, score1{11, 3}, score2{4, 11};
+  std::vector<int> k1{40, 24}, k2{16, 32};
+  std::vector<double> deviations(2, 350.0), volatilities(2, 0.06);
+  utils::MarginEloEngine margin(32, utils::ExpectedScoreMode::kExact);
+  for (const utils::RatingEngine* e : {static_cast<const utils::RatingEngine*>(&engine),
+                                       static_cast<const utils::RatingEngine*>(&margin)}) {
+    auto r1 = rating1, r2 = rating2;
+    e->rateBatch({r1, r2, deviations, deviations, volatilities, volatilities, score1, score2, k1, k2});
+    for (size_t i = 0; i < 2; ++i) {
+      auto [n1, n2] = e->rate({rating1[i], 350.0, 0.06, k1[i]}, {rating2[i], 350.0, 0.06, k2[i]},
+                              score1[i], score2[i]);
+      EXPECT_EQ(r1[i], n1.rating);
+      EXPECT_EQ(r2[i], n2.rating);
+    }
+  }
+}
+
+TEST(RatingEngineTest, BatchRejectsMismatchedSpans) {
+  utils::Glicko2Engine engine;
+  std::vector<int> two(2, 1500), three(3, 1500);
+  std::vector<double> deviations(2, 350.0), volatilities(2, 0.06);
+  EXPECT_THROW(engine.rateBatch({two, two, deviations, deviations, volatilities, volatilities, two, three}),
+               std::invalid_argument);
+  std::vector<int> one_k(1, 32);
+  EXPECT_THROW(engine.rateBatch({two, two, deviations, deviations, volatilities, volatilities, two, two,
+                                 one_k, one_k}),
+               std::invalid_argument);
+}
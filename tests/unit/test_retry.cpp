@@ -245,3 +245,21 @@ TEST_F(RetryTest, RetrySuccessAfterMaxRetriesMinusOne) {
 
 
 
+
+TEST_F(RetryTest, RetryCountsConflictsInMetrics) {
+  utils::RetryConfig config;
+  config.max_retries = 2;
+  config.initial_delay = std::chrono::milliseconds(1);
+  
+  auto retries_before = utils::detail::optimisticLockRetries().value();
+  auto failures_before = utils::detail::optimisticLockFailures().value();
+  
+  EXPECT_THROW({
+    utils::retryWithBackoff([]() -> int {
+      throw utils::OptimisticLockException("Lock conflict");
+    }, config);
+  }, utils::OptimisticLockException);
+  
+  EXPECT_EQ(utils::detail::optimisticLockRetries().value() - retries_before, 2u);
+  EXPECT_EQ(utils::detail::optimisticLockFailures().value() - failures_before, 1u);
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "utils/thread_pool.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RejectsZeroThreads) {
+  EXPECT_THROW(utils::ThreadPool(0, 4), std::invalid_argument);
+}
+
+TEST(ThreadPoolTest, RunsSubmittedTasks) {
+  std::atomic<int> counter{0};
+  {
+    utils::ThreadPool pool(4, 100);
+    for (int i = 0; i < 50; ++i) {
+      EXPECT_TRUE(pool.trySubmit([&counter]() { counter++; }));
+    }
+    pool.shutdown();
+  }
+  EXPECT_EQ(counter.load(), 50);
+}
+
+TEST(ThreadPoolTest, RejectsWhenQueueFull) {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  std::atomic<int> started{0};
+
+  utils::ThreadPool pool(1, 2);
+  auto blocker = [&]() {
+    started++;
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return release; });
+  };
+
+  // Occupy the single worker, then fill the queue
+  ASSERT_TRUE(pool.trySubmit(blocker));
+  while (started.load() == 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(pool.trySubmit([] {}));
+  EXPECT_TRUE(pool.trySubmit([] {}));
+  EXPECT_EQ(pool.getQueueDepth(), 2u);
+  EXPECT_EQ(pool.getBusyWorkers(), 1u);
+
+  EXPECT_FALSE(pool.trySubmit([] {}));
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cv.notify_all();
+  pool.shutdown();
+  EXPECT_EQ(pool.getQueueDepth(), 0u);
+}
+
+TEST(ThreadPoolTest, RejectsAfterShutdown) {
+  utils::ThreadPool pool(2, 4);
+  pool.shutdown();
+  EXPECT_FALSE(pool.trySubmit([] {}));
+}
+
+TEST(ThreadPoolTest, ConcurrentShutdownsJoinEachWorkerOnce) {
+  std::atomic<int> counter{0};
+  utils::ThreadPool pool(4, 64);
+  for (int i = 0; i < 32; ++i) {
+    EXPECT_TRUE(pool.trySubmit([&counter]() { counter++; }));
+  }
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 4; ++i) {
+    callers.emplace_back([&pool]() { pool.shutdown(); });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  pool.shutdown();
+  EXPECT_EQ(pool.getThreadCount(), 0u);
+  EXPECT_EQ(counter.load(), 32);
+}
+
+TEST(ThreadPoolTest, TaskExceptionDoesNotKillWorker) {
+  std::atomic<int> counter{0};
+  utils::ThreadPool pool(1, 4);
+  EXPECT_TRUE(pool.trySubmit([]() { throw std::runtime_error("boom"); }));
+  EXPECT_TRUE(pool.trySubmit([&counter]() { counter++; }));
+  pool.shutdown();
+  EXPECT_EQ(counter.load(), 1);
+}
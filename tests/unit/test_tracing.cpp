@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "observability/tracing.h"
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace observability;
+
+namespace {
+
+// Collects exported OTLP bodies
+struct Sink {
+  std::mutex mutex;
+  std::vector<std::string> bodies;
+  bool fail = false;
+
+  Tracer::Exporter exporter() {
+    return [this](const std::string& body) {
+      std::lock_guard<std::mutex> lock(mutex);
+      bodies.push_back(body);
+      return !fail;
+    };
+  }
+
+  std::string all() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string joined;
+    for (const auto& body : bodies) {
+      joined += body;
+    }
+    return joined;
+  }
+};
+
+Tracer::Options enabledOptions(double sampling_rate = 1.0) {
+  Tracer::Options options;
+  options.enabled = true;
+  options.sampling_rate = sampling_rate;
+  options.export_interval = std::chrono::milliseconds(20);
+  return options;
+}
+
+}  // namespace
+
+TEST(TracingTest, DisabledTracerRecordsNothing) {
+  Tracer tracer;
+  Span span = tracer.startSpan("update");
+  EXPECT_FALSE(span.isRecording());
+  EXPECT_FALSE(span.context().valid());
+}
+
+TEST(TracingTest, ChildSpansShareTheTraceAndPointAtTheirParent) {
+  Sink sink;
+  Tracer tracer;
+  tracer.configure(enabledOptions(), sink.exporter());
+
+  SpanContext root_context;
+  SpanContext child_context;
+  {
+    Span root = tracer.startSpan("webhook.update", SpanKind::kServer);
+    ASSERT_TRUE(root.isRecording());
+    root.setAttribute("http.request.body.size", 42);
+    root_context = root.context();
+
+    ContextScope scope(root.context());
+    Span child = tracer.startSpan("db player_by_id", SpanKind::kClient);
+    child.setAttribute("db.system", "postgresql");
+    child.setError("timeout");
+    child_context = child.context();
+  }
+  EXPECT_FALSE(currentContext().valid());
+  EXPECT_EQ(child_context.trace_id, root_context.trace_id);
+  EXPECT_NE(child_context.span_id, root_context.span_id);
+
+  tracer.shutdown();
+  EXPECT_EQ(tracer.getStats().exported, 2u);
+
+  std::string otlp = sink.all();
+  EXPECT_NE(otlp.find("\"service.name\""), std::string::npos);
+  EXPECT_NE(otlp.find("\"name\":\"webhook.update\",\"kind\":2"), std::string::npos);
+  EXPECT_NE(otlp.find("\"key\":\"http.request.body.size\",\"value\":{\"intValue\":\"42\"}"), std::string::npos);
+  EXPECT_NE(otlp.find("\"key\":\"db.system\",\"value\":{\"stringValue\":\"postgresql\"}"), std::string::npos);
+  EXPECT_NE(otlp.find("\"status\":{\"code\":2,\"message\":\"timeout\"}"), std::string::npos);
+  std::string parent_id = root_context.traceparent().substr(36, 16);
+  EXPECT_NE(otlp.find("\"parentSpanId\":\"" + parent_id + "\""), std::string::npos);
+}
+
+TEST(TracingTest, UnsampledTracesPropagateWithoutRecording) {
+  Sink sink;
+  Tracer tracer;
+  tracer.configure(enabledOptions(0.0), sink.exporter());
+
+  Span root = tracer.startSpan("webhook.update");
+  EXPECT_TRUE(root.context().valid());
+  EXPECT_FALSE(root.context().sampled);
+  EXPECT_FALSE(root.isRecording());
+
+  Span child = tracer.startSpan("command", SpanKind::kInternal, root.context());
+  EXPECT_FALSE(child.isRecording());
+  EXPECT_EQ(child.context().trace_id, root.context().trace_id);
+
+  root.end();
+  child.end();
+  tracer.shutdown();
+  EXPECT_EQ(tracer.getStats().exported, 0u);
+  EXPECT_TRUE(sink.all().empty());
+}
+
+TEST(TracingTest, ContextCrossesThreadsThroughContextScope) {
+  Sink sink;
+  Tracer tracer;
+  tracer.configure(enabledOptions(), sink.exporter());
+
+  Span root = tracer.startSpan("webhook.update");
+  SpanContext child_context;
+  std::thread worker([&tracer, &child_context, context = root.context()]() {
+    ContextScope scope(context);
+    Span child = tracer.startSpan("telegram sendMessage", SpanKind::kClient);
+    child_context = child.context();
+  });
+  worker.join();
+
+  EXPECT_EQ(child_context.trace_id, root.context().trace_id);
+  EXPECT_TRUE(child_context.sampled);
+}
+
+TEST(TracingTest, FailedExportsAreCountedAsDropped) {
+  Sink sink;
+  sink.fail = true;
+  Tracer tracer;
+  tracer.configure(enabledOptions(), sink.exporter());
+
+  tracer.startSpan("a").end();
+  tracer.startSpan("b").end();
+  tracer.shutdown();
+
+  EXPECT_EQ(tracer.getStats().exported, 0u);
+  EXPECT_EQ(tracer.getStats().dropped, 2u);
+}
+
+TEST(TracingTest, TraceparentFormat) {
+  SpanContext context;
+  context.trace_id.fill(0xab);
+  context.span_id.fill(0x01);
+  context.sampled = true;
+  EXPECT_EQ(context.traceparent(), "00-abababababababababababababababab-0101010101010101-01");
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "bot/update_dispatcher.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(UpdateDispatcherTest, RejectsZeroLanes) {
+  EXPECT_THROW(bot::UpdateDispatcher(0, 8), std::invalid_argument);
+}
+
+TEST(UpdateDispatcherTest, SameChatAlwaysMapsToSameLane) {
+  bot::UpdateDispatcher dispatcher(4, 8);
+  for (int64_t chat_id : {int64_t{-1001234567890}, int64_t{42}, int64_t{0}}) {
+    size_t lane = dispatcher.laneFor(chat_id);
+    EXPECT_LT(lane, 4u);
+    EXPECT_EQ(dispatcher.laneFor(chat_id), lane);
+  }
+}
+
+TEST(UpdateDispatcherTest, PreservesOrderWithinChat) {
+  std::mutex mutex;
+  std::vector<int> seen;
+  {
+    bot::UpdateDispatcher dispatcher(4, 16);
+    for (int i = 0; i < 200; ++i) {
+      ASSERT_TRUE(dispatcher.dispatch(-100777, [&, i]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.push_back(i);
+      }));
+    }
+    dispatcher.shutdown();
+  }
+
+  ASSERT_EQ(seen.size(), 200u);
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_EQ(seen[i], i);
+  }
+}
+
+TEST(UpdateDispatcherTest, RunsDifferentChatsInParallel) {
+  bot::UpdateDispatcher dispatcher(8, 16);
+
+  // Find two chats on different lanes
+  int64_t chat_a = 1;
+  int64_t chat_b = 2;
+  while (dispatcher.laneFor(chat_b) == dispatcher.laneFor(chat_a)) {
+    chat_b++;
+  }
+
+  std::atomic<bool> a_started{false};
+  std::atomic<bool> b_ran{false};
+  std::atomic<bool> release{false};
+
+  dispatcher.dispatch(chat_a, [&]() {
+    a_started = true;
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  dispatcher.dispatch(chat_b, [&]() { b_ran = true; });
+
+  // chat_b must complete while chat_a is still blocked
+  for (int i = 0; i < 2000 && !b_ran.load(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(a_started.load());
+  EXPECT_TRUE(b_ran.load());
+
+  release = true;
+  dispatcher.shutdown();
+}
+
+TEST(UpdateDispatcherTest, NestedDispatchOnSameLaneRunsInline) {
+  std::vector<int> order;
+  bot::UpdateDispatcher dispatcher(2, 1);
+  dispatcher.dispatch(5, [&]() {
+    order.push_back(1);
+    dispatcher.dispatch(5, [&]() { order.push_back(2); });
+    order.push_back(3);
+  });
+  dispatcher.shutdown();
+
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 3}));
+}
+
+TEST(UpdateDispatcherTest, TracksLaneStats) {
+  bot::UpdateDispatcher dispatcher(2, 8);
+  for (int i = 0; i < 5; ++i) {
+    dispatcher.dispatch(7, [] { throw std::runtime_error("handler failure is contained"); });
+  }
+  dispatcher.shutdown();
+
+  auto stats = dispatcher.getLaneStats(dispatcher.laneFor(7));
+  EXPECT_EQ(stats.processed, 5u);
+  EXPECT_EQ(stats.queue_depth, 0u);
+  EXPECT_GE(stats.total_wait_us, stats.max_wait_us);
+  EXPECT_EQ(dispatcher.getStats().size(), 2u);
+}
+
+TEST(UpdateDispatcherTest, RejectsAfterShutdown) {
+  bot::UpdateDispatcher dispatcher(1, 4);
+  dispatcher.shutdown();
+  EXPECT_FALSE(dispatcher.dispatch(1, [] {}));
+}
+
+TEST(UpdateDispatcherTest, TryDispatchRefusesWhenLaneIsFull) {
+  bot::UpdateDispatcher dispatcher(1, 1);
+  std::mutex mutex;
+  std::unique_lock<std::mutex> hold(mutex);
+  std::atomic<bool> started{false};
+  using Result = bot::UpdateDispatcher::DispatchResult;
+
+  // The first task blocks the lane thread, the second fills the queue
+  ASSERT_EQ(dispatcher.tryDispatch(1, [&] {
+    started = true;
+    std::lock_guard<std::mutex> lock(mutex);
+  }), Result::kAccepted);
+  while (!started) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(dispatcher.tryDispatch(1, [] {}), Result::kAccepted);
+  EXPECT_EQ(dispatcher.tryDispatch(1, [] {}), Result::kLaneFull);
+
+  hold.unlock();
+  dispatcher.shutdown();
+  EXPECT_EQ(dispatcher.tryDispatch(1, [] {}), Result::kShutDown);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "school21/verification_cache.h"
+#include <chrono>
+
+namespace {
+
+school21::Lookup found(const std::string& login, const std::string& status) {
+  school21::Lookup lookup;
+  lookup.status = school21::LookupStatus::kFound;
+  lookup.participant = school21::Participant{login, status, std::nullopt, std::nullopt};
+  return lookup;
+}
+
+school21::Lookup notFound() {
+  school21::Lookup lookup;
+  lookup.status = school21::LookupStatus::kNotFound;
+  return lookup;
+}
+
+}  // namespace
+
+TEST(VerificationCacheTest, ReturnsFoundParticipants) {
+  school21::VerificationCache cache(school21::VerificationCache::Options{});
+  EXPECT_FALSE(cache.get("alice").has_value());
+
+  cache.put("alice", found("alice", "ACTIVE"), 1, 1, 10);
+  auto cached = cache.get("alice");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->status, school21::LookupStatus::kFound);
+  EXPECT_EQ(cached->participant->status, "ACTIVE");
+
+  auto stats = cache.getStats();
+  EXPECT_EQ(stats.memory_hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+}
+
+TEST(VerificationCacheTest, LoginsAreCaseInsensitive) {
+  school21::VerificationCache cache(school21::VerificationCache::Options{});
+  cache.put("Alice", found("alice", "ACTIVE"), 1, 1, 10);
+  EXPECT_TRUE(cache.get("ALICE").has_value());
+  EXPECT_TRUE(cache.get("alice").has_value());
+}
+
+TEST(VerificationCacheTest, CachesUnknownLoginsWithTheFailureTtl) {
+  school21::VerificationCache::Options options;
+  options.success_ttl = std::chrono::hours(1);
+  options.failure_ttl = std::chrono::seconds(0);
+  school21::VerificationCache cache(options);
+
+  cache.put("ghost", notFound(), 1, 1, 10);
+  cache.put("alice", found("alice", "ACTIVE"), 1, 1, 11);
+  // Expired right away: only the success TTL keeps an entry
+  EXPECT_FALSE(cache.get("ghost").has_value());
+  EXPECT_TRUE(cache.get("alice").has_value());
+
+  options.failure_ttl = std::chrono::hours(1);
+  school21::VerificationCache longer(options);
+  longer.put("ghost", notFound(), 1, 1, 10);
+  auto cached = longer.get("ghost");
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->status, school21::LookupStatus::kNotFound);
+  EXPECT_FALSE(cached->participant.has_value());
+}
+
+TEST(VerificationCacheTest, ErrorsAreNotCached) {
+  school21::VerificationCache cache(school21::VerificationCache::Options{});
+  cache.put("alice", school21::Lookup{}, 1, 1, 10);
+  EXPECT_FALSE(cache.get("alice").has_value());
+}
+
+TEST(VerificationCacheTest, EvictsBeyondCapacity) {
+  school21::VerificationCache::Options options;
+  options.capacity = 2;
+  options.shards = 1;
+  school21::VerificationCache cache(options);
+
+  cache.put("a", found("a", "ACTIVE"), 1, 1, 1);
+  cache.put("b", found("b", "ACTIVE"), 1, 1, 2);
+  cache.put("c", found("c", "ACTIVE"), 1, 1, 3);
+  EXPECT_FALSE(cache.get("a").has_value());
+  EXPECT_TRUE(cache.get("c").has_value());
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "school21/verification_pool.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <optional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Minimal HTTP server on 127.0.0.1 answering /v1/participants/{login}
+class FakeSchool21 {
+ public:
+  FakeSchool21() {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd_, 64) != 0) {
+      throw std::runtime_error("FakeSchool21: cannot listen");
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread([this]() { serve(); });
+  }
+
+  ~FakeSchool21() {
+    stopping_ = true;
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    thread_.join();
+  }
+
+  std::string baseUrl() const { return "http://127.0.0.1:" + std::to_string(port_); }
+  int requests() const { return requests_; }
+  std::string lastAuthorization() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_authorization_;
+  }
+
+ private:
+  void serve() {
+    while (!stopping_) {
+      int client = accept(fd_, nullptr, nullptr);
+      if (client < 0) {
+        continue;
+      }
+      std::string request;
+      char buffer[1024];
+      while (request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+          break;
+        }
+        request.append(buffer, static_cast<size_t>(n));
+      }
+      handle(client, request);
+      close(client);
+    }
+  }
+
+  void handle(int client, const std::string& request) {
+    ++requests_;
+    auto auth = request.find("Authorization: ");
+    if (auth != std::string::npos) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      last_authorization_ = request.substr(auth + 15, request.find("\r\n", auth) - auth - 15);
+    }
+    std::string status = "404 Not Found";
+    std::string body = "{}";
+    if (request.rfind("GET /v1/participants/alice ", 0) == 0) {
+      status = "200 OK";
+      body = R"({"login":"alice","status":"ACTIVE","className":"A1"})";
+    }
+    std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: application/json\r\n"
+                           "Content-Length: " + std::to_string(body.size()) +
+                           "\r\nConnection: close\r\n\r\n" + body;
+    send(client, response.data(), response.size(), MSG_NOSIGNAL);
+  }
+
+  int fd_ = -1;
+  int port_ = 0;
+  std::atomic<bool> stopping_{false};
+  std::atomic<int> requests_{0};
+  std::mutex mutex_;
+  std::string last_authorization_;
+  std::thread thread_;
+};
+
+// Collects callback results
+struct Results {
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::map<int, school21::Lookup> by_id;
+
+  school21::VerificationPool::Callback callback(int id) {
+    return [this, id](school21::Lookup lookup) {
+      std::lock_guard<std::mutex> lock(mutex);
+      by_id[id] = std::move(lookup);
+      cv.notify_all();
+    };
+  }
+
+  bool waitFor(size_t count) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, std::chrono::seconds(10), [&] { return by_id.size() >= count; });
+  }
+};
+
+}  // namespace
+
+TEST(VerificationPoolTest, ResolvesConcurrentLookups) {
+  FakeSchool21 server;
+  Results results;
+  school21::VerificationPool::Options options;
+  options.base_url = server.baseUrl();
+  options.max_concurrent = 4;
+  school21::VerificationPool pool(options, [] { return std::string("secret"); });
+
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(pool.submit(i % 2 == 0 ? "alice" : "ghost", results.callback(i)));
+  }
+  ASSERT_TRUE(results.waitFor(20));
+
+  std::lock_guard<std::mutex> lock(results.mutex);
+  for (int i = 0; i < 20; ++i) {
+    if (i % 2 == 0) {
+      ASSERT_EQ(results.by_id[i].status, school21::LookupStatus::kFound) << "i = " << i;
+      EXPECT_EQ(results.by_id[i].participant->login, "alice");
+      EXPECT_EQ(results.by_id[i].participant->status, "ACTIVE");
+      EXPECT_EQ(results.by_id[i].participant->class_name, "A1");
+    } else {
+      EXPECT_EQ(results.by_id[i].status, school21::LookupStatus::kNotFound) << "i = " << i;
+      EXPECT_FALSE(results.by_id[i].participant.has_value());
+    }
+  }
+  EXPECT_EQ(server.requests(), 20);
+  EXPECT_EQ(server.lastAuthorization(), "Bearer secret");
+}
+
+TEST(VerificationPoolTest, TokenFailureFailsTheLookups) {
+  FakeSchool21 server;
+  Results results;
+  school21::VerificationPool::Options options;
+  options.base_url = server.baseUrl();
+  school21::VerificationPool pool(options, []() -> std::string {
+    throw std::runtime_error("auth down");
+  });
+
+  ASSERT_TRUE(pool.submit("alice", results.callback(1)));
+  ASSERT_TRUE(results.waitFor(1));
+  EXPECT_EQ(results.by_id[1].status, school21::LookupStatus::kError);
+  EXPECT_EQ(server.requests(), 0);
+}
+
+TEST(VerificationPoolTest, ShutdownFinishesQueuedLookups) {
+  FakeSchool21 server;
+  Results results;
+  school21::VerificationPool::Options options;
+  options.base_url = server.baseUrl();
+  options.max_concurrent = 1;
+  school21::VerificationPool pool(options, [] { return std::string(); });
+
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(pool.submit("alice", results.callback(i)));
+  }
+  pool.shutdown();
+  EXPECT_EQ(results.by_id.size(), 5u);
+  EXPECT_FALSE(pool.submit("alice", results.callback(99)));
+}
+
+TEST(VerificationPoolTest, CallbackContinuesTheSubmittersTrace) {
+  FakeSchool21 server;
+  school21::VerificationPool::Options options;
+  options.base_url = server.baseUrl();
+  school21::VerificationPool pool(options, [] { return std::string(); });
+
+  observability::SpanContext submitted;
+  submitted.trace_id.fill(0x42);
+  submitted.span_id.fill(0x07);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::optional<observability::SpanContext> seen;
+  {
+    observability::ContextScope scope(submitted);
+    ASSERT_TRUE(pool.submit("alice", [&](school21::Lookup) {
+      std::lock_guard<std::mutex> lock(mutex);
+      seen = observability::currentContext();
+      cv.notify_all();
+    }));
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&] { return seen.has_value(); }));
+  EXPECT_EQ(seen->trace_id, submitted.trace_id);
+  EXPECT_EQ(seen->span_id, submitted.span_id);
+}
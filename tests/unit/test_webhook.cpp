@@ -69,7 +69,7 @@ TEST_F(WebhookServerTest, CallbackCanBeSet) {
   
   server_->setUpdateCallback([&](const std::string&) {
     callback_set = true;
-    return true;
+    return bot::WebhookServer::UpdateResult::kProcessed;
   });
   
   // Callback is stored but not called until server receives a request
@@ -103,6 +103,12 @@ TEST_F(WebhookServerTest, DefaultConfigurationValues) {
   EXPECT_TRUE(config.secret_token.empty());
   EXPECT_EQ(config.backlog, 10);
   EXPECT_GT(config.max_body_size, 0);
+  EXPECT_EQ(config.worker_threads, 0);
+  EXPECT_GT(config.max_queue_depth, 0);
+  EXPECT_GT(config.keep_alive_timeout_seconds, 0);
+  EXPECT_GT(config.max_connections, 0);
+  EXPECT_EQ(config.metrics_path, "/metrics");
+  EXPECT_TRUE(config.metrics_token.empty());
 }
 
 // =============================================================================